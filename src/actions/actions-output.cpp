@@ -229,6 +229,20 @@ export_png_antialias(const Glib::VariantBase&  value, InkscapeApplication *app)
     app->file_export()->export_png_antialias = i.get();
 }
 
+void
+export_png_strip_height(const Glib::VariantBase&  value, InkscapeApplication *app)
+{
+    Glib::Variant<int> i = Glib::VariantBase::cast_dynamic<Glib::Variant<int> >(value);
+    app->file_export()->export_png_strip_height = i.get();
+}
+
+void
+export_png_threads(const Glib::VariantBase&  value, InkscapeApplication *app)
+{
+    Glib::Variant<int> i = Glib::VariantBase::cast_dynamic<Glib::Variant<int> >(value);
+    app->file_export()->export_png_threads = i.get();
+}
+
 void
 export_do(InkscapeApplication *app)
 {
@@ -276,6 +290,8 @@ std::vector<std::vector<Glib::ustring>> raw_data_output =
     {"app.export-png-use-dithering",  N_("Export PNG Dithering"),      "Export",     N_("Set dithering for PNG export")                       },
     {"app.export-png-compression",    N_("Export PNG Compression"),    "Export",     N_("Set compression level for PNG export")               },
     {"app.export-png-antialias",      N_("Export PNG Antialiasing"),      "Export",     N_("Set antialiasing level for PNG export")                 },
+    {"app.export-png-strip-height",   N_("Export PNG Strip Height"),   "Export",     N_("Set number of rows rendered at once for PNG export") },
+    {"app.export-png-threads",        N_("Export PNG Threads"),        "Export",     N_("Set number of rendering threads for PNG export")     },
 
     {"app.export-do",                 N_("Do Export"),                 "Export",     N_("Do export")                                          }
     // clang-format on
@@ -312,7 +328,9 @@ std::vector<std::vector<Glib::ustring>> hint_data_output =
     {"app.export-png-color-mode",     N_("Enter string for PNG Color Mode, one of Gray_1/Gray_2/Gray_4/Gray_8/Gray_16/RGB_8/RGB_16/GrayAlpha_8/GrayAlpha_16/RGBA_8/RGBA_16")},
     {"app.export-png-use-dithering",  N_("Enter 1/0 for Yes/No to use dithering")          },
     {"app.export-png-compression",    N_("Enter integer for PNG compression level (0 (none) to 9 (max))")},
-    {"app.export-png-antialias",      N_("Enter integer for PNG antialiasing level (0 (none) to 3 (best))")}
+    {"app.export-png-antialias",      N_("Enter integer for PNG antialiasing level (0 (none) to 3 (best))")},
+    {"app.export-png-strip-height",   N_("Enter integer for number of rows rendered at once for PNG export")},
+    {"app.export-png-threads",        N_("Enter integer for number of PNG rendering threads (0 to use preferences)")}
     // clang-format on
 };
 
@@ -361,6 +379,8 @@ add_actions_output(InkscapeApplication* app)
     gapp->add_action_with_parameter( "export-png-use-dithering", Bool,   sigc::bind(sigc::ptr_fun(&export_png_use_dithering), app));
     gapp->add_action_with_parameter( "export-png-compression",   Int,    sigc::bind(sigc::ptr_fun(&export_png_compression),   app));
     gapp->add_action_with_parameter( "export-png-antialias",     Int,    sigc::bind(sigc::ptr_fun(&export_png_antialias),     app));
+    gapp->add_action_with_parameter( "export-png-strip-height",  Int,    sigc::bind(sigc::ptr_fun(&export_png_strip_height),  app));
+    gapp->add_action_with_parameter( "export-png-threads",       Int,    sigc::bind(sigc::ptr_fun(&export_png_threads),       app));
 
     // Extra
     gapp->add_action(                "export-do",                        sigc::bind(sigc::ptr_fun(&export_do),           app));
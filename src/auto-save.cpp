@@ -11,7 +11,11 @@
  */
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <future>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -21,6 +25,7 @@
 #include <glibmm/i18n.h> // Internationalization
 #include <glibmm/main.h>
 #include <glibmm/miscutils.h>
+#include <glib/gstdio.h>
 
 #include "auto-save.h"
 #include "document.h"
@@ -28,21 +33,91 @@
 #include "preferences.h"
 #include "extension/output.h"
 #include "helper/auto-connection.h"
+#include "gc-anchored.h"
 #include "io/sys.h"
+#include "xml/journal.h"
 #include "xml/repr.h"
 
 #ifdef _WIN32
 #include <process.h>
+#include <windows.h>
 typedef int uid_t;
 #define getuid() 0
+#else
+#include <signal.h>
 #endif
 
 namespace Inkscape {
 
+namespace {
+
+constexpr char const *JOURNAL_SUFFIX = ".journal";
+
+std::string autosave_directory()
+{
+    std::string autosave_dir = Inkscape::Preferences::get()->getString("/options/autosave/path"); // Filenames should be std::string
+    if (autosave_dir.empty()) {
+        autosave_dir = Glib::build_filename(Glib::get_user_cache_dir(), "inkscape");
+    }
+    return autosave_dir;
+}
+
+/// Writes or appends @a data to the file at @a path; runs on the threads saving journals.
+bool write_file(std::string const &path, std::string const &data, bool append)
+{
+    FILE *file = Inkscape::IO::fopen_utf8name(path.c_str(), append ? "ab" : "wb");
+    bool ok = file && std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    if (file && std::fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        auto const safeUri = Inkscape::IO::sanitizeString(path.c_str());
+        g_warning(_("Autosave failed! File %s could not be saved."), safeUri.c_str());
+    }
+    return ok;
+}
+
+bool process_running(int pid)
+{
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process) {
+        return false;
+    }
+    DWORD exit_code = 0;
+    bool running = GetExitCodeProcess(process, &exit_code) && exit_code == STILL_ACTIVE;
+    CloseHandle(process);
+    return running;
+#else
+    return kill(pid, 0) == 0 || errno == EPERM;
+#endif
+}
+
+} // namespace
+
+/// The journal of one document, and the file it is written to.
+struct AutoSave::Journal
+{
+    explicit Journal(Inkscape::XML::Document &doc)
+        : changes(doc)
+    {}
+
+    Inkscape::XML::Journal changes;
+    std::string path;
+    std::size_t snapshot_size = 0; ///< In records, like appended.
+    std::size_t appended = 0;
+    std::future<void> writing;     ///< The last write, which the next one waits for.
+    auto_connection destroyed;
+};
+
+AutoSave::AutoSave() = default;
+AutoSave::~AutoSave() = default;
+
 void
 AutoSave::init(InkscapeApplication* app)
 {
     _app = app;
+    recover();
     start();
 }
 
@@ -79,11 +154,7 @@ AutoSave::save()
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
 
     // Find/create autosave directory
-    std::string autosave_dir = prefs->getString("/options/autosave/path"); // Filenames should be std::string
-    if (autosave_dir.empty()) {
-        autosave_dir = Glib::build_filename(Glib::get_user_cache_dir(), "inkscape");
-    }
-
+    std::string autosave_dir = autosave_directory();
     Glib::RefPtr<Gio::File> dir_file = Gio::File::create_for_path(autosave_dir);
     if (!dir_file->query_exists()) {
         if (!dir_file->make_directory_with_parents()) {
@@ -93,7 +164,6 @@ AutoSave::save()
     }
 
     // Get unique info
-    uid_t uid = getuid(); // Avoid naming conflicts between users
     int pid = ::getpid(); // Avoid naming conflicts between processes
 
     // Get time stamp
@@ -108,73 +178,139 @@ AutoSave::save()
 
         ++docnum; // Give each document a unique number.
 
-        if (document->isModifiedSinceAutoSave()) {
-            std::string base_name = "automatic-save-" + std::to_string(uid);
-
-            // The following we do for each document (rather wasteful...) so that
-            // we make room for each document that needs saving. We probably should
-            // be counting per document and not overall documents.
-
-            // Open directory
-            Glib::Dir directory(autosave_dir);
-            std::vector<std::string> file_names(directory.begin(), directory.end());
-
-            // Sort them so that oldest are last (file name encodes time).
-            std::sort(file_names.begin(), file_names.end(), std::greater<std::string>());
-
-            // Delete oldest files.
-            int count = 0;
-            for (auto &file_name : file_names) {
-                if (file_name.compare(0, base_name.size(), base_name) == 0) {
-                    ++count;
-                    if (count >= autosave_max) {
-                        // Delete (making room for one more).
-                        std::string path = Glib::build_filename(autosave_dir, file_name);
-                        if (unlink(path.c_str()) == -1) {
-                            std::cerr << "InkscapeApplication::document_autosave: Failed to unlink file: "
-                                      << path << ": " << strerror(errno) << std::endl;
-                        }
-                    }
-                }
+        auto &journal = _journals[document];
+        if (journal) {
+            // Wait for the last save, which had the whole interval to finish.
+            if (journal->writing.valid()) {
+                journal->writing.wait();
+            }
+            if (journal->changes.empty()) {
+                continue;
             }
+            if (journal->appended <= journal->snapshot_size / 2 &&
+                Glib::file_test(journal->path, Glib::FileTest::EXISTS)) {
+                // Only append what changed since the last save.
+                auto changes = journal->changes.takeChanges();
+                journal->appended += changes.size();
+                journal->writing = std::async(std::launch::async, [path = journal->path, changes = std::move(changes)] {
+                    write_file(path, changes.text(), true);
+                });
+                document->setModifiedSinceAutoSaveFalse();
+                continue;
+            }
+        } else if (document->isModifiedSinceAutoSave()) {
+            journal = std::make_unique<Journal>(*document->getReprDoc());
+            journal->destroyed = document->connectDestroy([this, document] { _journals.erase(document); });
+        } else {
+            _journals.erase(document);
+            continue;
+        }
+
+        std::string base_name = "automatic-save-" + std::to_string(getuid());
 
-            // Construct save file path
-            // datetime MUST happen first, otherwise the above sorting will fail
-            std::string filename = base_name + "-" + datetime.str() + "-" + std::to_string(pid) + "-" + std::to_string(docnum) + ".svg";
-            std::string path = Glib::build_filename(autosave_dir, filename.c_str());
-
-            // Try to save the file
-            // Following code needs to be reviewed
-            FILE *file = Inkscape::IO::fopen_utf8name(path.c_str(), "w");
-            gchar *errortext = nullptr;
-            if (file) {
-                try {
-                    Inkscape::XML::Node *repr = document->getReprRoot();
-                    sp_repr_save_stream(repr->document(), file, SP_SVG_NS_URI);
-                } catch (Inkscape::Extension::Output::no_extension_found &e) {
-                    errortext = g_strdup(_("Autosave failed! Could not find inkscape extension to save document."));
-                } catch (Inkscape::Extension::Output::save_failed &e) {
-                    auto const safeUri = Inkscape::IO::sanitizeString(path.c_str());
-                    errortext = g_strdup_printf(_("Autosave failed! File %s could not be saved."), safeUri.c_str());
+        // The following we do for each document (rather wasteful...) so that
+        // we make room for each document that needs saving. We probably should
+        // be counting per document and not overall documents.
+
+        // Open directory
+        Glib::Dir directory(autosave_dir);
+        std::vector<std::string> file_names(directory.begin(), directory.end());
+
+        // Sort them so that oldest are last (file name encodes time).
+        std::sort(file_names.begin(), file_names.end(), std::greater<std::string>());
+
+        // Delete oldest files.
+        int count = 0;
+        for (auto &file_name : file_names) {
+            if (file_name.compare(0, base_name.size(), base_name) == 0) {
+                ++count;
+                std::string path = Glib::build_filename(autosave_dir, file_name);
+                bool in_use = std::any_of(_journals.begin(), _journals.end(),
+                                          [&] (auto const &entry) { return entry.second && entry.second->path == path; });
+                if (count >= autosave_max && !in_use) {
+                    // Delete (making room for one more).
+                    if (unlink(path.c_str()) == -1) {
+                        std::cerr << "InkscapeApplication::document_autosave: Failed to unlink file: "
+                                  << path << ": " << strerror(errno) << std::endl;
+                    }
                 }
-                fclose(file);
-            } else {
-                auto const safeUri = Inkscape::IO::sanitizeString(path.c_str());
-                errortext = g_strdup_printf(_("Autosave failed! File %s could not be saved."), safeUri.c_str());
             }
+        }
 
-            if (errortext) {
-                g_warning("%s", errortext);
-                g_free(errortext);
-            } else {
-                document->setModifiedSinceAutoSaveFalse();
+        // Construct save file path
+        // datetime MUST happen first, otherwise the above sorting will fail
+        std::string filename = base_name + "-" + datetime.str() + "-" + std::to_string(pid) + "-" + std::to_string(docnum) + JOURNAL_SUFFIX;
+
+        // Start a new journal with the whole document, written out of the way so that an
+        // interrupted write does not leave a journal without a snapshot behind. Only the records
+        // are gathered here; they are turned into text on the writing thread.
+        auto snapshot = journal->changes.snapshot();
+        journal->path = Glib::build_filename(autosave_dir, filename);
+        journal->snapshot_size = snapshot.size();
+        journal->appended = 0;
+        journal->writing = std::async(std::launch::async, [path = journal->path, snapshot = std::move(snapshot)] {
+            auto const partial = path + ".part";
+            if (write_file(partial, snapshot.text(), false) && g_rename(partial.c_str(), path.c_str()) != 0) {
+                auto const safeUri = Inkscape::IO::sanitizeString(path.c_str());
+                g_warning(_("Autosave failed! File %s could not be saved."), safeUri.c_str());
             }
-        }
+        });
+        document->setModifiedSinceAutoSaveFalse();
     } // Loop over documents
 
     return true;
 }
 
+void
+AutoSave::recover()
+{
+    std::string autosave_dir = autosave_directory();
+    if (!Glib::file_test(autosave_dir, Glib::FileTest::IS_DIR)) {
+        return;
+    }
+
+    std::string base_name = "automatic-save-" + std::to_string(getuid());
+    Glib::Dir directory(autosave_dir);
+    for (auto const &file_name : std::vector<std::string>(directory.begin(), directory.end())) {
+        if (file_name.compare(0, base_name.size(), base_name) != 0 ||
+            !Glib::str_has_suffix(file_name, JOURNAL_SUFFIX)) {
+            continue;
+        }
+
+        // The name ends with "-<pid>-<docnum>.journal"; leave the journals of running sessions.
+        auto const stem = file_name.substr(0, file_name.size() - std::strlen(JOURNAL_SUFFIX));
+        auto const docnum_start = stem.rfind('-');
+        auto const pid_start = docnum_start == std::string::npos ? docnum_start : stem.rfind('-', docnum_start - 1);
+        if (pid_start == std::string::npos) {
+            continue;
+        }
+        int const pid = std::atoi(stem.c_str() + pid_start + 1);
+        if (pid == ::getpid() || process_running(pid)) {
+            continue;
+        }
+
+        std::string path = Glib::build_filename(autosave_dir, file_name);
+        Inkscape::XML::Document *doc = nullptr;
+        try {
+            doc = Inkscape::XML::Journal::read(Glib::file_get_contents(path));
+        } catch (Glib::FileError const &) {
+        }
+
+        auto const safeUri = Inkscape::IO::sanitizeString(path.c_str());
+        if (!doc) {
+            g_warning(_("Autosave file %s could not be read."), safeUri.c_str());
+            continue;
+        }
+        std::string svg_path = Glib::build_filename(autosave_dir, stem + ".svg");
+        if (sp_repr_save_file(doc, svg_path.c_str(), SP_SVG_NS_URI)) {
+            unlink(path.c_str());
+        } else {
+            g_warning(_("Autosave failed! File %s could not be saved."), safeUri.c_str());
+        }
+        Inkscape::GC::release(doc);
+    }
+}
+
 void
 AutoSave::restart()
 {
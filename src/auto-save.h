@@ -13,13 +13,26 @@
 #ifndef INKSCAPE_AUTOSAVE_H
 #define INKSCAPE_AUTOSAVE_H
 
+#include <memory>
+#include <unordered_map>
+
 class InkscapeApplication;
+class SPDocument;
 
 namespace Inkscape {
 
+/**
+ * Saves the open documents at regular intervals.
+ *
+ * The first save of a document writes a snapshot of it to a journal file, and the following
+ * ones only append the changes made since; the journal is written out again as a whole once
+ * those outgrow the snapshot. Writing happens on a separate thread. Journals left behind by
+ * a previous session are turned into SVG files at startup.
+ */
 class AutoSave final {
 private:
-    AutoSave() = default;
+    AutoSave();
+    ~AutoSave();
 
 public:
     AutoSave(const AutoSave &) = delete;
@@ -38,8 +51,14 @@ public:
     void start(); // Includes restarting.
     bool save();
 
+    /// Turns the journals of the sessions that ended into SVG files next to them.
+    void recover();
+
 private:
+    struct Journal;
+
     InkscapeApplication* _app = nullptr;
+    std::unordered_map<SPDocument *, std::unique_ptr<Journal>> _journals;
 };
 
 } // namespace Inkscape
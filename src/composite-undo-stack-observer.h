@@ -103,6 +103,17 @@ public:
 			this->_observer->notifyClearRedoEvent();
 		}
 
+		/**
+		 * Issue an expired event to the UndoStackObserver that is associated with this
+		 * UndoStackObserverRecord.
+		 *
+		 * \param log The event dropped from the undo stack.
+		 */
+		void issueUndoExpired(Event* log)
+		{
+			this->_observer->notifyUndoExpiredEvent(log);
+		}
+
 	private:
 		UndoStackObserver *_observer;
 	};
@@ -155,6 +166,13 @@ public:
 	void notifyClearUndoEvent() override;
 	void notifyClearRedoEvent() override;
 
+	/**
+	 * Notify all registered UndoStackObservers that the oldest event of the undo stack is dropped.
+	 *
+	 * \param log The event dropped from the undo stack.
+	 */
+	void notifyUndoExpiredEvent(Event* log) override;
+
 private:
 	// Remove an observer from a given list
 	bool _remove_one(UndoObserverRecordList& list, UndoStackObserver& rec);
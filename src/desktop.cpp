@@ -1253,6 +1253,7 @@ SPDesktop::setDocument (SPDocument *doc)
         if (auto const drawing_item = root->invoke_show(*drawing, dkey, SP_ITEM_SHOW_DISPLAY)) {
             drawing->root()->prependChild(drawing_item);
         }
+        _canvas_drawing->set_disk_cache_document(doc);
 
         namedview->show(this);
         namedview->setShowGrids(namedview->getShowGrids());
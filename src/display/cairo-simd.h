@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Vectorized pixel kernels for the software filter and blend templates.
+ *
+ * The kernels operate on spans of premultiplied 32-bit ARGB pixels and produce exactly the same
+ * output as the scalar functors in the nr-filter-* primitives. The instruction set is picked
+ * once at runtime (AVX2, SSE4.1 or the compiler's generic vector code); when none is available,
+ * ink_cairo_surface_filter() and ink_cairo_surface_blend() use the scalar functors instead.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DISPLAY_CAIRO_SIMD_H
+#define SEEN_INKSCAPE_DISPLAY_CAIRO_SIMD_H
+
+#include <cstdint>
+
+namespace Inkscape {
+namespace Display {
+namespace Simd {
+
+enum class Level
+{
+    None,    ///< No vector kernels; callers must use the scalar code.
+    Generic, ///< Baseline instruction set of the build (e.g. SSE2, NEON).
+    SSE41,
+    AVX2,
+};
+
+/// The instruction set used by the kernels below, or Level::None if they must not be used.
+Level level();
+char const *level_name(Level level);
+
+/// Enable or disable the vector kernels, e.g. to compare them against the scalar templates.
+void set_enabled(bool enabled);
+
+/**
+ * Apply a feColorMatrix matrix in the fixed point form used by FilterColorMatrix::ColorMatrixMatrix:
+ * coefficients scaled by 255, offsets (every fifth value) scaled by 255*255.
+ * The input is unpremultiplied before and the output premultiplied after the multiplication.
+ */
+void color_matrix(std::int32_t const matrix[20], std::uint32_t const *in, std::uint32_t *out, int n);
+
+/// Premultiply the color channels of n pixels by their alpha.
+void premultiply(std::uint32_t const *in, std::uint32_t *out, int n);
+
+/// Divide the color channels of n pixels by their alpha; pixels with zero alpha are copied.
+void unpremultiply(std::uint32_t const *in, std::uint32_t *out, int n);
+
+/**
+ * feComposite operator="arithmetic" with k1 scaled by 255, k2 and k3 by 255^2 and k4 by 255^3,
+ * as in ComposeArithmetic.
+ */
+void compose_arithmetic(std::int32_t const k[4], std::uint32_t const *in1, std::uint32_t const *in2,
+                        std::uint32_t *out, int n);
+
+} // namespace Simd
+} // namespace Display
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_DISPLAY_CAIRO_SIMD_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
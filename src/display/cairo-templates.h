@@ -19,17 +19,34 @@
 
 #include <glib.h>
 
-#ifdef HAVE_OPENMP
-#include <omp.h>
-// single-threaded operation if the number of pixels is below this threshold
-static const int OPENMP_THRESHOLD = 2048;
-#endif
-
 #include <cmath>
 #include <algorithm>
 #include <cairo.h>
 #include "display/nr-3dutils.h"
+#include "display/cairo-simd.h"
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
+
+/**
+ * Functors may additionally process a whole span of 32-bit ARGB pixels at once, which lets them
+ * use the vectorized kernels from cairo-simd.h. The templates below call the span version for
+ * ARGB32 surfaces whenever Inkscape::Display::Simd::level() says the kernels can be used.
+ */
+template <typename Filter>
+concept SpanFilter = requires(Filter &filter, guint32 const *in, guint32 *out, int n) {
+    filter.filter_span(in, out, n);
+};
+
+template <typename Blend>
+concept SpanBlend = requires(Blend &blend, guint32 const *in1, guint32 const *in2, guint32 *out,
+                             int n) {
+    blend.blend_span(in1, in2, out, n);
+};
+
+inline bool ink_cairo_simd_enabled()
+{
+    return Inkscape::Display::Simd::level() != Inkscape::Display::Simd::Level::None;
+}
 
 /**
  * Blend two surfaces using the supplied functor.
@@ -74,25 +91,29 @@ void ink_cairo_surface_blend(cairo_surface_t *in1, cairo_surface_t *in2, cairo_s
     // NOTE
     // OpenMP probably doesn't help much here.
     // It would be better to render more than 1 tile at a time.
-    #if HAVE_OPENMP
-    int numOfThreads = get_num_filter_threads();
-    #endif
+    auto &pool = Inkscape::get_dispatch_pool();
+    bool const parallel = limit > Inkscape::DISPATCH_PIXEL_THRESHOLD;
+
+    if constexpr (SpanBlend<Blend>) {
+        if (bpp1 == 4 && bpp2 == 4 && ink_cairo_simd_enabled()) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
+                blend.blend_span(in1_data + i * stride1/4, in2_data + i * stride2/4,
+                                 out_data + i * strideout/4, w);
+            });
+            cairo_surface_mark_dirty(out);
+            return;
+        }
+    }
 
     // The number of code paths here is evil.
     if (bpp1 == 4) {
         if (bpp2 == 4) {
             if (fast_path) {
-                #if HAVE_OPENMP
-                #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-                #endif
-                for (int i = 0; i < limit; ++i) {
+                pool.dispatch_threshold(limit, parallel, [&] (int i) {
                     *(out_data + i) = blend(*(in1_data + i), *(in2_data + i));
-                }
+                });
             } else {
-                #if HAVE_OPENMP
-                #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-                #endif
-                for (int i = 0; i < h; ++i) {
+                pool.dispatch_threshold(h, parallel, [&] (int i) {
                     guint32 *in1_p = in1_data + i * stride1/4;
                     guint32 *in2_p = in2_data + i * stride2/4;
                     guint32 *out_p = out_data + i * strideout/4;
@@ -100,14 +121,11 @@ void ink_cairo_surface_blend(cairo_surface_t *in1, cairo_surface_t *in2, cairo_s
                         *out_p = blend(*in1_p, *in2_p);
                         ++in1_p; ++in2_p; ++out_p;
                     }
-                }
+                });
             }
         } else {
             // bpp2 == 1
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < h; ++i) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
                 guint32 *in1_p = in1_data + i * stride1/4;
                 guint8  *in2_p = reinterpret_cast<guint8*>(in2_data) + i * stride2;
                 guint32 *out_p = out_data + i * strideout/4;
@@ -117,15 +135,12 @@ void ink_cairo_surface_blend(cairo_surface_t *in1, cairo_surface_t *in2, cairo_s
                     *out_p = blend(*in1_p, in2_px);
                     ++in1_p; ++in2_p; ++out_p;
                 }
-            }
+            });
         }
     } else {
         if (bpp2 == 4) {
             // bpp1 == 1
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < h; ++i) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
                 guint8  *in1_p = reinterpret_cast<guint8*>(in1_data) + i * stride1;
                 guint32 *in2_p = in2_data + i * stride2/4;
                 guint32 *out_p = out_data + i * strideout/4;
@@ -135,14 +150,11 @@ void ink_cairo_surface_blend(cairo_surface_t *in1, cairo_surface_t *in2, cairo_s
                     *out_p = blend(in1_px, *in2_p);
                     ++in1_p; ++in2_p; ++out_p;
                 }
-            }
+            });
         } else {
             // bpp1 == 1 && bpp2 == 1
             if (fast_path) {
-                #if HAVE_OPENMP
-                #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-                #endif
-                for (int i = 0; i < limit; ++i) {
+                pool.dispatch_threshold(limit, parallel, [&] (int i) {
                     guint8 *in1_p = reinterpret_cast<guint8*>(in1_data) + i;
                     guint8 *in2_p = reinterpret_cast<guint8*>(in2_data) + i;
                     guint8 *out_p = reinterpret_cast<guint8*>(out_data) + i;
@@ -150,12 +162,9 @@ void ink_cairo_surface_blend(cairo_surface_t *in1, cairo_surface_t *in2, cairo_s
                     guint32 in2_px = *in2_p; in2_px <<= 24;
                     guint32 out_px = blend(in1_px, in2_px);
                     *out_p = out_px >> 24;
-                }
+                });
             } else {
-                #if HAVE_OPENMP
-                #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-                #endif
-                for (int i = 0; i < h; ++i) {
+                pool.dispatch_threshold(h, parallel, [&] (int i) {
                     guint8 *in1_p = reinterpret_cast<guint8*>(in1_data) + i * stride1;
                     guint8 *in2_p = reinterpret_cast<guint8*>(in2_data) + i * stride2;
                     guint8 *out_p = reinterpret_cast<guint8*>(out_data) + i * strideout;
@@ -166,7 +175,7 @@ void ink_cairo_surface_blend(cairo_surface_t *in1, cairo_surface_t *in2, cairo_s
                         *out_p = out_px >> 24;
                         ++in1_p; ++in2_p; ++out_p;
                     }
-                }
+                });
             }
         }
     }
@@ -200,29 +209,33 @@ void ink_cairo_surface_filter(cairo_surface_t *in, cairo_surface_t *out, Filter
     guint32 *const in_data  = reinterpret_cast<guint32*>(cairo_image_surface_get_data(in));
     guint32 *const out_data = reinterpret_cast<guint32*>(cairo_image_surface_get_data(out));
 
-    #if HAVE_OPENMP
-    int numOfThreads = get_num_filter_threads();
-    #endif
+    auto &pool = Inkscape::get_dispatch_pool();
+    bool const parallel = limit > Inkscape::DISPATCH_PIXEL_THRESHOLD;
+
+    if constexpr (SpanFilter<Filter>) {
+        // the span kernels load each block of pixels before storing it, so in == out is fine
+        if (bppin == 4 && bppout == 4 && ink_cairo_simd_enabled()) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
+                filter.filter_span(in_data + i * stridein/4, out_data + i * strideout/4, w);
+            });
+            cairo_surface_mark_dirty(out);
+            return;
+        }
+    }
 
     // this is provided just in case, to avoid problems with strict aliasing rules
     if (in == out) {
         if (bppin == 4) {
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < limit; ++i) {
+            pool.dispatch_threshold(limit, parallel, [&] (int i) {
                 *(in_data + i) = filter(*(in_data + i));
-            }
+            });
         } else {
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < limit; ++i) {
+            pool.dispatch_threshold(limit, parallel, [&] (int i) {
                 guint8 *in_p = reinterpret_cast<guint8*>(in_data) + i;
                 guint32 in_px = *in_p; in_px <<= 24;
                 guint32 out_px = filter(in_px);
                 *in_p = out_px >> 24;
-            }
+            });
         }
         cairo_surface_mark_dirty(out);
         return;
@@ -232,32 +245,23 @@ void ink_cairo_surface_filter(cairo_surface_t *in, cairo_surface_t *out, Filter
         if (bppout == 4) {
             // bppin == 4, bppout == 4
             if (fast_path) {
-                #if HAVE_OPENMP
-                #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-                #endif
-                for (int i = 0; i < limit; ++i) {
+                pool.dispatch_threshold(limit, parallel, [&] (int i) {
                     *(out_data + i) = filter(*(in_data + i));
-                }
+                });
             } else {
-                #if HAVE_OPENMP
-                #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-                #endif
-                for (int i = 0; i < h; ++i) {
+                pool.dispatch_threshold(h, parallel, [&] (int i) {
                     guint32 *in_p = in_data + i * stridein/4;
                     guint32 *out_p = out_data + i * strideout/4;
                     for (int j = 0; j < w; ++j) {
                         *out_p = filter(*in_p);
                         ++in_p; ++out_p;
                     }
-                }
+                });
             }
         } else {
             // bppin == 4, bppout == 1
             // we use this path with COLORMATRIX_LUMINANCETOALPHA
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < h; ++i) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
                 guint32 *in_p = in_data + i * stridein/4;
                 guint8 *out_p = reinterpret_cast<guint8*>(out_data) + i * strideout;
                 for (int j = 0; j < w; ++j) {
@@ -265,26 +269,20 @@ void ink_cairo_surface_filter(cairo_surface_t *in, cairo_surface_t *out, Filter
                     *out_p = out_px >> 24;
                     ++in_p; ++out_p;
                 }
-            }
+            });
         }
     } else if (bppout == 1) {
         // bppin == 1, bppout == 1
         if (fast_path) {
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < limit; ++i) {
+            pool.dispatch_threshold(limit, parallel, [&] (int i) {
                 guint8 *in_p = reinterpret_cast<guint8*>(in_data) + i;
                 guint8 *out_p = reinterpret_cast<guint8*>(out_data) + i;
                 guint32 in_px = *in_p; in_px <<= 24;
                 guint32 out_px = filter(in_px);
                 *out_p = out_px >> 24;
-            }
+            });
         } else {
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < h; ++i) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
                 guint8 *in_p = reinterpret_cast<guint8*>(in_data) + i * stridein;
                 guint8 *out_p = reinterpret_cast<guint8*>(out_data) + i * strideout;
                 for (int j = 0; j < w; ++j) {
@@ -293,30 +291,24 @@ void ink_cairo_surface_filter(cairo_surface_t *in, cairo_surface_t *out, Filter
                     *out_p = out_px >> 24;
                     ++in_p; ++out_p;
                 }
-            }
+            });
         }
     } else {
         // bppin == 1, bppout == 4
         // used in COLORMATRIX_MATRIX when in is NR_FILTER_SOURCEALPHA
         if (fast_path) {
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < limit; ++i) {
+            pool.dispatch_threshold(limit, parallel, [&] (int i) {
                 guint8 in_p = reinterpret_cast<guint8*>(in_data)[i];
                 out_data[i] = filter(guint32(in_p) << 24);
-            }
+            });
         } else {
-            #if HAVE_OPENMP
-            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-            #endif
-            for (int i = 0; i < h; ++i) {
+            pool.dispatch_threshold(h, parallel, [&] (int i) {
                 guint8 *in_p = reinterpret_cast<guint8*>(in_data) + i * stridein;
                 guint32 *out_p = out_data + i * strideout/4;
                 for (int j = 0; j < w; ++j) {
                     out_p[j] = filter(guint32(in_p[j]) << 24);
                 }
-            }
+            });
         }
     }
     cairo_surface_mark_dirty(out);
@@ -346,35 +338,30 @@ void ink_cairo_surface_synthesize(cairo_surface_t *out, cairo_rectangle_t const
 
     unsigned char *out_data = cairo_image_surface_get_data(out);
 
-    #if HAVE_OPENMP
     int limit = w * h;
-    int numOfThreads = get_num_filter_threads();
-    #endif
+    auto &pool = Inkscape::get_dispatch_pool();
+    bool const parallel = limit > Inkscape::DISPATCH_PIXEL_THRESHOLD;
 
     if (bppout == 4) {
-        #if HAVE_OPENMP
-        #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-        #endif
-        for (int i = out_area.y; i < h; ++i) {
+        pool.dispatch_threshold(h - (int)out_area.y, parallel, [&] (int k) {
+            int i = out_area.y + k;
             guint32 *out_p = reinterpret_cast<guint32*>(out_data + i * strideout);
             for (int j = out_area.x; j < w; ++j) {
                 *out_p = synth(j, i);
                 ++out_p;
             }
-        }
+        });
     } else {
         // bppout == 1
-        #if HAVE_OPENMP
-        #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-        #endif
-        for (int i = out_area.y; i < h; ++i) {
+        pool.dispatch_threshold(h - (int)out_area.y, parallel, [&] (int k) {
+            int i = out_area.y + k;
             guint8 *out_p = out_data + i * strideout;
             for (int j = out_area.x; j < w; ++j) {
                 guint32 out_px = synth(j, i);
                 *out_p = out_px >> 24;
                 ++out_p;
             }
-        }
+        });
     }
     cairo_surface_mark_dirty(out);
 }
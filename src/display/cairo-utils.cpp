@@ -19,7 +19,6 @@
 #include <2geom/point.h>
 #include <2geom/sbasis-to-bezier.h>
 #include <2geom/transforms.h>
-#include <atomic>
 #include <boost/algorithm/string.hpp>
 #include <boost/operators.hpp>
 #include <boost/optional/optional.hpp>
@@ -701,7 +700,7 @@ void Pixbuf::ensure_pixbuf(GdkPixbuf *pb)
  * Can be called recursively.
  * If optimize_stroke == false, the view Rect is not used.
  */
-static void
+void
 feed_curve_to_cairo(cairo_t *cr, Geom::Curve const &c, Geom::Affine const &trans, Geom::Rect const &view, bool optimize_stroke)
 {
     using Geom::X;
@@ -969,18 +968,6 @@ std::optional<Geom::PathVector> extract_pathvector_from_cairo(cairo_t *ct)
     return res.peek();
 }
 
-static std::atomic<int> num_filter_threads = 4;
-
-int get_num_filter_threads()
-{
-    return num_filter_threads.load(std::memory_order_relaxed);
-}
-
-void set_num_filter_threads(int n)
-{
-    num_filter_threads.store(n, std::memory_order_relaxed);
-}
-
 SPColorInterpolation
 get_cairo_surface_ci(cairo_surface_t *surface) {
     void* data = cairo_surface_get_user_data( surface, &ink_color_interpolation_key );
@@ -91,10 +91,6 @@ public:
 
 } // namespace Inkscape
 
-// Atomic accessors to global variable governing number of filter threads.
-int  get_num_filter_threads();
-void set_num_filter_threads(int);
-
 SPColorInterpolation get_cairo_surface_ci(cairo_surface_t *surface);
 void set_cairo_surface_ci(cairo_surface_t *surface, SPColorInterpolation cif);
 void copy_cairo_surface_ci(cairo_surface_t *in, cairo_surface_t *out);
@@ -168,6 +164,7 @@ unpremul_alpha(const guint32 color, const guint32 alpha)
 }
 
 // TODO: move those to 2Geom
+void feed_curve_to_cairo(cairo_t *cr, Geom::Curve const &c, Geom::Affine const &trans, Geom::Rect const &view, bool optimize_stroke);
 void feed_pathvector_to_cairo (cairo_t *ct, Geom::PathVector const &pathv, Geom::Affine trans, Geom::OptRect area, bool optimize_stroke, double stroke_width);
 void feed_pathvector_to_cairo (cairo_t *ct, Geom::PathVector const &pathv);
 
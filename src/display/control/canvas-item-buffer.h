@@ -18,6 +18,7 @@
  *
  */
 
+#include <atomic>
 #include <2geom/rect.h>
 #include <cairomm/context.h>
 
@@ -32,6 +33,8 @@ struct CanvasItemBuffer
     int device_scale; // For high DPI monitors.
     Cairo::RefPtr<Cairo::Context> cr;
     bool outline_pass;
+    bool preview = false; // Draw quickly at reduced quality; the buffer will be drawn again later.
+    std::atomic<bool> const *cancel = nullptr; // Set by another thread when the buffer is no longer wanted.
 };
 
 } // namespace Inkscape
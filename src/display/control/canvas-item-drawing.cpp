@@ -16,20 +16,104 @@
 
 #include "canvas-item-drawing.h"
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <sstream>
+#include <glibmm/stringutils.h>
+#include <glibmm/ustring.h>
+#include <cairomm/region.h>
+
 #include "desktop.h"
+#include "document.h"
+#include "gc-anchored.h"
 
+#include "async/async.h"
 #include "display/drawing.h"
 #include "display/drawing-context.h"
 #include "display/drawing-item.h"
 #include "display/drawing-group.h"
+#include "display/tile-disk-cache.h"
 
 #include "helper/geom.h"
+#include "ui/util.h"
 #include "ui/widget/canvas.h"
 #include "ui/widget/events/canvas-event.h"
 #include "ui/modifiers.h"
+#include "xml/document.h"
+#include "xml/node-observer.h"
 
 namespace Inkscape {
 
+/**
+ * The disk cache of the document shown, usable as long as the document stays the same as the
+ * file it was read from. Its file is hashed on a background thread, while the changes made to
+ * it are watched from the start.
+ */
+struct CanvasItemDrawing::DiskCache : XML::NodeObserver
+{
+    std::shared_ptr<TileDiskCache> const cache;
+    std::shared_future<std::string> hash;
+    XML::Document *const doc;
+    std::atomic<bool> changed = false;
+
+    DiskCache(std::shared_ptr<TileDiskCache> cache_, XML::Document &doc_, std::string filename)
+        : cache(std::move(cache_))
+        , doc(GC::anchor(&doc_))
+    {
+        auto promise = std::make_shared<std::promise<std::string>>();
+        hash = promise->get_future().share();
+        Async::fire_and_forget([promise, filename = std::move(filename)] {
+            promise->set_value(TileDiskCache::hash_file(filename));
+        });
+        doc->addSubtreeObserver(*this);
+    }
+
+    ~DiskCache() override
+    {
+        doc->removeSubtreeObserver(*this);
+        GC::release(doc);
+    }
+
+    /// The hash of the document file, or null if it is not known yet or the document changed.
+    std::string const *usable_hash() const
+    {
+        if (changed || hash.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return nullptr;
+        }
+        auto const &result = hash.get();
+        return result.empty() ? nullptr : &result;
+    }
+
+    void notifyChildAdded(XML::Node &node, XML::Node &child, XML::Node *) override { _changed(node, &child); }
+    void notifyChildRemoved(XML::Node &node, XML::Node &child, XML::Node *) override { _changed(node, &child); }
+    void notifyChildOrderChanged(XML::Node &node, XML::Node &child, XML::Node *, XML::Node *) override { _changed(node, &child); }
+    void notifyContentChanged(XML::Node &node, Util::ptr_shared, Util::ptr_shared) override { _changed(node); }
+    void notifyAttributeChanged(XML::Node &node, GQuark, Util::ptr_shared, Util::ptr_shared) override { _changed(node); }
+    void notifyElementNameChanged(XML::Node &node, GQuark, GQuark) override { _changed(node); }
+
+private:
+    void _changed(XML::Node const &node, XML::Node const *child = nullptr)
+    {
+        // The named view holds the settings of the windows, such as the zoom and the current
+        // layer, which change without the drawing changing.
+        auto const is_namedview = [] (XML::Node const *n) {
+            return n->name() && std::strcmp(n->name(), "sodipodi:namedview") == 0;
+        };
+        if (child && is_namedview(child)) {
+            return;
+        }
+        for (auto n = &node; n; n = n->parent()) {
+            if (is_namedview(n)) {
+                return;
+            }
+        }
+        changed = true;
+    }
+};
+
 /**
  * Create the drawing. One per window!
  */
@@ -45,6 +129,8 @@ CanvasItemDrawing::CanvasItemDrawing(CanvasItemGroup *group)
     _drawing->setRoot(root);
 }
 
+CanvasItemDrawing::~CanvasItemDrawing() = default;
+
 /**
  * Returns true if point p (in canvas units) is inside some object in drawing.
  */
@@ -112,8 +198,107 @@ void CanvasItemDrawing::_update(bool)
  */
 void CanvasItemDrawing::_render(Inkscape::CanvasItemBuffer &buf) const
 {
+    if (_render_disk_cached(buf)) {
+        return;
+    }
+
     auto dc = Inkscape::DrawingContext(buf.cr->cobj(), buf.rect.min());
-    _drawing->render(dc, buf.rect, buf.outline_pass * DrawingItem::RENDER_OUTLINE);
+    _drawing->render(dc, buf.rect, buf.outline_pass * DrawingItem::RENDER_OUTLINE, buf.cancel, buf.preview);
+}
+
+/**
+ * Render the tiles of the disk cache lying wholly within the buffer from the cache, rendering
+ * and storing those it lacks, then the rest of the buffer as usual. Returns false without
+ * rendering anything if the disk cache cannot be used.
+ */
+bool CanvasItemDrawing::_render_disk_cached(Inkscape::CanvasItemBuffer &buf) const
+{
+    auto const hash = _disk_cache ? _disk_cache->usable_hash() : nullptr;
+    if (!hash || buf.outline_pass || _drawing->renderMode() != RenderMode::NORMAL ||
+        _drawing->colorMode() != ColorMode::NORMAL || _drawing->clipped())
+    {
+        return false;
+    }
+
+    constexpr int size = TileDiskCache::TILE_SIZE;
+    auto const first = Geom::IntPoint(std::ceil(buf.rect.left() / (double)size), std::ceil(buf.rect.top() / (double)size));
+    auto const last = Geom::IntPoint(std::floor(buf.rect.right() / (double)size), std::floor(buf.rect.bottom() / (double)size));
+    if (first.x() >= last.x() || first.y() >= last.y()) {
+        return false;
+    }
+
+    // Everything the rendering depends on, besides the position of the tile.
+    auto key_stream = std::ostringstream();
+    key_stream << *hash << std::hexfloat;
+    for (int i = 0; i < 6; i++) {
+        key_stream << ' ' << _drawing_affine[i];
+    }
+    auto const antialiasing = _drawing->antialiasingOverride();
+    key_stream << ' ' << buf.device_scale
+           << ' ' << _drawing->filterQuality()
+           << ' ' << _drawing->blurQuality()
+           << ' ' << _drawing->useDithering()
+           << ' ' << _drawing->outlineOverlay()
+           << ' ' << (antialiasing ? static_cast<int>(*antialiasing) : -1) << ' ';
+    auto const prefix = key_stream.str();
+
+    auto const cr = buf.cr->cobj();
+    auto const scale = buf.device_scale;
+    auto rest = Cairo::Region::create(geom_to_cairo(buf.rect));
+
+    for (int y = first.y(); y < last.y(); y++) {
+        for (int x = first.x(); x < last.x(); x++) {
+            auto const tile = Geom::IntRect::from_xywh(x * size, y * size, size, size);
+            auto const key = prefix + std::to_string(x) + ' ' + std::to_string(y);
+
+            auto surface = _disk_cache->cache->render(key, *_drawing, tile, scale, buf.cancel, buf.preview);
+
+            cairo_save(cr);
+            cairo_set_source_surface(cr, surface, tile.left() - buf.rect.left(), tile.top() - buf.rect.top());
+            cairo_paint(cr);
+            cairo_restore(cr);
+            cairo_surface_destroy(surface);
+
+            rest->subtract(geom_to_cairo(tile));
+        }
+    }
+
+    for (int i = 0; i < rest->get_num_rectangles(); i++) {
+        auto const area = cairo_to_geom(rest->get_rectangle(i));
+        cairo_save(cr);
+        cairo_rectangle(cr, area.left() - buf.rect.left(), area.top() - buf.rect.top(), area.width(), area.height());
+        cairo_clip(cr);
+        {
+            auto dc = Inkscape::DrawingContext(cr, buf.rect.min());
+            _drawing->render(dc, area, 0, buf.cancel, buf.preview);
+        }
+        cairo_restore(cr);
+    }
+
+    return true;
+}
+
+/**
+ * Render the drawing of @a document through the disk cache for as long as the document is the
+ * same as its file, or stop using the disk cache if it is null. Only documents opened from SVG
+ * files are cached, as importing other formats depends on the import settings.
+ */
+void CanvasItemDrawing::set_disk_cache_document(SPDocument *document)
+{
+    std::unique_ptr<DiskCache> disk_cache;
+
+    auto const filename = document ? document->getDocumentFilename() : nullptr;
+    if (filename && !document->isModifiedSinceSave()) {
+        auto const lowercase = Glib::ustring(filename).lowercase().raw();
+        bool const svg = Glib::str_has_suffix(lowercase, ".svg") || Glib::str_has_suffix(lowercase, ".svgz");
+        if (auto cache = TileDiskCache::get(); cache && svg) {
+            disk_cache = std::make_unique<DiskCache>(std::move(cache), *document->getReprDoc(), filename);
+        }
+    }
+
+    defer([this, disk_cache = std::move(disk_cache)] () mutable {
+        _disk_cache = std::move(disk_cache);
+    });
 }
 
 /**
@@ -21,6 +21,8 @@
 
 #include "canvas-item.h"
 
+class SPDocument;
+
 namespace Inkscape {
 
 class Drawing;
@@ -47,16 +49,20 @@ public:
     void set_sticky(bool sticky) { _sticky = sticky; }
     void set_pick_outline(bool pick_outline) { _pick_outline = pick_outline; }
 
+    // Disk cache
+    void set_disk_cache_document(SPDocument *document);
+
     // Signals
     sigc::connection connect_drawing_event(sigc::slot<bool(CanvasEvent const &, Inkscape::DrawingItem *)> slot) {
         return _drawing_event_signal.connect(slot);
     }
 
 protected:
-    ~CanvasItemDrawing() override = default;
+    ~CanvasItemDrawing() override;
 
     void _update(bool propagate) override;
     void _render(Inkscape::CanvasItemBuffer &buf) const override;
+    bool _render_disk_cached(Inkscape::CanvasItemBuffer &buf) const;
 
     // Selection
     Geom::Point _c;
@@ -73,6 +79,10 @@ protected:
     bool _sticky = false; // Pick anything, even if hidden.
     bool _pick_outline = false;
 
+    // Disk cache
+    struct DiskCache;
+    std::unique_ptr<DiskCache> _disk_cache;
+
     // Signals
     sigc::signal<bool(CanvasEvent const &, Inkscape::DrawingItem *)> _drawing_event_signal;
 };
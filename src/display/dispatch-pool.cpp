@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Pools of worker threads for rendering.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/dispatch-pool.h"
+
+#include <algorithm>
+
+namespace Inkscape {
+namespace {
+
+/// The pool whose worker is the current thread, if any.
+thread_local DispatchPool *current_pool = nullptr;
+
+} // namespace
+
+DispatchPool::DispatchPool(int num_threads)
+{
+    set_num_threads(num_threads);
+}
+
+DispatchPool::~DispatchPool()
+{
+    auto lock = std::unique_lock(_mutex);
+    _shutdown = true;
+    auto workers = std::move(_workers);
+    lock.unlock();
+    _work_cond.notify_all();
+
+    for (auto &worker : workers) {
+        worker.thread.join();
+    }
+}
+
+void DispatchPool::set_num_threads(int num_threads)
+{
+    num_threads = std::max(num_threads, 1);
+
+    auto lock = std::unique_lock(_mutex);
+    _num_threads = num_threads;
+
+    // Collect the workers that have exited since the last resize. They no longer hold the lock,
+    // so joining them cannot wait on anything but their return.
+    int active = 0;
+    for (auto it = _workers.begin(); it != _workers.end(); ) {
+        if (it->exited) {
+            it->thread.join();
+            it = _workers.erase(it);
+        } else {
+            active += !it->retired;
+            ++it;
+        }
+    }
+
+    // Retire the surplus without waiting for them; they exit once they have finished their work.
+    for (auto it = _workers.rbegin(); it != _workers.rend() && active > num_threads; ++it) {
+        if (!it->retired) {
+            it->retired = true;
+            active--;
+        }
+    }
+    for (; active < num_threads; active++) {
+        auto &worker = _workers.emplace_back();
+        worker.thread = std::thread([this, &worker] { _worker(worker); });
+    }
+
+    lock.unlock();
+    _work_cond.notify_all();
+}
+
+int DispatchPool::num_threads() const
+{
+    auto lock = std::unique_lock(_mutex);
+    return _num_threads;
+}
+
+void DispatchPool::post(std::function<void()> task)
+{
+    {
+        auto lock = std::unique_lock(_mutex);
+        _tasks.emplace_back(std::move(task));
+    }
+    _work_cond.notify_one();
+}
+
+void DispatchPool::_dispatch(int count, void (*run)(void *, int, int), void *data)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    // A few chunks per thread, so that uneven chunks still balance out.
+    Batch batch;
+    batch.run = run;
+    batch.data = data;
+    batch.count = count;
+    batch.grain = std::max(1, count / (4 * (_num_threads + 1)));
+    batch.unfinished = count;
+
+    _batches.push_back(&batch);
+    lock.unlock();
+    _work_cond.notify_all();
+    lock.lock();
+
+    // Work through our own batch. Never run anything else here, or a long task picked up while
+    // waiting could hold up the caller indefinitely.
+    int begin, end;
+    while (_claim(batch, begin, end)) {
+        _run(batch, begin, end, lock);
+    }
+
+    _done_cond.wait(lock, [&] { return batch.unfinished == 0; });
+
+    if (batch.error) {
+        std::rethrow_exception(batch.error);
+    }
+}
+
+// Called with _mutex held.
+bool DispatchPool::_claim(Batch &batch, int &begin, int &end)
+{
+    if (batch.next >= batch.count) {
+        return false;
+    }
+
+    begin = batch.next;
+    end = std::min(begin + batch.grain, batch.count);
+    batch.next = end;
+
+    if (batch.next >= batch.count) {
+        // Fully handed out; no one else needs to find it any more.
+        _batches.erase(std::find(_batches.begin(), _batches.end(), &batch));
+    }
+
+    return true;
+}
+
+// Run a claimed chunk with the lock released, then account for it.
+void DispatchPool::_run(Batch &batch, int begin, int end, std::unique_lock<std::mutex> &lock)
+{
+    lock.unlock();
+    std::exception_ptr error;
+    try {
+        batch.run(batch.data, begin, end);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    lock.lock();
+
+    if (error && !batch.error) {
+        batch.error = std::move(error);
+    }
+    batch.unfinished -= end - begin;
+    if (batch.unfinished == 0) {
+        _done_cond.notify_all();
+    }
+}
+
+void DispatchPool::_worker(Worker &self)
+{
+    current_pool = this;
+    auto lock = std::unique_lock(_mutex);
+
+    while (true) {
+        _work_cond.wait(lock, [&] {
+            return _shutdown || self.retired || !_batches.empty() || !_tasks.empty();
+        });
+
+        if (_shutdown) {
+            return;
+        }
+        if (self.retired) {
+            self.exited = true;
+            return;
+        }
+
+        // Loops first, since their callers are blocked waiting for them.
+        if (!_batches.empty()) {
+            auto &batch = *_batches.front();
+            int begin, end;
+            _claim(batch, begin, end);
+            _run(batch, begin, end, lock);
+        } else {
+            auto task = std::move(_tasks.front());
+            _tasks.pop_front();
+            lock.unlock();
+            task();
+            task = nullptr;
+            lock.lock();
+        }
+    }
+}
+
+DispatchPool &get_global_dispatch_pool()
+{
+    static DispatchPool pool([] {
+        int n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 4; // Sensible fallback if not reported.
+    }());
+    return pool;
+}
+
+DispatchPool &get_dispatch_pool()
+{
+    return current_pool ? *current_pool : get_global_dispatch_pool();
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Pools of worker threads for rendering.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_DISPATCH_POOL_H
+#define INKSCAPE_DISPLAY_DISPATCH_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace Inkscape {
+
+/**
+ * A pool of worker threads for rendering. The canvas has a pool of its own; exports and other
+ * rendering share the global one. Loops run from a worker stay on its pool (see
+ * get_dispatch_pool()), so that each pool keeps within its own number of threads.
+ *
+ * It accepts two kinds of work:
+ *
+ *  - Tasks submitted with post() run once, on whichever worker becomes free first.
+ *
+ *  - Loops submitted with dispatch() are cut into chunks. Idle workers steal chunks from the
+ *    loop while the calling thread works through it too. While waiting for the stolen chunks
+ *    to finish, the caller never picks up unrelated work, so dispatch() can be nested freely
+ *    (a filter primitive inside a filter tile inside a canvas tile): when every worker is busy
+ *    the inner loops simply run on the thread that issued them.
+ *
+ * Tasks are run in the order they were posted, so a pool must not be given tasks that wait for
+ * the main thread, while the main thread waits for other tasks of the same pool. The canvas,
+ * whose tiles wait for the main thread, therefore has a pool of its own.
+ */
+class DispatchPool
+{
+public:
+    explicit DispatchPool(int num_threads);
+    ~DispatchPool();
+
+    DispatchPool(DispatchPool const &) = delete;
+    DispatchPool &operator=(DispatchPool const &) = delete;
+
+    /// Change the number of worker threads. Work that is already running is not interrupted,
+    /// nor waited for: workers beyond the new number exit once they have finished it.
+    void set_num_threads(int num_threads);
+    int num_threads() const;
+
+    /// Run @a task on a worker thread.
+    void post(std::function<void()> task);
+
+    /**
+     * Call @a function(i) for every i in [0, count) and return once all calls have finished.
+     * The calls are spread over the calling thread and any idle workers, in no particular order.
+     * If a call throws, some of the remaining calls may be skipped, and the first exception is
+     * rethrown here once no more calls are running.
+     */
+    template <typename F>
+    void dispatch(int count, F &&function)
+    {
+        using Function = std::remove_reference_t<F>;
+        if (count <= 0) {
+            return;
+        }
+        if (count == 1) {
+            function(0);
+            return;
+        }
+        _dispatch(count, [] (void *data, int begin, int end) {
+            auto &f = *static_cast<Function *>(data);
+            for (int i = begin; i < end; ++i) {
+                f(i);
+            }
+        }, const_cast<std::remove_const_t<Function> *>(std::addressof(function)));
+    }
+
+    /// Like dispatch(), but run everything on the calling thread unless @a parallel is true.
+    template <typename F>
+    void dispatch_threshold(int count, bool parallel, F &&function)
+    {
+        if (parallel) {
+            dispatch(count, std::forward<F>(function));
+        } else {
+            for (int i = 0; i < count; ++i) {
+                function(i);
+            }
+        }
+    }
+
+private:
+    struct Batch
+    {
+        void (*run)(void *data, int begin, int end);
+        void *data;
+        int count;
+        int grain;
+        int next = 0;   ///< First index not yet claimed by any thread.
+        int unfinished; ///< Number of indices not yet finished.
+        std::exception_ptr error;
+    };
+
+    void _dispatch(int count, void (*run)(void *, int, int), void *data);
+    bool _claim(Batch &batch, int &begin, int &end);
+    struct Worker
+    {
+        std::thread thread;
+        bool retired = false; ///< Asked to exit once it has finished its work.
+        bool exited = false;  ///< Its thread has nothing left to do but return.
+    };
+
+    void _run(Batch &batch, int begin, int end, std::unique_lock<std::mutex> &lock);
+    void _worker(Worker &self);
+
+    mutable std::mutex _mutex;
+    std::condition_variable _work_cond;
+    std::condition_variable _done_cond;
+    std::deque<Batch *> _batches;
+    std::deque<std::function<void()>> _tasks;
+    std::list<Worker> _workers;
+    int _num_threads = 0;
+    bool _shutdown = false;
+};
+
+/**
+ * The pool used for rendering other than the canvas. Its size follows the /options/threading/numthreads preference
+ * and defaults to the number of hardware threads.
+ */
+DispatchPool &get_global_dispatch_pool();
+
+/**
+ * The pool to dispatch loops on from the calling thread: the pool of the worker that runs it,
+ * or the global pool on any other thread. The filters of a canvas tile are thus spread over the
+ * canvas threads only, rather than over the global pool as well.
+ */
+DispatchPool &get_dispatch_pool();
+
+/// Items below this number of pixels are not worth spreading over several threads.
+inline constexpr int DISPATCH_PIXEL_THRESHOLD = 2048;
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_DISPATCH_POOL_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -10,19 +10,131 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <vector>
+
 #include "drawing-group.h"
 #include "cairo-utils.h"
 #include "drawing-context.h"
 #include "drawing-surface.h"
 #include "drawing-text.h"
 #include "drawing.h"
+#include "helper/geom.h"
 #include "style.h"
 
 namespace Inkscape {
 
+/// Groups with fewer children than this are picked by a linear scan; building an index does not pay off.
+static constexpr std::size_t PICK_INDEX_MIN_CHILDREN = 64;
+/// Maximum number of children stored in a leaf of the pick index.
+static constexpr std::size_t PICK_INDEX_LEAF_SIZE = 8;
+
+/**
+ * Bounding volume hierarchy over the children of a group, used to accelerate picking.
+ *
+ * Each child is stored with a box that is guaranteed to contain every point at which
+ * DrawingItem::pick() could possibly succeed for it (before expansion by the pick delta),
+ * together with its position in the children list, so that the Z-order of the linear
+ * scan can be reproduced exactly.
+ *
+ * The index is a snapshot of the children's bounding boxes. It is dropped whenever the
+ * group is updated, which happens whenever the bounding box of any child could have
+ * changed, since that always goes through _markForUpdate().
+ */
+struct DrawingGroup::PickIndex
+{
+    struct Entry
+    {
+        Geom::IntRect box;
+        unsigned order;
+        DrawingItem *item;
+    };
+
+    struct Node
+    {
+        Geom::IntRect box;
+        unsigned begin, end; ///< Range of entries for leaves.
+        unsigned left = 0, right = 0; ///< Child nodes; zero for leaves (the root is never a child).
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Node> nodes;
+
+    void build();
+    unsigned build(unsigned begin, unsigned end);
+    void query(Geom::Rect const &area, std::vector<Entry const *> &result) const;
+};
+
+void DrawingGroup::PickIndex::build()
+{
+    nodes.clear();
+    if (!entries.empty()) {
+        nodes.reserve(2 * entries.size() / PICK_INDEX_LEAF_SIZE + 1);
+        build(0, entries.size());
+    }
+}
+
+unsigned DrawingGroup::PickIndex::build(unsigned begin, unsigned end)
+{
+    auto box = entries[begin].box;
+    for (auto i = begin + 1; i < end; i++) {
+        box.unionWith(entries[i].box);
+    }
+
+    unsigned const index = nodes.size();
+    nodes.push_back({box, begin, end});
+
+    if (end - begin <= PICK_INDEX_LEAF_SIZE) {
+        return index;
+    }
+
+    // Split at the median of the box centres along the longer dimension.
+    auto const dim = box.width() >= box.height() ? Geom::X : Geom::Y;
+    auto const mid = begin + (end - begin) / 2;
+    std::nth_element(entries.begin() + begin, entries.begin() + mid, entries.begin() + end, [=] (Entry const &a, Entry const &b) {
+        return a.box[dim].min() + a.box[dim].max() < b.box[dim].min() + b.box[dim].max();
+    });
+
+    auto const left = build(begin, mid);
+    auto const right = build(mid, end);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+void DrawingGroup::PickIndex::query(Geom::Rect const &area, std::vector<Entry const *> &result) const
+{
+    if (nodes.empty()) {
+        return;
+    }
+
+    unsigned stack[64];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        auto const &node = nodes[stack[--top]];
+        if (!area.intersects(Geom::Rect(node.box))) {
+            continue;
+        }
+        if (node.left == 0) {
+            for (auto i = node.begin; i < node.end; i++) {
+                if (area.intersects(Geom::Rect(entries[i].box))) {
+                    result.push_back(&entries[i]);
+                }
+            }
+        } else {
+            stack[top++] = node.right;
+            stack[top++] = node.left;
+        }
+    }
+}
+
 DrawingGroup::DrawingGroup(Drawing &drawing)
     : DrawingItem(drawing) {}
 
+DrawingGroup::~DrawingGroup() = default;
+
 /**
  * Set whether the group returns children from pick calls.
  * Previously this feature was called "transparent groups".
@@ -62,6 +174,9 @@ unsigned DrawingGroup::_updateItem(Geom::IntRect const &area, UpdateContext cons
 
     _bbox = {};
 
+    // Children may have moved, been added or removed; rebuild the pick index on demand.
+    _pick_index_valid = false;
+
     for (auto &c : _children) {
         c.update(area, child_ctx, flags, reset);
         if (c.visible()) {
@@ -108,8 +223,28 @@ void DrawingGroup::_clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRec
 
 DrawingItem *DrawingGroup::_pickItem(Geom::Point const &p, double delta, unsigned flags)
 {
-    for (auto &i : _children) {
-        DrawingItem *picked = i.pick(p, delta, flags);
+    if (_children.size() < PICK_INDEX_MIN_CHILDREN) {
+        _pick_index.reset();
+        for (auto &i : _children) {
+            DrawingItem *picked = i.pick(p, delta, flags);
+            if (picked) {
+                return _pick_children ? picked : this;
+            }
+        }
+        return nullptr;
+    }
+
+    if (!_pick_index || !_pick_index_valid) {
+        _buildPickIndex();
+    }
+
+    // Only visit children whose boxes are within delta of the point, in the same order as a linear scan.
+    std::vector<PickIndex::Entry const *> candidates;
+    _pick_index->query(expandedBy(Geom::Rect(p, p), delta), candidates);
+    std::sort(candidates.begin(), candidates.end(), [] (auto a, auto b) { return a->order < b->order; });
+
+    for (auto c : candidates) {
+        DrawingItem *picked = c->item->pick(p, delta, flags);
         if (picked) {
             return _pick_children ? picked : this;
         }
@@ -117,6 +252,35 @@ DrawingItem *DrawingGroup::_pickItem(Geom::Point const &p, double delta, unsigne
     return nullptr;
 }
 
+void DrawingGroup::_buildPickIndex()
+{
+    if (!_pick_index) {
+        _pick_index = std::make_unique<PickIndex>();
+    }
+
+    auto &entries = _pick_index->entries;
+    entries.clear();
+    entries.reserve(_children.size());
+
+    unsigned order = 0;
+    for (auto &c : _children) {
+        // Union of every box that pick() may test, so the index is valid for all pick flags.
+        auto box = c.bbox();
+        box.unionWith(c.drawbox());
+        if (auto glyphs = cast<DrawingGlyphs>(&c)) {
+            box.unionWith(glyphs->getPickBox());
+        }
+        // Children without a bounding box can never be picked.
+        if (box) {
+            entries.push_back({*box, order, &c});
+        }
+        order++;
+    }
+
+    _pick_index->build();
+    _pick_index_valid = true;
+}
+
 } // namespace Inkscape
 
 /*
@@ -13,6 +13,8 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_GROUP_H
 #define INKSCAPE_DISPLAY_DRAWING_GROUP_H
 
+#include <memory>
+
 #include "display/drawing-item.h"
 
 namespace Inkscape {
@@ -30,7 +32,7 @@ public:
     void setChildTransform(Geom::Affine const &);
 
 protected:
-    ~DrawingGroup() override = default;
+    ~DrawingGroup() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
@@ -39,6 +41,13 @@ protected:
     bool _canClip() const override { return true; }
 
     std::unique_ptr<Geom::Affine> _child_transform;
+
+private:
+    void _buildPickIndex();
+
+    struct PickIndex;
+    std::unique_ptr<PickIndex> _pick_index; ///< Lazily built spatial index over children, used by _pickItem().
+    bool _pick_index_valid = false;
 };
 
 } // namespace Inkscape
@@ -10,6 +10,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <2geom/bezier-curve.h>
 
 #include "drawing.h"
@@ -26,10 +28,16 @@ DrawingImage::DrawingImage(Drawing &drawing)
 {
 }
 
+DrawingImage::~DrawingImage()
+{
+    _drawing._image_pyramids.remove(this);
+}
+
 void DrawingImage::setPixbuf(std::shared_ptr<Inkscape::Pixbuf const> pixbuf)
 {
     defer([this, pixbuf = std::move(pixbuf)] () mutable {
         _pixbuf = std::move(pixbuf);
+        _drawing._image_pyramids.remove(this);
         _markForUpdate(STATE_ALL, false);
     });
 }
@@ -98,9 +106,64 @@ unsigned DrawingImage::_updateItem(Geom::IntRect const &, UpdateContext const &,
         _bbox = Geom::OptIntRect();
     }
 
+    // Choose the coarsest pyramid level that still has at least one image pixel per device pixel.
+    // Drawings without a cache budget, such as exports, have nowhere to keep the levels.
+    _mip_level = 0;
+    if (_pixbuf && _drawing._cache_budget > 0
+                && style_image_rendering != SP_CSS_IMAGE_RENDERING_OPTIMIZESPEED
+                && style_image_rendering != SP_CSS_IMAGE_RENDERING_PIXELATED
+                && style_image_rendering != SP_CSS_IMAGE_RENDERING_CRISPEDGES)
+    {
+        auto const pixel_to_device = Geom::Affine(_scale) * _ctm;
+        double const expansion = std::max(pixel_to_device.expansionX(), pixel_to_device.expansionY());
+        if (expansion > 0.0 && expansion < 0.5) {
+            int const max_level = std::ilogb(std::min(_pixbuf->width(), _pixbuf->height()));
+            _mip_level = std::clamp(static_cast<int>(std::floor(-std::log2(expansion))), 0, max_level);
+        }
+    }
+
     return STATE_ALL;
 }
 
+/**
+ * Return a new reference to the given level of the image pyramid, building it and any missing
+ * levels below it if necessary, or null if the drawing's cache budget does not leave room for it.
+ * May be called from render threads.
+ */
+cairo_surface_t *DrawingImage::_getMipLevel(int level) const
+{
+    auto &cache = _drawing._image_pyramids;
+    auto lock = std::lock_guard(_mip_mutex);
+
+    if (auto surface = cache.lookup(this, level)) {
+        return surface;
+    }
+
+    // Start from the finest level still cached, or the image itself.
+    int base = level - 1;
+    cairo_surface_t *src = nullptr;
+    for (; base > 0; base--) {
+        if ((src = cache.lookup(this, base))) {
+            break;
+        }
+    }
+    if (!src) {
+        src = cairo_surface_reference(const_cast<cairo_surface_t *>(_pixbuf->getSurfaceRaw()));
+    }
+
+    for (int i = base + 1; i <= level; i++) {
+        auto const dst = downsample_half(src);
+        cairo_surface_destroy(src);
+        if (!cache.insert(this, i, dst)) {
+            cairo_surface_destroy(dst);
+            return nullptr;
+        }
+        src = dst;
+    }
+
+    return src;
+}
+
 unsigned DrawingImage::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &/*area*/, unsigned flags, DrawingItem const */*stop_at*/) const
 {
     bool const outline = (flags & RENDER_OUTLINE) && !_drawing.imageOutlineMode();
@@ -116,10 +179,20 @@ unsigned DrawingImage::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
 
         dc.translate(_origin);
         dc.scale(_scale);
-        // const_cast required since Cairo needs to modify the internal refcount variable, but we do not want to give up the
-        // benefits of const for the rest of our code. The underlying object is guaranteed to be non-const, so this is well-defined.
-        // It is also thread-safe to modify the refcount in this way, since Cairo uses atomics internally.
-        dc.setSource(const_cast<cairo_surface_t*>(_pixbuf->getSurfaceRaw()), 0, 0);
+
+        // When zoomed out, paint from a downscaled copy of the image, which is both faster and less aliased.
+        auto mip = _mip_level > 0 ? _getMipLevel(_mip_level) : nullptr;
+        if (mip) {
+            dc.scale(Geom::Scale((double)_pixbuf->width()  / cairo_image_surface_get_width(mip),
+                                 (double)_pixbuf->height() / cairo_image_surface_get_height(mip)));
+            dc.setSource(mip, 0, 0);
+            cairo_surface_destroy(mip);
+        } else {
+            // const_cast required since Cairo needs to modify the internal refcount variable, but we do not want to give up the
+            // benefits of const for the rest of our code. The underlying object is guaranteed to be non-const, so this is well-defined.
+            // It is also thread-safe to modify the refcount in this way, since Cairo uses atomics internally.
+            dc.setSource(const_cast<cairo_surface_t*>(_pixbuf->getSurfaceRaw()), 0, 0);
+        }
         dc.patternSetExtend(CAIRO_EXTEND_PAD);
 
         // See: http://www.w3.org/TR/SVG/painting.html#ImageRenderingProperty
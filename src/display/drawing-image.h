@@ -14,6 +14,7 @@
 #define INKSCAPE_DISPLAY_DRAWING_IMAGE_H
 
 #include <memory>
+#include <mutex>
 #include <2geom/transforms.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <cairo.h>
@@ -39,7 +40,7 @@ public:
     Geom::Rect bounds() const;
 
 protected:
-    ~DrawingImage() override = default;
+    ~DrawingImage() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
@@ -53,6 +54,12 @@ protected:
     Geom::Rect _clipbox; ///< for preserveAspectRatio
     Geom::Point _origin;
     Geom::Scale _scale;
+
+private:
+    cairo_surface_t *_getMipLevel(int level) const;
+
+    int _mip_level = 0; ///< Pyramid level matching the current transform; 0 is the full resolution image.
+    mutable std::mutex _mip_mutex; ///< Stops render threads building the same levels at once.
 };
 
 } // namespace Inkscape
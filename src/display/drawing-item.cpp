@@ -111,6 +111,7 @@ DrawingItem::~DrawingItem()
 
     // Remove from the set of cached items and delete cache.
     _setCached(false, true);
+    _drawing._filter_results.remove(this);
 
     _children.clear_and_dispose([] (auto c) { delete c; });
     delete _clip;
@@ -279,6 +280,16 @@ void DrawingItem::_setCached(bool cached, bool persistent)
     }
 }
 
+/// Whether the cache of this item holds rendered content.
+bool DrawingItem::_hasCachedContent() const
+{
+    if (!_cache) {
+        return false;
+    }
+    auto lock = std::unique_lock(_cache->mutables);
+    return _cache->surface && !_cache->surface->empty();
+}
+
 /**
  * Process information related to the new style.
  *
@@ -415,6 +426,8 @@ void DrawingItem::setZOrder(unsigned zorder)
         std::advance(it2, std::min<unsigned>(zorder, _parent->_children.size()));
         _parent->_children.insert(it2, *this);
         _markForRendering();
+        // The pick order of the parent has changed.
+        _parent->_markForUpdate(STATE_PICK, false);
     });
 }
 
@@ -467,6 +480,10 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
     bool const filters = _drawing.renderMode() != RenderMode::NO_FILTERS;
     bool const forcecache = _filter && filters;
 
+    // Whether our appearance changed, as opposed to only being transformed by an ancestor:
+    // changes are reported through _markForUpdate(), which resets our own state.
+    bool const content_changed = ~_state & STATE_RENDER;
+
     // Set reset flags according to propagation status
     reset |= _propagate_state;
     _propagate_state = 0;
@@ -670,7 +687,7 @@ void DrawingItem::update(Geom::IntRect const &area, UpdateContext const &ctx, un
         }
         if (!totally_invalidated) {
             if (!is<DrawingGroup>(this) || (_filter && filters) || totally_invalidate) {
-                _markForRendering();
+                _markForRendering(content_changed);
             }
         }
     }
@@ -712,8 +729,8 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
         return RENDER_STOP;
     }
 
-    // If we are invisible, return immediately
-    if (!_visible) {
+    // If we are invisible, or the rendering was abandoned, return immediately
+    if (!_visible || rc.cancelled()) {
         return RENDER_OK;
     }
 
@@ -871,11 +888,46 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
 
     // 3. Render object itself
     ict.pushGroup();
-    apply_antialias(ict, antialias);
-    render_result = _renderItem(ict, rc, *carea, flags, stop_at);
+
+    // Filter results that only depend on the item itself are kept across redraws. They are
+    // stored relative to the integer part of the translation, so they can be reused after moving.
+    std::optional<FilterResultCache::Key> filter_key;
+    Geom::IntPoint filter_shift;
+    if (_filter && render_filters && !stop_at && !_filter->uses_background()) {
+        filter_shift = _ctm.translation().floor();
+        auto transform = _ctm;
+        transform.setTranslation(_ctm.translation() - Geom::Point(filter_shift));
+        filter_key = FilterResultCache::Key{
+            .item = this,
+            .filter = _filter.get(),
+            .transform = transform,
+            .device_scale = device_scale,
+            .filter_quality = _drawing.filterQuality(),
+            .blur_quality = _drawing.blurQuality(),
+            .flags = flags
+        };
+    }
+
+    Geom::IntRect result_area;
+    cairo_surface_t *result = nullptr;
+    if (filter_key) {
+        result = _drawing._filter_results.lookup(*filter_key, *carea - filter_shift, result_area);
+    }
+
+    if (result) {
+        result_area += filter_shift;
+        ict.setSource(result, result_area.left(), result_area.top());
+        ict.setOperator(CAIRO_OPERATOR_SOURCE);
+        ict.paint();
+        ict.setOperator(CAIRO_OPERATOR_OVER);
+        cairo_surface_destroy(result);
+    } else {
+        apply_antialias(ict, antialias);
+        render_result = _renderItem(ict, rc, *carea, flags, stop_at);
+    }
 
     // 4. Apply filter.
-    if (_filter && render_filters) {
+    if (_filter && render_filters && !result) {
         bool rendered = false;
         if (_filter->uses_background() && _background_accumulate) {
             auto bg_root = this;
@@ -896,6 +948,10 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
         // Note that because the object was rendered to a group,
         // the internals of the filter need to use cairo_get_group_target()
         // instead of cairo_get_target().
+
+        if (filter_key && render_result == RENDER_OK && rc.cacheable()) {
+            _drawing._filter_results.insert(*filter_key, *carea - filter_shift, ict.rawTarget());
+        }
     }
 
     // 4b. Apply greyscale rendering mode, if root node.
@@ -908,8 +964,8 @@ unsigned DrawingItem::render(DrawingContext &dc, RenderContext &rc, Geom::IntRec
     ict.setOperator(CAIRO_OPERATOR_IN);
     ict.paint();
 
-    // 6. Paint the completed rendering onto the base context (or into cache)
-    if (_cache && !(flags & RENDER_BYPASS_CACHE)) {
+    // 6. Paint the completed rendering onto the base context (or into cache, unless incomplete or a preview)
+    if (_cache && !(flags & RENDER_BYPASS_CACHE) && rc.cacheable()) {
         if (!forcecache) {
             lock.lock(); // Only hold the lock for the full duration of rendering for filters.
         }
@@ -1107,8 +1163,11 @@ void DrawingItem::recursivePrintTree(unsigned level) const
  * This is called whenever the object changes its visible appearance.
  * For some cases (such as setting opacity) this is enough, but for others
  * _markForUpdate() also needs to be called.
+ *
+ * @param content_changed False if the item only moved along with its ancestors, in which case
+ *                        the stored filter results of the item and its ancestors remain valid.
  */
-void DrawingItem::_markForRendering()
+void DrawingItem::_markForRendering(bool content_changed)
 {
     bool outline = _drawing.renderMode() == RenderMode::OUTLINE || _drawing.outlineOverlay();
     Geom::OptIntRect dirty = outline ? _bbox : _drawbox;
@@ -1121,6 +1180,9 @@ void DrawingItem::_markForRendering()
         if (i != this && i->_filter) {
             i->_filter->area_enlarge(*dirty, i);
         }
+        if (content_changed && (i == this || i->_filter)) {
+            _drawing._filter_results.remove(i);
+        }
         if (i->_cache && i->_cache->surface) {
             i->_cache->surface->markDirty(*dirty);
         }
@@ -13,6 +13,7 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_ITEM_H
 #define INKSCAPE_DISPLAY_DRAWING_ITEM_H
 
+#include <atomic>
 #include <cstdint>
 #include <exception>
 #include <memory>
@@ -53,6 +54,14 @@ struct RenderContext
     std::uint32_t outline_color;
     std::optional<Antialiasing> antialiasing_override;
     bool dithering = false;
+    bool preview = false; ///< Render filters at the worst quality, for a preview to be replaced later.
+    std::atomic<bool> const *cancel = nullptr; ///< Set by another thread to abandon the rendering.
+
+    /// Whether the rendering was abandoned, leaving the target partly drawn.
+    bool cancelled() const { return cancel && cancel->load(std::memory_order_relaxed); }
+
+    /// Whether the rendering is complete and at full quality, so may be kept for later renderings.
+    bool cacheable() const { return !preview && !cancelled(); }
 };
 
 struct UpdateContext
@@ -184,11 +193,12 @@ protected:
     virtual ~DrawingItem(); // Private to prevent deletion of items that are still in use by a snapshot.
     void _renderOutline(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags) const;
     void _markForUpdate(unsigned state, bool propagate);
-    void _markForRendering();
+    void _markForRendering(bool content_changed = true);
     void _invalidateFilterBackground(Geom::IntRect const &area);
     double _cacheScore();
     Geom::OptIntRect _cacheRect() const;
     void _setCached(bool cached, bool persistent = false);
+    bool _hasCachedContent() const;
     virtual unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) { return 0; }
     virtual unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const { return RENDER_OK; }
     virtual void _clipItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area) const {}
@@ -207,9 +207,14 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
         apply_antialias(dc, rc.antialiasing_override.value());
     }
 
+    // The surface is kept for later renderings, so it must always be drawn in full and at full quality.
+    auto prc = rc;
+    prc.preview = false;
+    prc.cancel = nullptr;
+
     auto paint = [&, this] (Geom::IntRect const &rect) {
         if (_overflow_steps == 1) {
-            render(dc, rc, rect);
+            render(dc, prc, rect);
         } else {
             // Overflow transforms need to be transformed to the old coordinate system
             // before stretching to the pattern resolution.
@@ -218,7 +223,7 @@ cairo_pattern_t *DrawingPattern::renderPattern(RenderContext &rc, Geom::IntRect
             dc.transform(initial_transform);
             for (int i = 0; i < _overflow_steps; i++) {
                 // render() fails to handle transforms applied here when using cache.
-                render(dc, rc, rect, RENDER_BYPASS_CACHE);
+                render(dc, prc, rect, RENDER_BYPASS_CACHE);
                 dc.transform(step_transform);
                 // auto raw = pattern_surface.raw();
                 // auto filename = "drawing-pattern" + std::to_string(i) + ".png";
@@ -10,6 +10,11 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
 #include <glibmm.h>
 #include <2geom/curves.h>
 #include <2geom/pathvector.h>
@@ -18,6 +23,7 @@
 
 #include "style.h"
 
+#include "cairo-utils.h"
 #include "curve.h"
 #include "drawing.h"
 #include "drawing-context.h"
@@ -30,6 +36,365 @@
 
 namespace Inkscape {
 
+/// Paths with fewer segments than this are drawn whole; culling them does not pay off.
+static constexpr std::size_t SEGMENT_INDEX_MIN_SEGMENTS = 256;
+/// Number of consecutive segments stored in a leaf of the segment index.
+static constexpr unsigned SEGMENT_INDEX_LEAF_SIZE = 16;
+/// Dashed strokes seen in more pieces than this within an area are drawn whole instead.
+static constexpr std::size_t SEGMENT_INDEX_MAX_DASHED_RUNS = 64;
+
+/**
+ * Hierarchy of bounding boxes over runs of consecutive segments of a path, in device space,
+ * used to draw only the parts of a long path that lie within the area being rendered.
+ *
+ * Each subpath has its own tree. A node covers a range of segments, split in two halves by
+ * its children down to leaves of SEGMENT_INDEX_LEAF_SIZE segments, so that a query visits the
+ * segments in path order and finds whole ranges that lie outside of the area at once.
+ *
+ * Segments outside of the area cannot simply be left out of a fill, as the rest of the path
+ * would no longer enclose the same region. A range whose box is disjoint from the area lies
+ * entirely on one side of it, so replacing it by the line between its endpoints clamped to
+ * the area adds the same winding to every point within the area. A stroke only needs the
+ * ranges whose box, grown by the stroke margin, meets the area; the margin keeps the caps
+ * that appear where a range is left out away from the area as well.
+ *
+ * Dashes restart at every subpath, so a dashed stroke cut into pieces is drawn one piece at a
+ * time, each with the dash offset it has within the whole subpath, which needs the length of
+ * every range. Markers are separate child items and are not affected.
+ *
+ * The index is rebuilt whenever the bounding box of the shape is, which covers every change
+ * of its path, style or transform.
+ */
+struct DrawingShape::SegmentIndex
+{
+    static constexpr unsigned NO_ROOT = -1;
+
+    struct Node
+    {
+        Geom::Rect box;
+        unsigned begin, end;          ///< Range of segments of the subpath.
+        unsigned left = 0, right = 0; ///< Child nodes; zero for leaves (roots are never children).
+        double length = 0;            ///< Length of the segments, only for dashed strokes.
+    };
+
+    /// Range of segments found by a query, either within the area or left out.
+    struct Span
+    {
+        unsigned begin, end;
+        bool visible;
+        double length;
+    };
+
+    /// Piece of a subpath to stroke.
+    struct Run
+    {
+        unsigned path;
+        unsigned begin, end; ///< Segments to draw; may go past the end of a closed subpath and wrap.
+        bool close;          ///< Whether the run is a whole closed subpath.
+        double offset;       ///< Length of the subpath before the run, for dashes.
+    };
+
+    Geom::Affine ctm, inverse;
+    double stroke_margin = 0; ///< Device distance within which a segment can affect the stroke.
+    bool has_lengths = false;
+    std::vector<Node> nodes;
+    std::vector<unsigned> roots; ///< Root of the tree of each subpath, or NO_ROOT if it is empty.
+
+    void build(Geom::PathVector const &pv, Geom::Affine const *dash_space);
+    unsigned build(Geom::Path const &path, unsigned begin, unsigned end, Geom::Affine const *dash_space);
+    void query(unsigned index, Geom::Rect const &area, unsigned limit, std::vector<Span> &spans) const;
+
+    void fill(cairo_t *ct, Geom::PathVector const &pv, Geom::Rect const &area) const;
+    void runs(Geom::PathVector const &pv, Geom::Rect const &area, bool dashed, std::vector<Run> &result) const;
+    static void emit(cairo_t *ct, Geom::PathVector const &pv, Run const &run, Geom::Affine const &trans);
+};
+
+/// Bounds of the control points of a segment, which contain it.
+static Geom::Rect segment_bounds(Geom::Curve const &c, Geom::Affine const &ctm)
+{
+    if (auto bezier = dynamic_cast<Geom::BezierCurve const *>(&c)) {
+        auto box = Geom::Rect(bezier->controlPoint(0) * ctm, bezier->controlPoint(0) * ctm);
+        for (unsigned i = 1; i <= bezier->order(); i++) {
+            box.expandTo(bezier->controlPoint(i) * ctm);
+        }
+        return box;
+    }
+    return std::unique_ptr<Geom::Curve>(c.transformed(ctm))->boundsFast();
+}
+
+static double segment_length(Geom::Curve const &c, Geom::Affine const &space)
+{
+    if (space.isIdentity()) {
+        return c.length();
+    }
+    return std::unique_ptr<Geom::Curve>(c.transformed(space))->length();
+}
+
+void DrawingShape::SegmentIndex::build(Geom::PathVector const &pv, Geom::Affine const *dash_space)
+{
+    inverse = ctm.inverse();
+    has_lengths = dash_space != nullptr;
+    nodes.clear();
+    roots.clear();
+    roots.reserve(pv.size());
+    for (auto const &path : pv) {
+        roots.push_back(path.empty() ? NO_ROOT : build(path, 0, path.size_closed(), dash_space));
+    }
+}
+
+unsigned DrawingShape::SegmentIndex::build(Geom::Path const &path, unsigned begin, unsigned end, Geom::Affine const *dash_space)
+{
+    unsigned const index = nodes.size();
+    nodes.push_back({{}, begin, end});
+
+    if (end - begin <= SEGMENT_INDEX_LEAF_SIZE) {
+        auto box = segment_bounds(path[begin], ctm);
+        double length = 0;
+        for (auto i = begin; i < end; i++) {
+            if (i > begin) {
+                box.unionWith(segment_bounds(path[i], ctm));
+            }
+            if (dash_space) {
+                length += segment_length(path[i], *dash_space);
+            }
+        }
+        nodes[index].box = box;
+        nodes[index].length = length;
+        return index;
+    }
+
+    auto const mid = begin + (end - begin) / 2;
+    auto const left = build(path, begin, mid, dash_space);
+    auto const right = build(path, mid, end, dash_space);
+
+    auto &node = nodes[index];
+    node.box = nodes[left].box;
+    node.box.unionWith(nodes[right].box);
+    node.length = nodes[left].length + nodes[right].length;
+    node.left = left;
+    node.right = right;
+    return index;
+}
+
+/// Appends the ranges of segments below @a limit to @a spans in order, merging the adjacent visible ones.
+void DrawingShape::SegmentIndex::query(unsigned index, Geom::Rect const &area, unsigned limit, std::vector<Span> &spans) const
+{
+    auto const &node = nodes[index];
+    if (node.begin >= limit) {
+        return;
+    }
+    auto const end = std::min(node.end, limit);
+
+    if (!area.intersects(node.box)) {
+        spans.push_back({node.begin, end, false, node.length});
+    } else if (node.left == 0) {
+        if (!spans.empty() && spans.back().visible && spans.back().end == node.begin) {
+            spans.back().end = end;
+            spans.back().length += node.length;
+        } else {
+            spans.push_back({node.begin, end, true, node.length});
+        }
+    } else {
+        query(node.left, area, limit, spans);
+        query(node.right, area, limit, spans);
+    }
+}
+
+/// Adds an outline to @a ct that fills @a area like the whole path would, in user space.
+void DrawingShape::SegmentIndex::fill(cairo_t *ct, Geom::PathVector const &pv, Geom::Rect const &area) const
+{
+    auto const clamped = [&, this] (Geom::Point const &p) {
+        auto d = p * ctm;
+        d = Geom::Point(std::clamp(d.x(), area.left(), area.right()), std::clamp(d.y(), area.top(), area.bottom()));
+        return d * inverse;
+    };
+    auto const move_to = [=] (Geom::Point const &p) { cairo_move_to(ct, p.x(), p.y()); };
+    auto const line_to = [=] (Geom::Point const &p) { cairo_line_to(ct, p.x(), p.y()); };
+
+    std::vector<Span> spans;
+    for (unsigned i = 0; i < pv.size(); i++) {
+        // A subpath entirely on one side of the area does not cover any of it.
+        if (roots[i] == NO_ROOT || !area.intersects(nodes[roots[i]].box)) {
+            continue;
+        }
+
+        auto const &path = pv[i];
+        spans.clear();
+        query(roots[i], area, path.size_closed(), spans);
+
+        // Filling closes every subpath, so the closing segment is treated like the others.
+        bool on_border = !spans.front().visible;
+        move_to(on_border ? clamped(path.initialPoint()) : path.initialPoint());
+        for (auto const &span : spans) {
+            if (span.visible) {
+                if (on_border) {
+                    line_to(path[span.begin].initialPoint());
+                }
+                for (auto j = span.begin; j < span.end; j++) {
+                    feed_curve_to_cairo(ct, path[j], Geom::identity(), Geom::Rect(), false);
+                }
+                on_border = false;
+            } else {
+                if (!on_border) {
+                    line_to(clamped(path[span.begin].initialPoint()));
+                }
+                line_to(clamped(path[span.end - 1].finalPoint()));
+                on_border = true;
+            }
+        }
+        cairo_close_path(ct);
+    }
+}
+
+/// Finds the pieces of the path to stroke within @a area, which should include the stroke margin.
+void DrawingShape::SegmentIndex::runs(Geom::PathVector const &pv, Geom::Rect const &area, bool dashed, std::vector<Run> &result) const
+{
+    std::vector<Span> spans;
+    for (unsigned i = 0; i < pv.size(); i++) {
+        if (roots[i] == NO_ROOT || !area.intersects(nodes[roots[i]].box)) {
+            continue;
+        }
+
+        auto const &path = pv[i];
+        unsigned const size = path.size_default();
+        spans.clear();
+        query(roots[i], area, size, spans);
+
+        auto const first = result.size();
+        double offset = 0;
+        for (auto const &span : spans) {
+            if (span.visible) {
+                result.push_back({i, span.begin, span.end, false, offset});
+            }
+            offset += span.length;
+        }
+        if (result.size() == first) {
+            continue;
+        }
+
+        auto const whole = Run{i, 0, static_cast<unsigned>(path.size_open()), path.closed(), 0};
+        auto &head = result[first];
+        auto &tail = result.back();
+        if (result.size() == first + 1 && head.begin == 0 && head.end == size) {
+            head = whole;
+        } else if (path.closed() && head.begin == 0 && tail.end == size) {
+            // Start from the last piece instead, so that the start of the subpath is not cut.
+            // Dashes start over there however, which a single piece cannot do.
+            if (dashed) {
+                result.resize(first);
+                result.push_back(whole);
+            } else {
+                tail.end = size + head.end;
+                result.erase(result.begin() + first);
+            }
+        }
+    }
+}
+
+void DrawingShape::SegmentIndex::emit(cairo_t *ct, Geom::PathVector const &pv, Run const &run, Geom::Affine const &trans)
+{
+    auto const &path = pv[run.path];
+    unsigned const size = path.size_default();
+    auto const start = path[run.begin % size].initialPoint() * trans;
+    cairo_move_to(ct, start.x(), start.y());
+    for (auto i = run.begin; i < run.end; i++) {
+        feed_curve_to_cairo(ct, path[i % size], trans, Geom::Rect(), false);
+    }
+    if (run.close) {
+        cairo_close_path(ct);
+    }
+}
+
+/// Paths with fewer segments than this are always drawn as they are.
+static constexpr std::size_t LOD_MIN_SEGMENTS = 256;
+/// Largest distance, in device pixels, between a path and the simplified path drawn for it.
+static constexpr double LOD_MAX_ERROR = 0.25;
+/// Number of levels kept per shape, counting those found not worth drawing.
+static constexpr std::size_t LOD_MAX_LEVELS = 6;
+
+/**
+ * Simplified copies of the path of a shape, drawn in its place when zoomed out far enough that
+ * the difference does not show.
+ *
+ * There is one level for each power of two of the distance allowed, in user units, made when
+ * the zoom first asks for it and kept for zooming back and forth. A level is simplified from
+ * the closest finer one, which is smaller than the path, with what remains of the distance.
+ * A level that does not drop a good part of the segments is not kept, nor are levels finer than
+ * the segments of the path are long.
+ */
+struct DrawingShape::LevelsOfDetail
+{
+    struct Level
+    {
+        int exponent; ///< The level is within 2^exponent user units of the path.
+        double error; ///< Bound on its distance to the path; at most that.
+        std::shared_ptr<Geom::PathVector const> path; ///< Null if not worth drawing.
+    };
+
+    explicit LevelsOfDetail(Geom::PathVector const &path);
+
+    /// The level for @a exponent, or null to draw the path itself.
+    std::shared_ptr<Geom::PathVector const> get(int exponent);
+
+    Geom::PathVector const &original;
+    std::size_t segments;
+    double mean_chord; ///< Average distance between the ends of a segment.
+    std::vector<Level> levels;
+};
+
+DrawingShape::LevelsOfDetail::LevelsOfDetail(Geom::PathVector const &path)
+    : original(path)
+    , segments(path.curveCount())
+{
+    double chords = 0;
+    for (auto const &p : path) {
+        for (auto const &c : p) {
+            chords += Geom::distance(c.initialPoint(), c.finalPoint());
+        }
+    }
+    mean_chord = chords / std::max<std::size_t>(segments, 1);
+}
+
+std::shared_ptr<Geom::PathVector const> DrawingShape::LevelsOfDetail::get(int exponent)
+{
+    auto const tolerance = std::ldexp(1.0, exponent);
+    if (mean_chord > 4 * tolerance) {
+        return {};
+    }
+
+    for (auto const &level : levels) {
+        if (level.exponent == exponent) {
+            return level.path;
+        }
+    }
+
+    auto source = &original;
+    double error = 0;
+    int source_exponent = std::numeric_limits<int>::min();
+    for (auto const &level : levels) {
+        if (level.path && level.exponent < exponent && level.exponent > source_exponent) {
+            source = level.path.get();
+            error = level.error;
+            source_exponent = level.exponent;
+        }
+    }
+
+    auto simplified = pathv_simplify_within(*source, tolerance - error);
+    std::shared_ptr<Geom::PathVector const> path;
+    if (simplified.curveCount() * 4 < segments * 3) {
+        path = std::make_shared<Geom::PathVector const>(std::move(simplified));
+    }
+
+    if (levels.size() >= LOD_MAX_LEVELS) {
+        // Forget the level farthest from the zoom asked for.
+        levels.erase(std::max_element(levels.begin(), levels.end(), [=] (Level const &a, Level const &b) {
+            return std::abs(a.exponent - exponent) < std::abs(b.exponent - exponent);
+        }));
+    }
+    levels.push_back({exponent, tolerance, path});
+    return path;
+}
+
 DrawingShape::DrawingShape(Drawing &drawing)
     : DrawingItem(drawing)
     , style_vector_effect_stroke(false)
@@ -42,11 +407,15 @@ DrawingShape::DrawingShape(Drawing &drawing)
 {
 }
 
+DrawingShape::~DrawingShape() = default;
+
 void DrawingShape::setPath(std::shared_ptr<SPCurve const> curve)
 {
     defer([this, curve = std::move(curve)] () mutable {
         _markForRendering();
         _curve = std::move(curve);
+        _lod.reset();
+        _display_path.reset();
         _markForUpdate(STATE_ALL, false);
     });
 }
@@ -99,16 +468,7 @@ unsigned DrawingShape::_updateItem(Geom::IntRect const &area, UpdateContext cons
         _nrstyle.invalidate();
     }
 
-    auto calc_curve_bbox = [&, this] () -> Geom::OptIntRect {
-        if (!_curve) {
-            return {};
-        }
-
-        auto rect = bounds_exact_transformed(_curve->get_pathvector(), ctx.ctm);
-        if (!rect) {
-            return {};
-        }
-
+    auto calc_stroke_max = [&, this] {
         float stroke_max = 0.0f;
 
         // Get the normal stroke.
@@ -132,27 +492,67 @@ unsigned DrawingShape::_updateItem(Geom::IntRect const &area, UpdateContext cons
             stroke_max = std::max(stroke_max, 0.5f);
         }
 
-        if (stroke_max > 0.0f) {
-            // Expand by mitres, if present.
-            if (_nrstyle.data.line_join == CAIRO_LINE_JOIN_MITER && _nrstyle.data.miter_limit >= 1.0f) {
-                stroke_max *= _nrstyle.data.miter_limit;
-            }
+        // Expand by mitres, if present.
+        if (_nrstyle.data.line_join == CAIRO_LINE_JOIN_MITER && _nrstyle.data.miter_limit >= 1.0f) {
+            stroke_max *= _nrstyle.data.miter_limit;
+        }
 
-            // Apply expansion if non-zero.
-            if (stroke_max > 0.01) {
-                rect->expandBy(stroke_max);
-            }
+        return stroke_max;
+    };
+
+    auto calc_curve_bbox = [&, this] (float stroke_max) -> Geom::OptIntRect {
+        if (!_curve) {
+            return {};
+        }
+
+        auto rect = bounds_exact_transformed(_curve->get_pathvector(), ctx.ctm);
+        if (!rect) {
+            return {};
+        }
+
+        // Apply expansion if non-zero.
+        if (stroke_max > 0.01) {
+            rect->expandBy(stroke_max);
         }
 
         return rect->roundOutwards();
     };
 
     if (flags & STATE_BBOX) {
-        _bbox = calc_curve_bbox();
+        auto const stroke_max = calc_stroke_max();
+        _bbox = calc_curve_bbox(stroke_max);
 
         for (auto &c : _children) {
             _bbox.unionWith(c.bbox());
         }
+
+        // Zoomed out, dense paths are drawn simplified, within a fraction of a pixel of the real
+        // ones. Dashes would move along the shorter path, so dashed paths are left alone.
+        _display_path.reset();
+        if (_curve && !_drawing.exact() && _nrstyle.data.dash.empty() && _curve->get_pathvector().curveCount() >= LOD_MIN_SEGMENTS) {
+            if (auto const scale = max_expansion(ctx.ctm); scale > 0) {
+                if (!_lod) {
+                    _lod = std::make_unique<LevelsOfDetail>(_curve->get_pathvector());
+                }
+                _display_path = _lod->get(static_cast<int>(std::floor(std::log2(LOD_MAX_ERROR / scale))));
+            }
+        }
+
+        // Long paths are drawn one area at a time through an index of their segments.
+        if (_curve && _displayPath().curveCount() >= SEGMENT_INDEX_MIN_SEGMENTS && !ctx.ctm.isSingular()) {
+            if (!_segment_index) {
+                _segment_index = std::make_unique<SegmentIndex>();
+            }
+            _segment_index->ctm = ctx.ctm;
+            // Square caps, where a stroke is cut, reach further than half its width. Outline mode
+            // may draw a half pixel wide line regardless, and antialiasing reaches one pixel more.
+            _segment_index->stroke_margin = std::max(stroke_max, 0.5f) * M_SQRT2 + 1.0;
+            // Dashes are measured in user space, or in device space under vector-effect.
+            Geom::Affine const dash_space = style_vector_effect_stroke ? ctx.ctm : Geom::identity();
+            _segment_index->build(_displayPath(), _nrstyle.data.dash.empty() ? nullptr : &dash_space);
+        } else {
+            _segment_index.reset();
+        }
     }
 
     return _state | flags;
@@ -166,7 +566,7 @@ void DrawingShape::_renderFill(DrawingContext &dc, RenderContext &rc, Geom::IntR
     auto has_fill = _nrstyle.prepareFill(dc, rc, area, _item_bbox, _fill_pattern);
 
     if (has_fill) {
-        dc.path(_curve->get_pathvector());
+        _fillPath(dc, area);
         _nrstyle.applyFill(dc, has_fill);
         dc.fillPreserve();
         dc.newPath(); // clear path
@@ -184,8 +584,10 @@ void DrawingShape::_renderStroke(DrawingContext &dc, RenderContext &rc, Geom::In
     }
 
     if (has_stroke) {
-        // TODO: remove segments outside of bbox when no dashes present
-        dc.path(_curve->get_pathvector());
+        bool const by_runs = _strokesByRuns();
+        if (!by_runs) {
+            _strokePath(dc, area, !_nrstyle.data.dash.empty());
+        }
         if (style_vector_effect_stroke) {
             dc.restore();
             dc.save();
@@ -203,7 +605,11 @@ void DrawingShape::_renderStroke(DrawingContext &dc, RenderContext &rc, Geom::In
             }
         }
 
-        dc.strokePreserve();
+        if (by_runs) {
+            _strokeRuns(dc, area);
+        } else {
+            dc.strokePreserve();
+        }
         dc.newPath(); // clear path
     }
 }
@@ -216,6 +622,79 @@ void DrawingShape::_renderMarkers(DrawingContext &dc, RenderContext &rc, Geom::I
     }
 }
 
+/// The path to draw, which may be simplified; see LevelsOfDetail.
+Geom::PathVector const &DrawingShape::_displayPath() const
+{
+    return _display_path ? *_display_path : _curve->get_pathvector();
+}
+
+/// Adds the path, or what fills @a area like it, to the current path in user space.
+void DrawingShape::_fillPath(DrawingContext &dc, Geom::IntRect const &area) const
+{
+    if (!_segment_index) {
+        dc.path(_displayPath());
+        return;
+    }
+
+    // Keep a pixel of margin, so that the edges moved onto the border do not touch the area.
+    _segment_index->fill(dc.raw(), _displayPath(), expandedBy(Geom::Rect(area), 1.0));
+}
+
+/// Adds the path, or the parts of it that show within @a area when stroked, to the current path in user space.
+void DrawingShape::_strokePath(DrawingContext &dc, Geom::IntRect const &area, bool dashed) const
+{
+    // Cutting a dashed stroke shifts its dashes; see _strokeRuns().
+    if (!_segment_index || dashed) {
+        dc.path(_displayPath());
+        return;
+    }
+
+    std::vector<SegmentIndex::Run> runs;
+    _segment_index->runs(_displayPath(), expandedBy(Geom::Rect(area), _segment_index->stroke_margin), false, runs);
+    for (auto const &run : runs) {
+        _segment_index->emit(dc.raw(), _displayPath(), run, Geom::identity());
+    }
+}
+
+/// Whether the stroke is dashed and drawn by _strokeRuns() rather than from _strokePath().
+bool DrawingShape::_strokesByRuns() const
+{
+    return _segment_index && _segment_index->has_lengths && !_nrstyle.data.dash.empty();
+}
+
+/**
+ * Strokes the parts of a dashed path that show within @a area one at a time, each with the
+ * dash offset it has within the whole path. The stroke must already be applied to @a dc.
+ */
+void DrawingShape::_strokeRuns(DrawingContext &dc, Geom::IntRect const &area) const
+{
+    auto const &pv = _displayPath();
+    std::vector<SegmentIndex::Run> runs;
+    _segment_index->runs(pv, expandedBy(Geom::Rect(area), _segment_index->stroke_margin), true, runs);
+
+    // Under vector-effect, the user space of the path has already been left.
+    Geom::Affine const trans = style_vector_effect_stroke ? _ctm : Geom::identity();
+
+    if (runs.size() > SEGMENT_INDEX_MAX_DASHED_RUNS) {
+        dc.newPath();
+        for (unsigned i = 0; i < pv.size(); i++) {
+            if (!pv[i].empty()) {
+                SegmentIndex::emit(dc.raw(), pv, {i, 0, static_cast<unsigned>(pv[i].size_open()), pv[i].closed(), 0}, trans);
+            }
+        }
+        dc.stroke();
+        return;
+    }
+
+    auto const &dash = _nrstyle.data.dash;
+    for (auto const &run : runs) {
+        dc.newPath();
+        SegmentIndex::emit(dc.raw(), pv, run, trans);
+        cairo_set_dash(dc.raw(), dash.data(), _nrstyle.data.n_dash, _nrstyle.data.dash_offset + run.offset);
+        dc.stroke();
+    }
+}
+
 unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const
 {
     if (!_curve) return RENDER_OK;
@@ -232,7 +711,7 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
         {
             Inkscape::DrawingContext::Save save(dc);
             dc.transform(_ctm);
-            dc.path(_curve->get_pathvector());
+            _strokePath(dc, *visible, false);
         }
         {
             Inkscape::DrawingContext::Save save(dc);
@@ -247,7 +726,7 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
     }
 
     if (_nrstyle.data.paint_order_layer[0] == NRStyleData::PAINT_ORDER_NORMAL) {
-        // This is the most common case, special case so we don't call get_pathvector(), etc. twice
+        // This is the most common case, special case so we don't call _displayPath(), etc. twice
 
         {
             // we assume the context has no path
@@ -263,11 +742,24 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
                 has_stroke.reset();
             }
             if (has_fill || has_stroke) {
-                dc.path(_curve->get_pathvector());
-                // TODO: remove segments outside of bbox when no dashes present
+                // Fill and stroke share the whole path, but not the parts of it an index finds.
+                bool const shared_path = !_segment_index;
+                bool const by_runs = has_stroke && _strokesByRuns();
+                if (shared_path) {
+                    dc.path(_displayPath());
+                }
                 if (has_fill) {
+                    if (!shared_path) {
+                        _fillPath(dc, *visible);
+                    }
                     _nrstyle.applyFill(dc, has_fill);
                     dc.fillPreserve();
+                    if (!shared_path) {
+                        dc.newPath();
+                    }
+                }
+                if (has_stroke && !shared_path && !by_runs) {
+                    _strokePath(dc, *visible, !_nrstyle.data.dash.empty());
                 }
                 if (style_vector_effect_stroke) {
                     dc.restore();
@@ -287,7 +779,11 @@ unsigned DrawingShape::_renderItem(DrawingContext &dc, RenderContext &rc, Geom::
                         }
                     }
 
-                    dc.strokePreserve();
+                    if (by_runs) {
+                        _strokeRuns(dc, *visible);
+                    } else {
+                        dc.strokePreserve();
+                    }
                 }
                 dc.newPath(); // clear path
             } // has fill or stroke pattern
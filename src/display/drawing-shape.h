@@ -13,6 +13,9 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_SHAPE_H
 #define INKSCAPE_DISPLAY_DRAWING_SHAPE_H
 
+#include <memory>
+#include <2geom/forward.h>
+
 #include "display/drawing-item.h"
 #include "display/nr-style.h"
 
@@ -33,7 +36,7 @@ public:
     void setChildrenStyle(SPStyle const *context_style) override;
 
 protected:
-    ~DrawingShape() override = default;
+    ~DrawingShape() override;
 
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset) override;
     unsigned _renderItem(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const override;
@@ -45,6 +48,12 @@ protected:
     void _renderStroke(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags) const;
     void _renderMarkers(DrawingContext &dc, RenderContext &rc, Geom::IntRect const &area, unsigned flags, DrawingItem const *stop_at) const;
 
+    Geom::PathVector const &_displayPath() const;
+    void _fillPath(DrawingContext &dc, Geom::IntRect const &area) const;
+    void _strokePath(DrawingContext &dc, Geom::IntRect const &area, bool dashed) const;
+    bool _strokesByRuns() const;
+    void _strokeRuns(DrawingContext &dc, Geom::IntRect const &area) const;
+
     bool style_vector_effect_stroke : 1;
     bool style_stroke_extensions_hairline : 1;
     SPWindRule style_clip_rule;
@@ -52,6 +61,13 @@ protected:
     unsigned style_opacity : 24;
 
     std::shared_ptr<SPCurve const> _curve;
+
+    struct LevelsOfDetail;
+    std::unique_ptr<LevelsOfDetail> _lod;
+    std::shared_ptr<Geom::PathVector const> _display_path; ///< Simplified path drawn instead, if any.
+
+    struct SegmentIndex;
+    std::unique_ptr<SegmentIndex> _segment_index; ///< Only for long paths; see drawing-shape.cpp.
     NRStyle _nrstyle;
 
     DrawingItem *_last_pick;
@@ -72,6 +72,7 @@ public:
     void scheduleTransform(Geom::IntRect const &new_area, Geom::Affine const &trans);
     void prepare();
     void paintFromCache(DrawingContext &dc, Geom::OptIntRect &area, bool is_filter);
+    bool empty() const { return cairo_region_is_empty(_clean_region); } ///< Whether no part of the cache is clean.
 
 protected:
     cairo_region_t *_clean_region;
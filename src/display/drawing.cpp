@@ -13,10 +13,12 @@
 
 #include "drawing.h"
 
+#include <algorithm>
 #include <array>
 #include <thread>
 
 #include "cairo-utils.h"
+#include "dispatch-pool.h"
 #include "drawing-context.h"
 #include "control/canvas-item-drawing.h"
 #include "nr-filter-gaussian.h"
@@ -192,6 +194,7 @@ void Drawing::setCacheBudget(size_t bytes)
 {
     defer([=, this] {
         _cache_budget = bytes;
+        _setReservedCacheBudgets();
         _pickItemsForCaching();
     });
 }
@@ -235,14 +238,21 @@ void Drawing::update(Geom::IntRect const &area, Geom::Affine const &affine, unsi
     }
 }
 
-void Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags) const
+/**
+ * Render @a area of the drawing. If @a cancel is given, the rendering stops early once it is
+ * set, at the next item or filter primitive, and what was drawn so far must be thrown away.
+ * If @a preview is set, filters are rendered at the worst quality, and nothing is cached.
+ */
+void Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags, std::atomic<bool> const *cancel, bool preview) const
 {
     apply_antialias(dc, _antialiasing_override.value_or(Antialiasing(_root->_antialias)));
 
     auto rc = RenderContext{
         .outline_color = 0xff,
         .antialiasing_override = _antialiasing_override,
-        .dithering = _use_dithering
+        .dithering = _use_dithering,
+        .preview = preview,
+        .cancel = cancel
     };
     flags |= rendermode_to_renderflags(_rendermode);
 
@@ -275,13 +285,22 @@ void Drawing::unsnapshot()
     _funclog();
 }
 
+size_t Drawing::cachedItemCount() const
+{
+    return std::count_if(_cached_items.begin(), _cached_items.end(), [] (auto item) { return item->_hasCachedContent(); });
+}
+
 void Drawing::_pickItemsForCaching()
 {
+    // Image pyramids and filter results take priority, as they are reused at every zoom level.
+    size_t const reserved = _image_pyramids.size() + _filter_results.size();
+    size_t const budget = _cache_budget - std::min(reserved, _cache_budget);
+
     // Build sorted list of items that should be cached.
     std::vector<DrawingItem*> to_cache;
     size_t used = 0;
     for (auto &rec : _candidate_items) {
-        if (used + rec.cache_size > _cache_budget) break;
+        if (used + rec.cache_size > budget) break;
         to_cache.emplace_back(rec.item);
         used += rec.cache_size;
     }
@@ -303,8 +322,17 @@ void Drawing::_pickItemsForCaching()
     }
 }
 
+/// Reserve a quarter of the cache budget for filter results, and another for image pyramids.
+void Drawing::_setReservedCacheBudgets()
+{
+    _filter_results.set_budget(_cache_budget / 4);
+    _image_pyramids.set_budget(_cache_budget / 4);
+}
+
 void Drawing::_clearCache()
 {
+    _filter_results.clear();
+
     // Note: setCached() modifies _cached_items, so the temporary container is necessary.
     std::vector<DrawingItem*> to_uncache;
     std::copy(_cached_items.begin(), _cached_items.end(), std::back_inserter(to_uncache));
@@ -335,9 +363,10 @@ void Drawing::_loadPrefs()
     } else {
         _cache_budget = 0;
     }
+    _setReservedCacheBudgets();
 
-    // Set the global variable governing the number of filter threads, and track it too. (This is ugly, but hopefully transitional.)
-    set_num_filter_threads(prefs->getIntLimited("/options/threading/numthreads", default_numthreads(), 1, 256));
+    // Size the render thread pool shared by exports and filters, and track it too.
+    get_global_dispatch_pool().set_num_threads(prefs->getIntLimited("/options/threading/numthreads", default_numthreads(), 1, 256));
 
     // Similarly, enable preference tracking only for the Canvas's drawing.
     if (_canvas_item_drawing) {
@@ -354,7 +383,7 @@ void Drawing::_loadPrefs()
         actions.emplace("/options/cursortolerance/value",        [this] (auto &entry) { setCursorTolerance(entry.getDouble(1.0)); });
         actions.emplace("/options/selection/zeroopacity",        [this] (auto &entry) { setSelectZeroOpacity(entry.getBool(false)); });
         actions.emplace("/options/renderingcache/size",          [this] (auto &entry) { setCacheBudget((1 << 20) * entry.getIntLimited(64, 0, 4096)); });
-        actions.emplace("/options/threading/numthreads",         [this] (auto &entry) { set_num_filter_threads(entry.getIntLimited(default_numthreads(), 1, 256)); });
+        actions.emplace("/options/threading/numthreads",         [this] (auto &entry) { get_global_dispatch_pool().set_num_threads(entry.getIntLimited(default_numthreads(), 1, 256)); });
 
         _pref_tracker = Inkscape::Preferences::PreferencesObserver::create("/options", [actions = std::move(actions)] (auto &entry) {
             auto it = actions.find(entry.getPath());
@@ -381,10 +410,12 @@ void Drawing::averageColor(Geom::IntRect const &area, double &R, double &G, doub
 }
 
 /*
- * Convenience function to set high quality options for export.
+ * Convenience function to set high quality options for export. This also turns off the
+ * simplified paths shown in place of dense ones when zoomed out.
  */
 void Drawing::setExact()
 {
+    _exact = true;
     setFilterQuality(Filters::FILTER_QUALITY_BEST);
     setBlurQuality(BLUR_QUALITY_BEST);
 }
@@ -13,6 +13,7 @@
 #ifndef INKSCAPE_DISPLAY_DRAWING_H
 #define INKSCAPE_DISPLAY_DRAWING_H
 
+#include <atomic>
 #include <optional>
 #include <set>
 #include <cstdint>
@@ -23,6 +24,8 @@
 #include <sigc++/sigc++.h>
 
 #include "display/drawing-item.h"
+#include "display/filter-result-cache.h"
+#include "display/image-pyramid-cache.h"
 #include "display/rendermode.h"
 #include "nr-filter-colormatrix.h"
 #include "preferences.h"
@@ -77,11 +80,16 @@ public:
     bool useDithering() const { return _use_dithering; }
     double cursorTolerance() const { return _cursor_tolerance; }
     bool selectZeroOpacity() const { return _select_zero_opacity; }
+    bool exact() const { return _exact; } ///< Whether shortcuts that only fool the eye are off.
+    bool clipped() const { return _clip.has_value(); }
+    auto antialiasingOverride() const { return _antialiasing_override; }
     Geom::OptIntRect const &cacheLimit() const { return _cache_limit; }
+    size_t cachedItemCount() const; ///< The number of items whose cache holds rendered content.
+    size_t filterResultSize() const { return _filter_results.size(); }
 
     void update(Geom::IntRect const &area = Geom::IntRect::infinite(), Geom::Affine const &affine = Geom::identity(),
                 unsigned flags = DrawingItem::STATE_ALL, unsigned reset = 0);
-    void render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags = 0) const;
+    void render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags = 0, std::atomic<bool> const *cancel = nullptr, bool preview = false) const;
     DrawingItem *pick(Geom::Point const &p, double delta, unsigned flags);
 
     void snapshot();
@@ -97,6 +105,7 @@ private:
     void _pickItemsForCaching();
     void _clearCache();
     void _loadPrefs();
+    void _setReservedCacheBudgets();
 
     DrawingItem *_root = nullptr;
     CanvasItemDrawing *_canvas_item_drawing = nullptr;
@@ -118,10 +127,13 @@ private:
     Geom::OptIntRect _cache_limit;
     std::optional<Geom::PathVector> _clip;
     bool _select_zero_opacity;
+    bool _exact = false;
     std::optional<Antialiasing> _antialiasing_override;
 
     std::set<DrawingItem*> _cached_items; // modified by DrawingItem::_setCached()
     CacheList _candidate_items;           // keep this list always sorted with std::greater
+    ImagePyramidCache _image_pyramids; ///< Downscaled copies of images, counted against the cache budget.
+    FilterResultCache _filter_results; ///< Filter outputs kept across redraws, counted against the cache budget.
 
     /*
      * Simple cacheline separator compatible with x86 (64 bytes) and M* (128 bytes).
@@ -137,6 +149,7 @@ private:
     void defer(F &&f) { _snapshotted ? _funclog.emplace(std::forward<F>(f)) : f(); }
 
     friend class DrawingItem;
+    friend class DrawingImage;
 };
 
 } // namespace Inkscape
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Filtered renderings of items, kept across redraws.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/filter-result-cache.h"
+
+#include <functional>
+
+#include "display/cairo-utils.h"
+
+namespace Inkscape {
+
+FilterResultCache::~FilterResultCache()
+{
+    clear();
+}
+
+size_t FilterResultCache::KeyHash::operator()(Key const &key) const
+{
+    size_t seed = std::hash<void const *>()(key.item);
+    auto combine = [&] (size_t h) {
+        seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    combine(std::hash<void const *>()(key.filter));
+    for (int i = 0; i < 6; i++) {
+        combine(std::hash<double>()(key.transform[i]));
+    }
+    combine(key.device_scale);
+    combine(key.filter_quality);
+    combine(key.blur_quality);
+    combine(key.flags);
+    return seed;
+}
+
+cairo_surface_t *FilterResultCache::lookup(Key const &key, Geom::IntRect const &area, Geom::IntRect &result_area)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    auto [begin, end] = _index.equal_range(key);
+    for (auto it = begin; it != end; ++it) {
+        auto const entry = it->second;
+        if (entry->area.contains(area)) {
+            _entries.splice(_entries.begin(), _entries, entry);
+            result_area = entry->area;
+            return cairo_surface_reference(entry->surface);
+        }
+    }
+
+    return nullptr;
+}
+
+void FilterResultCache::insert(Key const &key, Geom::IntRect const &area, cairo_surface_t *surface)
+{
+    size_t const bytes = cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+
+    auto lock = std::unique_lock(_mutex);
+
+    // Drop results made redundant by this one.
+    for (auto [it, end] = _index.equal_range(key); it != end; ) {
+        auto const entry = it++->second;
+        if (area.contains(entry->area)) {
+            _erase(entry);
+        }
+    }
+    if (bytes > _budget) {
+        return;
+    }
+
+    _entries.push_front({key, area, ink_cairo_surface_copy(surface), bytes});
+    _index.emplace(key, _entries.begin());
+    _size += bytes;
+    _evict();
+}
+
+void FilterResultCache::remove(DrawingItem const *item)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    for (auto it = _entries.begin(); it != _entries.end(); ) {
+        auto next = std::next(it);
+        if (it->key.item == item) {
+            _erase(it);
+        }
+        it = next;
+    }
+}
+
+void FilterResultCache::clear()
+{
+    auto lock = std::unique_lock(_mutex);
+
+    while (!_entries.empty()) {
+        _erase(_entries.begin());
+    }
+}
+
+void FilterResultCache::set_budget(size_t bytes)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    _budget = bytes;
+    _evict();
+}
+
+size_t FilterResultCache::size() const
+{
+    auto lock = std::unique_lock(_mutex);
+    return _size;
+}
+
+// Called with the lock held.
+void FilterResultCache::_erase(EntryList::iterator it)
+{
+    for (auto [i, end] = _index.equal_range(it->key); i != end; ++i) {
+        if (i->second == it) {
+            _index.erase(i);
+            break;
+        }
+    }
+    _size -= it->bytes;
+    cairo_surface_destroy(it->surface);
+    _entries.erase(it);
+}
+
+// Called with the lock held.
+void FilterResultCache::_evict()
+{
+    while (_size > _budget) {
+        _erase(std::prev(_entries.end()));
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
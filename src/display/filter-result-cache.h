@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Filtered renderings of items, kept across redraws.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_FILTER_RESULT_CACHE_H
+#define INKSCAPE_DISPLAY_FILTER_RESULT_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <2geom/affine.h>
+#include <2geom/int-rect.h>
+#include <cairo.h>
+
+namespace Inkscape {
+
+class DrawingItem;
+namespace Filters { class Filter; }
+
+/**
+ * Filter outputs of items, so that returning to an earlier zoom level or scrolling an item back
+ * into view does not run its filter again.
+ *
+ * Unlike the item caches, which are transformed and marked dirty whenever the view changes,
+ * the results here are addressed by everything the filter output depends on: the item and its
+ * filter renderer (replaced whenever the filter definition changes), the transformation up to an
+ * integer translation, the device scale and the rendering settings. An item's results are
+ * dropped when its content changes, as reported by DrawingItem::_markForRendering().
+ *
+ * Filters are rendered tile by tile, so several results covering different areas may be stored
+ * for the same key; a lookup is served by any of them that covers the requested area.
+ *
+ * Results are evicted in least recently used order once they exceed their share of the
+ * drawing's cache budget. All methods are thread-safe.
+ */
+class FilterResultCache
+{
+public:
+    struct Key
+    {
+        DrawingItem const *item;
+        Filters::Filter const *filter;
+        Geom::Affine transform; ///< Item transform with its translation reduced to less than a pixel.
+        int device_scale;
+        int filter_quality;
+        int blur_quality;
+        unsigned flags;         ///< Render flags.
+
+        bool operator==(Key const &other) const = default;
+    };
+
+    FilterResultCache() = default;
+    FilterResultCache(FilterResultCache const &) = delete;
+    FilterResultCache &operator=(FilterResultCache const &) = delete;
+    ~FilterResultCache();
+
+    /**
+     * Return a new reference to a stored result for @a key that covers @a area,
+     * and set @a result_area to the area it covers. Otherwise return null.
+     */
+    cairo_surface_t *lookup(Key const &key, Geom::IntRect const &area, Geom::IntRect &result_area);
+
+    /// Store a copy of @a surface, covering @a area, as a result for @a key.
+    /// Results for the same key whose area lies within @a area are dropped.
+    void insert(Key const &key, Geom::IntRect const &area, cairo_surface_t *surface);
+
+    /// Drop all results of @a item.
+    void remove(DrawingItem const *item);
+    void clear();
+
+    void set_budget(size_t bytes);
+    size_t size() const;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(Key const &key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        Geom::IntRect area;
+        cairo_surface_t *surface;
+        size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void _erase(EntryList::iterator it);
+    void _evict();
+
+    mutable std::mutex _mutex;
+    EntryList _entries; ///< Most recently used first.
+    std::unordered_multimap<Key, EntryList::iterator, KeyHash> _index;
+    size_t _size = 0;
+    size_t _budget = 0;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_FILTER_RESULT_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
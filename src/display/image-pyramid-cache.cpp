@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Downscaled copies of images, kept for painting them when zoomed out.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/image-pyramid-cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+#include "display/cairo-utils.h"
+
+namespace Inkscape {
+
+cairo_surface_t *downsample_half(cairo_surface_t *src)
+{
+    cairo_surface_flush(src);
+    int const sw = cairo_image_surface_get_width(src);
+    int const sh = cairo_image_surface_get_height(src);
+    int const sstride = cairo_image_surface_get_stride(src);
+    auto const spx = cairo_image_surface_get_data(src);
+
+    int const dw = (sw + 1) / 2;
+    int const dh = (sh + 1) / 2;
+    auto const dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dw, dh);
+    int const dstride = cairo_image_surface_get_stride(dst);
+    auto const dpx = cairo_image_surface_get_data(dst);
+
+    for (int y = 0; y < dh; y++) {
+        auto const row0 = reinterpret_cast<std::uint32_t const *>(spx + 2 * y * sstride);
+        auto const row1 = reinterpret_cast<std::uint32_t const *>(spx + std::min(2 * y + 1, sh - 1) * sstride);
+        auto const out = reinterpret_cast<std::uint32_t *>(dpx + y * dstride);
+        for (int x = 0; x < dw; x++) {
+            int const x0 = 2 * x;
+            int const x1 = std::min(2 * x + 1, sw - 1);
+            std::uint32_t const p[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+            std::uint32_t result = 0;
+            // Premultiplied channels can be averaged independently.
+            for (int shift = 0; shift < 32; shift += 8) {
+                std::uint32_t sum = 2;
+                for (auto q : p) {
+                    sum += (q >> shift) & 0xff;
+                }
+                result |= (sum / 4) << shift;
+            }
+            out[x] = result;
+        }
+    }
+
+    cairo_surface_mark_dirty(dst);
+    copy_cairo_surface_ci(src, dst);
+    return dst;
+}
+
+ImagePyramidCache::~ImagePyramidCache()
+{
+    clear();
+}
+
+size_t ImagePyramidCache::KeyHash::operator()(Key const &key) const
+{
+    size_t seed = std::hash<void const *>()(key.image);
+    seed ^= std::hash<int>()(key.level) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+cairo_surface_t *ImagePyramidCache::lookup(DrawingImage const *image, int level)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    auto it = _index.find({image, level});
+    if (it == _index.end()) {
+        return nullptr;
+    }
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return cairo_surface_reference(it->second->surface);
+}
+
+bool ImagePyramidCache::insert(DrawingImage const *image, int level, cairo_surface_t *surface)
+{
+    size_t const bytes = cairo_image_surface_get_stride(surface) * cairo_image_surface_get_height(surface);
+    auto const key = Key{image, level};
+
+    auto lock = std::unique_lock(_mutex);
+
+    if (auto it = _index.find(key); it != _index.end()) {
+        _erase(it->second);
+    }
+    if (bytes > _budget) {
+        return false;
+    }
+
+    _entries.push_front({key, cairo_surface_reference(surface), bytes});
+    _index.emplace(key, _entries.begin());
+    _size += bytes;
+    _evict();
+    return true;
+}
+
+void ImagePyramidCache::remove(DrawingImage const *image)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    for (auto it = _entries.begin(); it != _entries.end(); ) {
+        auto next = std::next(it);
+        if (it->key.image == image) {
+            _erase(it);
+        }
+        it = next;
+    }
+}
+
+void ImagePyramidCache::clear()
+{
+    auto lock = std::unique_lock(_mutex);
+
+    while (!_entries.empty()) {
+        _erase(_entries.begin());
+    }
+}
+
+void ImagePyramidCache::set_budget(size_t bytes)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    _budget = bytes;
+    _evict();
+}
+
+size_t ImagePyramidCache::size() const
+{
+    auto lock = std::unique_lock(_mutex);
+    return _size;
+}
+
+// Called with the lock held.
+void ImagePyramidCache::_erase(EntryList::iterator it)
+{
+    _index.erase(it->key);
+    _size -= it->bytes;
+    cairo_surface_destroy(it->surface);
+    _entries.erase(it);
+}
+
+// Called with the lock held.
+void ImagePyramidCache::_evict()
+{
+    while (_size > _budget) {
+        _erase(std::prev(_entries.end()));
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Downscaled copies of images, kept for painting them when zoomed out.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_IMAGE_PYRAMID_CACHE_H
+#define INKSCAPE_DISPLAY_IMAGE_PYRAMID_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <cairo.h>
+
+namespace Inkscape {
+
+class DrawingImage;
+
+/**
+ * Return a new ARGB32 image surface half the size of @a src in each direction, rounding up.
+ * Each pixel is the average of the corresponding 2x2 block, whose missing pixels at odd edges
+ * are taken from the last row or column.
+ */
+cairo_surface_t *downsample_half(cairo_surface_t *src);
+
+/**
+ * The levels of the image pyramids of a drawing, each built from the level before it by
+ * downsample_half(). Level 0 is the image itself, which is not stored here.
+ *
+ * Levels are evicted in least recently used order once they exceed their share of the
+ * drawing's cache budget, and rebuilt when needed again. All methods are thread-safe.
+ */
+class ImagePyramidCache
+{
+public:
+    ImagePyramidCache() = default;
+    ImagePyramidCache(ImagePyramidCache const &) = delete;
+    ImagePyramidCache &operator=(ImagePyramidCache const &) = delete;
+    ~ImagePyramidCache();
+
+    /// Return a new reference to @a level of the pyramid of @a image, or null if not stored.
+    cairo_surface_t *lookup(DrawingImage const *image, int level);
+
+    /// Store @a surface as @a level of the pyramid of @a image, keeping a reference to it.
+    /// Returns false if it does not fit in the budget.
+    bool insert(DrawingImage const *image, int level, cairo_surface_t *surface);
+
+    /// Drop all levels of the pyramid of @a image.
+    void remove(DrawingImage const *image);
+    void clear();
+
+    void set_budget(size_t bytes);
+    size_t size() const;
+
+private:
+    struct Key
+    {
+        DrawingImage const *image;
+        int level;
+
+        bool operator==(Key const &other) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(Key const &key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        cairo_surface_t *surface;
+        size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    void _erase(EntryList::iterator it);
+    void _evict();
+
+    mutable std::mutex _mutex;
+    EntryList _entries; ///< Most recently used first.
+    std::unordered_map<Key, EntryList::iterator, KeyHash> _index;
+    size_t _size = 0;
+    size_t _budget = 0;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_IMAGE_PYRAMID_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
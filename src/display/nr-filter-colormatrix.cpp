@@ -69,6 +69,11 @@ guint32 FilterColorMatrix::ColorMatrixMatrix::operator()(guint32 in)
     return pxout;
 }
 
+void FilterColorMatrix::ColorMatrixMatrix::filter_span(guint32 const *in, guint32 *out, int n) const
+{
+    Display::Simd::color_matrix(_v, in, out, n);
+}
+
 struct ColorMatrixSaturate
 {
     ColorMatrixSaturate(double v_in)
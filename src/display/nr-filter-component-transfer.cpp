@@ -37,6 +37,11 @@ struct UnmultiplyAlpha
         ASSEMBLE_ARGB32(out, a, r, g, b);
         return out;
     }
+
+    void filter_span(guint32 const *in, guint32 *out, int n) const
+    {
+        Display::Simd::unpremultiply(in, out, n);
+    }
 };
 
 struct MultiplyAlpha
@@ -50,6 +55,11 @@ struct MultiplyAlpha
         ASSEMBLE_ARGB32(out, a, r, g, b);
         return out;
     }
+
+    void filter_span(guint32 const *in, guint32 *out, int n) const
+    {
+        Display::Simd::premultiply(in, out, n);
+    }
 };
 
 struct ComponentTransfer
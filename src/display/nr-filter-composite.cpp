@@ -31,37 +31,36 @@ FilterComposite::FilterComposite()
 
 FilterComposite::~FilterComposite() = default;
 
-struct ComposeArithmetic
+FilterComposite::ComposeArithmetic::ComposeArithmetic(double k1, double k2, double k3, double k4)
+    : _k{static_cast<gint32>(round(k1 * 255)),
+         static_cast<gint32>(round(k2 * 255*255)),
+         static_cast<gint32>(round(k3 * 255*255)),
+         static_cast<gint32>(round(k4 * 255*255*255))} {}
+
+guint32 FilterComposite::ComposeArithmetic::operator()(guint32 in1, guint32 in2)
 {
-    ComposeArithmetic(double k1, double k2, double k3, double k4)
-        : _k1(round(k1 * 255))
-        , _k2(round(k2 * 255*255))
-        , _k3(round(k3 * 255*255))
-        , _k4(round(k4 * 255*255*255)) {}
-
-    guint32 operator()(guint32 in1, guint32 in2)
-    {
-        EXTRACT_ARGB32(in1, aa, ra, ga, ba)
-        EXTRACT_ARGB32(in2, ab, rb, gb, bb)
-
-        gint32 ao = _k1*aa*ab + _k2*aa + _k3*ab + _k4;
-        gint32 ro = _k1*ra*rb + _k2*ra + _k3*rb + _k4;
-        gint32 go = _k1*ga*gb + _k2*ga + _k3*gb + _k4;
-        gint32 bo = _k1*ba*bb + _k2*ba + _k3*bb + _k4;
-
-        ao = pxclamp(ao, 0, 255*255*255); // r, g and b are premultiplied, so should be clamped to the alpha channel
-        ro = (pxclamp(ro, 0, ao) + (255*255/2)) / (255*255);
-        go = (pxclamp(go, 0, ao) + (255*255/2)) / (255*255);
-        bo = (pxclamp(bo, 0, ao) + (255*255/2)) / (255*255);
-        ao = (ao + (255*255/2)) / (255*255);
-
-        ASSEMBLE_ARGB32(pxout, ao, ro, go, bo)
-        return pxout;
-    }
+    EXTRACT_ARGB32(in1, aa, ra, ga, ba)
+    EXTRACT_ARGB32(in2, ab, rb, gb, bb)
+
+    gint32 ao = _k[0]*aa*ab + _k[1]*aa + _k[2]*ab + _k[3];
+    gint32 ro = _k[0]*ra*rb + _k[1]*ra + _k[2]*rb + _k[3];
+    gint32 go = _k[0]*ga*gb + _k[1]*ga + _k[2]*gb + _k[3];
+    gint32 bo = _k[0]*ba*bb + _k[1]*ba + _k[2]*bb + _k[3];
+
+    ao = pxclamp(ao, 0, 255*255*255); // r, g and b are premultiplied, so should be clamped to the alpha channel
+    ro = (pxclamp(ro, 0, ao) + (255*255/2)) / (255*255);
+    go = (pxclamp(go, 0, ao) + (255*255/2)) / (255*255);
+    bo = (pxclamp(bo, 0, ao) + (255*255/2)) / (255*255);
+    ao = (ao + (255*255/2)) / (255*255);
+
+    ASSEMBLE_ARGB32(pxout, ao, ro, go, bo)
+    return pxout;
+}
 
-private:
-    gint32 _k1, _k2, _k3, _k4;
-};
+void FilterComposite::ComposeArithmetic::blend_span(guint32 const *in1, guint32 const *in2, guint32 *out, int n) const
+{
+    Display::Simd::compose_arithmetic(_k, in1, in2, out, n);
+}
 
 void FilterComposite::render_cairo(FilterSlot &slot) const
 {
@@ -39,6 +39,16 @@ public:
 
     Glib::ustring name() const override { return Glib::ustring("Composite"); }
 
+    /// The arithmetic operator, applied to premultiplied pixels.
+    struct ComposeArithmetic
+    {
+        ComposeArithmetic(double k1, double k2, double k3, double k4);
+        guint32 operator()(guint32 in1, guint32 in2);
+        void blend_span(guint32 const *in1, guint32 const *in2, guint32 *out, int n) const;
+    private:
+        gint32 _k[4];
+    };
+
 private:
     FeCompositeOperator op;
     double k1, k2, k3, k4;
@@ -22,11 +22,10 @@
 #include <cstdlib>
 #include <glib.h>
 #include <limits>
-#if HAVE_OPENMP
-#include <omp.h>
-#endif //HAVE_OPENMP
+#include <vector>
 
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/nr-filter-primitive.h"
 #include "display/nr-filter-gaussian.h"
 #include "display/nr-filter-types.h"
@@ -35,10 +34,6 @@
 #include <2geom/affine.h>
 #include "util/fixed_point.h"
 
-#ifndef INK_UNUSED
-#define INK_UNUSED(x) ((void)(x))
-#endif
-
 // IIR filtering method based on:
 // L.J. van Vliet, I.T. Young, and P.W. Verbeek, Recursive Gaussian Derivative Filters,
 // in: A.K. Jain, S. Venkatesh, B.C. Lovell (eds.),
@@ -289,8 +284,7 @@ template<typename PT, unsigned int PC, bool PREMULTIPLIED_ALPHA>
 static void
 filter2D_IIR(PT *const dest, int const dstr1, int const dstr2,
              PT const *const src, int const sstr1, int const sstr2,
-             int const n1, int const n2, IIRValue const b[N+1], double const M[N*N],
-             IIRValue *const tmpdata[], int const num_threads)
+             int const n1, int const n2, IIRValue const b[N+1], double const M[N*N])
 {
     assert(src && dest);
 
@@ -302,16 +296,12 @@ filter2D_IIR(PT *const dest, int const dstr1, int const dstr2,
     #define PREMUL_ALPHA_LOOP for(unsigned int c=1; c<PC; ++c)
 #endif
 
-INK_UNUSED(num_threads); // to suppress unused argument compiler warning
-#if HAVE_OPENMP
-#pragma omp parallel for num_threads(num_threads)
-#endif // HAVE_OPENMP
-    for ( int c2 = 0 ; c2 < n2 ; c2++ ) {
-#if HAVE_OPENMP
-        unsigned int tid = omp_get_thread_num();
-#else
-        unsigned int tid = 0;
-#endif // HAVE_OPENMP
+    get_dispatch_pool().dispatch(n2, [&] (int c2) {
+        // Temporary storage for the forward pass, kept per thread to avoid reallocating it
+        // for every line. NOTE: This can be eliminated, but it reduces the precision a bit
+        thread_local std::vector<IIRValue> tmpdata;
+        tmpdata.resize(std::max<size_t>(tmpdata.size(), n1 * PC));
+
         // corresponding line in the source and output buffer
         PT const * srcimg = src  + c2*sstr2;
         PT       * dstimg = dest + c2*dstr2 + n1*dstr1;
@@ -329,7 +319,7 @@ INK_UNUSED(num_threads); // to suppress unused argument compiler warning
             for(unsigned int i=1; i<N+1; i++) {
                 for(unsigned int c=0; c<PC; c++) u[0][c] += u[i][c]*b[i];
             }
-            copy_n(u[0], PC, tmpdata[tid]+c1*PC);
+            copy_n(u[0], PC, tmpdata.data()+c1*PC);
         }
         // Backward pass
         IIRValue v[N+1][PC];
@@ -344,7 +334,7 @@ INK_UNUSED(num_threads); // to suppress unused argument compiler warning
         int c1=n1-1;
         while(c1-->0) {
             for(unsigned int i=N; i>0; i--) copy_n(v[i-1], PC, v[i]);
-            copy_n(tmpdata[tid]+c1*PC, PC, v[0]);
+            copy_n(tmpdata.data()+c1*PC, PC, v[0]);
             for(unsigned int c=0; c<PC; c++) v[0][c] *= b[0];
             for(unsigned int i=1; i<N+1; i++) {
                 for(unsigned int c=0; c<PC; c++) v[0][c] += v[i][c]*b[i];
@@ -357,7 +347,7 @@ INK_UNUSED(num_threads); // to suppress unused argument compiler warning
                 for(unsigned int c=0; c<PC; c++) dstimg[c] = clip_round_cast<PT>(v[0][c]);
             }
         }
-    }
+    });
 }
 
 // Filters over 1st dimension
@@ -367,18 +357,13 @@ template<typename PT, unsigned int PC>
 static void
 filter2D_FIR(PT *const dst, int const dstr1, int const dstr2,
              PT const *const src, int const sstr1, int const sstr2,
-             int const n1, int const n2, FIRValue const *const kernel, int const scr_len, int const num_threads)
+             int const n1, int const n2, FIRValue const *const kernel, int const scr_len)
 {
     assert(src && dst);
 
-    // Past pixels seen (to enable in-place operation)
-    PT history[scr_len+1][PC];
-
-INK_UNUSED(num_threads); // suppresses unused argument compiler warning
-#if HAVE_OPENMP
-#pragma omp parallel for num_threads(num_threads) private(history)
-#endif // HAVE_OPENMP
-    for ( int c2 = 0 ; c2 < n2 ; c2++ ) {
+    get_dispatch_pool().dispatch(n2, [&] (int c2) {
+        // Past pixels seen (to enable in-place operation)
+        PT history[scr_len+1][PC];
 
         // corresponding line in the source buffer
         int const src_line = c2 * sstr2;
@@ -465,12 +450,11 @@ INK_UNUSED(num_threads); // suppresses unused argument compiler warning
                 }
             }
         }
-    }
+    });
 }
 
 static void
-gaussian_pass_IIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_surface_t *dest,
-    IIRValue **tmpdata, int num_threads)
+gaussian_pass_IIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_surface_t *dest)
 {
     // Filter variables
     IIRValue b[N+1];  // scaling coefficient + filter coefficients (can be 10.21 fixed point)
@@ -500,13 +484,13 @@ gaussian_pass_IIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_su
         filter2D_IIR<unsigned char,1,false>(
             cairo_image_surface_get_data(dest), d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
             cairo_image_surface_get_data(src),  d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
-            w, h, b, M, tmpdata, num_threads);
+            w, h, b, M);
         break;
     case CAIRO_FORMAT_ARGB32: ///< Premultiplied 8 bit RGBA
         filter2D_IIR<unsigned char,4,true>(
             cairo_image_surface_get_data(dest), d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
             cairo_image_surface_get_data(src),  d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
-            w, h, b, M, tmpdata, num_threads);
+            w, h, b, M);
         break;
     default:
         g_warning("gaussian_pass_IIR: unsupported image format");
@@ -514,8 +498,7 @@ gaussian_pass_IIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_su
 }
 
 static void
-gaussian_pass_FIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_surface_t *dest,
-    int num_threads)
+gaussian_pass_FIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_surface_t *dest)
 {
     int scr_len = _effect_area_scr(deviation);
     // Filter kernel for x direction
@@ -533,13 +516,13 @@ gaussian_pass_FIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_su
         filter2D_FIR<unsigned char,1>(
             cairo_image_surface_get_data(dest), d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
             cairo_image_surface_get_data(src),  d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
-            w, h, &kernel[0], scr_len, num_threads);
+            w, h, &kernel[0], scr_len);
         break;
     case CAIRO_FORMAT_ARGB32: ///< Premultiplied 8 bit RGBA
         filter2D_FIR<unsigned char,4>(
             cairo_image_surface_get_data(dest), d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
             cairo_image_surface_get_data(src),  d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
-            w, h, &kernel[0], scr_len, num_threads);
+            w, h, &kernel[0], scr_len);
         break;
     default:
         g_warning("gaussian_pass_FIR: unsupported image format");
@@ -587,18 +570,7 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
     deviation_x_orig *= device_scale;
     deviation_y_orig *= device_scale;
 
-    cairo_format_t fmt = cairo_image_surface_get_format(in);
-    int bytes_per_pixel = 0;
-    switch (fmt) {
-        case CAIRO_FORMAT_A8:
-            bytes_per_pixel = 1; break;
-        case CAIRO_FORMAT_ARGB32:
-        default:
-            bytes_per_pixel = 4; break;
-    }
-
     int quality = slot.get_blurquality();
-    int threads = get_num_filter_threads();
     int x_step = 1 << _effect_subsample_step_log2(deviation_x_orig, quality);
     int y_step = 1 << _effect_subsample_step_log2(deviation_y_orig, quality);
     bool resampling = x_step > 1 || y_step > 1;
@@ -619,16 +591,6 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
     bool use_IIR_x = deviation_x > 3;
     bool use_IIR_y = deviation_y > 3;
 
-    // Temporary storage for IIR filter
-    // NOTE: This can be eliminated, but it reduces the precision a bit
-    IIRValue * tmpdata[threads];
-    std::fill_n(tmpdata, threads, (IIRValue*)0);
-    if ( use_IIR_x || use_IIR_y ) {
-        for(int i = 0; i < threads; ++i) {
-            tmpdata[i] = new IIRValue[std::max(w_downsampled,h_downsampled)*bytes_per_pixel];
-        }
-    }
-
     cairo_surface_t *downsampled = nullptr;
     if (resampling) {
         // Divide by device scale as w_downsampled is in pixels while
@@ -647,24 +609,17 @@ void FilterGaussian::render_cairo(FilterSlot &slot) const
 
     if (scr_len_x > 0) {
         if (use_IIR_x) {
-            gaussian_pass_IIR(Geom::X, deviation_x, downsampled, downsampled, tmpdata, threads);
+            gaussian_pass_IIR(Geom::X, deviation_x, downsampled, downsampled);
         } else {
-            gaussian_pass_FIR(Geom::X, deviation_x, downsampled, downsampled, threads);
+            gaussian_pass_FIR(Geom::X, deviation_x, downsampled, downsampled);
         }
     }
 
     if (scr_len_y > 0) {
         if (use_IIR_y) {
-            gaussian_pass_IIR(Geom::Y, deviation_y, downsampled, downsampled, tmpdata, threads);
+            gaussian_pass_IIR(Geom::Y, deviation_y, downsampled, downsampled);
         } else {
-            gaussian_pass_FIR(Geom::Y, deviation_y, downsampled, downsampled, threads);
-        }
-    }
-
-    // free the temporary data
-    if ( use_IIR_x || use_IIR_y ) {
-        for(int i = 0; i < threads; ++i) {
-            delete[] tmpdata[i];
+            gaussian_pass_FIR(Geom::Y, deviation_y, downsampled, downsampled);
         }
     }
 
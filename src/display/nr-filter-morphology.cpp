@@ -20,6 +20,7 @@
 #include <functional>
 #include "display/cairo-templates.h"
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/nr-filter-morphology.h"
 #include "display/nr-filter-slot.h"
 #include "display/nr-filter-units.h"
@@ -65,11 +66,8 @@ void morphologicalFilter1D(cairo_surface_t * const input, cairo_surface_t * cons
     int ri = round(radius); // TODO: Support fractional radii?
     int wi = 2*ri+1;
 
-    #if HAVE_OPENMP
-    int limit = w * h;
-    #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(get_num_filter_threads())
-    #endif // HAVE_OPENMP
-    for (int i = 0; i < h; ++i) {
+    auto &pool = get_dispatch_pool();
+    pool.dispatch_threshold(h, w * h > DISPATCH_PIXEL_THRESHOLD, [&] (int i) {
         // TODO: Store position and value in one 32 bit integer? 24 bits should be enough for a position, it would be quite strange to have an image with a width/height of more than 16 million(!).
         std::deque<std::pair<int, unsigned char>> vals[BPP]; // In my tests it was actually slightly faster to allocate it here than allocate it once for all threads and retrieving the correct set based on the thread id.
 
@@ -148,7 +146,7 @@ void morphologicalFilter1D(cairo_surface_t * const input, cairo_surface_t * cons
             }
             if (axis == Geom::Y) out_p += strideout - BPP;
         }
-    }
+    });
 
     cairo_surface_mark_dirty(out);
 }
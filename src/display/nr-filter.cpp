@@ -11,6 +11,7 @@
  */
 
 #include <glib.h>
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <string>
@@ -40,6 +41,7 @@
 #include "display/nr-filter-turbulence.h"
 
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/drawing.h"
 #include "display/drawing-item.h"
 #include "display/drawing-context.h"
@@ -55,6 +57,9 @@ namespace Filters {
 using Geom::X;
 using Geom::Y;
 
+/// Edge length of the tiles that large filter areas are split into for rendering in parallel.
+static constexpr int FILTER_TILE_SIZE = 256;
+
 Filter::Filter()
 {
     _common_init();
@@ -109,8 +114,8 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
         graphic.setOperator(CAIRO_OPERATOR_OVER);
         return 1;
     }
-    FilterQuality filterquality = (FilterQuality)item->drawing().filterQuality();
-    int blurquality = item->drawing().blurQuality();
+    FilterQuality filterquality = rc.preview ? FILTER_QUALITY_WORST : (FilterQuality)item->drawing().filterQuality();
+    int blurquality = rc.preview ? BLUR_QUALITY_WORST : item->drawing().blurQuality();
 
     Geom::Affine trans = item->ctm();
 
@@ -149,25 +154,154 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
         }
     }
 
+    if (!bgdc) {
+        auto const tiles = _render_tiles(graphic, pbtrans, item);
+        if (tiles.size() > 1) {
+            _render_tiled(tiles, item, graphic, units, rc, blurquality);
+            return 0;
+        }
+    }
+
     auto slot = FilterSlot(bgdc, graphic, units, rc, blurquality);
 
+    Geom::Point origin = graphic.targetLogicalBounds().min();
+    cairo_surface_t *result = _render_slot(slot);
+
+    graphic.setSource(result, origin[Geom::X], origin[Geom::Y]);
+    graphic.setOperator(CAIRO_OPERATOR_SOURCE);
+    graphic.paint();
+    graphic.setOperator(CAIRO_OPERATOR_OVER);
+    cairo_surface_destroy(result);
+
+    return 0;
+}
+
+/// Run all primitives on @a slot and return the filter's output.
+cairo_surface_t *Filter::_render_slot(FilterSlot &slot) const
+{
     for (auto &i : primitives) {
+        if (slot.get_rendercontext().cancelled()) {
+            break;
+        }
         i->render_cairo(slot);
     }
 
-    Geom::Point origin = graphic.targetLogicalBounds().min();
     cairo_surface_t *result = slot.get_result(_output_slot);
 
     // Assume for the moment that we paint the filter in sRGB
     set_cairo_surface_ci(result, SP_CSS_COLOR_INTERPOLATION_SRGB);
 
-    graphic.setSource(result, origin[Geom::X], origin[Geom::Y]);
-    graphic.setOperator(CAIRO_OPERATOR_SOURCE);
-    graphic.paint();
-    graphic.setOperator(CAIRO_OPERATOR_OVER);
-    cairo_surface_destroy(result);
+    return result;
+}
 
-    return 0;
+/**
+ * Split the area of @a graphic into tiles that can be filtered independently, or return
+ * no tiles if the filter should be rendered in one piece.
+ *
+ * Each tile is rendered from its area grown by area_enlarge(), just as the canvas renders
+ * filtered items in tiles, so this is only done where a tile's margin stays small.
+ */
+std::vector<Geom::IntRect> Filter::_render_tiles(DrawingContext &graphic, Geom::Affine const &pbtrans,
+                                                 Inkscape::DrawingItem const *item) const
+{
+    std::vector<Geom::IntRect> tiles;
+
+    // Only split surfaces whose pixels map to whole logical units, filtered without resampling.
+    Geom::Rect const bounds = graphic.targetLogicalBounds();
+    Geom::IntRect const area = bounds.roundOutwards();
+    if (!pbtrans.isTranslation() || !graphic.surface()->scale().isIdentity() || Geom::Rect(area) != bounds) {
+        return tiles;
+    }
+
+    if (area.area() < 2 * FILTER_TILE_SIZE * FILTER_TILE_SIZE) {
+        return tiles;
+    }
+    if (get_dispatch_pool().num_threads() < 2) {
+        return tiles;
+    }
+
+    // Give up if the margins would be a large part of the work, or unbounded as for feTile.
+    auto const probe = Geom::IntRect::from_xywh(0, 0, FILTER_TILE_SIZE, FILTER_TILE_SIZE);
+    auto enlarged = probe;
+    area_enlarge(enlarged, item);
+    int const margin = std::max({probe.left() - enlarged.left(), probe.top() - enlarged.top(),
+                                 enlarged.right() - probe.right(), enlarged.bottom() - probe.bottom()});
+    if (margin > FILTER_TILE_SIZE / 4) {
+        return tiles;
+    }
+
+    for (int y = area.top(); y < area.bottom(); y += FILTER_TILE_SIZE) {
+        for (int x = area.left(); x < area.right(); x += FILTER_TILE_SIZE) {
+            tiles.emplace_back(x, y, std::min(x + FILTER_TILE_SIZE, area.right()),
+                               std::min(y + FILTER_TILE_SIZE, area.bottom()));
+        }
+    }
+
+    return tiles;
+}
+
+/// Render the filter separately for each of @a tiles on the shared thread pool.
+void Filter::_render_tiled(std::vector<Geom::IntRect> const &tiles, Inkscape::DrawingItem const *item,
+                           DrawingContext &graphic, FilterUnits const &units, RenderContext &rc,
+                           int blurquality) const
+{
+    struct Piece
+    {
+        std::unique_ptr<DrawingSurface> surface;
+        std::unique_ptr<DrawingContext> dc;
+        cairo_surface_t *result = nullptr;
+    };
+
+    int const device_scale = graphic.surface()->device_scale();
+    Geom::Point const origin = graphic.targetLogicalBounds().min();
+    Geom::IntRect const area = graphic.targetLogicalBounds().roundOutwards();
+
+    // Copy each tile's source graphic with its margin before anything is written back,
+    // since the tiles overlap. Primitives may also modify their input in place.
+    std::vector<Piece> pieces(tiles.size());
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        auto enlarged = tiles[i];
+        area_enlarge(enlarged, item);
+        enlarged.intersectWith(area);
+
+        auto &piece = pieces[i];
+        piece.surface = std::make_unique<DrawingSurface>(enlarged, device_scale);
+        piece.dc = std::make_unique<DrawingContext>(*piece.surface);
+        piece.dc->setSource(graphic.rawTarget(), origin[X], origin[Y]);
+        piece.dc->setOperator(CAIRO_OPERATOR_SOURCE);
+        piece.dc->paint();
+        piece.dc->setOperator(CAIRO_OPERATOR_OVER);
+    }
+
+    auto destroy_results = [&] {
+        for (auto &piece : pieces) {
+            if (piece.result) {
+                cairo_surface_destroy(piece.result);
+            }
+        }
+    };
+
+    try {
+        get_dispatch_pool().dispatch(pieces.size(), [&] (int i) {
+            auto slot = FilterSlot(nullptr, *pieces[i].dc, units, rc, blurquality);
+            pieces[i].result = _render_slot(slot);
+        });
+    } catch (...) {
+        destroy_results();
+        throw;
+    }
+
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        Inkscape::DrawingContext::Save save(graphic);
+        graphic.rectangle(tiles[i]);
+        graphic.clip();
+        Geom::Point const piece_origin = pieces[i].surface->origin();
+        graphic.setSource(pieces[i].result, piece_origin[X], piece_origin[Y]);
+        graphic.setOperator(CAIRO_OPERATOR_SOURCE);
+        graphic.paint();
+    }
+
+    destroy_results();
 }
 
 void Filter::add_primitive(std::unique_ptr<FilterPrimitive> primitive)
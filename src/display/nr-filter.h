@@ -14,6 +14,7 @@
  */
 
 #include <memory>
+#include <vector>
 #include <cairo.h>
 #include "display/nr-filter-primitive.h"
 #include "display/nr-filter-types.h"
@@ -186,6 +187,12 @@ private:
     SPFilterUnits _primitive_units;
 
     void _common_init();
+    cairo_surface_t *_render_slot(FilterSlot &slot) const;
+    std::vector<Geom::IntRect> _render_tiles(DrawingContext &graphic, Geom::Affine const &pbtrans,
+                                             Inkscape::DrawingItem const *item) const;
+    void _render_tiled(std::vector<Geom::IntRect> const &tiles, Inkscape::DrawingItem const *item,
+                       DrawingContext &graphic, FilterUnits const &units, RenderContext &rc,
+                       int blurquality) const;
     static int _resolution_limit(FilterQuality quality);
     std::pair<double, double> _filter_resolution(Geom::Rect const &area,
                                                  Geom::Affine const &trans,
@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Rendered tiles of documents, kept on disk across sessions.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "display/tile-disk-cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+#include <vector>
+#include <glibmm/checksum.h>
+
+#include "inkscape-version.h"
+#include "preferences.h"
+#include "async/async.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "io/resource.h"
+
+namespace fs = std::filesystem;
+
+namespace Inkscape {
+namespace {
+
+/// The start of a tile file, followed by the rows of the image without padding.
+struct Header
+{
+    char magic[4];
+    std::int32_t width;
+    std::int32_t height;
+};
+
+constexpr char MAGIC[4] = {'I', 'T', 'C', '1'};
+constexpr int MAX_SIDE = 4096;
+
+/// Write @a surface to @a path, through a temporary file so that no tile is ever read half
+/// written. Return the size of the file, or zero on failure.
+std::size_t write_tile(std::string const &path, cairo_surface_t *surface)
+{
+    cairo_surface_flush(surface);
+    auto const header = Header{{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]},
+                               cairo_image_surface_get_width(surface),
+                               cairo_image_surface_get_height(surface)};
+    auto const data = reinterpret_cast<char const *>(cairo_image_surface_get_data(surface));
+    auto const stride = cairo_image_surface_get_stride(surface);
+
+    auto const temp = path + ".tmp";
+    {
+        auto file = std::ofstream(temp, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        for (int y = 0; y < header.height; y++) {
+            file.write(data + y * stride, header.width * 4);
+        }
+        if (!file) {
+            file.close();
+            std::error_code ec;
+            fs::remove(temp, ec);
+            return 0;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return 0;
+    }
+    return sizeof(header) + std::size_t{4} * header.width * header.height;
+}
+
+} // namespace
+
+std::shared_ptr<TileDiskCache> TileDiskCache::get()
+{
+    static std::shared_ptr<TileDiskCache> cache;
+
+    // Preference is stored in MiB; convert to bytes, taking care not to overflow.
+    auto const budget = (std::size_t{1} << 20) * Preferences::get()->getIntLimited("/options/renderingcache/disk", 0, 0, 65536);
+    if (budget == 0) {
+        return {};
+    }
+
+    if (!cache) {
+        cache = std::make_shared<TileDiskCache>(IO::Resource::get_path_string(IO::Resource::CACHE, IO::Resource::NONE, "tiles"), budget);
+    } else {
+        cache->set_budget(budget);
+    }
+    return cache;
+}
+
+TileDiskCache::TileDiskCache(std::string dir, std::size_t budget)
+    : _dir(std::move(dir))
+    , _budget(budget)
+{
+}
+
+TileDiskCache::~TileDiskCache()
+{
+    for (auto &[name, surface] : _pending) {
+        cairo_surface_destroy(surface);
+    }
+}
+
+std::string TileDiskCache::hash_file(std::string const &filename)
+{
+    auto file = std::ifstream(filename, std::ios::binary);
+    if (!file) {
+        return {};
+    }
+
+    auto checksum = Glib::Checksum(Glib::Checksum::Type::SHA256);
+    auto buffer = std::vector<char>(1 << 20);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        checksum.update(reinterpret_cast<guchar const *>(buffer.data()), file.gcount());
+    }
+    return file.eof() ? checksum.get_string() : std::string();
+}
+
+cairo_surface_t *TileDiskCache::lookup(std::string const &key)
+{
+    auto const name = _name(key);
+    auto const path = _path(name);
+
+    auto file = std::ifstream(path, std::ios::binary);
+    auto header = Header{};
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.width <= 0 || header.height <= 0 || header.width > MAX_SIDE || header.height > MAX_SIDE)
+    {
+        return nullptr;
+    }
+
+    auto const surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, header.width, header.height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    auto const data = reinterpret_cast<char *>(cairo_image_surface_get_data(surface));
+    auto const stride = cairo_image_surface_get_stride(surface);
+    for (int y = 0; y < header.height; y++) {
+        if (!file.read(data + y * stride, header.width * 4)) {
+            cairo_surface_destroy(surface);
+            return nullptr;
+        }
+    }
+    cairo_surface_mark_dirty(surface);
+
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    _touch(name, sizeof(header) + std::size_t{4} * header.width * header.height);
+
+    return surface;
+}
+
+void TileDiskCache::insert(std::string const &key, cairo_surface_t *surface)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    if (_budget == 0 || _pending.size() >= MAX_PENDING) {
+        return;
+    }
+    _pending.emplace_back(_name(key), cairo_surface_reference(surface));
+
+    if (!_writing) {
+        _writing = true;
+        Async::fire_and_forget([self = shared_from_this()] { self->_write_pending(); });
+    }
+}
+
+cairo_surface_t *TileDiskCache::render(std::string const &key, Drawing const &drawing, Geom::IntRect const &tile, int device_scale,
+                                       std::atomic<bool> const *cancel, bool preview)
+{
+    auto const width = tile.width() * device_scale;
+
+    auto surface = lookup(key);
+    if (surface && cairo_image_surface_get_width(surface) != width) {
+        cairo_surface_destroy(surface);
+        surface = nullptr;
+    }
+
+    if (surface) {
+        cairo_surface_set_device_scale(surface, device_scale, device_scale);
+        return surface;
+    }
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, tile.height() * device_scale);
+    cairo_surface_set_device_scale(surface, device_scale, device_scale);
+    {
+        auto dc = DrawingContext(surface, tile.min());
+        drawing.render(dc, tile, 0, cancel, preview);
+    }
+    // An incomplete or low quality rendering must not outlive the redraw it was made for.
+    if (!preview && !(cancel && cancel->load(std::memory_order_relaxed))) {
+        insert(key, surface);
+    }
+    return surface;
+}
+
+void TileDiskCache::flush()
+{
+    auto lock = std::unique_lock(_mutex);
+    _written.wait(lock, [this] { return !_writing; });
+}
+
+void TileDiskCache::set_budget(std::size_t bytes)
+{
+    auto lock = std::unique_lock(_mutex);
+    _budget = bytes;
+    if (_scanned) {
+        _evict();
+    }
+}
+
+std::size_t TileDiskCache::size() const
+{
+    auto lock = std::unique_lock(_mutex);
+    return _size;
+}
+
+std::string TileDiskCache::_path(std::string const &name) const
+{
+    return (fs::path(_dir) / name).string();
+}
+
+std::string TileDiskCache::_name(std::string const &key) const
+{
+    return Glib::Checksum::compute_checksum(Glib::Checksum::Type::SHA1, std::string(version_string) + '\n' + key) + ".tile";
+}
+
+/// Index the tiles left by earlier sessions, in the order they were last used.
+void TileDiskCache::_scan()
+{
+    std::vector<std::tuple<fs::file_time_type, std::string, std::size_t>> found;
+
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(_dir, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        auto const &path = it->path();
+        if (path.extension() != ".tile") {
+            continue;
+        }
+        std::error_code entry_ec;
+        auto const time = it->last_write_time(entry_ec);
+        auto const bytes = it->file_size(entry_ec);
+        if (!entry_ec) {
+            found.emplace_back(time, path.filename().string(), bytes);
+        }
+    }
+    std::sort(found.begin(), found.end(), [] (auto const &a, auto const &b) { return std::get<0>(a) > std::get<0>(b); });
+
+    auto lock = std::unique_lock(_mutex);
+    for (auto &[time, name, bytes] : found) {
+        if (!_index.contains(name)) {
+            _entries.push_back({name, bytes});
+            _index.emplace(std::move(name), std::prev(_entries.end()));
+            _size += bytes;
+        }
+    }
+    _scanned = true;
+    _evict();
+}
+
+void TileDiskCache::_touch(std::string const &name, std::size_t bytes)
+{
+    auto lock = std::unique_lock(_mutex);
+
+    if (!_scanned) {
+        // The modification time alone will place it when the directory is scanned.
+        return;
+    }
+
+    if (auto it = _index.find(name); it != _index.end()) {
+        _entries.splice(_entries.begin(), _entries, it->second);
+    } else {
+        // Written by another instance since the scan.
+        _entries.push_front({name, bytes});
+        _index.emplace(name, _entries.begin());
+        _size += bytes;
+        _evict();
+    }
+}
+
+/// Write the pending tiles on a background thread, until there are none left.
+void TileDiskCache::_write_pending()
+{
+    std::error_code ec;
+    fs::create_directories(_dir, ec);
+
+    if (!_scanned) {
+        _scan();
+    }
+
+    auto lock = std::unique_lock(_mutex);
+    while (!_pending.empty()) {
+        auto [name, surface] = std::move(_pending.front());
+        _pending.pop_front();
+
+        lock.unlock();
+        auto const bytes = write_tile(_path(name), surface);
+        cairo_surface_destroy(surface);
+        lock.lock();
+
+        if (bytes == 0) {
+            continue;
+        }
+        if (auto it = _index.find(name); it != _index.end()) {
+            _size -= it->second->bytes;
+            _entries.erase(it->second);
+            _index.erase(it);
+        }
+        _entries.push_front({name, bytes});
+        _index.emplace(std::move(name), _entries.begin());
+        _size += bytes;
+        _evict();
+    }
+
+    _writing = false;
+    _written.notify_all();
+}
+
+void TileDiskCache::_evict()
+{
+    while (_size > _budget && !_entries.empty()) {
+        auto const &entry = _entries.back();
+        std::error_code ec;
+        fs::remove(_path(entry.name), ec);
+        _size -= entry.bytes;
+        _index.erase(entry.name);
+        _entries.pop_back();
+    }
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
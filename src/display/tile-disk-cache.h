@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Rendered tiles of documents, kept on disk across sessions.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_DISPLAY_TILE_DISK_CACHE_H
+#define INKSCAPE_DISPLAY_TILE_DISK_CACHE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <cairo.h>
+#include <2geom/int-rect.h>
+
+namespace Inkscape {
+
+class Drawing;
+
+/**
+ * Renderings of fixed squares of unchanged documents, so that opening a large document again,
+ * or showing it again in a slideshow, does not render it from scratch.
+ *
+ * Tiles are addressed by a key which must name everything the rendering depends on; see
+ * CanvasItemDrawing, which builds it from the hash of the document file, the transformation
+ * and the rendering settings. The program version is added to it here. Each tile is a file in
+ * the user's cache directory, holding the raw pixels of an ARGB32 image surface.
+ *
+ * Tiles are written on a background thread, and evicted in least recently used order once they
+ * exceed the budget. The order is kept in the modification times of the files, which lookups
+ * bring up to date, so that it carries over to later sessions. All methods are thread-safe.
+ */
+class TileDiskCache : public std::enable_shared_from_this<TileDiskCache>
+{
+public:
+    /// The length of the side of a tile in logical pixels.
+    static constexpr int TILE_SIZE = 128;
+
+    /// The cache in the user's cache directory, or null if it is turned off in the preferences.
+    static std::shared_ptr<TileDiskCache> get();
+
+    /// A cache in @a dir, which is created when the first tile is written.
+    TileDiskCache(std::string dir, std::size_t budget);
+    TileDiskCache(TileDiskCache const &) = delete;
+    TileDiskCache &operator=(TileDiskCache const &) = delete;
+    ~TileDiskCache();
+
+    /// The hash of the contents of a file, or an empty string if it cannot be read.
+    /// Reads the whole file, so better called on a background thread.
+    static std::string hash_file(std::string const &filename);
+
+    /// Return a new image surface with the tile stored for @a key, or null.
+    cairo_surface_t *lookup(std::string const &key);
+
+    /// Store the image surface @a surface as the tile for @a key. A reference to the surface
+    /// is kept until it is written, so it must not be changed afterwards.
+    void insert(std::string const &key, cairo_surface_t *surface);
+
+    /// Return a new image surface with @a tile of @a drawing, read back as the tile for @a key if
+    /// it is stored, or else rendered and stored, unless the rendering is a preview or cancelled.
+    cairo_surface_t *render(std::string const &key, Drawing const &drawing, Geom::IntRect const &tile, int device_scale,
+                            std::atomic<bool> const *cancel = nullptr, bool preview = false);
+
+    /// Wait until the tiles inserted so far are written.
+    void flush();
+
+    void set_budget(std::size_t bytes);
+    std::size_t size() const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    /// The most tiles waiting to be written; more are dropped rather than queued.
+    static constexpr std::size_t MAX_PENDING = 256;
+
+    std::string _path(std::string const &name) const;
+    std::string _name(std::string const &key) const;
+    void _scan();
+    void _touch(std::string const &name, std::size_t bytes);
+    void _write_pending();
+    void _evict();
+
+    std::string const _dir;
+
+    mutable std::mutex _mutex;
+    EntryList _entries; ///< Most recently used first.
+    std::unordered_map<std::string, EntryList::iterator> _index;
+    std::size_t _size = 0;
+    std::size_t _budget;
+    bool _scanned = false;
+
+    std::deque<std::pair<std::string, cairo_surface_t *>> _pending;
+    bool _writing = false;
+    std::condition_variable _written;
+};
+
+} // namespace Inkscape
+
+#endif // INKSCAPE_DISPLAY_TILE_DISK_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -53,6 +53,7 @@
 #include "document.h"                       // for SPDocument
 #include "event.h"                          // for Event
 #include "inkscape.h"                       // for Application, INKSCAPE
+#include "preferences.h"                    // for Preferences
 #include "composite-undo-stack-observer.h"  // for CompositeUndoStackObserver
 
 #include "debug/event-tracker.h"            // for EventTracker
@@ -170,6 +171,9 @@ void Inkscape::DocumentUndo::maybeDone(SPDocument *doc,
 	Inkscape::XML::Event *log = sp_repr_coalesce_log (doc->partial, sp_repr_commit_undoable (doc->rdoc));
 	doc->partial = nullptr;
 
+	// Dragging or tweaking changes the same attributes over and over within one transaction.
+	log = sp_repr_compact_log(log);
+
 	if (!log) {
 		sp_repr_begin_transaction (doc->rdoc);
 		return;
@@ -177,14 +181,18 @@ void Inkscape::DocumentUndo::maybeDone(SPDocument *doc,
 
 	if (key && !doc->actionkey.empty() && (doc->actionkey == key) && !doc->undo.empty()) {
                 (doc->undo.back())->event =
-                    sp_repr_coalesce_log ((doc->undo.back())->event, log);
+                    sp_repr_compact_log(sp_repr_coalesce_log ((doc->undo.back())->event, log));
+                account_undo_size(*doc, *doc->undo.back());
 	} else {
         Inkscape::Event *event = new Inkscape::Event(log, event_description, icon_name);
         doc->undo.push_back(event);
 		doc->history_size++;
+        account_undo_size(*doc, *event);
 		doc->undoStackObservers.notifyUndoCommitEvent(event);
 	}
 
+    trim_history(*doc);
+
     if ( key ) {
         doc->actionkey = key;
     } else {
@@ -220,6 +228,7 @@ void Inkscape::DocumentUndo::finish_incomplete_transaction(SPDocument &doc) {
         if (!doc.undo.empty()) {
             Inkscape::Event* undo_stack_top = doc.undo.back();
             undo_stack_top->event = sp_repr_coalesce_log(undo_stack_top->event, doc.partial);
+            account_undo_size(doc, *undo_stack_top);
         } else {
             sp_repr_free_log(doc.partial);
         }
@@ -243,12 +252,41 @@ void Inkscape::DocumentUndo::perform_document_update(SPDocument &doc) {
         if (!doc.undo.empty()) {
             Inkscape::Event* undo_stack_top = doc.undo.back();
             undo_stack_top->event = sp_repr_coalesce_log(undo_stack_top->event, update_log);
+            account_undo_size(doc, *undo_stack_top);
         } else {
             sp_repr_free_log(update_log);
         }
     }
 }
 
+// Member function for friend access to SPDocument privates.
+void Inkscape::DocumentUndo::account_undo_size(SPDocument &doc, Inkscape::Event &event)
+{
+    doc.undo_size -= event.size;
+    event.size = sp_repr_log_size(event.event);
+    doc.undo_size += event.size;
+}
+
+// Drop the oldest steps while the undo stack holds more memory than allowed.
+void Inkscape::DocumentUndo::trim_history(SPDocument &doc)
+{
+    auto const budget = (std::size_t{1} << 20) *
+                        Inkscape::Preferences::get()->getIntLimited("/options/undo/budget", 256, 0, 65536);
+    if (!budget) {
+        return;
+    }
+
+    // The latest step is kept however large, so that it can always be undone.
+    while (doc.undo_size > budget && doc.undo.size() > 1) {
+        Inkscape::Event *e = doc.undo.front();
+        doc.undoStackObservers.notifyUndoExpiredEvent(e);
+        doc.undo.pop_front();
+        doc.undo_size -= e->size;
+        delete e;
+        doc.history_size--;
+    }
+}
+
 gboolean Inkscape::DocumentUndo::undo(SPDocument *doc)
 {
     using Inkscape::Debug::EventTracker;
@@ -269,6 +307,7 @@ gboolean Inkscape::DocumentUndo::undo(SPDocument *doc)
     if (! doc->undo.empty()) {
         Inkscape::Event *log = doc->undo.back();
         doc->undo.pop_back();
+        doc->undo_size -= log->size;
         sp_repr_undo_log (log->event);
         perform_document_update(*doc);
         doc->redo.push_back(log);
@@ -308,6 +347,7 @@ gboolean Inkscape::DocumentUndo::redo(SPDocument *doc)
 		doc->redo.pop_back();
 		sp_repr_replay_log (log->event);
         doc->undo.push_back(log);
+        doc->undo_size += log->size;
         perform_document_update(*doc);
 
         doc->setModifiedSinceSave();
@@ -335,6 +375,7 @@ void Inkscape::DocumentUndo::clearUndo(SPDocument *doc)
     while (! doc->undo.empty()) {
         Inkscape::Event *e = doc->undo.back();
         doc->undo.pop_back();
+        doc->undo_size -= e->size;
         delete e;
         doc->history_size--;
     }
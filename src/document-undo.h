@@ -20,6 +20,8 @@ class SPDocument;
 
 namespace Inkscape {
 
+class Event;
+
 class DocumentUndo
 {
 public:
@@ -47,6 +49,10 @@ private:
 
     static void perform_document_update(SPDocument &document);
 
+    static void account_undo_size(SPDocument &document, Inkscape::Event &event);
+
+    static void trim_history(SPDocument &document);
+
 public:
     static void resetKey(SPDocument *document);
 
@@ -35,8 +35,11 @@
 
 #include "document.h"
 
+#include <algorithm>
+#include <optional>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstring>
 
 #include <boost/range/adaptor/reversed.hpp>
@@ -70,7 +73,9 @@
 #include "display/drawing.h"
 #include "io/dir-util.h"
 #include "live_effects/lpeobject.h"
+#include "object/item-index.h"
 #include "object/persp3d.h"
+#include "object/preparsed-attributes.h"
 #include "object/sp-defs.h"
 #include "object/sp-factory.h"
 #include "object/sp-item-group.h"
@@ -79,10 +84,10 @@
 #include "object/sp-page.h"
 #include "object/sp-root.h"
 #include "object/sp-symbol.h"
+#include "object/style-rule-index.h"
 #include "ui/widget/canvas.h"
 #include "ui/widget/desktop-widget.h"
 #include "util/units.h"
-#include "xml/croco-node-iface.h"
 #include "xml/rebase-hrefs.h"
 #include "xml/simple-document.h"
 
@@ -116,6 +121,7 @@ SPDocument::SPDocument() :
     actionkey(),
     object_id_counter(1),
     _router(std::make_unique<Avoid::Router>(Avoid::PolyLineRouting|Avoid::OrthogonalRouting)),
+    _item_index(std::make_unique<Inkscape::ItemIndex>()),
     current_persp3d(nullptr),
     current_persp3d_impl(nullptr),
     _activexmltree(nullptr)
@@ -190,6 +196,7 @@ SPDocument::~SPDocument() {
     resources.clear();
 
     // This also destroys all attached stylesheets
+    _style_rules.reset();
     cr_cascade_unref(style_cascade);
     style_cascade = nullptr;
 
@@ -403,8 +410,10 @@ std::unique_ptr<SPDocument> SPDocument::createDoc(
     	throw;
     }
 
-    // Recursively build object tree
+    // Recursively build object tree, from attributes parsed in parallel beforehand
+    document->_preparsed = std::make_unique<Inkscape::PreparsedAttributes>(*rroot);
     document->root->invoke_build(document.get(), rroot, false);
+    document->_preparsed.reset();
 
     /* Eliminate obsolete sodipodi:docbase, for privacy reasons */
     rroot->removeAttribute("sodipodi:docbase");
@@ -673,46 +682,60 @@ void SPDocument::update_lpobjs() {
  */
 std::unique_ptr<SPDocument> SPDocument::createNewDoc(char const *filename, bool keepalive, bool make_new, SPDocument *parent)
 {
-    Inkscape::XML::Document *rdoc = nullptr;
-    gchar *document_base = nullptr;
-    gchar *document_name = nullptr;
-
     if (filename) {
-        Inkscape::XML::Node *rroot;
         /* Try to fetch repr from file */
-        rdoc = sp_repr_read_file(filename, SP_SVG_NS_URI);
-        /* If file cannot be loaded, return NULL without warning */
-        if (rdoc == nullptr) return nullptr;
-        rroot = rdoc->root();
-        /* If xml file is not svg, return NULL without warning */
-        /* fixme: destroy document */
-        if (strcmp(rroot->name(), "svg:svg") != 0) return nullptr;
-
-        // Opening a template that points to a sister file should still work
-        // this also includes tutorials which point to png files.
-        document_base = g_path_get_dirname(filename);
-
-        if (make_new) {
-            filename = nullptr;
-            document_name = g_strdup_printf(_("New document %d"), ++doc_count);
-        } else {
-            document_name = g_path_get_basename(filename);
-            if (strcmp(document_base, ".") == 0) {
-                g_free(document_base);
-                document_base = nullptr;
-            }
-        }
-    } else {
-        if (make_new) {
-            document_name = g_strdup_printf(_("Memory document %d"), ++doc_mem_count);
-        }
+        return createNewDocFromRepr(sp_repr_read_file(filename, SP_SVG_NS_URI), filename, keepalive, make_new, parent);
+    }
 
-        rdoc = sp_repr_document_new("svg:svg");
+    gchar *document_name = nullptr;
+    if (make_new) {
+        document_name = g_strdup_printf(_("Memory document %d"), ++doc_mem_count);
     }
 
+    Inkscape::XML::Document *rdoc = sp_repr_document_new("svg:svg");
+
     //# These should be set by now
     g_assert(document_name);
 
+    auto doc = createDoc(rdoc, nullptr, nullptr, document_name, keepalive, parent);
+
+    g_free(document_name);
+
+    return doc;
+}
+
+/**
+ * Creates a document from @a rdoc, which was read from @a filename and is taken over; NULL if
+ * the file could not be read, or is not SVG.
+ */
+std::unique_ptr<SPDocument> SPDocument::createNewDocFromRepr(Inkscape::XML::Document *rdoc, char const *filename,
+                                                             bool keepalive, bool make_new, SPDocument *parent)
+{
+    /* If file cannot be loaded, return NULL without warning */
+    if (rdoc == nullptr) return nullptr;
+    Inkscape::XML::Node *rroot = rdoc->root();
+    /* If xml file is not svg, return NULL without warning */
+    if (strcmp(rroot->name(), "svg:svg") != 0) {
+        Inkscape::GC::release(rdoc);
+        return nullptr;
+    }
+
+    // Opening a template that points to a sister file should still work
+    // this also includes tutorials which point to png files.
+    gchar *document_base = g_path_get_dirname(filename);
+    gchar *document_name = nullptr;
+
+    if (make_new) {
+        filename = nullptr;
+        document_name = g_strdup_printf(_("New document %d"), ++doc_count);
+    } else {
+        document_name = g_path_get_basename(filename);
+        if (strcmp(document_base, ".") == 0) {
+            g_free(document_base);
+            document_base = nullptr;
+        }
+    }
+
     auto doc = createDoc(rdoc, filename, document_base, document_name, keepalive, parent);
 
     g_free(document_base);
@@ -1206,106 +1229,140 @@ SPObject *SPDocument::getObjectByHref(char const *href) const
     return getObjectById(id);
 }
 
-static void _getObjectsByClassRecursive(Glib::ustring const &klass, SPObject *parent, std::vector<SPObject*> &objects)
-{
-    if (!parent) return;
+namespace {
 
-    if (auto const temp = parent->getAttribute("class")) {
-        std::istringstream classes(temp);
-        Glib::ustring token;
-        while (classes >> token) {
-            // we can have multiple class
-            if (classes.str() == " ") {
-                token = "";
-                continue;
-            }
-            if (token == klass) {
-                objects.emplace_back(parent);
-                break;
-            }
-        }
+void index_add(auto &index, std::string_view key, SPObject *object)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        it = index.try_emplace(std::string(key)).first;
     }
+    it->second.insert(object);
+}
 
-    // Check children
-    for (auto &child : parent->children) {
-        _getObjectsByClassRecursive(klass, &child, objects);
+void index_remove(auto &index, std::string_view key, SPObject *object)
+{
+    if (auto it = index.find(key); it != index.end()) {
+        it->second.erase(object);
+        if (it->second.empty()) {
+            index.erase(it);
+        }
     }
 }
 
-std::vector<SPObject*> SPDocument::getObjectsByClass(Glib::ustring const &klass) const
+/// The objects under @a key, in the order of a depth-first walk of the document.
+std::vector<SPObject *> index_lookup(auto const &index, std::string_view key)
 {
-    if (klass.empty()) return {};
-    std::vector<SPObject*> objects;
-    _getObjectsByClassRecursive(klass, root, objects);
+    auto it = index.find(key);
+    if (it == index.end()) return {};
+
+    std::vector<SPObject *> objects(it->second.begin(), it->second.end());
+    std::sort(objects.begin(), objects.end(), [] (SPObject const *a, SPObject const *b) {
+        if (a->isAncestorOf(b)) return true;
+        if (b->isAncestorOf(a)) return false;
+        return sp_object_compare_position(a, b) < 0;
+    });
     return objects;
 }
 
-static void _getObjectsByElementRecursive(Glib::ustring const &element,
-                                          SPObject *parent,
-                                          std::vector<SPObject*> &objects,
-                                          bool custom)
+} // namespace
+
+void SPDocument::bindObjectToClasses(SPObject *object, char const *old_classes, char const *new_classes)
 {
-    if (!parent) return;
+    Inkscape::Util::for_each_class(old_classes, [&] (std::string_view klass) { index_remove(_class_index, klass, object); });
+    Inkscape::Util::for_each_class(new_classes, [&] (std::string_view klass) { index_add(_class_index, klass, object); });
+}
 
-    Glib::ustring prefixed = custom ? "inkscape:" : "svg:";
-    prefixed += element;
-    if (parent->getRepr()->name() == prefixed) {
-        objects.emplace_back(parent);
+void SPDocument::bindObjectToElement(SPObject *object, char const *old_name, char const *new_name)
+{
+    if (old_name) {
+        index_remove(_element_index, old_name, object);
     }
-
-    // Check children
-    for (auto &child : parent->children) {
-        _getObjectsByElementRecursive(element, &child, objects, custom);
+    if (new_name) {
+        index_add(_element_index, new_name, object);
     }
 }
 
+std::vector<SPObject*> SPDocument::getObjectsByClass(Glib::ustring const &klass) const
+{
+    if (klass.empty()) return {};
+    return index_lookup(_class_index, klass.raw());
+}
+
 std::vector<SPObject*> SPDocument::getObjectsByElement(Glib::ustring const &element, bool custom) const
 {
     if (element.empty()) return {};
-    std::vector<SPObject*> objects;
-    _getObjectsByElementRecursive(element, root, objects, custom);
-    return objects;
+    auto const prefixed = (custom ? "inkscape:" : "svg:") + element.raw();
+    return index_lookup(_element_index, prefixed);
 }
 
-static void _getObjectsBySelectorRecursive(SPObject *parent,
-                                           CRSelEng *sel_eng, CRSimpleSel *simple_sel,
+static void _getObjectsBySelectorRecursive(SPObject *parent, CRSimpleSel *simple_sel,
                                            std::vector<SPObject*> &objects)
 {
     if (parent) {
-        gboolean result = false;
-        cr_sel_eng_matches_node(sel_eng, simple_sel, parent->getRepr(), &result);
-        if (result) {
+        if (Inkscape::StyleRuleIndex::matches(simple_sel, *parent->getRepr())) {
             objects.push_back(parent);
         }
 
         // Check children
         for (auto &child : parent->children) {
-            _getObjectsBySelectorRecursive(&child, sel_eng, simple_sel, objects);
+            _getObjectsBySelectorRecursive(&child, simple_sel, objects);
         }
     }
 }
 
+/// A class of the rightmost compound of the selector starting at @a simple_sel, if any.
+static char const *required_class(CRSimpleSel const *simple_sel)
+{
+    while (simple_sel->next) {
+        simple_sel = simple_sel->next;
+    }
+    for (auto add = simple_sel->add_sel; add; add = add->next) {
+        if (add->type == CLASS_ADD_SELECTOR && add->content.class_name && add->content.class_name->stryng) {
+            return add->content.class_name->stryng->str;
+        }
+    }
+    return nullptr;
+}
+
 std::vector<SPObject*> SPDocument::getObjectsBySelector(Glib::ustring const &selector) const
 {
     if (selector.empty()) return {};
 
-    static CRSelEng *sel_eng = nullptr;
-    if (!sel_eng) {
-        sel_eng = cr_sel_eng_new(&Inkscape::XML::croco_node_iface);
-    }
-
     auto cr_selector = cr_selector_parse_from_buf(reinterpret_cast<guchar const*>(selector.c_str()), CR_UTF_8);
 
     std::vector<SPObject*> objects;
     for (auto cur = cr_selector; cur; cur = cur->next) {
-        if (cur->simple_sel) {
-            _getObjectsBySelectorRecursive(root, sel_eng, cur->simple_sel, objects);
+        if (!cur->simple_sel) continue;
+
+        if (auto const klass = required_class(cur->simple_sel)) {
+            // Only the objects with that class can match.
+            for (auto object : index_lookup(_class_index, klass)) {
+                if (Inkscape::StyleRuleIndex::matches(cur->simple_sel, *object->getRepr())) {
+                    objects.push_back(object);
+                }
+            }
+        } else {
+            _getObjectsBySelectorRecursive(root, cur->simple_sel, objects);
         }
     }
     cr_selector_destroy(cr_selector);
     return objects;
 }
 
+Inkscape::StyleRuleIndex const &SPDocument::getStyleRules()
+{
+    if (!_style_rules) {
+        _style_rules = std::make_unique<Inkscape::StyleRuleIndex>(style_cascade);
+    }
+    return *_style_rules;
+}
+
+void SPDocument::invalidateStyleRules()
+{
+    _style_rules.reset();
+}
+
 // Note: Despite appearances, this implementation is allocation-free thanks to SSO.
 std::string SPDocument::generate_unique_id(char const *prefix)
 {
@@ -1530,10 +1587,38 @@ static bool overlaps(Geom::Rect const &area, Geom::Rect const &box)
     return area.intersects(box);
 }
 
+/**
+ * Whether walking down from @a group, as find_items_in_area() does, reaches @a item:
+ * all groups in between must be entered, and the item itself taken.
+ */
+static bool is_reachable(SPItem const *item, SPGroup const *group, unsigned int dkey,
+                         bool take_hidden, bool take_insensitive, bool take_groups,
+                         bool enter_groups, bool enter_layers)
+{
+    auto is_entered_layer = [&] (SPGroup const *g) {
+        return enter_layers && g->effectiveLayerMode(dkey) == SPGroup::LAYER;
+    };
+
+    if ((!take_insensitive && item->isLocked()) || (!take_hidden && item->isHidden())) {
+        return false;
+    }
+    if (auto g = cast<SPGroup>(item); g && (!take_groups || is_entered_layer(g))) {
+        return false;
+    }
+
+    for (auto o = item->parent; o != group; o = o->parent) {
+        auto g = cast<SPGroup>(o);
+        if (!g || (!take_hidden && g->isHidden()) || !(enter_groups || is_entered_layer(g))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * Return a vector list of items in a given area.
  *
- * @param s The returned list
+ * @param index The spatial index of the document
  * @param group The starting group
  * @param dkey The display control group to traverse
  * @param area Area in document coordinates
@@ -1544,43 +1629,39 @@ static bool overlaps(Geom::Rect const &area, Geom::Rect const &box)
  * @param enter_groups (false) traverse into regular groups
  * @param enter_layers (true) traverse into layer groups
  */
-static std::vector<SPItem*> &find_items_in_area(std::vector<SPItem*> &s,
-                                                SPGroup *group, unsigned int dkey,
-                                                Geom::Rect const &area,
-                                                bool (*test)(Geom::Rect const &, Geom::Rect const &),
-                                                bool take_hidden = false,
-                                                bool take_insensitive = false,
-                                                bool take_groups = true,
-                                                bool enter_groups = false,
-                                                bool enter_layers = true)
-{
+static std::vector<SPItem*> find_items_in_area(Inkscape::ItemIndex &index,
+                                               SPGroup *group, unsigned int dkey,
+                                               Geom::Rect const &area,
+                                               bool (*test)(Geom::Rect const &, Geom::Rect const &),
+                                               bool take_hidden = false,
+                                               bool take_insensitive = false,
+                                               bool take_groups = true,
+                                               bool enter_groups = false,
+                                               bool enter_layers = true)
+{
+    std::vector<SPItem*> s;
     g_return_val_if_fail(group, s);
 
-    for (auto& o: group->children) {
-        if (auto item = cast<SPItem>(&o)) {
-            if (!take_insensitive && item->isLocked()) {
-                continue;
-            }
-
-            if (!take_hidden && item->isHidden()) {
-                continue;
-            }
-
-            if (auto childgroup = cast<SPGroup>(item)) {
-                bool is_layer = childgroup->effectiveLayerMode(dkey) == SPGroup::LAYER;
-                if ((enter_layers && is_layer) || (enter_groups)) {
-                    s = find_items_in_area(s, childgroup, dkey, area, test, take_hidden, take_insensitive, take_groups, enter_groups, enter_layers);
-                }
-                if (!take_groups || (enter_layers && is_layer)) {
-                    continue;
-                }
-            }
-            Geom::OptRect box = item->documentVisualBounds();
-            if (box && test(area, *box)) {
-                s.push_back(item);
-            }
+    for (auto item : index.query(area)) {
+        Geom::OptRect box = item->documentVisualBounds();
+        if (box && test(area, *box) &&
+            is_reachable(item, group, dkey, take_hidden, take_insensitive, take_groups, enter_groups, enter_layers))
+        {
+            s.push_back(item);
         }
     }
+
+    // Return them in the order of a walk through the tree: groups after their contents.
+    std::sort(s.begin(), s.end(), [] (SPItem const *a, SPItem const *b) {
+        if (a->isAncestorOf(b)) {
+            return false;
+        }
+        if (b->isAncestorOf(a)) {
+            return true;
+        }
+        return sp_object_compare_position_bool(a, b);
+    });
+
     return s;
 }
 
@@ -1664,7 +1745,8 @@ upwards in z-order and returns what it has found so far (i.e. the found items ar
 guaranteed to be lower than upto). Requires a list of nodes built by build_flat_item_list.
 If items_count > 0, it'll return the topmost (in z-order) items_count items.
  */
-static std::vector<SPItem*> find_items_at_point(std::deque<SPItem*> const &nodes, unsigned dkey,
+template <typename Nodes>
+static std::vector<SPItem*> find_items_at_point(Nodes const &nodes, unsigned dkey,
                                                 Geom::Point const &p, int items_count = 0, SPItem *upto = nullptr)
 {
     double const delta = Inkscape::Preferences::get()->getDouble("/options/cursortolerance/value", 1.0);
@@ -1699,7 +1781,8 @@ static std::vector<SPItem*> find_items_at_point(std::deque<SPItem*> const &nodes
     return result;
 }
 
-static SPItem *find_item_at_point(std::deque<SPItem*> const &nodes, unsigned dkey, Geom::Point const &p, SPItem *upto = nullptr)
+template <typename Nodes>
+static SPItem *find_item_at_point(Nodes const &nodes, unsigned dkey, Geom::Point const &p, SPItem *upto = nullptr)
 {
     auto items = find_items_at_point(nodes, dkey, p, 1, upto);
     if (items.empty()) {
@@ -1708,6 +1791,55 @@ static SPItem *find_item_at_point(std::deque<SPItem*> const &nodes, unsigned dke
     return items.back();
 }
 
+/**
+ * Whether @a item is in the list built by get_flat_item_list().
+ */
+static bool is_in_flat_item_list(SPItem const *item, SPGroup const *root, unsigned int dkey, bool into_groups, bool active_only)
+{
+    auto is_entered = [&] (SPGroup const *g) {
+        return into_groups || g->effectiveLayerMode(dkey) == SPGroup::LAYER;
+    };
+
+    if (auto g = cast<SPGroup>(item); g && is_entered(g)) {
+        return false;
+    }
+    for (auto o = item->parent; o != root; o = o->parent) {
+        auto g = cast<SPGroup>(o);
+        if (!g || !is_entered(g)) {
+            return false;
+        }
+    }
+    return !active_only || item->isVisibleAndUnlocked(dkey);
+}
+
+/**
+ * Return the items of the flat item list that may be picked at point p, in the same order
+ * (topmost first), using the spatial index instead of going through the whole list.
+ * Returns nothing if there is no drawing for dkey to relate p to the document.
+ */
+static std::optional<std::vector<SPItem*>> find_pick_candidates(Inkscape::ItemIndex &index, SPGroup *root, unsigned dkey,
+                                                                Geom::Point const &p, bool into_groups, bool active_only)
+{
+    auto di = root->get_arenaitem(dkey);
+    if (!di || !di->ctm().isInvertible()) {
+        return {};
+    }
+
+    double const delta = Inkscape::Preferences::get()->getDouble("/options/cursortolerance/value", 1.0);
+    auto area = Geom::Rect(p, p);
+    area.expandBy(delta);
+    area = area * di->ctm().inverse();
+
+    auto candidates = index.query(area);
+    std::erase_if(candidates, [&] (SPItem const *item) {
+        return !is_in_flat_item_list(item, root, dkey, into_groups, active_only);
+    });
+    std::sort(candidates.begin(), candidates.end(), [] (SPItem const *a, SPItem const *b) {
+        return sp_object_compare_position_bool(b, a);
+    });
+    return candidates;
+}
+
 /**
  * Returns the topmost non-layer group from the descendants of group which is at point p,
  * or null if none. Recurses into layers but not into groups.
@@ -1748,8 +1880,7 @@ static SPItem *find_group_at_point(unsigned dkey, SPGroup *group, Geom::Point co
 
 std::vector<SPItem*> SPDocument::getItemsInBox(unsigned int dkey, Geom::Rect const &box, bool take_hidden, bool take_insensitive, bool take_groups, bool enter_groups, bool enter_layers) const
 {
-    std::vector<SPItem*> x;
-    return find_items_in_area(x, this->root, dkey, box, is_within, take_hidden, take_insensitive, take_groups, enter_groups, enter_layers);
+    return find_items_in_area(*_item_index, root, dkey, box, is_within, take_hidden, take_insensitive, take_groups, enter_groups, enter_layers);
 }
 
 /**
@@ -1765,8 +1896,7 @@ std::vector<SPItem*> SPDocument::getItemsInBox(unsigned int dkey, Geom::Rect con
 
 std::vector<SPItem*> SPDocument::getItemsPartiallyInBox(unsigned int dkey, Geom::Rect const &box, bool take_hidden, bool take_insensitive, bool take_groups, bool enter_groups, bool enter_layers) const
 {
-    std::vector<SPItem*> x;
-    return find_items_in_area(x, this->root, dkey, box, overlaps, take_hidden, take_insensitive, take_groups, enter_groups, enter_layers);
+    return find_items_in_area(*_item_index, root, dkey, box, overlaps, take_hidden, take_insensitive, take_groups, enter_groups, enter_layers);
 }
 
 std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vector<Geom::Point> points, bool all_layers, bool topmost_only, size_t limit, bool active_only) const
@@ -1780,7 +1910,7 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
     gdouble saved_delta = prefs->getDouble("/options/cursortolerance/value", 1.0);
     prefs->setDouble("/options/cursortolerance/value", 0.25);
 
-    auto &node_cache = get_flat_item_list(key, true, active_only);
+    std::deque<SPItem*> const *node_cache = nullptr;
 
     SPObject *current_layer = nullptr;
     SPDesktop *desktop = SP_ACTIVE_DESKTOP;
@@ -1789,7 +1919,15 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
     }
     size_t item_counter = 0;
     for(auto point : points) {
-        std::vector<SPItem*> items = find_items_at_point(node_cache, key, point, topmost_only);
+        std::vector<SPItem*> items;
+        if (auto candidates = find_pick_candidates(*_item_index, root, key, point, true, active_only)) {
+            items = find_items_at_point(*candidates, key, point, topmost_only);
+        } else {
+            if (!node_cache) {
+                node_cache = &get_flat_item_list(key, true, active_only);
+            }
+            items = find_items_at_point(*node_cache, key, point, topmost_only);
+        }
         for (SPItem *item : items) {
             if (item && result.end()==find(result.begin(), result.end(), item))
                 if(all_layers || (desktop && desktop->layerManager().layerForObject(item) == current_layer)){
@@ -1813,6 +1951,18 @@ std::vector<SPItem*> SPDocument::getItemsAtPoints(unsigned const key, std::vecto
 SPItem *SPDocument::getItemAtPoint( unsigned const key, Geom::Point const &p,
                                     bool const into_groups, SPItem *upto) const
 {
+    if (auto candidates = find_pick_candidates(*_item_index, root, key, p, into_groups, true)) {
+        if (upto) {
+            // Only look below upto, as when walking the flat list.
+            if (!is_in_flat_item_list(upto, root, key, into_groups, true)) {
+                return nullptr;
+            }
+            std::erase_if(*candidates, [&] (SPItem const *item) {
+                return !sp_object_compare_position_bool(item, upto);
+            });
+        }
+        return find_item_at_point(*candidates, key, p);
+    }
     return find_item_at_point(get_flat_item_list(key, into_groups, true), key, p, upto);
 }
 
@@ -25,6 +25,9 @@
 #include <queue>                               // for queue
 #include <span>
 #include <string>                              // for string
+#include <string_view>                         // for string_view
+#include <unordered_map>                       // for unordered_map
+#include <unordered_set>                       // for unordered_set
 #include <vector>                              // for vector
 
 #include <boost/ptr_container/ptr_list.hpp>    // for ptr_list
@@ -46,6 +49,8 @@
 // XXX only for testing!
 #include "console-output-undo-observer.h"
 
+#include "util/string-keys.h"
+
 // This variable is introduced with 0.92.1
 // with the introduction of automatic fix 
 // for files detected to have been created 
@@ -80,6 +85,9 @@ namespace Inkscape {
     class DocumentUndo;
     class Event;
     class EventLog;
+    class ItemIndex;
+    class PreparsedAttributes;
+    class StyleRuleIndex;
     class PageManager;
     namespace Colors {
         class DocumentCMS;
@@ -116,6 +124,8 @@ public:
             char const *base, char const *name, bool keepalive, SPDocument *parent = nullptr);
     static std::unique_ptr<SPDocument> createNewDoc(char const *filename, bool keepalive,
             bool make_new = false, SPDocument *parent = nullptr);
+    static std::unique_ptr<SPDocument> createNewDocFromRepr(Inkscape::XML::Document *rdoc, char const *filename,
+            bool keepalive, bool make_new = false, SPDocument *parent = nullptr);
     static std::unique_ptr<SPDocument> createNewDocFromMem(std::span<char const> buffer, bool keepalive,
             std::string const &filename = "");
     SPDocument *createChildDoc(std::string const &filename);
@@ -190,6 +200,9 @@ public:
 
     // Document structure -----------------
     Avoid::Router* getRouter() const { return _router.get(); }
+    Inkscape::ItemIndex &getItemIndex() { return *_item_index; }
+    /// Attributes parsed ahead of building the objects, only while the document is being loaded.
+    Inkscape::PreparsedAttributes *getPreparsedAttributes() { return _preparsed.get(); }
     
     /** Returns our SPRoot */
     SPRoot *getRoot() { return root; }
@@ -216,6 +229,10 @@ public:
 
     // Styling
     CRCascade    *getStyleCascade() { return style_cascade; }
+    /// The rules of the style cascade, indexed for matching; built on first use.
+    Inkscape::StyleRuleIndex const &getStyleRules();
+    /// Drop the index of the style rules, when a style sheet of the cascade has changed.
+    void invalidateStyleRules();
 
     // File information --------------------
 
@@ -280,6 +297,14 @@ public:
     void bindObjectToRepr(Inkscape::XML::Node *repr, SPObject *object);
     SPObject *getObjectByRepr(Inkscape::XML::Node *repr) const;
 
+    /**
+     * Keep the indexes behind getObjectsByClass() and getObjectsByElement() up to date when the
+     * class attribute or element name of @a object changes. A null old value adds the object,
+     * a null new value removes it.
+     */
+    void bindObjectToClasses(SPObject *object, char const *old_classes, char const *new_classes);
+    void bindObjectToElement(SPObject *object, char const *old_name, char const *new_name);
+
     std::vector<SPObject *> getObjectsByClass(Glib::ustring const &klass) const;
     std::vector<SPObject *> getObjectsByElement(Glib::ustring const &element, bool custom = false) const;
     std::vector<SPObject *> getObjectsBySelector(Glib::ustring const &selector) const;
@@ -350,6 +375,8 @@ public:
     bool isPartial() const {return partial != nullptr;} // In partianl undo/redo transaction
     void reset_key(void *dummy) { actionkey.clear(); }
     bool isSensitive() const { return sensitive; }
+    std::size_t undoStepCount() const { return undo.size(); }
+    std::size_t undoMemoryUsage() const { return undo_size; } // Estimate, in bytes.
 
     // Garbage collecting ----------------------
     void queueForOrphanCollection(SPObject *object);
@@ -392,6 +419,7 @@ private:
 
     // Styling
     CRCascade *style_cascade;
+    std::unique_ptr<Inkscape::StyleRuleIndex> _style_rules;
 
     // Desktop geometry
     mutable Geom::Affine _doc2dt;
@@ -402,11 +430,19 @@ private:
     char *document_name;  ///< basename or other human-readable label for the document.
 
     // Find items ----------------------------
-    std::map<std::string, SPObject *> iddef;
-    std::map<Inkscape::XML::Node *, SPObject *> reprdef;
+    template <typename T>
+    using StringMap = Inkscape::Util::StringMap<T>;
+    using ObjectIndex = StringMap<std::unordered_set<SPObject *>>;
+
+    StringMap<SPObject *> iddef;
+    std::unordered_map<Inkscape::XML::Node *, SPObject *> reprdef;
+    ObjectIndex _class_index;   ///< Objects by each of their classes, including clones.
+    ObjectIndex _element_index; ///< Objects by qualified element name, including clones.
 
     // Find items by geometry --------------------
     mutable std::map<unsigned long, std::deque<SPItem*>> _node_cache; // Used to speed up search.
+    std::unique_ptr<Inkscape::ItemIndex> _item_index;
+    std::unique_ptr<Inkscape::PreparsedAttributes> _preparsed;
 
     // Box tool ----------------------------
     Persp3D *current_persp3d; /**< Currently 'active' perspective (to which, e.g., newly created boxes are attached) */
@@ -420,8 +456,9 @@ private:
     bool sensitive; /* If we save actions to undo stack */
     Inkscape::XML::Event * partial; /* partial undo log when interrupted */
     int history_size;
-    std::vector<Inkscape::Event *> undo; /* Undo stack of reprs */
+    std::deque<Inkscape::Event *> undo; /* Undo stack of reprs */
     std::vector<Inkscape::Event *> redo; /* Redo stack of reprs */
+    std::size_t undo_size = 0; /* Estimated memory held by the undo stack, in bytes */
     /* Undo listener */
     Inkscape::CompositeUndoStackObserver undoStackObservers;
 
@@ -353,6 +353,51 @@ EventLog::notifyClearRedoEvent()
     updateUndoVerbs();
 }
 
+void
+EventLog::notifyUndoExpiredEvent(Event *log)
+{
+    auto &_columns = getColumns();
+
+    // The oldest event is the first one after the initial pseudo event.
+    auto oldest = _event_list_store->children().begin();
+    ++oldest;
+    g_return_if_fail ( oldest != _event_list_store->children().end() && (*oldest)[_columns.event] == log );
+
+    // The pseudo event now stands for the state after the dropped event, and the state before
+    // it can no longer be reached.
+    if ( _last_saved == _event_list_store->children().begin() ) {
+        _last_saved = (iterator)nullptr;
+    } else if ( _last_saved == oldest ) {
+        _last_saved = _event_list_store->children().begin();
+    }
+
+    if ( oldest->children().empty() ) {
+        _event_list_store->erase(oldest);
+    } else {
+        // the first child of the branch takes the place of its parent
+        auto first = oldest->children().begin();
+        Gtk::TreeRow row = *oldest;
+        row[_columns.event] = static_cast<Event *>((*first)[_columns.event]);
+        row[_columns.description] = Glib::ustring{(*first)[_columns.description]};
+
+        if ( _curr_event == first ) {
+            _curr_event = oldest;
+            _curr_event_parent = (iterator)nullptr;
+        }
+        if ( _last_event == first ) {
+            _last_event = oldest;
+        }
+        if ( _last_saved == first ) {
+            _last_saved = oldest;
+        }
+
+        _event_list_store->erase(first);
+        row[_columns.child_count] = oldest->children().size() + 1;
+    }
+
+    updateUndoVerbs();
+}
+
 void  EventLog::addDialogConnection(Gtk::TreeView *event_list_view, CallbackMap *callback_connections)
 {
     _priv->addDialogConnection(event_list_view, callback_connections, _event_list_store, _curr_event);
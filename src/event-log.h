@@ -76,6 +76,7 @@ public:
     void notifyUndoCommitEvent(Event *log) override;
     void notifyClearUndoEvent() override;
     void notifyClearRedoEvent() override;
+    void notifyUndoExpiredEvent(Event *log) override;
 
     // Accessor functions
 
@@ -17,6 +17,7 @@
 
 #include <glibmm/ustring.h>
 
+#include <cstddef>
 #include <utility>
 
 #include "xml/event-fns.h"
@@ -40,6 +41,7 @@ public:
 
     XML::Event *event;
     unsigned int type = 0;
+    std::size_t size = 0;      // Estimated memory held by the event log, in bytes.
     Glib::ustring description; // The description to use in the Undo dialog.
     Glib::ustring icon_name;   // The icon to use in the Undo dialog.
 };
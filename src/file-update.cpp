@@ -135,11 +135,11 @@ void fix_font_name(SPObject *o)
         fix_font_name(ci);
     std::string prev = o->style->font_family.value();
     if (prev == "Sans")
-        o->style->font_family.read("sans-serif");
+        o->writableStyle()->font_family.read("sans-serif");
     else if (prev == "Serif")
-        o->style->font_family.read("serif");
+        o->writableStyle()->font_family.read("serif");
     else if (prev == "Monospace")
-        o->style->font_family.read("monospace");
+        o->writableStyle()->font_family.read("monospace");
 }
 
 void fix_font_size(SPObject *o)
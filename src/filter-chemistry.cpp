@@ -552,11 +552,12 @@ bool set_blend_mode(SPItem* item, SPBlendMode blend_mode) {
     if (!item->style->mix_blend_mode.set && item->style->filter.set && item->style->getFilter()) {
         remove_filter_legacy_blend(item);
     }
-    item->style->mix_blend_mode.set = TRUE;
-    if (item->style->isolation.value == SP_CSS_ISOLATION_ISOLATE) {
-        item->style->mix_blend_mode.value = SP_CSS_BLEND_NORMAL;
+    auto const style = item->writableStyle();
+    style->mix_blend_mode.set = TRUE;
+    if (style->isolation.value == SP_CSS_ISOLATION_ISOLATE) {
+        style->mix_blend_mode.value = SP_CSS_BLEND_NORMAL;
     } else { 
-        item->style->mix_blend_mode.value = blend_mode;
+        style->mix_blend_mode.value = blend_mode;
     }
 
     if (change_blend) { // we do blend so we need to update display style
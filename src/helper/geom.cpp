@@ -550,6 +550,120 @@ pathv_to_linear_and_cubic_beziers( Geom::PathVector const &pathv )
     return output;
 }
 
+static double distance_to_segment(Geom::Point const &p, Geom::Point const &a, Geom::Point const &b)
+{
+    auto const ab = b - a;
+    auto const length2 = Geom::dot(ab, ab);
+    auto const t = length2 > 0 ? std::clamp(Geom::dot(p - a, ab) / length2, 0.0, 1.0) : 0.0;
+    return Geom::distance(p, a + t * ab);
+}
+
+/// Whether a segment stays within tolerance of its chord, which holds if its control points do.
+static bool is_flat_curve(Geom::Curve const &c, double tolerance)
+{
+    auto const bezier = dynamic_cast<Geom::BezierCurve const *>(&c);
+    if (!bezier) {
+        return false;
+    }
+    for (unsigned i = 1; i < bezier->order(); i++) {
+        if (distance_to_segment(bezier->controlPoint(i), c.initialPoint(), c.finalPoint()) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Appends lines through the points of a polyline to path, which ends at its first point.
+static void append_simplified_polyline(Geom::Path &path, std::vector<Geom::Point> &points, double crowding, double tolerance)
+{
+    if (points.size() < 2) {
+        return;
+    }
+
+    // Drop the points close to the last point kept; the ends are always kept.
+    std::size_t kept = 1;
+    for (std::size_t i = 1; i + 1 < points.size(); i++) {
+        if (Geom::distance(points[i], points[kept - 1]) > crowding) {
+            points[kept++] = points[i];
+        }
+    }
+    points[kept++] = points.back();
+    points.resize(kept);
+
+    // Ramer-Douglas-Peucker, without recursion.
+    std::vector<bool> keep(points.size(), false);
+    keep.front() = keep.back() = true;
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+    stack.emplace_back(0, points.size() - 1);
+    while (!stack.empty()) {
+        auto const [first, last] = stack.back();
+        stack.pop_back();
+
+        double farthest = 0;
+        std::size_t index = first;
+        for (auto i = first + 1; i < last; i++) {
+            auto const d = distance_to_segment(points[i], points[first], points[last]);
+            if (d > farthest) {
+                farthest = d;
+                index = i;
+            }
+        }
+        if (farthest > tolerance) {
+            keep[index] = true;
+            stack.emplace_back(first, index);
+            stack.emplace_back(index, last);
+        }
+    }
+
+    for (std::size_t i = 1; i < points.size(); i++) {
+        if (keep[i]) {
+            path.appendNew<Geom::LineSegment>(points[i]);
+        }
+    }
+}
+
+/*
+ * Returns a copy of pathv with fewer segments that stays within tolerance of it: every point of
+ * either is at most that far from the other. Segments that are nearly straight become lines,
+ * points crowded together are dropped, and the runs of lines left are simplified with the
+ * Ramer-Douglas-Peucker algorithm. Other curves are kept as they are.
+ *
+ * Meant for display, where the tolerance is a fraction of a pixel; the result may intersect
+ * itself where pathv does not.
+ */
+Geom::PathVector
+pathv_simplify_within(Geom::PathVector const &pathv, double tolerance)
+{
+    // The errors of the three steps add up.
+    auto const flatness = tolerance / 4;
+    auto const crowding = tolerance / 4;
+    auto const deviation = tolerance / 2;
+
+    Geom::PathVector output;
+    std::vector<Geom::Point> points;
+
+    for (auto const &path : pathv) {
+        output.push_back(Geom::Path(path.initialPoint()));
+        auto &out = output.back();
+
+        points.assign(1, path.initialPoint());
+        for (auto it = path.begin(); it != path.end_open(); ++it) {
+            if (is_flat_curve(*it, flatness)) {
+                points.push_back(it->finalPoint());
+            } else {
+                append_simplified_polyline(out, points, crowding, deviation);
+                out.append(*it);
+                points.assign(1, it->finalPoint());
+            }
+        }
+        append_simplified_polyline(out, points, crowding, deviation);
+
+        out.close(path.closed());
+    }
+
+    return output;
+}
+
 /*
  * Converts all segments in all paths to Geom::LineSegment.  There is an intermediate
  * stage where some may be converted to beziers.  maxdisp is the maximum displacement from
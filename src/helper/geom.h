@@ -40,6 +40,7 @@ bool pointInTriangle(Geom::Point const &p, Geom::Point const &p1, Geom::Point co
 Geom::PathVector pathv_to_linear_and_cubic_beziers( Geom::PathVector const &pathv );
 Geom::PathVector pathv_to_linear( Geom::PathVector const &pathv, double maxdisp );
 Geom::PathVector pathv_to_cubicbezier( Geom::PathVector const &pathv, bool nolines);
+Geom::PathVector pathv_simplify_within(Geom::PathVector const &pathv, double tolerance);
 bool pathv_similar(Geom::PathVector const &apv, Geom::PathVector const &bpv, double precission = 0.001);
 void recursive_bezier4(const double x1, const double y1, const double x2, const double y2, 
                        const double x3, const double y3, const double x4, const double y4,
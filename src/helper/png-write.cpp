@@ -15,6 +15,13 @@
  */
 
 
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
 
@@ -22,9 +29,11 @@
 
 #include "document.h"
 #include "png-write.h"
+#include "preferences.h"
 #include "rdf.h"
 
 #include "display/cairo-utils.h"
+#include "display/dispatch-pool.h"
 #include "display/drawing-context.h"
 #include "display/drawing.h"
 
@@ -52,9 +61,9 @@ struct SPEBP {
     unsigned long int width, height, sheight;
     guint32 background;
     Inkscape::Drawing *drawing; // it is assumed that all unneeded items are hidden
-    guchar *px;
     unsigned (*status)(float, void *);
     void *data;
+    void *pipeline; // SPExportStripPipeline, if rendering in parallel
 };
 
 /* write a png file */
@@ -316,6 +325,45 @@ sp_png_write_rgba_striped(SPDocument *doc,
 }
 
 
+/**
+ * Render rows [row, row + num_rows) of the export area and convert them to the requested PNG format.
+ * The drawing must have been updated for this area. Safe to call from several threads at once
+ * as long as the drawing is snapshotted.
+ *
+ * @return The converted pixel data, to be freed by the caller; @a rows is filled with pointers into it.
+ */
+static guchar const *
+sp_export_render_strip(SPEBP const &ebp, guchar const **rows, int row, int num_rows, int color_type, int bit_depth)
+{
+    Geom::IntRect bbox = Geom::IntRect::from_xywh(0, row, ebp.width, num_rows);
+
+    int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp.width);
+    unsigned char *px = g_new(guchar, num_rows * stride);
+
+    cairo_surface_t *s = cairo_image_surface_create_for_data(
+        px, CAIRO_FORMAT_ARGB32, ebp.width, num_rows, stride);
+    Inkscape::DrawingContext dc(s, bbox.min());
+    dc.setSource(ebp.background);
+    dc.setOperator(CAIRO_OPERATOR_SOURCE);
+    dc.paint();
+    dc.setOperator(CAIRO_OPERATOR_OVER);
+
+    /* Render */
+    ebp.drawing->render(dc, bbox, 0);
+    cairo_surface_destroy(s);
+
+    // PNG stores data as unpremultiplied big-endian RGBA, which means
+    // it's identical to the GdkPixbuf format.
+    convert_pixels_argb32_to_pixbuf(px, ebp.width, num_rows, stride,
+                                    /* RGBA to ARGB with A=0 */ ebp.background >> 8);
+
+    // If a custom bit depth or color type is asked, then convert rgb to grayscale, etc.
+    const guchar* new_data = pixbuf_to_png(rows, px, num_rows, ebp.width, stride, color_type, bit_depth);
+    g_free(px);
+
+    return new_data;
+}
+
 /**
  *
  */
@@ -340,32 +388,146 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     /* Update to renderable state */
     ebp->drawing->update(bbox);
 
-    int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, ebp->width);
-    unsigned char *px = g_new(guchar, num_rows * stride);
+    *to_free = (void*) sp_export_render_strip(*ebp, rows, row, num_rows, color_type, bit_depth);
 
-    cairo_surface_t *s = cairo_image_surface_create_for_data(
-        px, CAIRO_FORMAT_ARGB32, ebp->width, num_rows, stride);
-    Inkscape::DrawingContext dc(s, bbox.min());
-    dc.setSource(ebp->background);
-    dc.setOperator(CAIRO_OPERATOR_SOURCE);
-    dc.paint();
-    dc.setOperator(CAIRO_OPERATOR_OVER);
+    return num_rows;
+}
 
-    /* Render */
-    ebp->drawing->render(dc, bbox, 0);
-    cairo_surface_destroy(s);
+/**
+ * Renders the strips of an export as tasks on the shared render thread pool, and hands them out
+ * in order to the thread writing the PNG file.
+ *
+ * At most a fixed number of strips are rendered ahead of the one being written,
+ * so the memory used does not depend on the size of the image.
+ */
+class SPExportStripPipeline
+{
+public:
+    SPExportStripPipeline(SPEBP &ebp, int color_type, int bit_depth, int num_threads);
+    ~SPExportStripPipeline();
 
-    // PNG stores data as unpremultiplied big-endian RGBA, which means
-    // it's identical to the GdkPixbuf format.
-    convert_pixels_argb32_to_pixbuf(px, ebp->width, num_rows, stride,
-                                    /* RGBA to ARGB with A=0 */ ebp->background >> 8);
-    
-    // If a custom bit depth or color type is asked, then convert rgb to grayscale, etc.
-    const guchar* new_data = pixbuf_to_png(rows, px, num_rows, ebp->width, stride, color_type, bit_depth);
-    *to_free = (void*) new_data;
-    free(px);
+    int get_rows(guchar const **rows, void **to_free, int row);
 
-    return num_rows;
+private:
+    struct Strip
+    {
+        std::vector<guchar const *> rows;
+        guchar const *data;
+    };
+
+    void schedule();
+    void render(int index);
+
+    SPEBP &_ebp;
+    int const _color_type;
+    int const _bit_depth;
+    int const _num_strips;
+    int const _num_threads;
+    int const _max_ahead;
+
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    int _next_render = 0; ///< Index of the next strip to be handed to the pool.
+    int _next_write = 0;  ///< Index of the next strip to be written.
+    int _in_flight = 0;   ///< Number of strips handed to the pool and not yet finished.
+    bool _cancelled = false;
+    std::map<int, Strip> _done;
+};
+
+SPExportStripPipeline::SPExportStripPipeline(SPEBP &ebp, int color_type, int bit_depth, int num_threads)
+    : _ebp(ebp)
+    , _color_type(color_type)
+    , _bit_depth(bit_depth)
+    , _num_strips((ebp.height + ebp.sheight - 1) / ebp.sheight)
+    , _num_threads(num_threads)
+    , _max_ahead(2 * num_threads)
+{
+    auto lock = std::unique_lock(_mutex);
+    schedule();
+}
+
+SPExportStripPipeline::~SPExportStripPipeline()
+{
+    // Tasks still queued in the pool refer to us, so wait for them to notice the cancellation.
+    auto lock = std::unique_lock(_mutex);
+    _cancelled = true;
+    _cond.wait(lock, [this] { return _in_flight == 0; });
+
+    for (auto &[index, strip] : _done) {
+        free((void *)strip.data);
+    }
+}
+
+/// Hand out strips to the pool, up to the limits on concurrency and read-ahead.
+/// Called with the lock held.
+void SPExportStripPipeline::schedule()
+{
+    int const end = std::min(_num_strips, _next_write + _max_ahead);
+    while (!_cancelled && _in_flight < _num_threads && _next_render < end) {
+        int const index = _next_render++;
+        _in_flight++;
+        Inkscape::get_global_dispatch_pool().post([this, index] { render(index); });
+    }
+}
+
+void SPExportStripPipeline::render(int index)
+{
+    Strip strip;
+    bool cancelled;
+    {
+        auto lock = std::unique_lock(_mutex);
+        cancelled = _cancelled;
+    }
+
+    if (!cancelled) {
+        int const row = index * _ebp.sheight;
+        int const num_rows = std::min<int>(_ebp.sheight, _ebp.height - row);
+        strip.rows.resize(num_rows);
+        strip.data = sp_export_render_strip(_ebp, strip.rows.data(), row, num_rows, _color_type, _bit_depth);
+    }
+
+    auto lock = std::unique_lock(_mutex);
+    if (!cancelled) {
+        _done.emplace(index, std::move(strip));
+    }
+    _in_flight--;
+    schedule();
+    // Notify under the lock: once it is released, the destructor may have run.
+    _cond.notify_all();
+}
+
+/**
+ * Wait for the strip starting at @a row and pass ownership of its data to the caller.
+ * Strips must be requested in order.
+ */
+int SPExportStripPipeline::get_rows(guchar const **rows, void **to_free, int row)
+{
+    if (_ebp.status) {
+        if (!_ebp.status((float) row / _ebp.height, _ebp.data)) return 0;
+    }
+
+    int const index = row / _ebp.sheight;
+    assert(index == _next_write);
+
+    auto lock = std::unique_lock(_mutex);
+    _cond.wait(lock, [&, this] { return _done.count(index); });
+    auto node = _done.extract(index);
+    _next_write = index + 1;
+    schedule();
+    lock.unlock();
+
+    auto &strip = node.mapped();
+    std::copy(strip.rows.begin(), strip.rows.end(), rows);
+    *to_free = (void *)strip.data;
+
+    return strip.rows.size();
+}
+
+static int
+sp_export_get_rows_parallel(guchar const **rows, void **to_free, int row, int /*num_rows*/, void *data, int /*color_type*/, int /*bit_depth*/)
+{
+    auto pipeline = static_cast<SPExportStripPipeline *>(static_cast<SPEBP *>(data)->pipeline);
+    return pipeline->get_rows(rows, to_free, row);
 }
 
 ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
@@ -374,10 +536,12 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 unsigned long bgcolor,
                                 unsigned int (*status) (float, void *),
                                 void *data, bool force_overwrite,
-                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                int strip_height, int num_threads)
 {
     return sp_export_png_file(doc, filename, Geom::Rect(Geom::Point(x0,y0),Geom::Point(x1,y1)),
-                              width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing);
+                              width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing,
+                              strip_height, num_threads);
 }
 
 /**
@@ -391,7 +555,8 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 unsigned long bgcolor,
                                 unsigned (*status)(float, void *),
                                 void *data, bool force_overwrite,
-                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+                                const std::vector<SPItem const *> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                int strip_height, int num_threads)
 {
     g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
     g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
@@ -452,15 +617,31 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 
     ebp.status = status;
     ebp.data   = data;
+    ebp.pipeline = nullptr;
+
+    bool write_status = false;
 
-    bool write_status = false;;
+    ebp.sheight = std::min<unsigned long>(std::max(strip_height, 1), height);
 
-    ebp.sheight = 64;
-    ebp.px = g_try_new(guchar, 4 * ebp.sheight * width);
+    if (num_threads <= 0) {
+        auto const fallback = std::max<int>(std::thread::hardware_concurrency(), 1);
+        num_threads = Inkscape::Preferences::get()->getIntLimited("/options/threading/numthreads", fallback, 1, 256);
+    }
 
-    if (ebp.px) {
+    // Interlaced images are written in several passes over all the rows, so they are rendered on demand.
+    if (interlace || num_threads <= 1 || height <= ebp.sheight) {
         write_status = sp_png_write_rgba_striped(doc, filename, width, height, xdpi, ydpi, sp_export_get_rows, &ebp, interlace, color_type, bit_depth, zlib);
-        g_free(ebp.px);
+    } else {
+        // Update the whole area up front, then freeze the drawing so that it can be rendered from several threads.
+        drawing.update(Geom::IntRect::from_xywh(0, 0, width, height));
+        drawing.snapshot();
+        {
+            SPExportStripPipeline pipeline(ebp, color_type, bit_depth, num_threads);
+            ebp.pipeline = &pipeline;
+            write_status = sp_png_write_rgba_striped(doc, filename, width, height, xdpi, ydpi, sp_export_get_rows_parallel, &ebp, interlace, color_type, bit_depth, zlib);
+            ebp.pipeline = nullptr;
+        }
+        drawing.unsnapshot();
     }
 
     // Hide items, this releases arenaitem
@@ -32,6 +32,10 @@ enum ExportResult {
 /**
  * Export the given document as a Portable Network Graphics (PNG) file.
  *
+ * The image is rendered in strips of @a strip_height rows. Unless interlacing is requested, the strips
+ * are rendered by @a num_threads worker threads while the calling thread compresses them in order.
+ * If @a num_threads is zero or negative, the "/options/threading/numthreads" preference is used.
+ *
  * @return EXPORT_OK if succeeded, EXPORT_ABORTED if no action was taken, EXPORT_ERROR (false) if an error occurred.
  */
 ExportResult sp_export_png_file(SPDocument *doc,
@@ -50,7 +54,9 @@ ExportResult sp_export_png_file(SPDocument *doc,
                                 int color_type = 6,
                                 int bit_depth = 8,
                                 int zlib = 6,
-                                int antialiasing = 2);
+                                int antialiasing = 2,
+                                int strip_height = 64,
+                                int num_threads = 0);
 
 ExportResult sp_export_png_file(SPDocument *doc,
                                 gchar const *filename,
@@ -68,6 +74,8 @@ ExportResult sp_export_png_file(SPDocument *doc,
                                 int color_type = 6,
                                 int bit_depth = 8,
                                 int zlib = 6,
-                                int antialiasing = 2);
+                                int antialiasing = 2,
+                                int strip_height = 64,
+                                int num_threads = 0);
 
 #endif // SEEN_SP_PNG_WRITE_H
@@ -57,6 +57,8 @@ struct Ops {
     void (*enable)();
     void (*disable)();
     void (*free)(void *ptr);
+    bool (*register_thread)();
+    void (*unregister_thread)();
 };
 
 struct Core {
@@ -112,10 +114,37 @@ public:
     static inline void free(void *ptr) {
         return _ops.free(ptr);
     }
+    static inline bool register_thread() {
+        return _ops.register_thread();
+    }
+    static inline void unregister_thread() {
+        _ops.unregister_thread();
+    }
 private:
     static Ops _ops;
 };
 
+/**
+ * Registers the thread creating it with the collector, for as long as it lives, so that the
+ * thread may allocate collected memory and keep it reachable from its stack.
+ * Threads other than the main thread must do this before using any collected memory.
+ */
+class ThreadRegistration {
+public:
+    ThreadRegistration() : _registered(Core::register_thread()) {}
+    ~ThreadRegistration() {
+        if (_registered) {
+            Core::unregister_thread();
+        }
+    }
+
+    ThreadRegistration(ThreadRegistration const &) = delete;
+    ThreadRegistration &operator=(ThreadRegistration const &) = delete;
+
+private:
+    bool _registered;
+};
+
 inline void init() {
     Core::init();
 }
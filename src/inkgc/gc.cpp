@@ -10,6 +10,10 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+// Declare the functions for registering threads, without redirecting thread creation to the
+// collector.
+#define GC_THREADS
+#define GC_NO_THREAD_REDIRECTS
 #include "inkgc/gc-core.h"
 #include <stdexcept>
 #include <cstring>
@@ -34,10 +38,24 @@ void do_init() {
     GC_set_finalize_on_demand(0);
 
     GC_INIT();
+    GC_allow_register_threads();
 
     GC_set_warn_proc(&display_warning);
 }
 
+bool register_thread() {
+    GC_stack_base base;
+    if (GC_get_stack_base(&base) != GC_SUCCESS) {
+        return false;
+    }
+    // Not for the main thread, nor any other thread registered already.
+    return GC_register_my_thread(&base) == GC_SUCCESS;
+}
+
+void unregister_thread() {
+    GC_unregister_my_thread();
+}
+
 void *debug_malloc(std::size_t size) {
     return GC_debug_malloc(size, GC_EXTRAS);
 }
@@ -109,6 +127,10 @@ void dummy_enable() {}
 
 void dummy_disable() {}
 
+bool dummy_register_thread() { return false; }
+
+void dummy_unregister_thread() {}
+
 Ops enabled_ops = {
     &do_init,
     &GC_malloc,
@@ -128,7 +150,9 @@ Ops enabled_ops = {
     &GC_gcollect,
     &GC_enable,
     &GC_disable,
-    &GC_free
+    &GC_free,
+    &register_thread,
+    &unregister_thread
 };
 
 Ops debug_ops = {
@@ -146,7 +170,9 @@ Ops debug_ops = {
     &GC_gcollect,
     &GC_enable,
     &GC_disable,
-    &GC_debug_free
+    &GC_debug_free,
+    &register_thread,
+    &unregister_thread
 };
 
 Ops disabled_ops = {
@@ -164,7 +190,9 @@ Ops disabled_ops = {
     &dummy_gcollect,
     &dummy_enable,
     &dummy_disable,
-    &std::free
+    &std::free,
+    &dummy_register_thread,
+    &dummy_unregister_thread
 };
 
 class InvalidGCModeError : public std::runtime_error {
@@ -247,6 +275,15 @@ void stub_free(void *) {
     die_because_not_initialized();
 }
 
+bool stub_register_thread() {
+    die_because_not_initialized();
+    return false;
+}
+
+void stub_unregister_thread() {
+    die_because_not_initialized();
+}
+
 }
 
 Ops Core::_ops = {
@@ -264,7 +301,9 @@ Ops Core::_ops = {
     &stub_gcollect,
     &stub_enable,
     &stub_disable,
-    &stub_free
+    &stub_free,
+    &stub_register_thread,
+    &stub_unregister_thread
 };
 
 void Core::init() {
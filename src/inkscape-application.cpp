@@ -53,6 +53,8 @@
 
 #include <giomm/file.h>
 #include <glibmm/i18n.h>  // Internationalization
+#include <glibmm/main.h>
+#include <glibmm/shell.h> // Batch export job parsing
 #include <gtkmm/application.h>
 #include <gtkmm/recentmanager.h>
 
@@ -63,6 +65,7 @@
 #include "document.h"
 #include "file.h"                   // sp_file_convert_dpi
 #include "inkscape.h"               // Inkscape::Application
+#include "message-stack.h"
 #include "selection.h"
 #include "path-prefix.h"            // Data directory
 
@@ -86,6 +89,7 @@
 #include "actions/actions-transform.h"
 #include "actions/actions-tutorial.h"
 #include "actions/actions-window.h"
+#include "async/background-task.h"
 #include "debug/logger.h"           // INKSCAPE_DEBUG_LOG support
 #include "extension/db.h"
 #include "extension/effect.h"
@@ -105,6 +109,8 @@
 #include "ui/tools/shortcuts.h"
 #include "ui/widget/desktop-widget.h"
 #include "util/scope_exit.h"
+#include "xml/repr.h"               // SP_SVG_NS_URI
+#include "xml/repr-reader.h"
 
 #ifdef ENABLE_NLS
 // Native Language Support - shouldn't this always be used?
@@ -167,9 +173,15 @@ std::pair<SPDocument *, bool> InkscapeApplication::document_open(Glib::RefPtr<Gi
     if (cancelled) {
         return {nullptr, true};
     }
+    return {document_opened(file, std::move(document)), false};
+}
+
+// Add a document opened from a file to app.
+SPDocument *InkscapeApplication::document_opened(Glib::RefPtr<Gio::File> const &file, std::unique_ptr<SPDocument> document)
+{
     if (!document) {
         std::cerr << "InkscapeApplication::document_open: Failed to open: " << file->get_parse_name().raw() << std::endl;
-        return {nullptr, false};
+        return nullptr;
     }
 
     document->setVirgin(false); // Prevents replacing document in same window during file open.
@@ -200,7 +212,88 @@ std::pair<SPDocument *, bool> InkscapeApplication::document_open(Glib::RefPtr<Gi
         }
     }
 
-    return {document_add(std::move(document)), false};
+    return document_add(std::move(document));
+}
+
+/// A document being opened in the background, see document_open_in_background().
+struct InkscapeApplication::Opening
+{
+    InkscapeWindow *window = nullptr; ///< Shows the progress; closing it stops the opening.
+    Inkscape::MessageId message = 0;
+    bool read = false;      ///< The whole file was read into nodes.
+    bool cancelled = false;
+    std::unique_ptr<Inkscape::XML::FileReader> reader;
+    // After the reader: destroying the task waits for its thread, which uses the reader.
+    std::unique_ptr<Inkscape::Async::BackgroundTask<bool, double>> task;
+    std::unique_ptr<SPDocument> document;
+};
+
+/** Open a document in a window, reading the file into XML nodes on a background thread, so that
+ *  the windows already open keep responding. The objects are then built on the main thread, and
+ *  the document is shown in an idle callback after that.
+ */
+void InkscapeApplication::document_open_in_background(Glib::RefPtr<Gio::File> const &file)
+{
+    auto const opening = _opening.emplace(_opening.end());
+    opening->window = _active_window;
+    // Created here, as it reads the preferences.
+    opening->reader = std::make_unique<Inkscape::XML::FileReader>(file->get_path().c_str(), SP_SVG_NS_URI);
+
+    auto const show_progress = [opening] (char const *message) {
+        auto const messages = opening->window->get_desktop()->messageStack();
+        messages->cancel(opening->message);
+        opening->message = message ? messages->push(Inkscape::NORMAL_MESSAGE, message) : 0;
+    };
+
+    opening->task.reset(new Inkscape::Async::BackgroundTask<bool, double>({
+        .work = [reader = opening->reader.get()] (auto &progress) {
+            // The nodes are allocated by the garbage collector.
+            Inkscape::GC::ThreadRegistration registration;
+            // Short slices, as closing the window waits for the current one.
+            while (reader->read(std::chrono::milliseconds(20))) {
+                progress.report_or_throw(reader->progress());
+            }
+            reader->complete();
+            return true;
+        },
+        .on_progress = [show_progress, name = file->get_parse_name()] (double fraction) {
+            auto const message = Glib::ustring::compose(_("Opening %1..."), name) + " " +
+                                 std::to_string(static_cast<int>(fraction * 100)) + "%";
+            show_progress(message.c_str());
+        },
+        .throttle_time = std::chrono::milliseconds(100),
+        .on_complete = [opening] (bool) { opening->read = true; },
+        .on_finished = [this, opening, show_progress, file] {
+            show_progress(nullptr);
+            // The task cannot be deleted while it runs this.
+            Glib::signal_idle().connect_once([this, opening, file] { document_build_opened(opening, file); });
+        },
+    }));
+}
+
+/** Build the objects of a document read by document_open_in_background(), then show it once the
+ *  main loop is idle again. Building the objects cannot be split up, as objects are live as soon
+ *  as they are built and building recurses through the tree.
+ */
+void InkscapeApplication::document_build_opened(std::list<Opening>::iterator opening, Glib::RefPtr<Gio::File> const &file)
+{
+    if (opening->cancelled || !opening->read) {
+        _opening.erase(opening);
+        return;
+    }
+
+    opening->task.reset();
+    opening->document = ink_file_open(file, opening->reader->finish());
+    opening->reader.reset();
+
+    Glib::signal_idle().connect_once([this, opening, file] {
+        auto document = std::move(opening->document);
+        bool const cancelled = opening->cancelled;
+        _opening.erase(opening);
+        if (!cancelled) {
+            window_for_opened(file, document_opened(file, std::move(document)), false);
+        }
+    });
 }
 
 // Open a document, add it to app.
@@ -459,6 +552,16 @@ void InkscapeApplication::window_close(InkscapeWindow *window)
     auto document = window->get_document();
     assert(document);
 
+    // Stop opening documents in this window.
+    for (auto &opening : _opening) {
+        if (opening.window == window) {
+            opening.cancelled = true;
+            if (opening.task && opening.task->is_running()) {
+                opening.task->cancel();
+            }
+        }
+    }
+
     // To be removed (remove once per window)!
     INKSCAPE.remove_document(document);
 
@@ -739,6 +842,8 @@ InkscapeApplication::InkscapeApplication()
     gapp->add_main_option_entry(T::OptionType::STRING,   "export-png-compression", '\0', N_("Compression level for PNG export (0 to 9); default is 6"), N_("LEVEL"));
     // FIXME: Antialias should really be an INT, but an upstream bug means 0 is detected as NULL
     gapp->add_main_option_entry(T::OptionType::STRING,   "export-png-antialias",   '\0', N_("Antialias level for PNG export (0 to 3); default is 2"),   N_("LEVEL"));
+    gapp->add_main_option_entry(T::OptionType::INT,      "export-png-strip-height", '\0', N_("Number of rows rendered at once for PNG export; default is 64"), N_("ROWS"));
+    gapp->add_main_option_entry(T::OptionType::INT,      "export-png-threads",     '\0', N_("Number of threads rendering PNG export; default is from preferences"), N_("COUNT"));
 
     // Query - Geometry
     _start_main_option_section(_("Query object/document geometry"));
@@ -766,6 +871,7 @@ InkscapeApplication::InkscapeApplication()
     gapp->add_main_option_entry(T::OptionType::BOOL,     "batch-process",         '\0', N_("Close GUI after executing all actions"),                                    "");
     _start_main_option_section();
     gapp->add_main_option_entry(T::OptionType::BOOL,     "shell",                 '\0', N_("Start Inkscape in interactive shell mode"),                                 "");
+    gapp->add_main_option_entry(T::OptionType::BOOL,     "batch-export",          '\0', N_("Read export jobs from standard input, one per line, until end of input"),  "");
     gapp->add_main_option_entry(T::OptionType::BOOL,     "active-window",          'q', N_("Use active window from commandline"),                                       "");
     // clang-format on
 
@@ -828,39 +934,52 @@ void InkscapeApplication::create_window(Glib::RefPtr<Gio::File> const &file)
         return;
     }
 
-    SPDocument* document = nullptr;
-    InkscapeWindow* window = nullptr;
-    bool cancelled = false;
-
     if (file) {
         startup_close();
-        std::tie(document, cancelled) = document_open(file);
-        if (document) {
-            // Remember document so much that we'll add it to recent documents
-            auto recentmanager = Gtk::RecentManager::get_default();
-            recentmanager->add_item (file->get_uri());
-
-            SPDocument* old_document = _active_document;
-            bool replace = old_document && old_document->getVirgin();
-
-            window = create_window(document, replace);
-            document_fix(window);
-        } else if (!cancelled) {
-            std::cerr << "InkscapeApplication::create_window: Failed to load: "
-                      << file->get_parse_name().raw() << std::endl;
-
-            gchar *text = g_strdup_printf(_("Failed to load the requested file %s"), file->get_parse_name().c_str());
-            sp_ui_error_dialog(text);
-            g_free(text);
+        if (_active_window && INKSCAPE.get_pages().empty() && ink_file_is_local_svg(file)) {
+            document_open_in_background(file);
+        } else {
+            auto [document, cancelled] = document_open(file);
+            window_for_opened(file, document, cancelled);
         }
+        return;
+    }
 
+    SPDocument *document = document_new();
+    InkscapeWindow *window = nullptr;
+    if (document) {
+        window = window_open(document);
     } else {
-        document = document_new();
-        if (document) {
-            window = window_open(document);
-        } else {
-            std::cerr << "InkscapeApplication::create_window: Failed to open default document!" << std::endl;
-        }
+        std::cerr << "InkscapeApplication::create_window: Failed to open default document!" << std::endl;
+    }
+
+    _active_document = document;
+    _active_window   = window;
+}
+
+/** Show a document just opened from a file in a window, or tell why it could not be opened.
+ */
+void InkscapeApplication::window_for_opened(Glib::RefPtr<Gio::File> const &file, SPDocument *document, bool cancelled)
+{
+    InkscapeWindow* window = nullptr;
+
+    if (document) {
+        // Remember document so much that we'll add it to recent documents
+        auto recentmanager = Gtk::RecentManager::get_default();
+        recentmanager->add_item (file->get_uri());
+
+        SPDocument* old_document = _active_document;
+        bool replace = old_document && old_document->getVirgin();
+
+        window = create_window(document, replace);
+        document_fix(window);
+    } else if (!cancelled) {
+        std::cerr << "InkscapeApplication::create_window: Failed to load: "
+                  << file->get_parse_name().raw() << std::endl;
+
+        gchar *text = g_strdup_printf(_("Failed to load the requested file %s"), file->get_parse_name().c_str());
+        sp_ui_error_dialog(text);
+        g_free(text);
     }
 
     _active_document = document;
@@ -1033,6 +1152,11 @@ InkscapeApplication::on_startup()
 void
 InkscapeApplication::on_activate()
 {
+    if (_use_batch_export) {
+        batch_export();
+        return;
+    }
+
     std::string output;
 
     // Create new document, either from pipe or from template.
@@ -1360,6 +1484,147 @@ InkscapeApplication::shell(bool active_window)
     }
 }
 
+/**
+ * Long-running export mode.
+ *
+ * Reads export jobs from standard input, one per line, and exports each of them in turn, so that
+ * fonts, extensions and preferences only have to be loaded once for any number of documents.
+ * A job is a list of shell-quoted KEY=VALUE words, for example:
+ *
+ *   input=drawing.svg type=png area=page dpi=300 id=layer1 id-only=true
+ *
+ * Recognised keys are input (required), output, type, area (page, drawing or x0:y0:x1:y1), dpi,
+ * width, height, margin, id, id-only, background, background-opacity and overwrite. Options given
+ * on the command line act as defaults for every job. For each job a single line is written to
+ * standard output with its status and the time spent opening and exporting the document.
+ *
+ * Jobs are processed sequentially: the document model is not thread-safe. PNG export renders
+ * each image on multiple threads.
+ */
+void InkscapeApplication::batch_export()
+{
+    using Clock = std::chrono::steady_clock;
+    auto const ms_since = [] (Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    unsigned job = 0;
+    std::string line;
+
+    while (std::getline(std::cin, line)) {
+        // Also drop the carriage return of job files with Windows line endings.
+        line = std::regex_replace(line, std::regex("^[ \t\r]+|[ \t\r]+$"), "");
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        job++;
+
+        auto const report_error = [&] (std::string const &message) {
+            std::cout << "job " << job << " error " << message << std::endl;
+        };
+
+        std::vector<std::string> words;
+        try {
+            words = Glib::shell_parse_argv(line);
+        } catch (Glib::ShellError const &e) {
+            report_error(e.what());
+            continue;
+        }
+
+        // Each job starts from the options given on the command line.
+        auto cmd = _file_export;
+        std::string input;
+        bool valid = true;
+
+        for (auto const &word : words) {
+            auto const eq = word.find('=');
+            if (eq == std::string::npos) {
+                report_error("malformed option '" + word + "'");
+                valid = false;
+                break;
+            }
+            auto const key = word.substr(0, eq);
+            auto const value = word.substr(eq + 1);
+
+            try {
+                if (key == "input") {
+                    input = value;
+                } else if (key == "output") {
+                    cmd.export_filename = value;
+                } else if (key == "type") {
+                    cmd.export_type = value;
+                } else if (key == "area") {
+                    if (value == "page") {
+                        cmd.set_export_area_type(ExportAreaType::Page);
+                    } else if (value == "drawing") {
+                        cmd.set_export_area_type(ExportAreaType::Drawing);
+                    } else {
+                        cmd.set_export_area(value);
+                    }
+                } else if (key == "dpi") {
+                    cmd.export_dpi = std::stod(value);
+                } else if (key == "width") {
+                    cmd.export_width = std::stoi(value);
+                } else if (key == "height") {
+                    cmd.export_height = std::stoi(value);
+                } else if (key == "margin") {
+                    cmd.export_margin = std::stoi(value);
+                } else if (key == "id") {
+                    cmd.export_id = value;
+                } else if (key == "id-only") {
+                    cmd.export_id_only = value == "true" || value == "1";
+                } else if (key == "background") {
+                    cmd.export_background = value;
+                } else if (key == "background-opacity") {
+                    cmd.export_background_opacity = std::stod(value);
+                } else if (key == "overwrite") {
+                    cmd.export_overwrite = value == "true" || value == "1";
+                } else {
+                    report_error("unknown option '" + key + "'");
+                    valid = false;
+                    break;
+                }
+            } catch (std::logic_error const &) {
+                report_error("invalid value for option '" + key + "'");
+                valid = false;
+                break;
+            }
+        }
+
+        if (!valid) {
+            continue;
+        }
+        if (input.empty()) {
+            report_error("no input file");
+            continue;
+        }
+
+        auto const start = Clock::now();
+        auto [document, cancelled] = ink_file_open(Gio::File::create_for_commandline_arg(input));
+        if (!document) {
+            report_error("failed to open " + input);
+            continue;
+        }
+        INKSCAPE.add_document(document.get());
+        document->ensureUpToDate();
+        auto const open_time = ms_since(start);
+
+        auto const export_start = Clock::now();
+        cmd.do_export(document.get(), input);
+        auto const export_time = ms_since(export_start);
+
+        INKSCAPE.remove_document(document.get());
+        document.reset();
+
+        std::cout << "job " << job << " done " << input
+                  << std::fixed << std::setprecision(1)
+                  << " open=" << open_time << "ms"
+                  << " export=" << export_time << "ms"
+                  << " total=" << ms_since(start) << "ms"
+                  << std::defaultfloat << std::endl;
+    }
+}
+
 // Todo: Code can be improved by using proper IPC rather than temporary file polling.
 void InkscapeApplication::redirect_output()
 {
@@ -1520,6 +1785,8 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
         options->contains("export-png-use-dithering") ||
         options->contains("export-png-compression") ||
         options->contains("export-png-antialias") ||
+        options->contains("export-png-strip-height") ||
+        options->contains("export-png-threads") ||
 
         options->contains("query-id")              ||
         options->contains("query-x")               ||
@@ -1534,7 +1801,8 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
         options->contains("action-list")           ||
         options->contains("actions")               ||
         options->contains("actions-file")          ||
-        options->contains("shell")
+        options->contains("shell")                 ||
+        options->contains("batch-export")
         ) {
         _with_gui = false;
     }
@@ -1550,6 +1818,7 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
     if (options->contains("batch-process"))  _batch_process = true;
     if (options->contains("shell"))          _use_shell = true;
     if (options->contains("pipe"))           _use_pipe  = true;
+    if (options->contains("batch-export"))   _use_batch_export = true;
 
     // Enable auto-export
     if (options->contains("export-filename")  ||
@@ -1812,6 +2081,14 @@ InkscapeApplication::on_handle_local_options(const Glib::RefPtr<Glib::VariantDic
             _file_export.export_png_antialias = (int) ival;
         }
     }
+
+    if (options->contains("export-png-strip-height")) {
+        options->lookup_value("export-png-strip-height", _file_export.export_png_strip_height);
+    }
+
+    if (options->contains("export-png-threads")) {
+        options->lookup_value("export-png-threads", _file_export.export_png_threads);
+    }
     
     if (use_active_window) {
         _gio_application->register_application();
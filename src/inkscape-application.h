@@ -10,7 +10,9 @@
 #ifndef INKSCAPE_APPLICATION_H
 #define INKSCAPE_APPLICATION_H
 
+#include <list>
 #include <map>
+#include <memory>
 #include <span>
 #include <string>
 #include <utility>
@@ -135,6 +137,7 @@ protected:
     bool _batch_process = false; // Temp
     bool _use_shell   = false;
     bool _use_pipe    = false;
+    bool _use_batch_export = false;
     bool _auto_export = false;
     int _pdf_poppler  = false;
     FontStrategy _pdf_font_strategy = FontStrategy::RENDER_MISSING;
@@ -183,12 +186,20 @@ protected:
     void on_about();
     void redirect_output();
     void shell(bool active_window = false);
+    void batch_export();
 
     void _start_main_option_section(const Glib::ustring& section_name = "");
     
 private:
     void init_extension_action_data();
     std::vector<Glib::RefPtr<Gio::SimpleAction>> _effect_actions;
+
+    struct Opening;
+    void document_open_in_background(Glib::RefPtr<Gio::File> const &file);
+    void document_build_opened(std::list<Opening>::iterator opening, Glib::RefPtr<Gio::File> const &file);
+    SPDocument *document_opened(Glib::RefPtr<Gio::File> const &file, std::unique_ptr<SPDocument> document);
+    void window_for_opened(Glib::RefPtr<Gio::File> const &file, SPDocument *document, bool cancelled);
+    std::list<Opening> _opening; ///< Documents being opened in the background.
 };
 
 #endif // INKSCAPE_APPLICATION_H
@@ -74,6 +74,8 @@ InkFileExportCmd::InkFileExportCmd()
     , export_plain_svg(false)
     ,export_png_compression(6)
     ,export_png_antialias(2)
+    ,export_png_strip_height(64)
+    ,export_png_threads(0)
 {
 }
 
@@ -797,7 +799,8 @@ InkFileExportCmd::do_export_png_now(SPDocument *doc, std::string const &filename
 
         if( sp_export_png_file(doc, filename_out.c_str(), area, width, height, xdpi, ydpi,
                                bgcolor, nullptr, nullptr, true, export_id_only ? items : std::vector<SPItem const *>(),
-                               false, color_type, bit_depth, export_png_compression, export_png_antialias) == 1 ) {
+                               false, color_type, bit_depth, export_png_compression, export_png_antialias,
+                               export_png_strip_height, export_png_threads) == 1 ) {
         } else {
             std::cerr << "InkFileExport::do_export_png: Failed to export to " << filename_out << std::endl;
         }
@@ -87,6 +87,8 @@ public:
     bool          export_png_use_dithering;
     int           export_png_compression;
     int           export_png_antialias;
+    int           export_png_strip_height;
+    int           export_png_threads;
     void set_export_area(const Glib::ustring &area);
     void set_export_area_type(ExportAreaType type);
 };
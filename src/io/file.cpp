@@ -10,6 +10,7 @@
 
 #include "io/file.h"
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <unistd.h>
@@ -121,6 +122,47 @@ std::pair<std::unique_ptr<SPDocument>, bool> ink_file_open(Glib::RefPtr<Gio::Fil
     return {std::move(doc), false};
 }
 
+/**
+ * Whether the file is a local file that Extension::open() would read with the SVG input, so that
+ * it can also be read on a background thread with Inkscape::XML::FileReader.
+ */
+bool ink_file_is_local_svg(Glib::RefPtr<Gio::File> const &file)
+{
+    auto const path = file->get_path();
+    if (path.empty()) {
+        return false;
+    }
+
+    // The input that Extension::open() would pick.
+    Inkscape::Extension::DB::InputList inputs;
+    for (auto input : Inkscape::Extension::db.get_input_list(inputs)) {
+        if (input->can_open_filename(path.c_str())) {
+            return !std::strcmp(input->get_id(), SP_MODULE_KEY_INPUT_SVG) ||
+                   !std::strcmp(input->get_id(), SP_MODULE_KEY_INPUT_SVGZ);
+        }
+    }
+    return false;
+}
+
+/**
+ * Open a document from the tree read from a local SVG file, as ink_file_open(file) would with
+ * the SVG input; takes over @a rdoc, which may be nullptr if the file could not be read.
+ */
+std::unique_ptr<SPDocument> ink_file_open(Glib::RefPtr<Gio::File> const &file, Inkscape::XML::Document *rdoc)
+{
+    auto const path = file->get_path();
+
+    auto doc = SPDocument::createNewDoc(rdoc, path.c_str(), true);
+    if (!doc) {
+        std::cerr << "ink_file_open: '" << path << "' cannot be opened!" << std::endl;
+        return nullptr;
+    }
+
+    doc->setDocumentFilename(path.c_str());
+    set_inkscape_and_svg_versions(doc->getRoot());
+    return doc;
+}
+
 namespace Inkscape::IO {
 
 /**
@@ -23,10 +23,17 @@ class File;
 
 class SPDocument;
 
+namespace Inkscape::XML {
+class Document;
+} // namespace Inkscape::XML
+
 std::unique_ptr<SPDocument> ink_file_new(std::string const &Template = "");
 std::unique_ptr<SPDocument> ink_file_open(std::span<char const> buffer);
 std::pair<std::unique_ptr<SPDocument>, bool /*cancelled*/> ink_file_open(Glib::RefPtr<Gio::File> const &file);
 
+bool ink_file_is_local_svg(Glib::RefPtr<Gio::File> const &file);
+std::unique_ptr<SPDocument> ink_file_open(Glib::RefPtr<Gio::File> const &file, Inkscape::XML::Document *rdoc);
+
 namespace Inkscape::IO {
 
 class TempFilename {
@@ -380,25 +380,15 @@ void GzipOutputStream::flush()
     }
 	
     uLong srclen = inputBuf.size();
-    Bytef *srcbuf = new (std::nothrow) Bytef [srclen];
-    if (!srcbuf)
-        {
-        return;
-        }
-        
+    Bytef *srcbuf = inputBuf.data();
+
     uLong destlen = srclen;
     Bytef *destbuf = new (std::nothrow) Bytef [(destlen + (srclen/100) + 13)];
     if (!destbuf)
         {
-        delete[] srcbuf;
         return;
         }
-        
-    std::vector<unsigned char>::iterator iter;
-    Bytef *p = srcbuf;
-    for (iter=inputBuf.begin() ; iter != inputBuf.end() ; ++iter)
-        *p++ = *iter;
-        
+
     crc = crc32(crc, const_cast<const Bytef *>(srcbuf), srclen);
     
     int zerr = compress(destbuf, static_cast<uLongf *>(&destlen), srcbuf, srclen);
@@ -409,15 +399,14 @@ void GzipOutputStream::flush()
 
     totalOut += destlen;
     //skip the redundant zlib header and checksum
-    for (uLong i=2; i<destlen-4 ; i++)
+    if (destlen > 6)
         {
-        destination.put((int)destbuf[i]);
+        destination.write(reinterpret_cast<char const *>(destbuf) + 2, destlen - 6);
         }
         
     destination.flush();
 
     inputBuf.clear();
-    delete[] srcbuf;
     delete[] destbuf;
 }
 
@@ -441,6 +430,20 @@ int GzipOutputStream::put(char ch)
     return 1;
 }
 
+/**
+ * Writes the specified bytes to this output stream.
+ */ 
+void GzipOutputStream::write(char const *data, std::size_t size)
+{
+    if (closed)
+        {
+        return;
+        }
+
+    inputBuf.insert(inputBuf.end(), data, data + size);
+    totalIn += size;
+}
+
 
 
 } // namespace IO
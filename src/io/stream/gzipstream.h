@@ -97,6 +97,8 @@ public:
     
     int put(char ch) override;
 
+    void write(char const *data, std::size_t size) override;
+
 private:
 
     std::vector<unsigned char> inputBuf;
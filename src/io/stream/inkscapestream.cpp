@@ -13,6 +13,7 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include "inkscapestream.h"
 
 namespace Inkscape
@@ -91,6 +92,15 @@ int BasicInputStream::get()
 //# B A S I C    O U T P U T    S T R E A M
 //#########################################################################
 
+/**
+ * Writes the specified bytes to this output stream, one at a time.
+ */
+void OutputStream::write(char const *data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i++)
+        put(data[i]);
+}
+
 /**
  *
  */ 
@@ -469,6 +479,16 @@ void BasicWriter::put(char ch)
         destination->put(ch);
 }
 
+/**
+ * Writes the specified bytes to this output writer.
+ */
+Writer &BasicWriter::write(char const *data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; i++)
+        put(data[i]);
+    return *this;
+}
+
 /**
  * Provide printf()-like formatting
  */ 
@@ -508,10 +528,7 @@ Writer &BasicWriter::writeUString(const Glib::ustring &str)
  */ 
 Writer &BasicWriter::writeStdString(const std::string &str)
 {
-    for (char it : str) {
-        put(it);
-    }
-    return *this;
+    return write(str.data(), str.size());
 }
 
 /**
@@ -519,13 +536,9 @@ Writer &BasicWriter::writeStdString(const std::string &str)
  */ 
 Writer &BasicWriter::writeString(const char *str)
 {
-    std::string tmp;
-    if (str)
-        tmp = str;
-    else
-        tmp = "null";
-    writeStdString(tmp);
-    return *this;
+    if (!str)
+        str = "null";
+    return write(str, strlen(str));
 }
 
 
@@ -740,6 +753,15 @@ void OutputStreamWriter::put(char ch)
     outputStream.put(ch);
 }
 
+/**
+ *  Pass blocks of output to the OutputStream whole.
+ */
+Writer &OutputStreamWriter::write(char const *data, std::size_t size)
+{
+    outputStream.write(data, size);
+    return *this;
+}
+
 //#########################################################################
 //# S T D    W R I T E R
 //#########################################################################
@@ -10,6 +10,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <cstddef>
 #include <cstdio>
 #include <glibmm/ustring.h>
 
@@ -194,6 +195,13 @@ public:
      */
     virtual int put(char ch) = 0;
 
+    /**
+     * Send @a size bytes to the destination stream.  The default
+     * calls put() for each of them; endpoints that can take a
+     * whole block at once should override it.
+     */
+    virtual void write(char const *data, std::size_t size);
+
 
 }; // class OutputStream
 
@@ -474,6 +482,11 @@ public:
     virtual void flush() = 0;
     
     virtual void put(char ch) = 0;
+
+    /**
+     * Write @a size bytes, as they are.
+     */
+    virtual Writer& write(char const *data, std::size_t size) = 0;
     
     /* Formatted output */
     virtual Writer& printf(char const *fmt, ...) G_GNUC_PRINTF(2,3) = 0;
@@ -529,7 +542,7 @@ public:
     
     void put(char ch) override;
     
-    
+    Writer& write(char const *data, std::size_t size) override;
     
     /* Formatted output */
     Writer &printf(char const *fmt, ...) override G_GNUC_PRINTF(2,3);
@@ -620,6 +633,8 @@ public:
     
     void put(char ch) override;
 
+    Writer& write(char const *data, std::size_t size) override;
+
 
 private:
 
@@ -115,6 +115,14 @@ int StringOutputStream::put(char ch)
 	return 1;
 }
 
+/**
+ * Writes the specified bytes to this output stream.
+ */ 
+void StringOutputStream::write(char const *data, std::size_t size)
+{
+    buffer.append(data, data + size);
+}
+
 
 } // namespace IO
 } // namespace Inkscape
@@ -156,7 +156,18 @@ int FileOutputStream::put(char ch)
     return 1;
 }
 
-
+/**
+ * Writes the specified bytes to this output stream.
+ */
+void FileOutputStream::write(char const *data, std::size_t size)
+{
+    if (!outf)
+        return;
+    if (fwrite(data, 1, size, outf) != size) {
+        Glib::ustring err = "ERROR writing to file ";
+        throw StreamException(err);
+    }
+}
 
 
 
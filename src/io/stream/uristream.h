@@ -80,6 +80,8 @@ public:
 
     int put(char ch) override;
 
+    void write(char const *data, std::size_t size) override;
+
 private:
 
     bool ownsFile;
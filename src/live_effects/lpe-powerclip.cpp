@@ -117,8 +117,9 @@ Geom::PathVector LPEPowerClip::getClipPathvector()
                     }
                     if (!childitem->style || !childitem->style->display.set ||
                         childitem->style->display.value != SP_CSS_DISPLAY_NONE) {
-                        childitem->style->display.set = TRUE;
-                        childitem->style->display.value = SP_CSS_DISPLAY_NONE;
+                        auto &display = childitem->writableStyle()->display;
+                        display.set = TRUE;
+                        display.value = SP_CSS_DISPLAY_NONE;
                         childitem->updateRepr(SP_OBJECT_WRITE_NO_CHILDREN | SP_OBJECT_WRITE_EXT);
                     }
                 }
@@ -248,8 +249,9 @@ LPEPowerClip::doOnRemove (SPLPEItem const* /*lpeitem*/)
             if (childitem) {
                 if (!childitem->style || childitem->style->display.set ||
                     childitem->style->display.value == SP_CSS_DISPLAY_NONE) {
-                    childitem->style->display.set = TRUE;
-                    childitem->style->display.value = SP_CSS_DISPLAY_BLOCK;
+                    auto &display = childitem->writableStyle()->display;
+                    display.set = TRUE;
+                    display.value = SP_CSS_DISPLAY_BLOCK;
                     childitem->updateRepr(SP_OBJECT_WRITE_NO_CHILDREN | SP_OBJECT_WRITE_EXT);
                 }
             }
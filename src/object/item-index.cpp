@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Spatial index of the items of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "item-index.h"
+
+#include "sp-flowtext.h"
+#include "sp-item.h"
+#include "sp-text.h"
+
+namespace Inkscape {
+
+void ItemIndex::add(SPItem *item)
+{
+    auto const [it, inserted] = _entries.try_emplace(item, Entry{item});
+    if (inserted) {
+        _dirty.push_back(item);
+    } else {
+        invalidate(item);
+    }
+}
+
+void ItemIndex::remove(SPItem const *item)
+{
+    auto it = _entries.find(item);
+    if (it == _entries.end()) {
+        return;
+    }
+    if (it->second.box) {
+        _tree.remove(Value{*it->second.box, it->second.item});
+    }
+    _text.erase(it->second.item);
+    // Stale pointers left in _dirty are skipped by _refresh().
+    _entries.erase(it);
+}
+
+void ItemIndex::invalidate(SPItem const *item)
+{
+    auto it = _entries.find(item);
+    if (it != _entries.end() && !it->second.dirty) {
+        it->second.dirty = true;
+        _dirty.push_back(item);
+    }
+}
+
+std::vector<SPItem *> ItemIndex::query(Geom::Rect const &area)
+{
+    _refresh();
+
+    std::vector<SPItem *> result;
+    auto const box = Box({area.left(), area.top()}, {area.right(), area.bottom()});
+    for (auto it = _tree.qbegin(boost::geometry::index::intersects(box)); it != _tree.qend(); ++it) {
+        result.push_back(it->second);
+    }
+    result.insert(result.end(), _text.begin(), _text.end());
+    return result;
+}
+
+void ItemIndex::_refresh()
+{
+    if (_dirty.empty()) {
+        return;
+    }
+
+    auto bounds_of = [this] (SPItem *item) -> std::optional<Box> {
+        if (is<SPText>(item) || is<SPFlowtext>(item)) {
+            _text.insert(item);
+            return {};
+        }
+        auto bbox = item->documentVisualBounds();
+        if (!bbox || !bbox->isFinite()) {
+            return {};
+        }
+        return Box({bbox->left(), bbox->top()}, {bbox->right(), bbox->bottom()});
+    };
+
+    if (_dirty.size() * 4 > _entries.size()) {
+        // Many changes, e.g. after loading: bulk loading gives a better tree, and faster.
+        std::vector<Value> values;
+        values.reserve(_entries.size());
+        for (auto &[key, entry] : _entries) {
+            if (entry.dirty) {
+                entry.box = bounds_of(entry.item);
+                entry.dirty = false;
+            }
+            if (entry.box) {
+                values.emplace_back(*entry.box, entry.item);
+            }
+        }
+        _tree = Tree(values);
+    } else {
+        for (auto item : _dirty) {
+            auto it = _entries.find(item);
+            if (it == _entries.end() || !it->second.dirty) {
+                continue;
+            }
+            auto &entry = it->second;
+            if (entry.box) {
+                _tree.remove(Value{*entry.box, entry.item});
+            }
+            entry.box = bounds_of(entry.item);
+            entry.dirty = false;
+            if (entry.box) {
+                _tree.insert(Value{*entry.box, entry.item});
+            }
+        }
+    }
+
+    _dirty.clear();
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
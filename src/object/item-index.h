@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Spatial index of the items of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_OBJECT_ITEM_INDEX_H
+#define SEEN_INKSCAPE_OBJECT_ITEM_INDEX_H
+
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <2geom/rect.h>
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+class SPItem;
+
+namespace Inkscape {
+
+/**
+ * An R-tree of the visual bounds of all items in a document, in document coordinates, used to
+ * answer area and point queries without visiting every item.
+ *
+ * Items are added and removed as they are built and released. When their bounds may have
+ * changed, they are only marked; their new bounds are computed by the next query. The index knows
+ * nothing about layers, visibility or locking: callers filter the items it returns.
+ *
+ * Text is picked by its character cells, which may extend beyond its visual bounds, so text items
+ * are returned by every query rather than stored in the tree.
+ */
+class ItemIndex
+{
+public:
+    void add(SPItem *item);
+    void remove(SPItem const *item);
+
+    /// Mark the bounds of @a item as possibly changed.
+    void invalidate(SPItem const *item);
+
+    /// Return the items whose visual bounds may intersect @a area, in no particular order.
+    std::vector<SPItem *> query(Geom::Rect const &area);
+
+    size_t size() const { return _entries.size(); }
+
+private:
+    using Point = boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>;
+    using Box = boost::geometry::model::box<Point>;
+    using Value = std::pair<Box, SPItem *>;
+    using Tree = boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16>>;
+
+    struct Entry
+    {
+        SPItem *item;
+        std::optional<Box> box; ///< The bounds under which the item is stored in the tree.
+        bool dirty = true;
+    };
+
+    void _refresh();
+
+    Tree _tree;
+    std::unordered_set<SPItem *> _text;
+    std::unordered_map<SPItem const *, Entry> _entries;
+    std::vector<SPItem const *> _dirty;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_OBJECT_ITEM_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Attributes parsed ahead of building the objects of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "preparsed-attributes.h"
+
+#include <cstring>
+#include <utility>
+
+#include "display/dispatch-pool.h"
+#include "svg/svg.h"
+#include "xml/node.h"
+
+namespace Inkscape {
+namespace {
+
+/// Below this number of elements, parsing is not worth handing to other threads.
+constexpr int PARALLEL_THRESHOLD = 64;
+
+/// Like sp_svg_read_pathv(), but leaves malformed paths to it, so that it warns on the main thread.
+std::optional<Geom::PathVector> read_pathv(char const *str)
+{
+    Geom::PathVector pathv;
+    if (!sp_svg_read_pathv(str, str + std::strlen(str), pathv)) {
+        return {};
+    }
+    return pathv;
+}
+
+} // namespace
+
+PreparsedAttributes::PreparsedAttributes(XML::Node const &root)
+{
+    std::vector<std::pair<XML::Node const *, Entry>> work;
+
+    std::vector<XML::Node const *> stack{&root};
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        if (node->type() != XML::NodeType::ELEMENT_NODE) {
+            continue;
+        }
+
+        Entry entry;
+        if (!std::strcmp(node->name(), "svg:path")) {
+            if (auto d = node->attribute("d")) {
+                entry.d = d;
+            }
+        }
+        if (auto transform = node->attribute("transform")) {
+            entry.transform = transform;
+        }
+        if (entry.d || entry.transform) {
+            work.emplace_back(node, entry);
+        }
+
+        for (auto child = node->firstChild(); child; child = child->next()) {
+            stack.push_back(child);
+        }
+    }
+
+    int const count = work.size();
+    get_global_dispatch_pool().dispatch_threshold(count, count >= PARALLEL_THRESHOLD, [&] (int i) {
+        auto &entry = work[i].second;
+        if (entry.d) {
+            entry.path = read_pathv(entry.d->c_str());
+        }
+        if (entry.transform) {
+            Geom::Affine affine;
+            if (sp_svg_transform_read(entry.transform->c_str(), &affine)) {
+                entry.affine = affine;
+            }
+        }
+    });
+
+    _entries.reserve(work.size());
+    for (auto &[node, entry] : work) {
+        _entries.emplace(node, std::move(entry));
+    }
+}
+
+PreparsedAttributes::~PreparsedAttributes() = default;
+
+std::optional<Geom::PathVector> PreparsedAttributes::takePath(XML::Node const *repr, char const *value)
+{
+    auto it = _entries.find(repr);
+    if (it == _entries.end() || !value || it->second.d != value) {
+        return {};
+    }
+    it->second.d.reset();
+    return std::exchange(it->second.path, std::nullopt);
+}
+
+std::optional<Geom::Affine> PreparsedAttributes::takeTransform(XML::Node const *repr, char const *value)
+{
+    auto it = _entries.find(repr);
+    if (it == _entries.end() || !value || it->second.transform != value) {
+        return {};
+    }
+    it->second.transform.reset();
+    return std::exchange(it->second.affine, std::nullopt);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Attributes parsed ahead of building the objects of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_OBJECT_PREPARSED_ATTRIBUTES_H
+#define SEEN_INKSCAPE_OBJECT_PREPARSED_ATTRIBUTES_H
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <2geom/affine.h>
+#include <2geom/pathvector.h>
+
+namespace Inkscape {
+namespace XML {
+class Node;
+} // namespace XML
+
+/**
+ * Path data and transforms of a freshly loaded XML tree, parsed in parallel before its objects
+ * are built.
+ *
+ * Building objects must happen on the main thread, but most of the time taken to load a drawing
+ * made of many paths goes into parsing their attributes, which needs nothing but the attribute
+ * string. The results are kept here until the objects' set() methods claim them.
+ *
+ * Each result keeps a copy of the value it was parsed from and is only handed out for an equal
+ * value, so a value changed in the meantime is simply parsed again. Addresses cannot be relied
+ * on for this: attribute values are garbage collected, and this class is not scanned.
+ */
+class PreparsedAttributes
+{
+public:
+    /// Parse the attributes of @a root and all its descendants.
+    explicit PreparsedAttributes(XML::Node const &root);
+    ~PreparsedAttributes();
+
+    /// Take the path data parsed from @a value, the "d" attribute of @a repr, if any.
+    std::optional<Geom::PathVector> takePath(XML::Node const *repr, char const *value);
+
+    /// Take the transform parsed from @a value, the "transform" attribute of @a repr, if any.
+    std::optional<Geom::Affine> takeTransform(XML::Node const *repr, char const *value);
+
+    size_t size() const { return _entries.size(); }
+
+private:
+    struct Entry
+    {
+        std::optional<std::string> d;
+        std::optional<std::string> transform;
+        std::optional<Geom::PathVector> path;
+        std::optional<Geom::Affine> affine;
+    };
+
+    std::unordered_map<XML::Node const *, Entry> _entries;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_OBJECT_PREPARSED_ATTRIBUTES_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
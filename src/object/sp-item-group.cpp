@@ -625,7 +625,7 @@ sp_item_group_ungroup (SPGroup *group, std::vector<SPItem*> &children)
             // it here _before_ the new transform is set, so as to use the pre-transform bbox
             citem->adjust_paint_recursive(Geom::identity(), Geom::identity());
 
-            child.style->merge( group->style );
+            child.writableStyle()->merge( group->style );
             /*
              * fixme: We currently make no allowance for the case where child is cloned
              * and the group has any style settings.
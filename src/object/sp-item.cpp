@@ -16,6 +16,7 @@
 #include "sp-item.h"
 
 #include <algorithm>
+#include <atomic>
 #include <glibmm/i18n.h>
 
 #include "colors/manager.h"
@@ -36,8 +37,11 @@
 #include "enums.h"
 #include "filter-chemistry.h"
 
+#include "item-index.h"
+#include "preparsed-attributes.h"
 #include "sp-clippath.h"
 #include "sp-desc.h"
+#include "sp-filter.h"
 #include "sp-guide.h"
 #include "sp-hatch.h"
 #include "sp-mask.h"
@@ -67,6 +71,20 @@
 
 //#define OBJECT_TRACE
 
+namespace {
+
+std::atomic<unsigned long> bounds_cache_hits;
+std::atomic<unsigned long> bounds_cache_misses;
+
+/**
+ * Advanced whenever an item recomputes its bounds after they were invalidated. While it does not
+ * change, the ancestors and users of an item already invalidated at this generation are still
+ * invalid, so invalidating them again can stop at that item.
+ */
+std::uint64_t bounds_generation = 1;
+
+} // namespace
+
 SPItemView::SPItemView(unsigned flags, unsigned key, DrawingItemPtr<Inkscape::DrawingItem> drawingitem)
     : flags(flags)
     , key(key)
@@ -90,9 +108,9 @@ SPItem::SPItem()
     clip_ref = nullptr;
     mask_ref = nullptr;
 
-    style->signal_fill_ps_changed.connect  ([this] (auto old_obj, auto obj) { fill_ps_ref_changed  (old_obj, obj); });
-    style->signal_stroke_ps_changed.connect([this] (auto old_obj, auto obj) { stroke_ps_ref_changed(old_obj, obj); });
-    style->signal_filter_changed.connect   ([this] (auto old_obj, auto obj) { filter_ref_changed   (old_obj, obj); });
+    connectFillPsChanged  ([this] (auto old_obj, auto obj) { fill_ps_ref_changed  (old_obj, obj); });
+    connectStrokePsChanged([this] (auto old_obj, auto obj) { stroke_ps_ref_changed(old_obj, obj); });
+    connectFilterChanged  ([this] (auto old_obj, auto obj) { filter_ref_changed   (old_obj, obj); });
 
     avoidRef = nullptr;
 }
@@ -226,10 +244,11 @@ bool SPItem::isHidden() const {
 }
 
 void SPItem::setHidden(bool hide) {
-    style->display.set = TRUE;
-    style->display.value = ( hide ? SP_CSS_DISPLAY_NONE : SP_CSS_DISPLAY_INLINE );
-    style->display.computed = style->display.value;
-    style->display.inherit = FALSE;
+    auto &display = writableStyle()->display;
+    display.set = TRUE;
+    display.value = ( hide ? SP_CSS_DISPLAY_NONE : SP_CSS_DISPLAY_INLINE );
+    display.computed = display.value;
+    display.inherit = FALSE;
     updateRepr();
 }
 
@@ -309,9 +328,10 @@ bool SPItem::isExplicitlyHidden() const
 }
 
 void SPItem::setExplicitlyHidden(bool val) {
-    style->display.set = val;
-    style->display.value = ( val ? SP_CSS_DISPLAY_NONE : SP_CSS_DISPLAY_INLINE );
-    style->display.computed = style->display.value;
+    auto &display = writableStyle()->display;
+    display.set = val;
+    display.value = ( val ? SP_CSS_DISPLAY_NONE : SP_CSS_DISPLAY_INLINE );
+    display.computed = display.value;
     updateRepr();
 }
 
@@ -514,6 +534,7 @@ void SPItem::build(SPDocument *document, Inkscape::XML::Node *repr) {
     object->readAttr(SPAttr::INKSCAPE_HIGHLIGHT_COLOR);
 
     SPObject::build(document, repr);
+    document->getItemIndex().add(this);
 #ifdef OBJECT_TRACE
     objectTrace( "SPItem::build", false);
 #endif
@@ -521,6 +542,8 @@ void SPItem::build(SPDocument *document, Inkscape::XML::Node *repr) {
 
 void SPItem::release()
 {
+    document->getItemIndex().remove(this);
+
     // Note: do this here before the clip_ref is deleted, since calling
     // ensureUpToDate() for triggered routing may reference
     // the deleted clip_ref.
@@ -554,8 +577,11 @@ void SPItem::set(SPAttr key, gchar const* value) {
 
     switch (key) {
         case SPAttr::TRANSFORM: {
+            auto preparsed = document ? document->getPreparsedAttributes() : nullptr;
             Geom::Affine t;
-            if (value && sp_svg_transform_read(value, &t)) {
+            if (auto pre = preparsed ? preparsed->takeTransform(getRepr(), value) : std::nullopt) {
+                item->set_item_transform(*pre);
+            } else if (value && sp_svg_transform_read(value, &t)) {
                 item->set_item_transform(t);
             } else {
                 item->set_item_transform(Geom::identity());
@@ -624,7 +650,7 @@ void SPItem::set(SPAttr key, gchar const* value) {
                 // non-#abcdef color formats.
 
                 // Propagate the property change to all clones
-                style->readFromObject(object);
+                object->readStyle();
                 object->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
             } else {
                 SPObject::set(key, value);
@@ -904,12 +930,60 @@ Geom::OptRect SPItem::bbox(Geom::Affine const & /*transform*/, SPItem::BBoxType
     return Geom::OptRect();
 }
 
+template <typename F>
+Geom::OptRect SPItem::_cachedBounds(BBoxType type, Geom::Affine const &transform, F const &compute) const
+{
+    if (!bbox_valid) {
+        for (auto &slots : _cached_bounds) {
+            for (auto &slot : slots) {
+                slot.valid = false;
+            }
+        }
+        bbox_valid = true;
+        bounds_generation++;
+    }
+
+    auto &slot = _cached_bounds[type == VISUAL_BBOX][!transform.isIdentity(0)];
+    if (slot.valid && slot.transform == transform) {
+        bounds_cache_hits.fetch_add(1, std::memory_order_relaxed);
+        return slot.bounds;
+    }
+
+    bounds_cache_misses.fetch_add(1, std::memory_order_relaxed);
+    auto bounds = compute();
+    slot = {transform, bounds, true};
+    return bounds;
+}
+
+SPItem::BoundsCacheStats SPItem::boundsCacheStats()
+{
+    return {bounds_cache_hits.load(std::memory_order_relaxed), bounds_cache_misses.load(std::memory_order_relaxed)};
+}
+
+void SPItem::resetBoundsCacheStats()
+{
+    bounds_cache_hits = 0;
+    bounds_cache_misses = 0;
+}
+
 Geom::OptRect SPItem::geometricBounds(Geom::Affine const &transform) const
 {
-    return bbox(transform, SPItem::GEOMETRIC_BBOX);
+    return _cachedBounds(GEOMETRIC_BBOX, transform, [&] {
+        return bbox(transform, SPItem::GEOMETRIC_BBOX);
+    });
 }
 
 Geom::OptRect SPItem::visualBounds(Geom::Affine const &transform, bool wfilter, bool wclip, bool wmask) const
+{
+    if (!wfilter || !wclip || !wmask) {
+        return _visualBounds(transform, wfilter, wclip, wmask);
+    }
+    return _cachedBounds(VISUAL_BBOX, transform, [&] {
+        return _visualBounds(transform, true, true, true);
+    });
+}
+
+Geom::OptRect SPItem::_visualBounds(Geom::Affine const &transform, bool wfilter, bool wclip, bool wmask) const
 {
     Geom::OptRect bbox;
 
@@ -1004,12 +1078,9 @@ Geom::OptRect SPItem::documentGeometricBounds() const
 
 Geom::OptRect SPItem::documentVisualBounds() const
 {
-    if (!bbox_valid) {
-        doc_bbox = visualBounds(i2doc_affine());
-        bbox_valid = true;
-    }
-    return doc_bbox;
+    return visualBounds(i2doc_affine());
 }
+
 Geom::OptRect SPItem::documentBounds(BBoxType type) const
 {
     if (type == GEOMETRIC_BBOX) {
@@ -1465,6 +1536,7 @@ void SPItem::adjust_stroke( gdouble ex )
     SPStyle *style = this->style;
 
     if (style && !Geom::are_near(ex, 1.0, Geom::EPSILON) && !style->stroke_extensions.hairline) {
+        style = writableStyle();
         style->stroke_width.computed *= ex;
         style->stroke_width.set = TRUE;
 
@@ -1498,6 +1570,30 @@ Geom::Affine sp_item_transform_repr (SPItem *item)
     return t_old;
 }
 
+void sp_item_invalidate_bounds(SPObject const *object)
+{
+    for (auto o = object; o; o = o->parent) {
+        auto item = cast<SPItem>(o);
+        if (item) {
+            if (!item->bbox_valid && item->_bounds_invalidated_at == bounds_generation) {
+                // Reached during an earlier call, with no bounds recomputed since.
+                break;
+            }
+            item->bbox_valid = false;
+            item->_bounds_invalidated_at = bounds_generation;
+            if (item->document) {
+                item->document->getItemIndex().invalidate(item);
+            }
+        }
+        if (item || is<SPClipPath>(o) || is<SPMask>(o) || is<SPFilter>(o)) {
+            // Clones, and items clipped, masked or filtered by us.
+            for (auto user : o->hrefList) {
+                sp_item_invalidate_bounds(user);
+            }
+        }
+    }
+}
+
 
 void SPItem::adjust_stroke_width_recursive(double expansion)
 {
@@ -126,7 +126,7 @@ public:
 
     unsigned int sensitive : 1;
     unsigned int stop_paint: 1;
-    mutable unsigned bbox_valid : 1;
+    mutable unsigned bbox_valid : 1; ///< Cleared to drop the cached bounds; see sp_item_invalidate_bounds().
     double transform_center_x;
     double transform_center_y;
     bool freeze_stroke_width;
@@ -136,7 +136,6 @@ public:
     bool _is_expanded = false;
 
     Geom::Affine transform;
-    mutable Geom::OptRect doc_bbox;
     Geom::Rect viewport;  // Cache viewport information
 
     SPClipPath *getClipObject() const;
@@ -293,6 +292,15 @@ public:
     Geom::OptRect desktopPreferredBounds() const;
     Geom::OptRect desktopBounds(BBoxType type) const;
 
+    /// Number of geometric and visual bounds queries answered from the cache and computed anew.
+    struct BoundsCacheStats
+    {
+        unsigned long hits = 0;
+        unsigned long misses = 0;
+    };
+    static BoundsCacheStats boundsCacheStats();
+    static void resetBoundsCacheStats();
+
     unsigned int pos_in_parent() const;
 
     /**
@@ -421,6 +429,26 @@ private:
     mutable bool _is_evaluated;
     mutable EvaluatedStatus _evaluated_status;
 
+    /**
+     * Bounds cached for each of GEOMETRIC_BBOX and VISUAL_BBOX: one in item coordinates and one
+     * for the most recent other transform, which is usually i2doc or i2dt.
+     */
+    struct CachedBounds
+    {
+        Geom::Affine transform;
+        Geom::OptRect bounds;
+        bool valid = false;
+    };
+    mutable CachedBounds _cached_bounds[2][2];
+
+    /// Value of the bounds generation when sp_item_invalidate_bounds() last reached this item.
+    mutable std::uint64_t _bounds_invalidated_at = 0;
+    friend void sp_item_invalidate_bounds(SPObject const *object);
+
+    template <typename F>
+    Geom::OptRect _cachedBounds(BBoxType type, Geom::Affine const &transform, F const &compute) const;
+    Geom::OptRect _visualBounds(Geom::Affine const &transform, bool wfilter, bool wclip, bool wmask) const;
+
     void clip_ref_changed(SPObject *old_clip, SPObject *clip);
     void mask_ref_changed(SPObject *old_mask, SPObject *mask);
     void fill_ps_ref_changed(SPObject *old_ps, SPObject *ps);
@@ -465,6 +493,15 @@ Geom::Affine i2i_affine(SPObject const *src, SPObject const *dest);
 
 Geom::Affine sp_item_transform_repr(SPItem *item);
 
+/**
+ * Forget the cached bounds of every item whose bounds may depend on \a object: its ancestors,
+ * and the items using it directly or through a clip, mask or filter.
+ * Called when a display update is requested, so only changes that bypass
+ * requestDisplayUpdate() need to call this directly. Stops at items already invalidated since
+ * bounds were last computed, as everything above and using them is still invalid.
+ */
+void sp_item_invalidate_bounds(SPObject const *object);
+
 /* fixme: - these are evil, but OK */
 
 int sp_item_repr_compare_position(SPItem const *first, SPItem const *second);
@@ -32,6 +32,7 @@
 #include "preferences.h"
 #include "style.h"
 #include "live_effects/lpeobject.h"
+#include "item-index.h"
 #include "sp-factory.h"
 #include "sp-font.h"
 #include "sp-paint-server.h"
@@ -40,6 +41,7 @@
 #include "sp-use-reference.h"
 #include "sp-style-elem.h"
 #include "sp-script.h"
+#include "sp-shape.h"
 #include "streq.h"
 #include "strneq.h"
 #include "xml/node-fns.h"
@@ -123,6 +125,7 @@ SPObject::SPObject()
     // polygon, text, tspan, tref, textPath, altGlyph, glyphRef, marker, linearGradient, radialGradient,
     // stop, pattern, clipPath, mask, filter, feImage, a, font, glyph, missing-glyph, foreignObject
     style = new SPStyle(nullptr, this);
+    _connectStyleSignals();
     context_style = nullptr;
 }
 
@@ -146,7 +149,7 @@ SPObject::~SPObject()
         parent->children.erase(parent->children.iterator_to(*this));
     }
 
-    delete style;
+    SPStyle::unref(style);
     this->document = nullptr;
     this->repr = nullptr;
 }
@@ -732,11 +735,14 @@ void SPObject::release() {
     SPObject* object = this;
     debug("id=%p, typename=%s", object, g_type_name_from_instance((GTypeInstance*)object));
 
-    style->filter.clear();
-    style->fill.href.reset();
-    style->stroke.href.reset();
-    style->shape_inside.clear();
-    style->shape_subtract.clear();
+    // A shared style has no references to release.
+    if (!style->isShared()) {
+        style->filter.clear();
+        style->fill.href.reset();
+        style->stroke.href.reset();
+        style->shape_inside.clear();
+        style->shape_subtract.clear();
+    }
 
     auto tmp = children | boost::adaptors::transformed([](SPObject& obj){return &obj;});
     std::vector<SPObject *> toRelease(tmp.begin(), tmp.end());
@@ -873,6 +879,9 @@ void SPObject::invoke_build(SPDocument *document, Inkscape::XML::Node *repr, uns
         g_assert(this->getId() == nullptr);
     }
 
+    this->document->bindObjectToElement(this, nullptr, repr->name());
+    this->document->bindObjectToClasses(this, nullptr, repr->attribute("class"));
+
     this->document->process_pending_resource_changes();
 
     /* Signalling (should be connected AFTER processing derived methods */
@@ -936,6 +945,9 @@ void SPObject::releaseReferences() {
     /* all hrefs should be released by the "release" handlers */
     g_assert(this->hrefcount == 0);
 
+    this->document->bindObjectToClasses(this, repr->attribute("class"), nullptr);
+    this->document->bindObjectToElement(this, repr->name(), nullptr);
+
     if (!cloned) {
         if (this->id) {
             this->document->bindObjectToId(this->id, nullptr);
@@ -996,6 +1008,7 @@ void SPObject::notifyElementNameChanged(Inkscape::XML::Node &node, GQuark old_na
     auto const oldname = g_quark_to_string(old_name);
     auto const newname = g_quark_to_string(new_name);
 
+    document->bindObjectToElement(this, oldname, newname);
     tag_name_changed(oldname, newname);
 }
 
@@ -1101,7 +1114,7 @@ void SPObject::set(SPAttr key, gchar const* value) {
             break;
 
         case SPAttr::STYLE:
-            object->style->readFromObject( object );
+            object->readStyle();
             object->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
             break;
 
@@ -1153,8 +1166,14 @@ void SPObject::readAttr(gchar const *key)
     }
 }
 
-void SPObject::notifyAttributeChanged(Inkscape::XML::Node &, GQuark key_, Util::ptr_shared, Util::ptr_shared)
+void SPObject::notifyAttributeChanged(Inkscape::XML::Node &, GQuark key_, Util::ptr_shared old_value,
+                                      Util::ptr_shared new_value)
 {
+    static GQuark const class_quark = g_quark_from_static_string("class");
+    if (key_ == class_quark) {
+        document->bindObjectToClasses(this, old_value, new_value);
+    }
+
     auto const key = g_quark_to_string(key_);
     readAttr(key);
 }
@@ -1227,7 +1246,7 @@ Inkscape::XML::Node* SPObject::write(Inkscape::XML::Document *doc, Inkscape::XML
             if(any_written) {
                 // We need to ask the object to update the style and keep things in sync
                 // see `case SPAttr::STYLE` above for how the style attr itself does this.
-                style->readFromObject(this);
+                readStyle();
                 requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
             }
 
@@ -1396,6 +1415,77 @@ Inkscape::XML::Node * SPObject::updateRepr(Inkscape::XML::Document *doc, Inkscap
 
 }
 
+/* Style */
+
+void SPObject::readStyle()
+{
+    if (style->isShared()) {
+        _setStyle(SPStyle::unshare(style, this));
+    }
+    style->readDeclared(this, getRepr());
+
+    auto const parent_style = parent ? parent->style : nullptr;
+    if (auto const shared = is<SPShape>(this) ? SPStyle::share(style, parent_style) : nullptr) {
+        _setStyle(shared);
+    } else if (parent_style) {
+        style->cascade(parent_style);
+    }
+}
+
+SPStyle *SPObject::writableStyle()
+{
+    if (style->isShared()) {
+        auto const own = SPStyle::unshare(style, this);
+        if (own != style) {
+            own->readFromObject(this);
+            // Have the views pick up the new style.
+            requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
+        }
+        _setStyle(own);
+    }
+    style->touch();
+    return style;
+}
+
+/**
+ * Cascade the style of this object again from the style of its parent, which has changed.
+ */
+void SPObject::_cascadeStyle()
+{
+    if (!style->isShared()) {
+        style->cascade(parent->style);
+    } else if (auto const shared = SPStyle::reshare(style, parent->style)) {
+        _setStyle(shared);
+    } else {
+        readStyle();
+    }
+}
+
+/**
+ * Make this object use the given style, dropping its reference to the style it used so far.
+ */
+void SPObject::_setStyle(SPStyle *new_style)
+{
+    if (new_style != style) {
+        SPStyle::unref(style);
+        style = new_style;
+    }
+    _connectStyleSignals();
+}
+
+void SPObject::_connectStyleSignals()
+{
+    for (auto &connection : _style_connections) {
+        connection.disconnect();
+    }
+    // Shared styles refer to no paint servers or filters, so have nothing to emit.
+    if (!style->isShared()) {
+        _style_connections[0] = style->signal_fill_ps_changed.connect(_fill_ps_changed_signal.make_slot());
+        _style_connections[1] = style->signal_stroke_ps_changed.connect(_stroke_ps_changed_signal.make_slot());
+        _style_connections[2] = style->signal_filter_changed.connect(_filter_changed_signal.make_slot());
+    }
+}
+
 /* Modification */
 
 void SPObject::requestDisplayUpdate(unsigned int flags)
@@ -1420,6 +1510,9 @@ void SPObject::requestDisplayUpdate(unsigned int flags)
     objectTrace( "SPObject::requestDisplayUpdate" );
 #endif
 
+    // Bounds must not be served from the cache until the update has happened.
+    sp_item_invalidate_bounds(this);
+
     bool already_propagated = (!(this->uflags & (SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_CHILD_MODIFIED_FLAG)));
     //https://stackoverflow.com/a/7841333
     if ((this->uflags & flags) !=  flags ) {
@@ -1472,13 +1565,21 @@ void SPObject::updateDisplay(SPCtx *ctx, unsigned int flags)
      * done immediately. I think this is correct (Lauris).
      */
     if (style) {
-        style->block_filter_bbox_updates = true;
+        auto const old_style = style;
+        if (!style->isShared()) {
+            style->block_filter_bbox_updates = true;
+        }
         if ((flags & SP_OBJECT_STYLESHEET_MODIFIED_FLAG)) {
-            style->readFromObject(this);
+            readStyle();
         } else if (parent && (flags & SP_OBJECT_STYLE_MODIFIED_FLAG) && (flags & SP_OBJECT_PARENT_MODIFIED_FLAG)) {
-            style->cascade( this->parent->style );
+            _cascadeStyle();
         }
         style->block_filter_bbox_updates = false;
+        if (style != old_style) {
+            // Have the views pick up the style the object uses now.
+            flags |= SP_OBJECT_STYLE_MODIFIED_FLAG;
+            this->mflags |= SP_OBJECT_STYLE_MODIFIED_FLAG;
+        }
     }
 
     try
@@ -1495,6 +1596,12 @@ void SPObject::updateDisplay(SPCtx *ctx, unsigned int flags)
         g_warning("SPObject::updateDisplay(SPCtx *ctx, unsigned int flags) : throw in ((SPObjectClass *) G_OBJECT_GET_CLASS(this))->update(this, ctx, flags);");
     }
 
+    // Bounds queried halfway through the update may predate the new geometry.
+    if (auto item = cast<SPItem>(this)) {
+        item->bbox_valid = false;
+        document->getItemIndex().invalidate(item);
+    }
+
     assert((document->update_in_progress)--);
 
 #ifdef OBJECT_TRACE
@@ -230,6 +230,9 @@ public:
      *
      * Note that some non-SPItem SPObject's, such as SPStop, do need styling information,
      * and need to inherit properties even through other non-SPItem parents like \<defs\>.
+     *
+     * The style may be shared with other objects, see readStyle(); change it through
+     * writableStyle() only.
      */
     SPStyle *style;
 
@@ -238,6 +241,33 @@ public:
      */
     SPStyle *context_style;
 
+    /**
+     * Reads the style of this object from its repr and cascades it from its parent. Shapes
+     * that declare the same style under the same parent style share one SPStyle.
+     */
+    void readStyle();
+
+    /**
+     * Returns the style of this object for changing it directly, first giving the object a style
+     * of its own if it shares one with other objects.
+     */
+    SPStyle *writableStyle();
+
+    /**
+     * Connect to the signals that the style of this object emits when its fill paint server,
+     * stroke paint server or filter starts pointing to a different object. Unlike connections
+     * to the signals of SPStyle, these outlast changes to which style the object uses.
+     */
+    sigc::connection connectFillPsChanged(sigc::slot<void (SPObject *, SPObject *)> slot) {
+        return _fill_ps_changed_signal.connect(slot);
+    }
+    sigc::connection connectStrokePsChanged(sigc::slot<void (SPObject *, SPObject *)> slot) {
+        return _stroke_ps_changed_signal.connect(slot);
+    }
+    sigc::connection connectFilterChanged(sigc::slot<void (SPObject *, SPObject *)> slot) {
+        return _filter_changed_signal.connect(slot);
+    }
+
     /// Switch containing next() method.
     struct ParentIteratorStrategy {
         static SPObject const *next(SPObject const *object) {
@@ -713,6 +743,9 @@ public:
     sigc::signal<void (SPObject *)> _delete_signal;
     sigc::signal<void (SPObject *)> _position_changed_signal;
     sigc::signal<void (SPObject *, unsigned int)> _modified_signal;
+    sigc::signal<void (SPObject *, SPObject *)> _fill_ps_changed_signal;
+    sigc::signal<void (SPObject *, SPObject *)> _stroke_ps_changed_signal;
+    sigc::signal<void (SPObject *, SPObject *)> _filter_changed_signal;
     SPObject *_successor{nullptr};
     SPObject *_tmpsuccessor{nullptr};
     CollectionPolicy _collection_policy{SPObject::COLLECT_WITH_PARENT};
@@ -791,6 +824,13 @@ public:
     bool storeAsDouble( char const *key, double *val ) const;
 
 private:
+    void _setStyle(SPStyle *new_style);
+    void _connectStyleSignals();
+    void _cascadeStyle();
+
+    /// Forward the signals of the style while it belongs to this object alone.
+    sigc::connection _style_connections[3];
+
     // Private member functions used in the definitions of setTitle(),
     // setDesc(), title() and desc().
 
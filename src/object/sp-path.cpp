@@ -24,6 +24,8 @@
 #include <2geom/curves.h>
 
 #include "attributes.h"
+#include "document.h"
+#include "preparsed-attributes.h"
 #include "sp-guide.h"
 #include "sp-lpe-item.h"
 #include "style.h"
@@ -158,7 +160,7 @@ void SPPath::build(SPDocument *document, Inkscape::XML::Node *repr) {
                 sp_repr_css_set ( getRepr(), css, "style" );
                 sp_repr_css_attr_unref ( css );
 
-                style->d.style_src = SPStyleSrc::ATTRIBUTE;
+                writableStyle()->d.style_src = SPStyleSrc::ATTRIBUTE;
             }
         }
         // If any if statement is false, do nothing... don't overwrite 'd' from attribute
@@ -200,7 +202,9 @@ void SPPath::set(SPAttr key, const gchar* value) {
 
        case SPAttr::D:
             if (value) {
-                setCurve(SPCurve(sp_svg_read_pathv(value)));
+                auto preparsed = document ? document->getPreparsedAttributes() : nullptr;
+                auto pathv = preparsed ? preparsed->takePath(getRepr(), value) : std::nullopt;
+                setCurve(SPCurve(pathv ? std::move(*pathv) : sp_svg_read_pathv(value)));
             } else {
                 setCurve(nullptr);
             }
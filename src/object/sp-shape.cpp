@@ -740,6 +740,11 @@ void SPShape::print(SPPrintContext* ctx) {
         if (style->stroke.paintOrigin == SP_CSS_PAINT_ORIGIN_CONTEXT_FILL)
             new_style->stroke.overwrite(ctx->context_item->style->fill.upcast());
         style = new_style;
+    } else if (style->isShared()) {
+        // Printers find the item through SPStyle::object, which shared styles have none of.
+        new_style = new SPStyle(document, this);
+        new_style->readFromObject(this);
+        style = new_style;
     }
 
     if (!style->fill.isNone()) {
@@ -1134,6 +1139,7 @@ void SPShape::setCurve(SPCurve const *new_curve)
         setCurve(*new_curve);
     } else {
         _curve.reset();
+        sp_item_invalidate_bounds(this);
     }
 }
 
@@ -1159,6 +1165,7 @@ void SPShape::setCurveBeforeLPE(SPCurve const *new_curve)
 void SPShape::setCurveInsync(SPCurve new_curve)
 {
     _curve = std::make_shared<SPCurve>(std::move(new_curve));
+    sp_item_invalidate_bounds(this);
 }
 void SPShape::setCurveInsync(SPCurve const *new_curve)
 {
@@ -1166,6 +1173,7 @@ void SPShape::setCurveInsync(SPCurve const *new_curve)
         setCurveInsync(*new_curve);
     } else {
         _curve.reset();
+        sp_item_invalidate_bounds(this);
     }
 }
 
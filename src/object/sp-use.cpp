@@ -786,8 +786,9 @@ SPItem *SPUse::unlink() {
     }
     
     // Merge style from the use.
-    unlinked->style->merge( this->style );
-    unlinked->style->cascade( unlinked->parent->style );
+    auto const unlinked_style = unlinked->writableStyle();
+    unlinked_style->merge( this->style );
+    unlinked_style->cascade( unlinked->parent->style );
     unlinked->updateRepr();
     unlinked->removeAttribute("display");
     
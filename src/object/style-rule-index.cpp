@@ -0,0 +1,292 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Index of the rules of a document's style sheets.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "style-rule-index.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "xml/croco-node-iface.h"
+#include "xml/node.h"
+
+namespace Inkscape {
+namespace {
+
+enum KeyKind : std::size_t
+{
+    ELEMENT_KEY = 1,
+    ID_KEY,
+    CLASS_KEY
+};
+
+std::size_t key_hash(KeyKind kind, std::string_view key)
+{
+    auto const h = std::hash<std::string_view>{}(key) + kind * 0x9e3779b97f4a7c15ull;
+    return h ^ (h >> 29);
+}
+
+/// A Bloom filter of the element names, ids and classes of the ancestors of a node.
+class AncestorFilter
+{
+public:
+    void add(std::size_t hash)
+    {
+        _set(hash);
+        _set(hash >> 8);
+    }
+
+    bool mayContain(std::size_t hash) const { return _test(hash) && _test(hash >> 8); }
+
+private:
+    void _set(std::size_t h) { _bits[(h >> 6) & 3] |= std::uint64_t{1} << (h & 63); }
+    bool _test(std::size_t h) const { return _bits[(h >> 6) & 3] & (std::uint64_t{1} << (h & 63)); }
+
+    std::array<std::uint64_t, 4> _bits{};
+};
+
+/// The name libcroco matches type selectors against.
+char const *local_name(XML::Node const &node)
+{
+    auto const name = node.name();
+    if (!name) return "";
+    auto const colon = std::strrchr(name, ':');
+    return colon ? colon + 1 : name;
+}
+
+char const *str(CRString const *s)
+{
+    return s && s->stryng ? s->stryng->str : nullptr;
+}
+
+/// Call @a f with each of the keys a node must have to match the compound selector @a sel.
+template <typename F>
+void for_each_required_key(CRSimpleSel const *sel, F &&f)
+{
+    if ((sel->type_mask & TYPE_SELECTOR) && str(sel->name)) {
+        f(ELEMENT_KEY, str(sel->name));
+    }
+    for (auto add = sel->add_sel; add; add = add->next) {
+        if (add->type == ID_ADD_SELECTOR && str(add->content.id_name)) {
+            f(ID_KEY, str(add->content.id_name));
+        } else if (add->type == CLASS_ADD_SELECTOR && str(add->content.class_name)) {
+            f(CLASS_KEY, str(add->content.class_name));
+        }
+    }
+}
+
+void add_keys(AncestorFilter &filter, XML::Node const &node)
+{
+    if (node.type() != XML::NodeType::ELEMENT_NODE) return;
+
+    filter.add(key_hash(ELEMENT_KEY, local_name(node)));
+    if (auto const id = node.attribute("id")) {
+        filter.add(key_hash(ID_KEY, id));
+    }
+    Util::for_each_class(node.attribute("class"), [&] (std::string_view klass) { filter.add(key_hash(CLASS_KEY, klass)); });
+}
+
+CRSimpleSel *rightmost(CRSimpleSel *sel)
+{
+    while (sel->next) {
+        sel = sel->next;
+    }
+    return sel;
+}
+
+} // namespace
+
+StyleRuleIndex::StyleRuleIndex(CRCascade *cascade)
+{
+    for (int origin = ORIGIN_UA; origin < NB_ORIGINS; ++origin) {
+        // Further <style> elements are chained to the first one.
+        for (auto sheet = cr_cascade_get_sheet(cascade, static_cast<CRStyleOrigin>(origin)); sheet; sheet = sheet->next) {
+            _addSheet(sheet);
+        }
+    }
+}
+
+void StyleRuleIndex::_addSheet(CRStyleSheet *sheet)
+{
+    for (auto statement = sheet->statements; statement; statement = statement->next) {
+        if (statement->type == AT_IMPORT_RULE_STMT) {
+            if (statement->kind.import_rule && statement->kind.import_rule->sheet) {
+                _addSheet(statement->kind.import_rule->sheet);
+            }
+        } else if (statement->type == RULESET_STMT && statement->kind.ruleset) {
+            _addRuleset(statement);
+        }
+    }
+}
+
+void StyleRuleIndex::_addRuleset(CRStatement *statement)
+{
+    for (auto sel = statement->kind.ruleset->sel_list; sel; sel = sel->next) {
+        if (!sel->simple_sel) continue;
+
+        cr_simple_sel_compute_specificity(sel->simple_sel);
+
+        auto rule = Rule{statement, sel->simple_sel, {}};
+        auto const last = rightmost(sel->simple_sel);
+
+        // A compound followed by a descendant or child combinator must match an ancestor of the
+        // node, even when a sibling combinator comes later, as siblings share their ancestors.
+        for (auto compound = last; compound->prev; compound = compound->prev) {
+            if (compound->combinator == COMB_WS || compound->combinator == COMB_GT) {
+                for_each_required_key(compound->prev, [&] (KeyKind kind, char const *key) {
+                    rule.ancestor_keys.push_back(key_hash(kind, key));
+                });
+            }
+        }
+
+        // Index under the rarest key of the rightmost compound.
+        char const *id = nullptr;
+        char const *klass = nullptr;
+        char const *element = nullptr;
+        for_each_required_key(last, [&] (KeyKind kind, char const *key) {
+            auto &slot = kind == ID_KEY ? id : kind == CLASS_KEY ? klass : element;
+            if (!slot) slot = key;
+        });
+
+        auto const index = static_cast<unsigned>(_rules.size());
+        if (id) {
+            _by_id[id].push_back(index);
+        } else if (klass) {
+            _by_class[klass].push_back(index);
+        } else if (element) {
+            _by_element[element].push_back(index);
+        } else {
+            _universal.push_back(index);
+        }
+        _rules.push_back(std::move(rule));
+    }
+}
+
+void StyleRuleIndex::_lookup(RuleMap const &map, std::string_view key, std::vector<unsigned> &out) const
+{
+    if (auto const it = map.find(key); it != map.end()) {
+        out.insert(out.end(), it->second.begin(), it->second.end());
+    }
+}
+
+bool StyleRuleIndex::matches(CRSimpleSel *sel, XML::Node const &node)
+{
+    /** \todo
+     * Check whether we need to register any pseudo-class handlers.
+     * libcroco has its own default handlers for first-child and lang.
+     *
+     * http://www.w3.org/TR/SVG11/styling.html#StylingWithCSS says that
+     * the following should be honoured, at least by inkview:
+     * :hover, :active, :focus, :visited, :link.
+     */
+    static CRSelEng *const sel_eng = cr_sel_eng_new(&XML::croco_node_iface);
+
+    gboolean result = false;
+    cr_sel_eng_matches_node(sel_eng, sel, const_cast<XML::Node *>(&node), &result);
+    return result;
+}
+
+std::vector<CRDeclaration *> StyleRuleIndex::matchedDeclarations(XML::Node const &node) const
+{
+    if (_rules.empty()) return {};
+
+    auto candidates = _universal;
+    if (auto const id = node.attribute("id")) {
+        _lookup(_by_id, id, candidates);
+    }
+    Util::for_each_class(node.attribute("class"), [&] (std::string_view klass) { _lookup(_by_class, klass, candidates); });
+    _lookup(_by_element, local_name(node), candidates);
+    if (candidates.empty()) return {};
+
+    // Back into the order of the cascade, and once each even if a class is repeated.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::optional<AncestorFilter> ancestors;
+    std::vector<unsigned> matched;
+    for (auto const i : candidates) {
+        auto const &rule = _rules[i];
+        if (!rule.ancestor_keys.empty()) {
+            if (!ancestors) {
+                ancestors.emplace();
+                for (auto parent = node.parent(); parent; parent = parent->parent()) {
+                    add_keys(*ancestors, *parent);
+                }
+            }
+            if (!std::all_of(rule.ancestor_keys.begin(), rule.ancestor_keys.end(),
+                             [&] (std::size_t key) { return ancestors->mayContain(key); })) {
+                continue;
+            }
+        }
+        if (matches(rule.selector, node)) {
+            matched.push_back(i);
+        }
+    }
+    if (matched.empty()) return {};
+
+    // What follows is libcroco's cascade, statement by statement and once for each selector that
+    // matched. A statement weighs as much as the last of its selectors that matched.
+    std::unordered_map<CRStatement const *, unsigned long> specificity;
+    for (auto const i : matched) {
+        specificity[_rules[i].statement] = _rules[i].selector->specificity;
+    }
+    auto const origin = [] (CRStatement const *statement) {
+        return statement && statement->parent_sheet ? statement->parent_sheet->origin : ORIGIN_AUTHOR;
+    };
+
+    std::vector<CRDeclaration *> props;
+    std::unordered_map<std::string_view, std::size_t> positions;
+    for (auto const i : matched) {
+        auto const statement = _rules[i].statement;
+        for (auto decl = statement->kind.ruleset->decl_list; decl; decl = decl->next) {
+            auto const name = decl->property ? str(decl->property) : nullptr;
+            if (!name) continue;
+
+            auto const [it, inserted] = positions.try_emplace(name, props.size());
+            auto &position = it->second;
+            if (inserted) {
+                props.push_back(decl);
+                continue;
+            }
+
+            auto const prev = props[position];
+            bool replace = false;
+            if (origin(prev->parent_statement) < origin(statement)) {
+                replace = !prev->important || origin(prev->parent_statement) == ORIGIN_UA;
+            } else if (origin(prev->parent_statement) == origin(statement)) {
+                replace = !prev->important && specificity[statement] >= specificity[prev->parent_statement];
+            }
+
+            // A declaration that wins is moved to the end of the list.
+            if (replace) {
+                props[position] = nullptr;
+                position = props.size();
+                props.push_back(decl);
+            }
+        }
+    }
+    std::erase(props, nullptr);
+    return props;
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
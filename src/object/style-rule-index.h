@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Index of the rules of a document's style sheets.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_OBJECT_STYLE_RULE_INDEX_H
+#define SEEN_INKSCAPE_OBJECT_STYLE_RULE_INDEX_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "3rdparty/libcroco/src/cr-sel-eng.h"
+#include "util/string-keys.h"
+
+namespace Inkscape {
+namespace XML {
+class Node;
+} // namespace XML
+
+/**
+ * The selectors of the author style sheets of a document, indexed by the id, class or element
+ * name their rightmost compound selector requires.
+ *
+ * libcroco tries every selector of the cascade against every node it is asked about, which makes
+ * styling a document with large style sheets quadratic. Here, only the selectors indexed under one
+ * of the keys of a node are tried, and those which also require keys of an ancestor are first
+ * checked against a Bloom filter of the node's ancestors. The few that remain are matched by
+ * libcroco, so the result is the same as cr_sel_eng_get_matched_properties_from_cascade().
+ *
+ * The index refers to the statements of the style sheets, so it must be rebuilt whenever they
+ * change; see SPDocument::invalidateStyleRules().
+ */
+class StyleRuleIndex
+{
+public:
+    explicit StyleRuleIndex(CRCascade *cascade);
+
+    /**
+     * The declarations of the rules that apply to @a node, in the same order as libcroco's
+     * cascade: a declaration takes precedence over those before it.
+     */
+    std::vector<CRDeclaration *> matchedDeclarations(XML::Node const &node) const;
+
+    /// Whether the selector starting at @a sel matches @a node.
+    static bool matches(CRSimpleSel *sel, XML::Node const &node);
+
+    /// The number of indexed selectors.
+    std::size_t size() const { return _rules.size(); }
+
+private:
+    struct Rule
+    {
+        CRStatement *statement;
+        CRSimpleSel *selector;
+        std::vector<std::size_t> ancestor_keys; ///< Keys some ancestor of the node must have.
+    };
+
+    using RuleMap = Util::StringMap<std::vector<unsigned>>;
+
+    void _addSheet(CRStyleSheet *sheet);
+    void _addRuleset(CRStatement *statement);
+    void _lookup(RuleMap const &map, std::string_view key, std::vector<unsigned> &out) const;
+
+    std::vector<Rule> _rules; ///< In the order of the cascade.
+    RuleMap _by_id;
+    RuleMap _by_class;
+    RuleMap _by_element;
+    std::vector<unsigned> _universal;
+};
+
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_OBJECT_STYLE_RULE_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
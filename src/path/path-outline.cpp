@@ -459,7 +459,8 @@ item_to_paths(SPItem *item, bool legacy, SPItem *context)
 
     // Copying stroke style to fill will fail for properties not defined by style attribute
     // (i.e., properties defined in style sheet or by attributes).
-    SPStyle *style = item->style;
+    // The style is cleared below to write those of the new paths.
+    SPStyle *style = item->writableStyle();
     SPCSSAttr *ncss = sp_css_attr_from_style(style, SP_STYLE_FLAG_ALWAYS);
     SPCSSAttr *ncsf = sp_css_attr_from_style(style, SP_STYLE_FLAG_ALWAYS);
 
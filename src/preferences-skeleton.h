@@ -261,7 +261,8 @@ static char const preferences_skeleton[] =
 
   <group id="options"
      rotationlock="1">
-    <group id="renderingcache" size="512" />
+    <group id="renderingcache" size="512" disk="0" />
+    <group id="undo" budget="256" />
     <group id="useoldpdfexporter" value="0" />
     <group id="highlightoriginal" value="1" />
     <group id="relinkclonesonduplicate" value="0" />
@@ -22,7 +22,9 @@
 
 #include "style.h"
 
+#include <atomic>
 #include <cstring>
+#include <ranges>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -37,13 +39,13 @@
 
 #include "3rdparty/libcroco/src/cr-sel-eng.h"
 #include "object/sp-paint-server.h"
+#include "object/style-rule-index.h"
 #include "object/uri.h"
 
 #include "svg/css-ostringstream.h"
 
 #include "util/units.h"
 
-#include "xml/croco-node-iface.h"
 #include "xml/simple-document.h"
 
 #if !GLIB_CHECK_VERSION(2, 64, 0)
@@ -64,7 +66,13 @@ void sp_style_fill_paint_server_ref_changed(SPObject *old_ref, SPObject *ref, SP
 void sp_style_stroke_paint_server_ref_changed(SPObject *old_ref, SPObject *ref, SPStyle *style);
 
 static void sp_style_object_release(SPObject *object, SPStyle *style);
-static CRSelEng *sp_repr_sel_eng();
+
+/// A version no style has had yet, see SPStyle::version().
+static std::uint64_t sp_style_new_version()
+{
+    static std::atomic<std::uint64_t> last{0};
+    return ++last;
+}
 
 /**
  * Helper class for SPStyle property member lookup by SPAttr or
@@ -462,6 +470,8 @@ SPStyle::SPStyle(SPDocument *document_in, SPObject *object_in) :
 
     // This might be too resource hungary... but for now it possible to loop over properties
     _properties = _prop_helper.get_vector(this);
+
+    _version = sp_style_new_version();
 }
 
 SPStyle::~SPStyle() {
@@ -495,6 +505,7 @@ const std::vector<SPIBase *> SPStyle::properties() { return this->_properties; }
 
 void
 SPStyle::clear(SPAttr id) {
+    touch();
     SPIBase *p = _prop_helper.get(this, id);
     if (p) {
         p->clear();
@@ -505,6 +516,7 @@ SPStyle::clear(SPAttr id) {
 
 void
 SPStyle::clear() {
+    touch();
     for (auto * p : _properties) {
         p->clear();
     }
@@ -544,6 +556,29 @@ SPStyle::read( SPObject *object, Inkscape::XML::Node *repr ) {
     //           << (object?(object->getId()?object->getId():"id null"):"object null") << " "
     //           << (repr?(repr->name()?repr->name():"no name"):"repr null")
     //           << std::endl;
+    readDeclared(object, repr);
+
+    /* 4 Cascade from parent */
+    if( object ) {
+        if( object->parent ) {
+            cascade( object->parent->style );
+        }
+    } else if( repr->parent() ) { // When does this happen?
+        // std::cout << "SPStyle::read(): reading via repr->parent()" << std::endl;
+        SPStyle *parent = new SPStyle(document);
+        parent->read( nullptr, repr->parent() );
+        cascade( parent );
+        delete parent;
+    }
+}
+
+/**
+ * Read the properties declared for an object by its style attribute, the style sheets and its
+ * presentation attributes, without cascading them from its parent.
+ */
+void
+SPStyle::readDeclared( SPObject *object, Inkscape::XML::Node *repr ) {
+
     g_assert(repr != nullptr);
     g_assert(!object || (object->getRepr() == repr));
 
@@ -584,19 +619,6 @@ SPStyle::read( SPObject *object, Inkscape::XML::Node *repr ) {
             p->readAttribute( repr );
         }
     }
-
-    /* 4 Cascade from parent */
-    if( object ) {
-        if( object->parent ) {
-            cascade( object->parent->style );
-        }
-    } else if( repr->parent() ) { // When does this happen?
-        // std::cout << "SPStyle::read(): reading via repr->parent()" << std::endl;
-        SPStyle *parent = new SPStyle(document);
-        parent->read( nullptr, repr->parent() );
-        cascade( parent );
-        delete parent;
-    }
 }
 
 /**
@@ -655,6 +677,7 @@ SPStyle::readIfUnset(SPAttr id, gchar const *val, SPStyleSrc const &source ) {
     // To Do: If it is not too slow, use std::map instead of std::vector inorder to remove switch()
     // (looking up SPAttr::xxxx already uses a hash).
     g_return_if_fail(val != nullptr);
+    touch();
 
     switch (id) {
             /* SVG */
@@ -818,6 +841,7 @@ Glib::ustring SPStyle::writeIfDiff(SPStyle const *base) const
 void
 SPStyle::cascade( SPStyle const *const parent ) {
     // std::cout << "SPStyle::cascade: " << (object->getId()?object->getId():"null") << std::endl;
+    touch();
     for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
         _properties[i]->cascade( parent->_properties[i] );
     }
@@ -844,6 +868,7 @@ SPStyle::cascade( SPStyle const *const parent ) {
 void
 SPStyle::merge( SPStyle const *const parent ) {
     // std::cout << "SPStyle::merge" << std::endl;
+    touch();
     for(std::vector<SPIBase*>::size_type i = 0; i != _properties.size(); ++i) {
         _properties[i]->merge( parent->_properties[i] );
     }
@@ -899,6 +924,224 @@ SPStyle::operator==(const SPStyle& rhs) const {
     return true;
 }
 
+/**
+ * Whether this style holds nothing that depends on which object it belongs to, so that other
+ * objects with the same declared style may use it too: no references to paint servers, filters,
+ * markers or shapes, no paint taken from a context, and no lengths resolved against a viewport.
+ */
+bool
+SPStyle::isShareable() const {
+    if (getFillURI() || getStrokeURI() || getFilterURI()) {
+        return false;
+    }
+    for (auto const paint : {fill.upcast(), stroke.upcast()}) {
+        if (paint->paintOrigin == SP_CSS_PAINT_ORIGIN_CONTEXT_FILL ||
+            paint->paintOrigin == SP_CSS_PAINT_ORIGIN_CONTEXT_STROKE) {
+            return false;
+        }
+    }
+    for (auto const marker : marker_ptrs) {
+        if (marker->set) {
+            return false;
+        }
+    }
+    if (shape_inside.set || shape_subtract.set) {
+        return false;
+    }
+    // SPShape::update() resolves these against the viewport of each shape.
+    if (stroke_width.unit == SP_CSS_UNIT_PERCENT || stroke_dashoffset.unit == SP_CSS_UNIT_PERCENT) {
+        return false;
+    }
+    for (auto const &length : stroke_dasharray.values) {
+        if (length.unit == SP_CSS_UNIT_PERCENT) {
+            return false;
+        }
+    }
+    // A 'd' given as a property is moved to the attribute by SPPath::build(), see share().
+    return !d.set || d.style_src == SPStyleSrc::ATTRIBUTE;
+}
+
+/**
+ * Mark the values of this style as changed. Styles cascaded from this one are then cascaded
+ * again rather than shared by SPStyle::reshare().
+ */
+void
+SPStyle::touch() {
+    if (isShared()) {
+        g_warning("SPStyle: changing a style that objects share, use SPObject::writableStyle()");
+    }
+    _version = sp_style_new_version();
+}
+
+namespace {
+
+/// The shared styles by the hash of their key, see SPStyle::share().
+std::unordered_multimap<std::size_t, SPStyle *> &sp_style_shared()
+{
+    static std::unordered_multimap<std::size_t, SPStyle *> styles;
+    return styles;
+}
+
+std::size_t sp_style_hash_combine(std::size_t seed, std::size_t hash)
+{
+    return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+} // namespace
+
+std::size_t
+SPStyle::_sharedHash(std::uint64_t parent_version) const {
+    auto hash = sp_style_hash_combine(_declared_hash, std::hash<std::uint64_t>{}(parent_version));
+    hash = sp_style_hash_combine(hash, std::hash<SPDocument const *>{}(document));
+    return sp_style_hash_combine(hash, cloned);
+}
+
+/// Find a shared style with the declared values of this one, cascaded from the given parent version.
+SPStyle *
+SPStyle::_findShared(std::size_t hash, std::uint64_t parent_version) const {
+    auto const [first, last] = sp_style_shared().equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        auto const other = it->second;
+        if (other != this && other->_parent_version == parent_version && other->document == document &&
+            other->cloned == cloned && other->_declared == _declared) {
+            return other;
+        }
+    }
+    return nullptr;
+}
+
+void
+SPStyle::_enterPool(std::size_t hash, std::uint64_t parent_version) {
+    _shared_hash = hash;
+    _parent_version = parent_version;
+    _shared_refs = 1;
+    // A shared style has no object of its own.
+    object = nullptr;
+    release_connection.disconnect();
+    sp_style_shared().emplace(hash, this);
+}
+
+void
+SPStyle::_leavePool() {
+    auto const [first, last] = sp_style_shared().equal_range(_shared_hash);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == this) {
+            sp_style_shared().erase(it);
+            break;
+        }
+    }
+    _shared_refs = 0;
+}
+
+/**
+ * Share a style just read with readDeclared() with the objects that declare the same style under
+ * the same parent style. Only the first of them cascades the style from the parent; the others
+ * reuse the result, found through a hash of the declared values.
+ *
+ * @return nullptr if the style cannot be shared, in which case it is left to the caller to
+ *         cascade; otherwise the shared style, which is either \a style itself or another style
+ *         that the caller now holds a reference to in its stead.
+ */
+SPStyle *
+SPStyle::share(SPStyle *style, SPStyle const *parent) {
+    g_assert(!style->isShared());
+
+    if (!style->isShareable()) {
+        return nullptr;
+    }
+
+    // The 'd' attribute of a path is its geometry, which SPPath reads itself, rather than style.
+    if (style->d.set) {
+        style->d.clear();
+    }
+
+    style->_declared = style->write(SPStyleSrc::STYLE_PROP).raw() + '\n' +
+                       style->write(SPStyleSrc::ATTRIBUTE).raw() + '\n' +
+                       style->write(SPStyleSrc::STYLE_SHEET).raw();
+    style->_declared_hash = std::hash<std::string>{}(style->_declared);
+
+    auto const parent_version = parent ? parent->version() : 0;
+    auto const hash = style->_sharedHash(parent_version);
+    if (auto const other = style->_findShared(hash, parent_version)) {
+        other->_shared_refs++;
+        return other;
+    }
+
+    if (parent) {
+        style->cascade(parent);
+    }
+    style->_enterPool(hash, parent_version);
+    return style;
+}
+
+/**
+ * Cascade a shared style again from a parent style that has changed.
+ *
+ * @return The style to use instead, referenced for the caller; or nullptr if the style has to be
+ *         read again, as other objects still use it with the old parent.
+ */
+SPStyle *
+SPStyle::reshare(SPStyle *style, SPStyle const *parent) {
+    g_assert(style->isShared());
+
+    auto const parent_version = parent->version();
+    if (style->_parent_version == parent_version) {
+        return style;
+    }
+
+    auto const hash = style->_sharedHash(parent_version);
+    if (auto const other = style->_findShared(hash, parent_version)) {
+        other->_shared_refs++;
+        return other;
+    }
+
+    if (style->_shared_refs > 1) {
+        return nullptr;
+    }
+
+    style->_leavePool();
+    style->cascade(parent);
+    style->_enterPool(hash, parent_version);
+    return style;
+}
+
+/**
+ * Give an object a style of its own in place of a shared one.
+ *
+ * @return The shared style itself if the object was its only user, or else a new style, which is
+ *         still to be read, for the object to use in its stead.
+ */
+SPStyle *
+SPStyle::unshare(SPStyle *style, SPObject *object) {
+    g_assert(style->isShared());
+
+    if (style->_shared_refs > 1) {
+        return new SPStyle(nullptr, object);
+    }
+
+    style->_leavePool();
+    style->_declared.clear();
+    style->object = object;
+    style->release_connection =
+        object->connectRelease(sigc::bind<1>(sigc::ptr_fun(&sp_style_object_release), style));
+    return style;
+}
+
+/**
+ * Drop the reference of an object to its style, deleting the style once no object uses it.
+ */
+void
+SPStyle::unref(SPStyle *style) {
+    if (style->_shared_refs > 1) {
+        style->_shared_refs--;
+        return;
+    }
+    if (style->isShared()) {
+        style->_leavePool();
+    }
+    delete style;
+}
+
 void
 SPStyle::_mergeString( gchar const *const p ) {
 
@@ -965,20 +1208,6 @@ SPStyle::_mergeDecl(  CRDeclaration const *const decl, SPStyleSrc const &source
     }
 }
 
-void
-SPStyle::_mergeProps( CRPropList *const props ) {
-
-    // std::cout << "SPStyle::_mergeProps" << std::endl;
-
-    // In reverse order, as later declarations to take precedence over earlier ones.
-    if (props) {
-        _mergeProps( cr_prop_list_get_next( props ) );
-        CRDeclaration *decl = nullptr;
-        cr_prop_list_get_decl(props, &decl);
-        _mergeDecl( decl, SPStyleSrc::STYLE_SHEET );
-    }
-}
-
 void
 SPStyle::_mergeObjectStylesheet( SPObject const *const object ) {
 
@@ -990,27 +1219,18 @@ SPStyle::_mergeObjectStylesheet( SPObject const *const object ) {
 void
 SPStyle::_mergeObjectStylesheet( SPObject const *const object, SPDocument *const document ) {
 
-    static CRSelEng *sel_eng = sp_repr_sel_eng();
-
     if (auto *const parent = document->getParent()) {
         _mergeObjectStylesheet(object, parent);
     } else if (auto *const parent = document->get_reference_document()) {
         _mergeObjectStylesheet(object, parent);
     }
 
-    CRPropList *props = nullptr;
-
     //XML Tree being directly used here while it shouldn't be.
-    CRStatus status =
-        cr_sel_eng_get_matched_properties_from_cascade(sel_eng,
-                                                       document->getStyleCascade(),
-                                                       object->getRepr(),
-                                                       &props);
-    g_return_if_fail(status == CR_OK);
-    /// \todo Check what errors can occur, and handle them properly.
-    if (props) {
-        _mergeProps(props);
-        cr_prop_list_destroy(props);
+    auto const decls = document->getStyleRules().matchedDeclarations(*object->getRepr());
+
+    // In reverse order, as later declarations to take precedence over earlier ones.
+    for (auto const decl : decls | std::views::reverse) {
+        _mergeDecl(decl, SPStyleSrc::STYLE_SHEET);
     }
 }
 
@@ -1223,28 +1443,6 @@ void sp_style_stroke_paint_server_ref_changed(SPObject *old_ref, SPObject *ref,
     sp_style_paint_server_ref_modified(ref, 0, style);
 }
 
-static CRSelEng *
-sp_repr_sel_eng()
-{
-    CRSelEng *const ret = cr_sel_eng_new(&Inkscape::XML::croco_node_iface);
-
-    /** \todo
-     * Check whether we need to register any pseudo-class handlers.
-     * libcroco has its own default handlers for first-child and lang.
-     *
-     * We probably want handlers for link and arguably visited (though
-     * inkscape can't visit links at the time of writing).  hover etc.
-     * more useful in inkview than the editor inkscape.
-     *
-     * http://www.w3.org/TR/SVG11/styling.html#StylingWithCSS says that
-     * the following should be honoured, at least by inkview:
-     * :hover, :active, :focus, :visited, :link.
-     */
-
-    g_assert(ret);
-    return ret;
-}
-
 // The following functions should be incorporated into SPIPaint. FIXME
 // Called in: style.cpp, style-internal.cpp
 void
@@ -22,8 +22,10 @@
 #include "style-internal.h"
 
 #include <sigc++/connection.h>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "3rdparty/libcroco/src/cr-declaration.h"
@@ -50,6 +52,7 @@ public:
     void clear();
     void clear(SPAttr id);
     void read(SPObject *object, Inkscape::XML::Node *repr);
+    void readDeclared(SPObject *object, Inkscape::XML::Node *repr);
     void readFromObject(SPObject *object);
     void readFromPrefs(Glib::ustring const &path);
     bool isSet(SPAttr id);
@@ -70,11 +73,44 @@ public:
     void mergeStatement(CRStatement *statement);
     bool operator==(SPStyle const &rhs) const;
 
+    /* ----------------------- SHARING ------------------------- */
+    /* Shapes that declare the same style under the same parent style use one SPStyle between
+     * them, see SPObject::readStyle(). Such a shared style must not be changed: objects change
+     * their style through SPObject::writableStyle(), which gives them one of their own first. */
+
+    bool isShareable() const;
+    bool isShared() const { return _shared_refs > 0; }
+
+    /// Changes whenever the values of this style might have, so that styles cascaded from it know.
+    std::uint64_t version() const { return _version; }
+    void touch();
+
+    static SPStyle *share(SPStyle *style, SPStyle const *parent);
+    static SPStyle *reshare(SPStyle *style, SPStyle const *parent);
+    static SPStyle *unshare(SPStyle *style, SPObject *object);
+    static void unref(SPStyle *style);
+
 private:
+    std::size_t _sharedHash(std::uint64_t parent_version) const;
+    SPStyle *_findShared(std::size_t hash, std::uint64_t parent_version) const;
+    void _enterPool(std::size_t hash, std::uint64_t parent_version);
+    void _leavePool();
+
+    std::uint64_t _version;
+
+    /// Number of objects using this style if it is shared, 0 if it belongs to its object alone.
+    unsigned _shared_refs = 0;
+
+    /// The declared values of a shared style and the version of the parent style they were
+    /// cascaded from, which together make up its key among the shared styles.
+    std::string _declared;
+    std::size_t _declared_hash = 0;
+    std::size_t _shared_hash = 0;
+    std::uint64_t _parent_version = 0;
+
     void _mergeString(char const *p);
     void _mergeDeclList(CRDeclaration const *decl_list, SPStyleSrc const &source);
     void _mergeDecl(    CRDeclaration const *decl,      SPStyleSrc const &source);
-    void _mergeProps(CRPropList *props);
     void _mergeObjectStylesheet(SPObject const *object);
     void _mergeObjectStylesheet(SPObject const *object, SPDocument *document);
 
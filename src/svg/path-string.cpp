@@ -160,15 +160,16 @@ void PathString::State::appendRelative(Geom::Coord v, Geom::Coord r) {
 }
 
 void PathString::State::appendNumber(double v, int precision, int minexp) {
-
-    str.append(sp_svg_number_write_de(v, precision, minexp));
+    char buf[SP_SVG_NUMBER_BUFFER_SIZE];
+    str.append(buf, sp_svg_number_write_de(buf, v, precision, minexp));
 }
 
+// rv is the value as written, i.e. after rounding to the precision
 void PathString::State::appendNumber(double v, double &rv) {
-    size_t const oldsize = str.size();
-    appendNumber(v, _precision, _minexp);
-    char* begin_of_num = const_cast<char*>(str.data()+oldsize); // Slightly evil, I know (but std::string should be storing its data in one big block of memory, so...)
-    sp_svg_number_read_d(begin_of_num, &rv);
+    char buf[SP_SVG_NUMBER_BUFFER_SIZE];
+    char const *end = sp_svg_number_write_de(buf, v, _precision, _minexp);
+    sp_svg_number_scan(buf, end, &rv);
+    str.append(buf, end);
 }
 
 }}
@@ -11,7 +11,10 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <charconv>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <glib.h>
@@ -27,10 +30,6 @@ using std::pow;
 
 static unsigned sp_svg_length_read_lff(gchar const *str, SVGLength::Unit *unit, float *val, float *computed, char **next);
 
-#ifndef MAX
-# define MAX(a,b) ((a < b) ? (b) : (a))
-#endif
-
 unsigned int sp_svg_number_read_f(gchar const *str, float *val)
 {
     if (!str) {
@@ -63,80 +62,306 @@ unsigned int sp_svg_number_read_d(gchar const *str, double *val)
     return 1;
 }
 
-static std::string sp_svg_number_write_d( double val, unsigned int tprec, unsigned int fprec)
+namespace {
+
+/// Most significant digits worth writing: 17 are enough to read back any double.
+constexpr int MAX_DIGITS = 17;
+
+constexpr double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/**
+ * Write the digits of the shortest decimal representation that reads back as @a val, which
+ * must be finite and positive, so that val = d0.d1d2... * 10^exp10.
+ * @return the number of digits written to @a digits, without trailing zeros.
+ */
+int shortest_digits(double val, char *digits, int &exp10)
 {
+    char buf[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    char const *const end = std::to_chars(buf, buf + sizeof(buf), val, std::chars_format::scientific).ptr;
+#else
+    // Not the shortest representation, but 17 digits always read back as the same double.
+    char const *const end = buf + std::strlen(g_ascii_formatd(buf, sizeof(buf), "%.16e", val));
+#endif
 
-    std::string buf;
-    /* Process sign */
-    if (val < 0.0) {
-        buf.append("-");
-        val = fabs(val);
+    int ndigits = 0;
+    char const *p = buf;
+    for (; p != end && *p != 'e'; ++p) {
+        if (is_digit(*p) && ndigits < MAX_DIGITS) {
+            digits[ndigits++] = *p;
+        }
+    }
+
+    exp10 = 0;
+    bool negative = false;
+    if (p != end) {
+        ++p;
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative = *p++ == '-';
+        }
+    }
+    for (; p != end; ++p) {
+        exp10 = exp10 * 10 + (*p - '0');
+    }
+    if (negative) {
+        exp10 = -exp10;
     }
 
-    /* Determine number of integral digits */
-    int idigits = 0;
+    while (ndigits > 1 && digits[ndigits - 1] == '0') {
+        --ndigits;
+    }
+    return ndigits;
+}
+
+/**
+ * Find the decimal exponent of @a val, which must be finite and positive, by comparing with
+ * powers of ten. Returns false for very large or small values and for values so close to a power
+ * of ten that the comparison could go either way.
+ */
+bool fast_exponent(double val, int &exp10)
+{
     if (val >= 1.0) {
-        idigits = (int) floor(log10(val)) + 1;
-    }
-
-    /* Determine the actual number of fractional digits */
-    fprec = MAX(static_cast<int>(fprec), static_cast<int>(tprec) - idigits);
-    /* Round value */
-    val += 0.5 / pow(10.0, fprec);
-    /* Extract integral and fractional parts */
-    double dival = floor(val);
-    double fval = val - dival;
-    /* Write integra */
-    if (idigits > (int)tprec) {
-        buf.append(std::to_string((unsigned int)floor(dival/pow(10.0, idigits-tprec) + .5)));
-        for(unsigned int j=0; j<(unsigned int)idigits-tprec; j++) {
-            buf.append("0");
+        if (val >= 1e16) {
+            return false;
         }
-    } else {
-       buf.append(std::to_string((unsigned int)dival));
-    }
-
-    if (fprec > 0 && fval > 0.0) {
-        std::string s(".");
-        do {
-            fval *= 10.0;
-            dival = floor(fval);
-            fval -= dival;
-            int const int_dival = (int) dival;
-            s.append(std::to_string(int_dival));
-            if(int_dival != 0){
-                buf.append(s);
-                s="";
+        exp10 = 0;
+        while (val >= POW10[exp10 + 1]) {
+            ++exp10;
+        }
+        return true;
+    }
+
+    if (val < 1e-5) {
+        return false;
+    }
+    for (int k = 1;; ++k) {
+        double const scaled = val * POW10[k];
+        if (std::fabs(scaled - 1.0) < 0x1p-50) {
+            return false;
+        }
+        if (scaled > 1.0) {
+            exp10 = -k;
+            return true;
+        }
+    }
+}
+
+/**
+ * Round @a val, finite, positive and of decimal exponent @a exp10, to @a nsig significant digits
+ * with a single multiplication. Returns false where that is not exact enough to tell which way
+ * the last digit rounds; the shortest representation decides those.
+ */
+bool fast_round(double val, int nsig, char *digits, int &ndigits, int &exp10)
+{
+    int const shift = nsig - 1 - exp10;
+    if (nsig < 1 || nsig > 15 || shift > 22 || shift < -22) {
+        return false;
+    }
+
+    double const scaled = shift >= 0 ? val * POW10[shift] : val / POW10[-shift];
+    double const integral = std::floor(scaled);
+    double const fraction = scaled - integral;
+    if (std::fabs(fraction - 0.5) < scaled * 0x1p-50) {
+        return false;
+    }
+
+    auto rounded = static_cast<std::uint64_t>(integral) + (fraction > 0.5);
+    if (rounded < POW10[nsig - 1]) {
+        return false;
+    }
+    if (rounded >= POW10[nsig]) {
+        rounded /= 10;
+        ++exp10;
+    }
+
+    ndigits = std::to_chars(digits, digits + MAX_DIGITS, rounded).ptr - digits;
+    while (ndigits > 1 && digits[ndigits - 1] == '0') {
+        --ndigits;
+    }
+    return true;
+}
+
+} // namespace
+
+char const *sp_svg_number_scan(char const *begin, char const *end, double *val)
+{
+    char const *p = begin;
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+        negative = *p++ == '-';
+    }
+
+    // Up to 19 significant digits fit into the mantissa; more are left to g_ascii_strtod().
+    std::uint64_t mantissa = 0;
+    int ndigits = 0;
+    int exp10 = 0;
+    bool exact = true;
+    bool any = false;
+    for (; p != end && is_digit(*p); ++p) {
+        any = true;
+        if (ndigits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            ndigits += mantissa != 0;
+        } else {
+            ++exp10;
+            exact = false;
+        }
+    }
+    if (p != end && *p == '.') {
+        ++p;
+        for (; p != end && is_digit(*p); ++p) {
+            any = true;
+            if (ndigits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                ndigits += mantissa != 0;
+                --exp10;
+            } else {
+                exact = false;
             }
-            fprec -= 1;
-        } while(fprec > 0 && fval > 0.0);
+        }
+    }
+    if (!any) {
+        return nullptr;
+    }
+
+    // An 'e' not followed by an exponent is not part of the number.
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        char const *q = p + 1;
+        bool exp_negative = false;
+        if (q != end && (*q == '+' || *q == '-')) {
+            exp_negative = *q++ == '-';
+        }
+        if (q != end && is_digit(*q)) {
+            int exp = 0;
+            for (; q != end && is_digit(*q); ++q) {
+                if (exp < 100000) {
+                    exp = exp * 10 + (*q - '0');
+                }
+            }
+            exp10 += exp_negative ? -exp : exp;
+            p = q;
+        }
     }
-    return buf;
+
+    double v;
+    if (mantissa == 0 && exact) {
+        v = 0.0;
+    } else if (exact && mantissa <= (std::uint64_t{1} << 53) && exp10 >= -22 && exp10 <= 22) {
+        // Both operands are exact, so a single rounding gives the correctly rounded result.
+        v = exp10 < 0 ? mantissa / POW10[-exp10] : mantissa * POW10[exp10];
+    } else {
+        char buf[64];
+        auto const len = static_cast<std::size_t>(p - begin);
+        if (len < sizeof(buf)) {
+            std::memcpy(buf, begin, len);
+            buf[len] = '\0';
+            *val = g_ascii_strtod(buf, nullptr);
+        } else {
+            *val = g_ascii_strtod(std::string(begin, p).c_str(), nullptr);
+        }
+        return p;
+    }
+
+    *val = negative ? -v : v;
+    return p;
 }
 
-std::string sp_svg_number_write_de(double val, unsigned int tprec, int min_exp)
+char *sp_svg_number_write_de(char *buf, double val, unsigned int tprec, int min_exp)
 {
-    std::string buf;
-    int eval = (int)floor(log10(fabs(val)));
-    if (val == 0.0 || eval < min_exp) {
-        buf.append("0");
-        return buf;
-    }
-    unsigned int maxnumdigitsWithoutExp = // This doesn't include the sign because it is included in either representation
-        eval<0?tprec+(unsigned int)-eval+1:
-        eval+1<(int)tprec?tprec+1:
-        (unsigned int)eval+1;
-    unsigned int maxnumdigitsWithExp = tprec + ( eval<0 ? 4 : 3 ); // It's not necessary to take larger exponents into account, because then maxnumdigitsWithoutExp is DEFINITELY larger
-    if (maxnumdigitsWithoutExp <= maxnumdigitsWithExp) {
-        buf.append(sp_svg_number_write_d(val, tprec, 0));
+    char *out = buf;
+    if (val == 0.0 || !std::isfinite(val)) {
+        *out++ = '0';
+        return out;
+    }
+
+    // Most numbers are rounded directly; the shortest representation settles the rest.
+    double const abs_val = std::fabs(val);
+    char digits[MAX_DIGITS];
+    int ndigits = 0;
+    int exp10;
+    if (!fast_exponent(abs_val, exp10)) {
+        ndigits = shortest_digits(abs_val, digits, exp10);
+    }
+    if (exp10 < min_exp) {
+        *out++ = '0';
+        return out;
+    }
+
+    // Use the notation that takes fewer characters at the given precision (not counting the sign).
+    int const prec = std::clamp(static_cast<int>(tprec), 1, MAX_DIGITS);
+    int const max_plain = exp10 < 0 ? prec - exp10 + 1 : std::max(exp10 + 1, prec + 1);
+    int const max_exp = prec + (exp10 < 0 ? 4 : 3);
+    bool const use_exp = max_plain > max_exp;
+
+    // In plain notation, numbers below 1 get prec decimal places rather than prec significant digits.
+    int const nsig = use_exp || exp10 >= 0 ? prec : prec + exp10 + 1;
+    if (ndigits == 0 && !fast_round(abs_val, nsig, digits, ndigits, exp10)) {
+        ndigits = shortest_digits(abs_val, digits, exp10);
+    }
+    if (nsig < ndigits) {
+        bool const round_up = nsig >= 0 && digits[nsig] >= '5';
+        ndigits = std::max(nsig, 0);
+        if (round_up) {
+            while (ndigits > 0 && digits[ndigits - 1] == '9') {
+                --ndigits;
+            }
+            if (ndigits == 0) {
+                digits[0] = '1';
+                ndigits = 1;
+                ++exp10;
+            } else {
+                ++digits[ndigits - 1];
+            }
+        }
+        while (ndigits > 0 && digits[ndigits - 1] == '0') {
+            --ndigits;
+        }
+        if (ndigits == 0) {
+            *out++ = '0';
+            return out;
+        }
+    }
+
+    if (val < 0.0) {
+        *out++ = '-';
+    }
+    if (use_exp) {
+        *out++ = digits[0];
+        if (ndigits > 1) {
+            *out++ = '.';
+            out = std::copy(digits + 1, digits + ndigits, out);
+        }
+        *out++ = 'e';
+        out = std::to_chars(out, out + 8, exp10).ptr;
+    } else if (exp10 < 0) {
+        *out++ = '0';
+        *out++ = '.';
+        out = std::fill_n(out, -exp10 - 1, '0');
+        out = std::copy(digits, digits + ndigits, out);
     } else {
-        val = eval < 0 ? val * pow(10.0, -eval) : val / pow(10.0, eval);
-        buf.append(sp_svg_number_write_d(val, tprec, 0));
-        buf.append("e");
-        buf.append(std::to_string(eval));
+        int const int_digits = exp10 + 1;
+        if (ndigits <= int_digits) {
+            out = std::copy(digits, digits + ndigits, out);
+            out = std::fill_n(out, int_digits - ndigits, '0');
+        } else {
+            out = std::copy(digits, digits + int_digits, out);
+            *out++ = '.';
+            out = std::copy(digits + int_digits, digits + ndigits, out);
+        }
     }
-    return buf;
+    return out;
+}
 
+std::string sp_svg_number_write_de(double val, unsigned int tprec, int min_exp)
+{
+    char buf[SP_SVG_NUMBER_BUFFER_SIZE];
+    return std::string(buf, sp_svg_number_write_de(buf, val, tprec, min_exp));
 }
 
 SVGLength::SVGLength()
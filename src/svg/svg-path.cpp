@@ -16,6 +16,7 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <cmath>
 #include <cstring>
 #include <string>
 #include <glib.h> // g_assert()
@@ -23,12 +24,344 @@
 #include <2geom/pathvector.h>
 #include <2geom/curves.h>
 #include <2geom/sbasis-to-bezier.h>
-#include <2geom/path-sink.h>
-#include <2geom/svg-path-parser.h>
 
 #include "svg/svg.h"
 #include "svg/path-string.h"
 
+namespace {
+
+inline bool is_wsp(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool starts_number(char c)
+{
+    return (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+';
+}
+
+/**
+ * Reads SVG path data straight into a path vector. It builds the same paths as
+ * Geom::SVGPathParser with a snap threshold of Geom::EPSILON, without going through a path sink.
+ */
+class PathDataParser
+{
+public:
+    PathDataParser(char const *begin, char const *end, Geom::PathVector &pathv)
+        : _pos(begin)
+        , _end(end)
+        , _pathv(pathv)
+    {}
+
+    bool parse();
+
+private:
+    bool _fail();
+    void _skipWsp();
+    bool _moreArguments();
+    bool _number(double &value);
+    bool _coord(double &value, double origin, bool relative);
+    bool _point(Geom::Point &p, bool relative);
+    bool _flag(bool &flag);
+
+    void _startPath();
+    void _flush();
+    void _moveTo(Geom::Point const &p);
+    void _lineTo(Geom::Point const &p);
+    void _quadTo(Geom::Point const &c, Geom::Point const &p);
+    void _curveTo(Geom::Point const &c0, Geom::Point const &c1, Geom::Point const &p);
+    void _arcTo(double rx, double ry, double angle, bool large_arc, bool sweep, Geom::Point const &p);
+    void _closePath();
+
+    char const *_pos;
+    char const *_end;
+    Geom::PathVector &_pathv;
+
+    Geom::Path _path;
+    bool _in_path = false;
+    bool _comma = false; ///< A comma was read after the last argument, so another must follow.
+    bool _relative = false; ///< The last command used relative coordinates.
+    bool _moveto_relative = false;
+
+    Geom::Point _initial;
+    Geom::Point _current;
+    Geom::Point _cubic_tangent;
+    Geom::Point _quad_tangent;
+};
+
+bool PathDataParser::parse()
+{
+    _skipWsp();
+    if (_pos != _end && *_pos != 'M' && *_pos != 'm') {
+        return _fail();
+    }
+
+    while (_pos != _end) {
+        char const cmd = *_pos++;
+        bool const rel = cmd >= 'a' && cmd <= 'z';
+        if (cmd != 'Z' && cmd != 'z') {
+            _relative = rel;
+        }
+        _skipWsp();
+
+        Geom::Point c0, c1, p;
+        double x, y, rx, ry, angle;
+        bool large_arc, sweep;
+
+        switch (cmd) {
+            case 'M':
+            case 'm':
+                if (!_point(p, rel)) {
+                    return _fail();
+                }
+                _moveTo(p);
+                // Further coordinate pairs are implicit lineto commands.
+                while (_moreArguments()) {
+                    if (!_point(p, rel)) {
+                        return _fail();
+                    }
+                    _lineTo(p);
+                }
+                break;
+            case 'L':
+            case 'l':
+                do {
+                    if (!_point(p, rel)) {
+                        return _fail();
+                    }
+                    _lineTo(p);
+                } while (_moreArguments());
+                break;
+            case 'H':
+            case 'h':
+                do {
+                    if (!_coord(x, _current[Geom::X], rel)) {
+                        return _fail();
+                    }
+                    _lineTo(Geom::Point(x, _current[Geom::Y]));
+                } while (_moreArguments());
+                break;
+            case 'V':
+            case 'v':
+                do {
+                    if (!_coord(y, _current[Geom::Y], rel)) {
+                        return _fail();
+                    }
+                    _lineTo(Geom::Point(_current[Geom::X], y));
+                } while (_moreArguments());
+                break;
+            case 'C':
+            case 'c':
+                do {
+                    if (!_point(c0, rel) || !_point(c1, rel) || !_point(p, rel)) {
+                        return _fail();
+                    }
+                    _curveTo(c0, c1, p);
+                } while (_moreArguments());
+                break;
+            case 'S':
+            case 's':
+                do {
+                    if (!_point(c1, rel) || !_point(p, rel)) {
+                        return _fail();
+                    }
+                    _curveTo(_cubic_tangent, c1, p);
+                } while (_moreArguments());
+                break;
+            case 'Q':
+            case 'q':
+                do {
+                    if (!_point(c0, rel) || !_point(p, rel)) {
+                        return _fail();
+                    }
+                    _quadTo(c0, p);
+                } while (_moreArguments());
+                break;
+            case 'T':
+            case 't':
+                do {
+                    if (!_point(p, rel)) {
+                        return _fail();
+                    }
+                    _quadTo(_quad_tangent, p);
+                } while (_moreArguments());
+                break;
+            case 'A':
+            case 'a':
+                do {
+                    if (!_number(rx) || !_number(ry) || !_number(angle) || !_flag(large_arc) || !_flag(sweep) ||
+                        !_point(p, rel)) {
+                        return _fail();
+                    }
+                    _arcTo(rx, ry, angle, large_arc, sweep, p);
+                } while (_moreArguments());
+                break;
+            case 'Z':
+            case 'z':
+                _closePath();
+                _skipWsp();
+                break;
+            default:
+                return _fail();
+        }
+    }
+
+    if (_comma) {
+        return _fail(); // a trailing comma
+    }
+    _flush();
+    return true;
+}
+
+bool PathDataParser::_fail()
+{
+    _flush();
+    return false;
+}
+
+void PathDataParser::_skipWsp()
+{
+    while (_pos != _end && is_wsp(*_pos)) {
+        ++_pos;
+    }
+}
+
+bool PathDataParser::_moreArguments()
+{
+    return _comma || (_pos != _end && starts_number(*_pos));
+}
+
+/// Read a number and the comma or whitespace after it.
+bool PathDataParser::_number(double &value)
+{
+    char const *next = sp_svg_number_scan(_pos, _end, &value);
+    if (!next) {
+        return false;
+    }
+    _pos = next;
+    _skipWsp();
+    _comma = _pos != _end && *_pos == ',';
+    if (_comma) {
+        ++_pos;
+        _skipWsp();
+    }
+    return true;
+}
+
+bool PathDataParser::_coord(double &value, double origin, bool relative)
+{
+    if (!_number(value)) {
+        return false;
+    }
+    if (relative) {
+        value += origin;
+    }
+    return true;
+}
+
+bool PathDataParser::_point(Geom::Point &p, bool relative)
+{
+    return _coord(p[Geom::X], _current[Geom::X], relative) && _coord(p[Geom::Y], _current[Geom::Y], relative);
+}
+
+/// Read an arc flag, which need not be separated from what follows.
+bool PathDataParser::_flag(bool &flag)
+{
+    if (_pos == _end || (*_pos != '0' && *_pos != '1')) {
+        return false;
+    }
+    flag = *_pos++ == '1';
+    _skipWsp();
+    _comma = _pos != _end && *_pos == ',';
+    if (_comma) {
+        ++_pos;
+        _skipWsp();
+    }
+    return true;
+}
+
+/// Drawing after a closepath without a moveto starts a new subpath at the same point.
+void PathDataParser::_startPath()
+{
+    if (!_in_path) {
+        _path.start(_initial);
+        _in_path = true;
+    }
+}
+
+void PathDataParser::_flush()
+{
+    if (_in_path) {
+        _pathv.push_back(_path);
+        _path.clear();
+        _in_path = false;
+    }
+}
+
+void PathDataParser::_moveTo(Geom::Point const &p)
+{
+    _flush();
+    _path.start(p);
+    _in_path = true;
+    _moveto_relative = _relative;
+    _quad_tangent = _cubic_tangent = _current = _initial = p;
+}
+
+void PathDataParser::_lineTo(Geom::Point const &p)
+{
+    _startPath();
+    _path.appendNew<Geom::LineSegment>(p);
+    _quad_tangent = _cubic_tangent = _current = p;
+}
+
+void PathDataParser::_quadTo(Geom::Point const &c, Geom::Point const &p)
+{
+    _startPath();
+    _path.appendNew<Geom::QuadraticBezier>(c, p);
+    _cubic_tangent = _current = p;
+    _quad_tangent = p + (p - c);
+}
+
+void PathDataParser::_curveTo(Geom::Point const &c0, Geom::Point const &c1, Geom::Point const &p)
+{
+    _startPath();
+    _path.appendNew<Geom::CubicBezier>(c0, c1, p);
+    _quad_tangent = _current = p;
+    _cubic_tangent = p + (p - c1);
+}
+
+void PathDataParser::_arcTo(double rx, double ry, double angle, bool large_arc, bool sweep, Geom::Point const &p)
+{
+    if (_current == p) {
+        return; // the SVG specification omits arcs that end where they start
+    }
+    _startPath();
+    // Negative radii stand for their absolute values, as in SVG 2.
+    _path.appendNew<Geom::EllipticalArc>(std::fabs(rx), std::fabs(ry), Geom::rad_from_deg(angle), large_arc, sweep,
+                                         p);
+    _quad_tangent = _cubic_tangent = _current = p;
+}
+
+void PathDataParser::_closePath()
+{
+    if (_in_path) {
+        // Relative coordinates accumulate rounding errors, so land exactly on the start point if close.
+        if ((_relative || _moveto_relative) && !_path.empty() && Geom::are_near(_initial, _current, Geom::EPSILON)) {
+            _path.setFinal(_initial);
+        }
+        _path.close();
+        _flush();
+    }
+    _quad_tangent = _cubic_tangent = _current = _initial;
+}
+
+} // namespace
+
+bool sp_svg_read_pathv(char const *begin, char const *end, Geom::PathVector &pathv)
+{
+    return PathDataParser(begin, end, pathv).parse();
+}
+
 /*
  * Parses the path in str. When an error is found in the pathstring, this method
  * returns a truncated path up to where the error was found in the pathstring.
@@ -40,15 +373,7 @@ Geom::PathVector sp_svg_read_pathv(char const * str)
     if (!str)
         return pathv;  // return empty pathvector when str == NULL
 
-    Geom::PathBuilder builder(pathv);
-    Geom::SVGPathParser parser(builder);
-    parser.setZSnapThreshold(Geom::EPSILON);
-
-    try {
-        parser.parse(str);
-    }
-    catch (Geom::SVGPathParseError &e) {
-        builder.flush();
+    if (!sp_svg_read_pathv(str, str + std::strlen(str), pathv)) {
         // This warning is extremely annoying when testing
         g_warning(
             "Malformed SVG path, truncated path up to where error was found.\n Input path=\"%s\"\n Parsed path=\"%s\"",
@@ -33,8 +33,18 @@ unsigned int sp_svg_number_read_f( const char *str, float *val );
 unsigned int sp_svg_number_read_d( const char *str, double *val );
 
 /*
- * No buffer overflow checking is done, so better wrap them if needed
+ * Reads the number at the start of [begin, end), in SVG syntax and regardless of locale.
+ * Returns the position just past it, or nullptr if there is no number there.
  */
+char const *sp_svg_number_scan( char const *begin, char const *end, double *val );
+
+/*
+ * Writes val with tprec significant digits (decimal places below 1), or 0 if its exponent is
+ * below min_exp. The buffer version returns the end of what it wrote, which is never more than
+ * SP_SVG_NUMBER_BUFFER_SIZE characters and is not null-terminated.
+ */
+constexpr std::size_t SP_SVG_NUMBER_BUFFER_SIZE = 32;
+char *sp_svg_number_write_de( char *buf, double val, unsigned int tprec, int min_exp );
 std::string sp_svg_number_write_de( double val, unsigned int tprec, int min_exp );
 
 /* Length */
@@ -63,6 +73,11 @@ double sp_svg_read_percentage( const char * str, double def );
 /* NB! As paths can be long, we use here dynamic string */
 
 Geom::PathVector sp_svg_read_pathv( char const * str );
+/*
+ * Parses the path data in [begin, end) into pathv. Returns false if the data is malformed, in
+ * which case pathv holds the path up to the error. Does not warn, so it can run on any thread.
+ */
+bool sp_svg_read_pathv( char const *begin, char const *end, Geom::PathVector &pathv );
 std::string sp_svg_write_path(Geom::PathVector const &p, bool normalize = false);
 std::string sp_svg_write_path(Geom::Path const &p);
 
@@ -2897,6 +2897,8 @@ void InkscapePreferences::initPageRendering()
     // rendering cache
     _rendering_cache_size.init("/options/renderingcache/size", 0.0, 4096.0, 1.0, 32.0, 64.0, true, false);
     _page_rendering.add_line( false, _("Rendering _cache size:"), _rendering_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory per document which can be used to store rendered parts of the drawing for later reuse; set to zero to disable caching"), false);
+    _rendering_disk_cache_size.init("/options/renderingcache/disk", 0.0, 65536.0, 1.0, 64.0, 0.0, true, false);
+    _page_rendering.add_line( false, _("_Disk cache size:"), _rendering_disk_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of disk space which can be used to keep rendered parts of unchanged SVG files, so that they show faster when opened again; set to zero to disable the disk cache"), false);
 
     // rendering x-ray radius
     _rendering_xray_radius.init("/options/rendering/xray-radius", 1.0, 1500.0, 1.0, 100.0, 100.0, true, false);
@@ -2908,8 +2910,8 @@ void InkscapePreferences::initPageRendering()
 
     // update strategy
     {
-        constexpr int values[] = { 1, 2, 3 };
-        Glib::ustring const labels[] = { _("Responsive"), _("Full redraw"), _("Multiscale") };
+        constexpr int values[] = { 1, 2, 3, 4 };
+        Glib::ustring const labels[] = { _("Responsive"), _("Full redraw"), _("Multiscale"), _("Preview") };
         _canvas_update_strategy.init("/options/rendering/update_strategy", labels, values, 3);
         _page_rendering.add_line(false, _("Update strategy:"), _canvas_update_strategy, "", _("How to update continually changing content when it can't be redrawn fast enough"), false);
     }
@@ -3732,6 +3734,8 @@ void InkscapePreferences::initPageSystem()
     box->set_size_request(300, -1);
     _page_system.add_line( false, _("Shared default resources folder:"), *box, "",
                             _("A folder structured like a user's Inkscape preferences directory. This makes it possible to share a set of resources, such as extensions, fonts, icon sets, keyboard shortcuts, patterns/hatches, palettes, symbols, templates, themes and user interface definition files, between multiple users who have access to that folder (on the same computer or in the network). Requires a restart of Inkscape to work when changed."), false, reset_icon());
+    _sys_undo_budget.init("/options/undo/budget", 0.0, 65536.0, 1.0, 32.0, 256.0, true, false);
+    _page_system.add_line( false, _("Undo history memory:"), _sys_undo_budget, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory per document which the undo history can use; the oldest steps are forgotten beyond it. Set to zero for no limit"), false);
     _page_system.add_group_header( _("System info"));
 
     _sys_user_prefs.set_text(prefs->getPrefsFilename());
@@ -342,6 +342,7 @@ protected:
 
     UI::Widget::PrefSpinButton  _filter_multi_threaded;
     UI::Widget::PrefSpinButton  _rendering_cache_size;
+    UI::Widget::PrefSpinButton  _rendering_disk_cache_size;
     UI::Widget::PrefSpinButton  _rendering_xray_radius;
     UI::Widget::PrefSpinButton  _rendering_outline_overlay_opacity;
     UI::Widget::PrefCombo       _canvas_update_strategy;
@@ -455,6 +456,7 @@ protected:
     UI::Widget::PrefOpenFolder _sys_user_paint_servers_dir;
     UI::Widget::PrefMultiEntry _sys_fontdirs_custom;
     UI::Widget::PrefEntryFile  _sys_shared_path;
+    UI::Widget::PrefSpinButton _sys_undo_budget;
     Gtk::Entry                 _sys_user_cache;
     Gtk::Entry                 _sys_data;
     Gtk::TextView              _sys_icon;
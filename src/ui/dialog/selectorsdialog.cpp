@@ -741,7 +741,7 @@ void SelectorsDialog::_addToSelector(Gtk::TreeModel::Row row)
         sp_repr_css_attr_unref(css_selector);
 
         obj->getRepr()->setAttribute("style", css_str);
-        obj->style->readFromObject(obj);
+        obj->readStyle();
         obj->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
     }
 
@@ -804,7 +804,7 @@ void SelectorsDialog::_removeFromSelector(Gtk::TreeModel::Row row)
 
     // Add entry to style element
     _writeStyleElement();
-    obj->style->readFromObject(obj);
+    obj->readStyle();
     obj->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
     _scrollock = false;
     _vadj->set_value(std::min(_scrollpos, _vadj->get_upper()));
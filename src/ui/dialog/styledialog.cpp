@@ -872,7 +872,7 @@ void StyleDialog::readStyleElement()
     }
 
     if (obj) {
-        obj->style->readFromObject(obj);
+        obj->readStyle();
         obj->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
     }
 
@@ -1091,7 +1091,7 @@ void StyleDialog::_writeStyleElement(Glib::RefPtr<Gtk::TreeStore> const &store,
     _updating = false;
     readStyleElement();
     for (auto iter : getDocument()->getObjectsBySelector(selector)) {
-        iter->style->readFromObject(iter);
+        iter->readStyle();
         iter->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
     }
     DocumentUndo::done(SP_ACTIVE_DOCUMENT, _("Edited style element."), "");
@@ -1362,7 +1362,7 @@ void StyleDialog::_valueEdited(const Glib::ustring &path, const Glib::ustring &v
                 css->removeAttribute(name);
                 sp_repr_css_write_string(css, css_str);
                 obj->getRepr()->setAttribute("style", css_str);
-                obj->style->readFromObject(obj);
+                obj->readStyle();
                 obj->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG | SP_OBJECT_STYLE_MODIFIED_FLAG);
             }
         }
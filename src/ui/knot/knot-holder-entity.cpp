@@ -511,7 +511,7 @@ void BlurKnotHolderEntity::on_created()
     _line->set_visible(false);
 
     // This watcher makes sure that adding or removing a blur results in updated knots.
-    _watch_filter = item->style->signal_filter_changed.connect([this] (auto old_obj, auto obj) {
+    _watch_filter = item->connectFilterChanged([this] (auto old_obj, auto obj) {
         update_knot();
     }); 
 }
@@ -2442,7 +2442,7 @@ TextKnotHolderEntityShapeMargin::knot_set(Geom::Point const &p, Geom::Point cons
         if (margin >= 0.0) {
             Inkscape::CSSOStringStream os;
             os << margin;
-            linked_shape->style->shape_margin.read(os.str().c_str());
+            linked_shape->writableStyle()->shape_margin.read(os.str().c_str());
 
             linked_shape->requestDisplayUpdate(SP_OBJECT_MODIFIED_FLAG);
             linked_shape->updateRepr();
@@ -890,6 +890,7 @@ sp_tweak_color_recursive (guint mode, SPItem *item, SPItem *item_at_point,
                 tweak_colors_in_gradient(item, Inkscape::FOR_FILL, *fill_goal, p, radius, this_force, mode, do_h, do_s, do_l, do_o);
                 did = true;
             } else if (style->fill.isColor()) {
+                style = item->writableStyle();
                 style->fill.setColor(tweak_color(mode, style->fill.getColor(), *fill_goal, this_force, do_h, do_s, do_l));
                 item->updateRepr();
                 did = true;
@@ -900,6 +901,7 @@ sp_tweak_color_recursive (guint mode, SPItem *item, SPItem *item_at_point,
                 tweak_colors_in_gradient(item, Inkscape::FOR_STROKE, *stroke_goal, p, radius, this_force, mode, do_h, do_s, do_l, do_o);
                 did = true;
             } else if (style->stroke.isColor()) {
+                style = item->writableStyle();
                 style->stroke.setColor(tweak_color(mode, style->stroke.getColor(), *stroke_goal, this_force, do_h, do_s, do_l));
                 item->updateRepr();
                 did = true;
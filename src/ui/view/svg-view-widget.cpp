@@ -76,6 +76,7 @@ void SVGViewWidget::setDocument(SPDocument *document)
     // Clear old document
     if (_document) {
         _document->getRoot()->invoke_hide(_dkey); // Removed from display tree
+        _drawing->set_disk_cache_document(nullptr);
     }
 
     _document = document;
@@ -92,6 +93,7 @@ void SVGViewWidget::setDocument(SPDocument *document)
         }
 
         set_layer_modes(_document->getRoot(), _dkey);
+        _drawing->set_disk_cache_document(_document);
 
         doRescale();
     }
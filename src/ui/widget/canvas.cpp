@@ -16,15 +16,15 @@
 
 #include <algorithm> // Sort
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cmath>
 #include <iostream> // Logging
 #include <mutex>
 #include <set> // Coarsener
 #include <thread>
 #include <utility>
 #include <vector>
-#include <boost/asio/thread_pool.hpp>
-#include <boost/asio/post.hpp>
 #include <gtkmm/eventcontrollerfocus.h>
 #include <gtkmm/eventcontrollerkey.h>
 #include <gtkmm/eventcontrollermotion.h>
@@ -47,8 +47,10 @@
 #include "display/control/canvas-item-drawing.h"
 #include "display/control/canvas-item-group.h"
 #include "display/control/snap-indicator.h"
+#include "display/dispatch-pool.h"
 #include "display/drawing.h"
 #include "display/drawing-item.h"
+#include "display/tile-disk-cache.h"
 #include "document.h"
 #include "events/canvas-event.h"
 #include "helper/geom.h"
@@ -113,7 +115,8 @@ auto pref_to_updater(int index)
 {
     constexpr auto arr = std::array{Updater::Strategy::Responsive,
                                     Updater::Strategy::FullRedraw,
-                                    Updater::Strategy::Multiscale};
+                                    Updater::Strategy::Multiscale,
+                                    Updater::Strategy::Preview};
     assert(1 <= index && index <= arr.size());
     return arr[index - 1];
 }
@@ -135,6 +138,19 @@ struct Tile
     Fragment fragment;
     Cairo::RefPtr<Cairo::ImageSurface> surface;
     Cairo::RefPtr<Cairo::ImageSurface> outline_surface;
+    bool cancelled = false; // Whether painting was abandoned, leaving the surfaces to be junked.
+};
+
+// How far ahead to predict where panning is heading, and for how long the prediction holds, in microseconds.
+constexpr gint64 PAN_LOOKAHEAD = 200000;
+constexpr gint64 PAN_PREDICTION_LIFETIME = 100000;
+
+// Where the view is predicted to be shortly, from the velocity of panning.
+struct PanPrediction
+{
+    Geom::IntRect rect;   // Rectangles outside this region are not worth painting yet.
+    Geom::IntPoint focus; // Rectangles are painted outwards from this point instead of the mouse.
+    gint64 expiry;        // Monotonic time after which the prediction no longer holds.
 };
 
 // The urgency with which the async redraw process should exit.
@@ -184,17 +200,26 @@ struct RedrawData
     bool preemptible;
     std::vector<Geom::IntRect> rects;
     int effective_tile_size;
+    bool preview; // Whether the rectangles are to be drawn as a preview, at reduced resolution and quality.
+
+    // Prediction of where panning is heading, which the main thread may update at any time under the mutex.
+    Geom::IntPoint focus;
+    std::optional<PanPrediction> prediction;
+    bool prediction_changed;
+    bool deferred; // Whether any rectangles were left dirty because of the prediction.
+    std::vector<std::pair<Geom::IntRect, std::atomic<bool> *>> inflight; // Rectangles being painted, with flags to cancel them.
 
     // Results
     std::mutex tiles_mutex;
     std::vector<Tile> tiles;
     bool timeoutflag;
+    bool preview_done; // Whether a preview pass has finished, and should be shown before it is refined.
 
-    // Return comparison object for sorting rectangles by distance from mouse point.
+    // Return comparison object for sorting rectangles by distance from the focus point.
     auto getcmp() const
     {
-        return [mouse_loc = mouse_loc] (Geom::IntRect const &a, Geom::IntRect const &b) {
-            return a.distanceSq(mouse_loc) > b.distanceSq(mouse_loc);
+        return [focus = focus] (Geom::IntRect const &a, Geom::IntRect const &b) {
+            return a.distanceSq(focus) > b.distanceSq(focus);
         };
     }
 };
@@ -247,6 +272,12 @@ public:
     void after_redraw();
     void commit_tiles();
 
+    // Steering the redraw process by the velocity of panning.
+    Geom::Point pan_velocity; // In pixels per microsecond.
+    gint64 last_pan_time = 0;
+    sigc::connection deferred_redraw_conn; // Redraws what was deferred while panning, once panning stops.
+    void predict_pan(Geom::IntPoint const &delta);
+
     // Event handling.
     bool process_event(CanvasEvent &event);
     CanvasItem *find_item_at(Geom::Point pt);
@@ -277,9 +308,9 @@ public:
     bool background_in_stores_enabled = false; // Whether the page and desk should be drawn into the stores/tiles; if not then transparency is used instead.
     bool background_in_stores_required() const { return !q->get_opengl_enabled() && SP_RGBA32_A_U(page) == 255 && SP_RGBA32_A_U(desk) == 255; } // Enable solid colour optimisation if both page and desk are solid (as opposed to checkerboard).
 
-    // Async redraw process.
-    std::optional<boost::asio::thread_pool> pool;
-    int numthreads;
+    // Async redraw process. Its tiles wait for the main thread, so they must not share a pool with
+    // work the main thread waits for, such as exports and saving. Filters in the tiles run on it too.
+    std::optional<DispatchPool> pool;
     int get_numthreads() const;
 
     Synchronizer sync;
@@ -291,8 +322,8 @@ public:
     bool end_redraw(); // returns true to indicate further redraw cycles required
     void process_redraw(Geom::IntRect const &bounds, Cairo::RefPtr<Cairo::Region> clean, bool interruptible = true, bool preemptible = true);
     void render_tile(int debug_id);
-    void paint_rect(Geom::IntRect const &rect);
-    void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass);
+    bool paint_rect(Geom::IntRect const &rect, bool preview, std::atomic<bool> const &cancel);
+    void paint_single_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const Geom::IntRect &rect, bool need_background, bool outline_pass, bool preview = false, std::atomic<bool> const *cancel = nullptr);
     void paint_error_buffer(const Cairo::RefPtr<Cairo::ImageSurface> &surface);
 
     // Trivial overload of GtkWidget function.
@@ -376,6 +407,7 @@ Canvas::Canvas()
             d->activate();
         }
     };
+    d->prefs.numthreads.action = [this] { d->pool->set_num_threads(d->get_numthreads()); };
     d->prefs.pixelstreamer_method.action = [this] {
         if (get_realized() && get_opengl_enabled()) {
             d->deactivate();
@@ -384,17 +416,6 @@ Canvas::Canvas()
             d->activate();
         }
     };
-    d->prefs.numthreads.action = [this] {
-        if (!d->active) return;
-        int const new_numthreads = d->get_numthreads();
-        if (d->numthreads == new_numthreads) return;
-        d->numthreads = new_numthreads;
-        d->deactivate();
-        d->deactivate_graphics();
-        d->pool.emplace(d->numthreads);
-        d->activate_graphics();
-        d->activate();
-    };
 
     // Canvas item tree
     d->canvasitem_ctx.emplace(this);
@@ -414,9 +435,7 @@ Canvas::Canvas()
     set_opengl_enabled(d->prefs.request_opengl);
 
     // Async redraw process.
-    d->numthreads = d->get_numthreads();
-    d->pool.emplace(d->numthreads);
-
+    d->pool.emplace(d->get_numthreads());
     d->sync.connectExit([this] { d->after_redraw(); });
 }
 
@@ -476,6 +495,7 @@ void CanvasPrivate::activate()
 void CanvasPrivate::deactivate()
 {
     active = false;
+    deferred_redraw_conn.disconnect();
 
     if (redraw_active) {
         if (schedule_redraw_conn.connected()) {
@@ -586,6 +606,8 @@ void CanvasPrivate::launch_redraw()
 {
     assert(redraw_active);
 
+    deferred_redraw_conn.disconnect();
+
     if (q->_render_mode != render_mode) {
         if ((render_mode == RenderMode::OUTLINE_OVERLAY) != (q->_render_mode == RenderMode::OUTLINE_OVERLAY) && !q->get_opengl_enabled()) {
             q->queue_draw(); // Clear the whitewash effect, an artifact of cairo mode.
@@ -700,12 +722,20 @@ void CanvasPrivate::launch_redraw()
     rd.debug_framecheck = prefs.debug_framecheck;
     rd.debug_show_redraw = prefs.debug_show_redraw;
 
+    // Paint outwards from where panning is heading instead of the mouse, if it is still heading somewhere.
+    if (rd.prediction && (rd.decoupled_mode || rd.prediction->expiry <= g_get_monotonic_time())) {
+        rd.prediction.reset();
+    }
+    rd.focus = rd.prediction ? rd.prediction->focus : rd.mouse_loc;
+    rd.prediction_changed = false;
+    rd.deferred = false;
+
     rd.snapshot_drawn = stores.snapshot().drawn ? stores.snapshot().drawn->copy() : Cairo::RefPtr<Cairo::Region>();
     rd.cms_transform = q->_cms_active ? q->_cms_transform : nullptr;
 
     abort_flags.store((int)AbortFlags::None, std::memory_order_relaxed);
 
-    boost::asio::post(*pool, [this] { init_tiler(); });
+    pool->post([this] { init_tiler(); });
 }
 
 void CanvasPrivate::after_redraw()
@@ -735,13 +765,60 @@ void CanvasPrivate::after_redraw()
     }
 
     // Relaunch or stop as necessary.
-    if (rd.timeoutflag || redraw_requested || stores_changed) {
+    if (rd.timeoutflag || rd.preview_done || redraw_requested || stores_changed) {
         if (prefs.debug_logging) std::cout << "Continuing redrawing" << std::endl;
         redraw_requested = false;
         launch_redraw();
     } else {
         if (prefs.debug_logging) std::cout << "Redraw exit" << std::endl;
         redraw_active = false;
+
+        // Come back for the rectangles deferred while panning, once the prediction has lapsed.
+        if (rd.deferred) {
+            deferred_redraw_conn = Glib::signal_timeout().connect([this] {
+                schedule_redraw();
+                return false;
+            }, PAN_PREDICTION_LIFETIME / 1000);
+        }
+    }
+}
+
+// Estimate where panning is heading from its recent velocity, and steer the redraw process there:
+// rectangles are painted outwards from the predicted position, and those the view is leaving behind
+// are deferred, or cancelled if already being painted.
+void CanvasPrivate::predict_pan(Geom::IntPoint const &delta)
+{
+    if (!active || stores.mode() != Stores::Mode::Normal) {
+        return;
+    }
+
+    auto const now = g_get_monotonic_time();
+    auto const dt = now - last_pan_time;
+    last_pan_time = now;
+    if (dt > PAN_PREDICTION_LIFETIME) {
+        // Panning has just started, so there is no velocity yet.
+        pan_velocity = {};
+        return;
+    }
+
+    // Smooth out the jitter of input events, some of which arrive within the same frame.
+    pan_velocity = 0.5 * pan_velocity + 0.5 * Geom::Point(delta) / std::max<gint64>(dt, 1000);
+    auto const lead = (pan_velocity * PAN_LOOKAHEAD).round();
+
+    // In normal mode, the store is in world space.
+    auto const visible = q->get_area_world();
+    auto predicted = visible;
+    predicted.unionWith(visible + lead);
+    predicted = expandedBy(predicted, prefs.prerender);
+    auto const focus = (last_mouse.value_or(Geom::Point(q->get_dimensions()) / 2) + Geom::Point(q->_pos + lead)).round();
+
+    auto lock = std::lock_guard(rd.mutex);
+    rd.prediction = PanPrediction{ predicted, focus, now + PAN_PREDICTION_LIFETIME };
+    rd.prediction_changed = true;
+    for (auto &[rect, cancel] : rd.inflight) {
+        if (!predicted.intersects(rect)) {
+            cancel->store(true, std::memory_order_relaxed);
+        }
     }
 }
 
@@ -785,6 +862,15 @@ void CanvasPrivate::commit_tiles()
     }
 
     for (auto &tile : tiles) {
+        // Dispose of tiles abandoned while panning; their rectangles were marked dirty again.
+        if (tile.cancelled) {
+            graphics->junk_tile_surface(std::move(tile.surface));
+            if (tile.outline_surface) {
+                graphics->junk_tile_surface(std::move(tile.outline_surface));
+            }
+            continue;
+        }
+
         // Paste tile content onto stores.
         graphics->draw_tile(tile.fragment, std::move(tile.surface), std::move(tile.outline_surface));
 
@@ -1674,7 +1760,9 @@ void Canvas::set_pos(Geom::IntPoint const &pos)
         return;
     }
 
+    auto const delta = pos - _pos;
     _pos = pos;
+    d->predict_pan(delta);
 
     d->schedule_redraw();
     queue_draw();
@@ -2119,6 +2207,7 @@ void CanvasPrivate::init_tiler()
     // Begin processing redraws.
     rd.start_time = g_get_monotonic_time();
     rd.phase = 0;
+    rd.preview_done = false;
     rd.vis_store = (rd.visible & rd.store.rect).regularized();
 
     if (!init_redraw()) {
@@ -2132,7 +2221,7 @@ void CanvasPrivate::init_tiler()
     rd.numactive = rd.numthreads;
 
     for (int i = 0; i < rd.numthreads - 1; i++) {
-        boost::asio::post(*pool, [=, this] { render_tile(i); });
+        pool->post([=, this] { render_tile(i); });
     }
 
     render_tile(rd.numthreads - 1);
@@ -2147,7 +2236,8 @@ bool CanvasPrivate::init_redraw()
             if (rd.vis_store && rd.decoupled_mode) {
                 // The highest priority to redraw is the region that is visible but not covered by either clean or snapshot content, if in decoupled mode.
                 // If this is not rendered immediately, it will be perceived as edge flicker, most noticeably on zooming out, but also on rotation too.
-                process_redraw(*rd.vis_store, unioned(updater->clean_region->copy(), rd.snapshot_drawn));
+                rd.preview = updater->preview_pass();
+                process_redraw(*rd.vis_store, unioned(updater->get_drawn_region()->copy(), rd.snapshot_drawn));
                 return true;
             } else {
                 rd.phase++;
@@ -2158,7 +2248,9 @@ bool CanvasPrivate::init_redraw()
             if (rd.vis_store) {
                 // The main priority to redraw, and the bread and butter of Inkscape's painting, is the visible content that is not clean.
                 // This may be done over several cycles, at the direction of the Updater, each outwards from the mouse.
-                process_redraw(*rd.vis_store, updater->get_next_clean_region());
+                auto clean = updater->get_next_clean_region();
+                rd.preview = updater->preview_pass();
+                process_redraw(*rd.vis_store, std::move(clean));
                 return true;
             } else {
                 rd.phase++;
@@ -2170,6 +2262,7 @@ bool CanvasPrivate::init_redraw()
             // (This is in addition to any opportunistic prerendering that may have already occurred in the above steps.)
             auto prerender = expandedBy(rd.visible, rd.margin);
             auto prerender_store = (prerender & rd.store.rect).regularized();
+            rd.preview = false;
             if (prerender_store) {
                 process_redraw(*prerender_store, updater->clean_region);
                 return true;
@@ -2230,7 +2323,7 @@ void CanvasPrivate::render_tile(int debug_id)
     while (true) {
         // If we've run out of rects, try to start a new redraw cycle.
         if (rd.rects.empty()) {
-            if (end_redraw()) {
+            if (!rd.preview_done && end_redraw()) {
                 // More redraw cycles to do.
                 continue;
             } else {
@@ -2247,7 +2340,14 @@ void CanvasPrivate::render_tile(int debug_id)
             break;
         }
 
-        // Extract the closest rectangle to the mouse.
+        // Follow the latest prediction of where panning is heading.
+        if (rd.prediction_changed) {
+            rd.prediction_changed = false;
+            rd.focus = rd.prediction->focus;
+            std::make_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
+        }
+
+        // Extract the closest rectangle to the focus point.
         std::pop_heap(rd.rects.begin(), rd.rects.end(), rd.getcmp());
         auto rect = rd.rects.back();
         rd.rects.pop_back();
@@ -2263,6 +2363,12 @@ void CanvasPrivate::render_tile(int debug_id)
             continue;
         }
 
+        // Defer rectangles the view is panning away from, leaving them dirty for a later redraw.
+        if (rd.prediction && !rd.prediction->rect.intersects(rect) && g_get_monotonic_time() < rd.prediction->expiry) {
+            rd.deferred = true;
+            continue;
+        }
+
         // Lambda to add a rectangle to the heap.
         auto add_rect = [&] (Geom::IntRect const &rect) {
             rd.rects.emplace_back(rect);
@@ -2272,6 +2378,12 @@ void CanvasPrivate::render_tile(int debug_id)
         // If the rectangle needs bisecting, bisect it and put it back on the heap.
         if (auto axis = bisect(rect, rd.effective_tile_size)) {
             int mid = rect[*axis].middle();
+            // Prefer cutting along the tile grid of the disk cache, so that rectangles cover whole tiles.
+            constexpr int grid = TileDiskCache::TILE_SIZE;
+            int const snapped = std::round((double)mid / grid) * grid;
+            if (std::abs(snapped - mid) <= rect[*axis].extent() / 4) {
+                mid = snapped;
+            }
             auto lo = rect; lo[*axis].setMax(mid); add_rect(lo);
             auto hi = rect; hi[*axis].setMin(mid); add_rect(hi);
             continue;
@@ -2290,16 +2402,33 @@ void CanvasPrivate::render_tile(int debug_id)
             }
         }
 
-        // Mark the rectangle as clean.
-        updater->mark_clean(rect);
+        // Mark the rectangle as clean, or as needing refinement if drawn as a preview.
+        bool const preview = rd.preview;
+        if (preview) {
+            updater->mark_coarse(rect);
+        } else {
+            updater->mark_clean(rect);
+        }
+
+        // Allow painting to be cancelled if the view pans away from the rectangle.
+        std::atomic<bool> cancel = false;
+        rd.inflight.emplace_back(rect, &cancel);
 
         rd.mutex.unlock();
 
         // Paint the rectangle.
-        paint_rect(rect);
+        bool const painted = paint_rect(rect, preview, cancel);
 
         rd.mutex.lock();
 
+        std::erase(rd.inflight, std::pair{rect, &cancel});
+
+        // If painting was cancelled, the rectangle must be painted again later.
+        if (!painted) {
+            updater->mark_dirty(rect);
+            rd.deferred = true;
+        }
+
         // Check for timeout.
         if (rd.interruptible) {
             auto now = g_get_monotonic_time();
@@ -2337,6 +2466,10 @@ bool CanvasPrivate::end_redraw()
         case 1:
             if (!updater->report_finished()) {
                 rd.phase++;
+            } else if (rd.preview) {
+                // Return to the main loop to show the preview, and refine it on the next redraw.
+                rd.preview_done = true;
+                return false;
             }
             return init_redraw();
 
@@ -2349,11 +2482,15 @@ bool CanvasPrivate::end_redraw()
     }
 }
 
-void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
+// Paint a rectangle and queue the resulting tile for committing. Returns false if painting was cancelled.
+bool CanvasPrivate::paint_rect(Geom::IntRect const &rect, bool preview, std::atomic<bool> const &cancel)
 {
     // Make sure the paint rectangle lies within the store.
     assert(rd.store.rect.contains(rect));
 
+    FrameCheck::Event fc;
+    if (rd.debug_framecheck) fc = FrameCheck::Event("paint_rect");
+
     auto paint = [&, this] (bool need_background, bool outline_pass) {
 
         auto surface = graphics->request_tile_surface(rect, true);
@@ -2367,7 +2504,7 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
 
         try {
 
-            paint_single_buffer(surface, rect, need_background, outline_pass);
+            paint_single_buffer(surface, rect, need_background, outline_pass, preview, &cancel);
 
         } catch (std::bad_alloc const &) {
             // Note: std::bad_alloc actually indicates a Cairo error that occurs regularly at high zoom, and we must handle it.
@@ -2389,9 +2526,14 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
     tile.fragment.affine = rd.store.affine;
     tile.fragment.rect = rect;
     tile.surface = paint(rd.background_in_stores_required, false);
-    if (outlines_enabled) {
+    if (outlines_enabled && !cancel.load(std::memory_order_relaxed)) {
         tile.outline_surface = paint(false, true);
     }
+    bool const cancelled = cancel.load(std::memory_order_relaxed);
+    tile.cancelled = cancelled;
+    if (cancelled && rd.debug_framecheck) {
+        fc.subtype = 1;
+    }
 
     // Introduce an artificial delay for each rectangle.
     if (rd.redraw_delay) g_usleep(*rd.redraw_delay);
@@ -2401,13 +2543,28 @@ void CanvasPrivate::paint_rect(Geom::IntRect const &rect)
         auto g = std::lock_guard(rd.tiles_mutex);
         rd.tiles.emplace_back(std::move(tile));
     }
+
+    return !cancelled;
 }
 
-void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface, Geom::IntRect const &rect, bool need_background, bool outline_pass)
+void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const &surface, Geom::IntRect const &rect, bool need_background, bool outline_pass, bool preview, std::atomic<bool> const *cancel)
 {
+    double device_scale;
+    cairo_surface_get_device_scale(surface->cobj(), &device_scale, nullptr); // No C++ API!
+
     // Create Cairo context.
     auto cr = Cairo::Context::create(surface);
 
+    // Paint a preview for a high DPI monitor at low resolution, then scale it up.
+    if (preview && device_scale > 1) {
+        auto lowres = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, rect.width(), rect.height());
+        paint_single_buffer(lowres, rect, need_background, outline_pass, preview, cancel);
+        cr->set_source(lowres, 0, 0);
+        cr->set_operator(Cairo::Context::Operator::SOURCE);
+        cr->paint();
+        return;
+    }
+
     // Clear background.
     cr->save();
     if (need_background) {
@@ -2419,7 +2576,7 @@ void CanvasPrivate::paint_single_buffer(Cairo::RefPtr<Cairo::ImageSurface> const
     cr->restore();
 
     // Render drawing on top of background.
-    auto buf = CanvasItemBuffer{ rect, scale_factor, cr, outline_pass };
+    auto buf = CanvasItemBuffer{ rect, (int)device_scale, cr, outline_pass, preview, cancel };
     canvasitem_ctx->root()->render(buf);
 
     // Apply CMS transform for the screen. This rarely is used by modern desktops, but sometimes
@@ -16,8 +16,11 @@ public:
     void mark_dirty(Geom::IntRect const &rect)               override { clean_region->subtract(geom_to_cairo(rect)); }
     void mark_dirty(Cairo::RefPtr<Cairo::Region> const &reg) override { clean_region->subtract(reg); }
     void mark_clean(Geom::IntRect const &rect)               override { clean_region->do_union(geom_to_cairo(rect)); }
+    void mark_coarse(Geom::IntRect const &rect)              override { mark_clean(rect); }
 
     Cairo::RefPtr<Cairo::Region> get_next_clean_region() override { return clean_region; }
+    bool                         preview_pass         () const override { return false; }
+    Cairo::RefPtr<Cairo::Region> get_drawn_region     () const override { return clean_region; }
     bool                         report_finished      () override { return false; }
     void                         next_frame           () override {}
 };
@@ -204,9 +207,89 @@ public:
     }
 };
 
+class PreviewUpdater : public ResponsiveUpdater
+{
+    // Whether we are currently refining the preview, as opposed to previewing.
+    bool refining = false;
+
+    // The region drawn only as a preview. Not part of the clean region, so lost if the strategy changes.
+    Cairo::RefPtr<Cairo::Region> coarse_region = Cairo::Region::create();
+
+public:
+    Strategy get_strategy() const override { return Strategy::Preview; }
+
+    void reset() override
+    {
+        ResponsiveUpdater::reset();
+        coarse_region = Cairo::Region::create();
+        refining = false;
+    }
+
+    void intersect(Geom::IntRect const &rect) override
+    {
+        ResponsiveUpdater::intersect(rect);
+        coarse_region->intersect(geom_to_cairo(rect));
+    }
+
+    void mark_dirty(Geom::IntRect const &rect) override
+    {
+        ResponsiveUpdater::mark_dirty(rect);
+        coarse_region->subtract(geom_to_cairo(rect));
+        refining = false; // Preview new damage before carrying on refining.
+    }
+
+    void mark_dirty(Cairo::RefPtr<Cairo::Region> const &reg) override
+    {
+        if (reg->empty()) return;
+        ResponsiveUpdater::mark_dirty(reg);
+        coarse_region->subtract(reg);
+        refining = false;
+    }
+
+    void mark_clean(Geom::IntRect const &rect) override
+    {
+        ResponsiveUpdater::mark_clean(rect);
+        coarse_region->subtract(geom_to_cairo(rect));
+    }
+
+    void mark_coarse(Geom::IntRect const &rect) override
+    {
+        coarse_region->do_union(geom_to_cairo(rect));
+    }
+
+    Cairo::RefPtr<Cairo::Region> get_next_clean_region() override
+    {
+        // When previewing, leave out what was already previewed.
+        return refining ? clean_region : get_drawn_region();
+    }
+
+    bool preview_pass() const override { return !refining; }
+
+    Cairo::RefPtr<Cairo::Region> get_drawn_region() const override
+    {
+        auto result = clean_region->copy();
+        result->do_union(coarse_region);
+        return result;
+    }
+
+    bool report_finished() override
+    {
+        if (!refining) {
+            // Completed preview => refine it, unless there is nothing to refine.
+            refining = !coarse_region->empty();
+            return refining;
+        } else {
+            // Completed refining => finished.
+            refining = false;
+            return false;
+        }
+    }
+};
+
 template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::Responsive>() {return std::make_unique<ResponsiveUpdater>();}
 template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::FullRedraw>() {return std::make_unique<FullRedrawUpdater>();}
 template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::Multiscale>() {return std::make_unique<MultiscaleUpdater>();}
+template<> std::unique_ptr<Updater> Updater::create<Updater::Strategy::Preview>   () {return std::make_unique<PreviewUpdater>();}
 
 std::unique_ptr<Updater> Updater::create(Strategy strategy)
 {
@@ -215,6 +298,7 @@ std::unique_ptr<Updater> Updater::create(Strategy strategy)
         case Strategy::Responsive: return create<Strategy::Responsive>();
         case Strategy::FullRedraw: return create<Strategy::FullRedraw>();
         case Strategy::Multiscale: return create<Strategy::Multiscale>();
+        case Strategy::Preview:    return create<Strategy::Preview>();
         default: return nullptr; // Never triggered, but GCC errors out on build without.
     }
 }
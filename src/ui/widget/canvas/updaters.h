@@ -32,6 +32,7 @@ public:
         Responsive, // As soon as a region is invalidated, redraw it.
         FullRedraw, // When a region is invalidated, delay redraw until after the current redraw is completed.
         Multiscale, // Updates tiles near the mouse faster. Gives the best of both.
+        Preview,    // Redraw invalidated regions quickly at low quality first, then refine them.
     };
 
     // Create an Updater using the given strategy.
@@ -49,6 +50,13 @@ public:
     virtual void mark_dirty(Geom::IntRect const &) = 0;                // Called on every invalidate event.
     virtual void mark_dirty(Cairo::RefPtr<Cairo::Region> const &) = 0; // Called on every invalidate event.
     virtual void mark_clean(Geom::IntRect const &) = 0;                // Called on every rectangle redrawn.
+    virtual void mark_coarse(Geom::IntRect const &) = 0;               // Called instead on every rectangle redrawn as a preview.
+
+    // Whether to redraw as a preview, at reduced resolution and quality, for the time being.
+    virtual bool preview_pass() const = 0;
+
+    // The subregion of the store with content, up-to-date if only as a preview.
+    virtual Cairo::RefPtr<Cairo::Region> get_drawn_region() const = 0;
 
     // Called at the start of a redraw to determine what region to consider clean (i.e. will not be drawn).
     virtual Cairo::RefPtr<Cairo::Region> get_next_clean_region() = 0;
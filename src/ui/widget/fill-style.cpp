@@ -515,7 +515,7 @@ void FillNStroke::updateFromPaint(bool switch_style)
                 for (auto item : items) {
                     // fill and stroke opacity should never be set on gradients since in our user interface
                     // these are controlled by the gradient stops themselves.
-                    item->style->clear(kind == FILL ? SPAttr::FILL_OPACITY : SPAttr::STROKE_OPACITY);
+                    item->writableStyle()->clear(kind == FILL ? SPAttr::FILL_OPACITY : SPAttr::STROKE_OPACITY);
                 }
                 DocumentUndo::done(document, (kind == FILL) ? _("Set gradient on fill") : _("Set gradient on stroke"), INKSCAPE_ICON("dialog-fill-and-stroke"));
             }
@@ -177,11 +177,12 @@ void ObjectCompositeSettings::_isolationValueChanged()
     _blocked = true;
 
     for (auto item : _subject->list()) {
-        item->style->isolation.set = TRUE;
-        item->style->isolation.value = _filter_modifier.get_isolation_mode();
-        if (item->style->isolation.value == SP_CSS_ISOLATION_ISOLATE) {
-            item->style->mix_blend_mode.set = TRUE;
-            item->style->mix_blend_mode.value = SP_CSS_BLEND_NORMAL;
+        auto const style = item->writableStyle();
+        style->isolation.set = TRUE;
+        style->isolation.value = _filter_modifier.get_isolation_mode();
+        if (style->isolation.value == SP_CSS_ISOLATION_ISOLATE) {
+            style->mix_blend_mode.set = TRUE;
+            style->mix_blend_mode.value = SP_CSS_BLEND_NORMAL;
         }
         item->updateRepr(SP_OBJECT_WRITE_NO_CHILDREN | SP_OBJECT_WRITE_EXT);
     }
@@ -65,6 +65,14 @@ public:
 	 */
 	virtual void notifyClearRedoEvent() = 0;
 
+	/**
+	 * Triggered when the oldest event of the undo log is dropped to keep the log within its
+	 * memory budget.  The event is deleted once the observers have been notified.
+	 *
+	 * \param log Pointer to the Event that is dropped.
+	 */
+	virtual void notifyUndoExpiredEvent(Event* log) = 0;
+
 };
 
 }
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * String-keyed lookup helpers shared by the document's object index and the style rule index.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef INKSCAPE_UTIL_STRING_KEYS_H
+#define INKSCAPE_UTIL_STRING_KEYS_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Inkscape::Util {
+
+/// Lets string-keyed maps be searched with char const * or std::string_view without a copy.
+struct StringHash
+{
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+template <typename T>
+using StringMap = std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
+
+/// Call @a f with each of the whitespace-separated names in a class attribute.
+template <typename F>
+void for_each_class(char const *classes, F &&f)
+{
+    if (!classes) return;
+
+    constexpr auto space = " \t\n\v\f\r";
+    std::string_view rest = classes;
+    while (true) {
+        auto const start = rest.find_first_not_of(space);
+        if (start == std::string_view::npos) break;
+        rest.remove_prefix(start);
+        auto const end = rest.find_first_of(space);
+        f(rest.substr(0, end));
+        if (end == std::string_view::npos) break;
+        rest.remove_prefix(end);
+    }
+}
+
+} // namespace Inkscape::Util
+
+#endif // INKSCAPE_UTIL_STRING_KEYS_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
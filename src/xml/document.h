@@ -13,6 +13,7 @@
 #ifndef SEEN_INKSCAPE_XML_SP_REPR_DOC_H
 #define SEEN_INKSCAPE_XML_SP_REPR_DOC_H
 
+#include "util/share.h"
 #include "xml/node.h"
 
 namespace Inkscape {
@@ -103,6 +104,14 @@ public:
      * It should be made non-public in the future.
      */
     virtual NodeObserver *logger()=0;
+
+    /**
+     * @brief Get a copy of an attribute value for a node of this document
+     *
+     * This is an implementation detail of nodes. Implementations may return the same copy
+     * for equal values.
+     */
+    virtual Util::ptr_shared shareValue(char const *value) { return Util::share_string(value); }
 };
 
 }
@@ -10,6 +10,8 @@
 #ifndef SEEN_INKSCAPE_XML_SP_REPR_ACTION_FNS_H
 #define SEEN_INKSCAPE_XML_SP_REPR_ACTION_FNS_H
 
+#include <cstddef>
+
 namespace Inkscape {
 namespace XML {
 
@@ -32,6 +34,16 @@ void sp_repr_undo_log (Inkscape::XML::Event *log);
 void sp_repr_replay_log (Inkscape::XML::Event *log);
 Inkscape::XML::Event *sp_repr_coalesce_log (Inkscape::XML::Event *a, Inkscape::XML::Event *b);
 void sp_repr_free_log (Inkscape::XML::Event *log);
+
+/**
+ * Merge all the changes of the same attribute, or of the content, of each node in @a log into one,
+ * and drop the changes that leave a value as it was.
+ * @return The compacted log, which may start with another event.
+ */
+Inkscape::XML::Event *sp_repr_compact_log (Inkscape::XML::Event *log);
+
+/// An estimate of the memory held by the events of @a log, in bytes.
+std::size_t sp_repr_log_size (Inkscape::XML::Event const *log);
 void sp_repr_debug_print_log(Inkscape::XML::Event const *log);
 
 #endif
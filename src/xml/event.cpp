@@ -16,6 +16,10 @@
 
 #include <glib.h> // g_assert()
 #include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "event.h"
 #include "event-fns.h"
@@ -294,6 +298,114 @@ sp_repr_free_log (Inkscape::XML::Event *log)
 
 namespace {
 
+bool same_value(Inkscape::Util::ptr_shared a, Inkscape::Util::ptr_shared b)
+{
+    return a.pointer() == b.pointer() || (a && b && std::strcmp(a, b) == 0);
+}
+
+struct AttributeKeyHash {
+    std::size_t operator()(std::pair<Inkscape::XML::Node const *, GQuark> const &key) const {
+        return std::hash<Inkscape::XML::Node const *>()(key.first) ^ (std::size_t(key.second) * 0x9e3779b97f4a7c15ull);
+    }
+};
+
+/// Rough size of a node and its attributes, for nodes only kept alive by the undo log.
+std::size_t subtree_size(Inkscape::XML::Node const &node)
+{
+    constexpr std::size_t NODE_SIZE = 128;
+
+    std::size_t size = NODE_SIZE;
+    if (auto const content = node.content()) {
+        size += std::strlen(content) + 1;
+    }
+    for (auto const &iter : node.attributeList()) {
+        size += sizeof(iter) + (iter.value ? std::strlen(iter.value) + 1 : 0);
+    }
+    for (auto child = node.firstChild(); child; child = child->next()) {
+        size += subtree_size(*child);
+    }
+    return size;
+}
+
+}
+
+Inkscape::XML::Event *
+sp_repr_compact_log (Inkscape::XML::Event *log)
+{
+    using Inkscape::XML::Event;
+    using Inkscape::XML::EventChgAttr;
+    using Inkscape::XML::EventChgContent;
+
+    /* the log runs from the latest event to the earliest, so the first
+     * change seen for a value is the one the earlier ones merge into */
+    std::unordered_map<std::pair<Inkscape::XML::Node const *, GQuark>, EventChgAttr *, AttributeKeyHash> attributes;
+    std::unordered_map<Inkscape::XML::Node const *, EventChgContent *> contents;
+
+    Event **prev_ptr = &log;
+    while (Event *action = *prev_ptr) {
+        if (auto chg_attr = dynamic_cast<EventChgAttr *>(action)) {
+            auto const [it, inserted] = attributes.try_emplace({chg_attr->repr, chg_attr->key}, chg_attr);
+            if (!inserted) {
+                it->second->oldval = chg_attr->oldval;
+                *prev_ptr = action->next;
+                delete action;
+                continue;
+            }
+        } else if (auto chg_content = dynamic_cast<EventChgContent *>(action)) {
+            auto const [it, inserted] = contents.try_emplace(chg_content->repr, chg_content);
+            if (!inserted) {
+                it->second->oldval = chg_content->oldval;
+                *prev_ptr = action->next;
+                delete action;
+                continue;
+            }
+        }
+        prev_ptr = &action->next;
+    }
+
+    /* a value set back to what it was needs no undoing */
+    prev_ptr = &log;
+    while (Event *action = *prev_ptr) {
+        auto const chg_attr = dynamic_cast<EventChgAttr *>(action);
+        auto const chg_content = dynamic_cast<EventChgContent *>(action);
+        if ((chg_attr && same_value(chg_attr->oldval, chg_attr->newval)) ||
+            (chg_content && same_value(chg_content->oldval, chg_content->newval)))
+        {
+            *prev_ptr = action->next;
+            delete action;
+        } else {
+            prev_ptr = &action->next;
+        }
+    }
+
+    return log;
+}
+
+std::size_t
+sp_repr_log_size (Inkscape::XML::Event const *log)
+{
+    using namespace Inkscape::XML;
+
+    /* only new values are counted: an old value is the new value of an
+     * earlier event, or still in the document */
+    std::size_t size = 0;
+    for (Event const *action = log; action; action = action->next) {
+        if (auto chg_attr = dynamic_cast<EventChgAttr const *>(action)) {
+            size += sizeof(EventChgAttr) + (chg_attr->newval ? std::strlen(chg_attr->newval) + 1 : 0);
+        } else if (auto chg_content = dynamic_cast<EventChgContent const *>(action)) {
+            size += sizeof(EventChgContent) + (chg_content->newval ? std::strlen(chg_content->newval) + 1 : 0);
+        } else if (auto del = dynamic_cast<EventDel const *>(action)) {
+            /* a removed subtree lives on in the log */
+            size += sizeof(EventDel) + subtree_size(*del->child);
+        } else {
+            size += sizeof(EventChgOrder);
+        }
+    }
+    return size;
+}
+
+namespace {
+
 template <typename T> struct ActionRelations;
 
 template <>
@@ -0,0 +1,560 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Journal of the changes made to an XML document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "xml/journal.h"
+
+#include <charconv>
+#include <cstring>
+#include <optional>
+
+#include "gc-anchored.h"
+#include "xml/document.h"
+#include "xml/simple-document.h"
+#include "xml/text-node.h"
+
+/*
+ * The records of a chunk, one per line, in which <node> is the number of a node and <value>
+ * stands for "<length>\n" followed by that many bytes. The document node is 0, and each node
+ * added takes the next number, counting from the start of the snapshot. Nodes are added or
+ * moved after <prev> among their siblings, or first if it is 0.
+ *
+ *   N <parent> <prev> e <name>   add an element
+ *   N <parent> <prev> t          add a text node
+ *   N <parent> <prev> x          add a CDATA section
+ *   N <parent> <prev> c          add a comment
+ *   N <parent> <prev> p <name>   add a processing instruction
+ *   R <node>                     remove a node
+ *   M <node> <prev>              move a node
+ *   A <node> <name> <value>      set an attribute
+ *   U <node> <name>              remove an attribute
+ *   C <node> <value>             set the content of a node
+ *   D <node>                     remove the content of a node
+ *   E <node> <name>              rename an element
+ */
+
+namespace Inkscape {
+namespace XML {
+
+namespace {
+
+constexpr std::string_view HEADER = "inkscape-journal 2\n";
+
+void append_value(std::string &out, char const *value)
+{
+    auto const length = std::strlen(value);
+    out += ' ';
+    out += std::to_string(length);
+    out += '\n';
+    out.append(value, length);
+}
+
+char type_of(Node const &node)
+{
+    switch (node.type()) {
+        case NodeType::ELEMENT_NODE:
+            return 'e';
+        case NodeType::TEXT_NODE: {
+            auto const text = dynamic_cast<TextNode const *>(&node);
+            return text && text->is_CData() ? 'x' : 't';
+        }
+        case NodeType::COMMENT_NODE:
+            return 'c';
+        case NodeType::PI_NODE:
+            return 'p';
+        default:
+            return 0;
+    }
+}
+
+/// Reads the records written by Journal::Chunk::text().
+class Parser
+{
+public:
+    explicit Parser(std::string_view text)
+        : _text(text)
+    {}
+
+    bool atEnd() const { return _pos >= _text.size(); }
+
+    /// The next character of the text.
+    std::optional<char> letter()
+    {
+        if (atEnd()) {
+            return {};
+        }
+        return _text[_pos++];
+    }
+
+    /// The next word, after one space.
+    std::optional<std::string_view> word()
+    {
+        if (atEnd() || _text[_pos] != ' ') {
+            return {};
+        }
+        auto const start = ++_pos;
+        while (_pos < _text.size() && _text[_pos] != ' ' && _text[_pos] != '\n') {
+            ++_pos;
+        }
+        if (_pos == start) {
+            return {};
+        }
+        return _text.substr(start, _pos - start);
+    }
+
+    std::optional<std::size_t> number()
+    {
+        auto const digits = word();
+        std::size_t result = 0;
+        if (!digits || std::from_chars(digits->data(), digits->data() + digits->size(), result).ptr !=
+                           digits->data() + digits->size()) {
+            return {};
+        }
+        return result;
+    }
+
+    bool endOfLine()
+    {
+        if (atEnd() || _text[_pos] != '\n') {
+            return false;
+        }
+        ++_pos;
+        return true;
+    }
+
+    /// The next @a length bytes.
+    std::optional<std::string_view> bytes(std::size_t length)
+    {
+        if (_text.size() - _pos < length) {
+            return {};
+        }
+        auto const start = _pos;
+        _pos += length;
+        return _text.substr(start, length);
+    }
+
+    /// A value: its length, the end of the line and that many bytes.
+    std::optional<std::string> value()
+    {
+        auto const length = number();
+        if (!length || !endOfLine()) {
+            return {};
+        }
+        auto const result = bytes(*length);
+        if (!result) {
+            return {};
+        }
+        return std::string(*result);
+    }
+
+private:
+    std::string_view _text;
+    std::size_t _pos = 0;
+};
+
+/// The nodes of a document being replayed, by number. Kept visible to the collector, since
+/// removed nodes may still be named by later records.
+using NodeList = std::vector<Node *, GC::Alloc<Node *, GC::SCANNED, GC::MANUAL>>;
+
+Node *find_node(NodeList const &nodes, std::optional<std::size_t> number)
+{
+    return number && *number < nodes.size() ? nodes[*number] : nullptr;
+}
+
+/// The sibling to add or move a node after, which is null for the start.
+std::optional<Node *> find_prev(NodeList const &nodes, Node const *parent, std::optional<std::size_t> number)
+{
+    if (!number) {
+        return {};
+    }
+    if (*number == 0) {
+        return nullptr;
+    }
+    auto const prev = find_node(nodes, number);
+    if (!prev || prev->parent() != parent) {
+        return {};
+    }
+    return prev;
+}
+
+/// Applies the records of one chunk.
+bool replay_chunk(Document &doc, NodeList &nodes, std::string_view chunk)
+{
+    Parser parser(chunk);
+    while (!parser.atEnd()) {
+        auto const kind = parser.letter();
+        auto const node = find_node(nodes, parser.number());
+        if (!node) {
+            return false;
+        }
+
+        switch (*kind) {
+            case 'N': {
+                auto const prev = find_prev(nodes, node, parser.number());
+                auto const type = parser.word();
+                if (!prev || !type || type->size() != 1) {
+                    return false;
+                }
+                Node *child = nullptr;
+                switch (type->front()) {
+                    case 'e':
+                    case 'p': {
+                        auto const name = parser.word();
+                        if (!name) {
+                            return false;
+                        }
+                        child = type->front() == 'e' ? doc.createElement(std::string(*name).c_str())
+                                                     : doc.createPI(std::string(*name).c_str(), "");
+                        break;
+                    }
+                    case 't':
+                        child = doc.createTextNode("");
+                        break;
+                    case 'x':
+                        child = doc.createTextNode("", true);
+                        break;
+                    case 'c':
+                        child = doc.createComment("");
+                        break;
+                    default:
+                        return false;
+                }
+                node->addChild(child, *prev);
+                nodes.push_back(child);
+                GC::release(child);
+                break;
+            }
+            case 'R':
+                if (!node->parent()) {
+                    return false;
+                }
+                node->parent()->removeChild(node);
+                break;
+            case 'M': {
+                auto const parent = node->parent();
+                auto const prev = parent ? find_prev(nodes, parent, parser.number()) : std::nullopt;
+                if (!prev || *prev == node) {
+                    return false;
+                }
+                parent->changeOrder(node, *prev);
+                break;
+            }
+            case 'A':
+            case 'U': {
+                auto const name = parser.word();
+                if (!name) {
+                    return false;
+                }
+                std::optional<std::string> value;
+                if (*kind == 'A' && !(value = parser.value())) {
+                    return false;
+                }
+                node->setAttribute(std::string(*name).c_str(), value ? value->c_str() : nullptr);
+                break;
+            }
+            case 'C':
+            case 'D': {
+                std::optional<std::string> content;
+                if (*kind == 'C' && !(content = parser.value())) {
+                    return false;
+                }
+                node->setContent(content ? content->c_str() : nullptr);
+                break;
+            }
+            case 'E': {
+                auto const name = parser.word();
+                if (!name || node->type() != NodeType::ELEMENT_NODE) {
+                    return false;
+                }
+                node->setCodeUnsafe(g_quark_from_string(std::string(*name).c_str()));
+                break;
+            }
+            default:
+                return false;
+        }
+
+        if (!parser.endOfLine()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Journal::Journal(Document &doc)
+    : _doc(doc)
+{
+    _doc.addSubtreeObserver(*this);
+}
+
+Journal::~Journal()
+{
+    _doc.removeSubtreeObserver(*this);
+}
+
+Journal::Chunk Journal::snapshot()
+{
+    _records.clear();
+    _latest.clear();
+    _ids.clear();
+    _ids.emplace(&_doc, 0);
+    _next_id = 1;
+
+    for (auto const &attribute : _doc.attributeList()) {
+        _setValue(0, 'A', attribute.key, attribute.value);
+    }
+    unsigned prev = 0;
+    for (auto child = _doc.firstChild(); child; child = child->next()) {
+        if (auto const id = _addSubtree(0, prev, *child)) {
+            prev = id;
+        }
+    }
+
+    return _takeChunk(true);
+}
+
+Journal::Chunk Journal::takeChanges()
+{
+    return _takeChunk(false);
+}
+
+Journal::Chunk Journal::_takeChunk(bool header)
+{
+    Chunk chunk;
+    chunk._records.swap(_records);
+    chunk._header = header;
+    _latest.clear();
+    return chunk;
+}
+
+std::string Journal::Chunk::text() const
+{
+    if (_records.empty() && !_header) {
+        return {};
+    }
+
+    std::string records;
+    for (auto const &record : _records) {
+        records += record.kind;
+        records += ' ';
+        records += std::to_string(record.node);
+        switch (record.kind) {
+            case 'N':
+                records += ' ';
+                records += std::to_string(record.prev);
+                records += ' ';
+                records += record.type;
+                if (record.name) {
+                    records += ' ';
+                    records += g_quark_to_string(record.name);
+                }
+                break;
+            case 'M':
+                records += ' ';
+                records += std::to_string(record.prev);
+                break;
+            case 'A':
+            case 'U':
+            case 'E':
+                records += ' ';
+                records += g_quark_to_string(record.name);
+                if (record.kind == 'A') {
+                    append_value(records, record.value);
+                }
+                break;
+            case 'C':
+                append_value(records, record.value);
+                break;
+            default:
+                break;
+        }
+        records += '\n';
+    }
+
+    auto const chunk = "K " + std::to_string(records.size()) + '\n' + records;
+    return _header ? std::string(HEADER) + chunk : chunk;
+}
+
+/// Records the adding of @a node and its subtree, and returns the number it was given, or 0 if
+/// it is of a type that is not journaled.
+unsigned Journal::_addSubtree(unsigned parent, unsigned prev, Node const &node)
+{
+    auto const type = type_of(node);
+    if (!type) {
+        return 0;
+    }
+
+    auto const id = _next_id++;
+    _ids.insert_or_assign(&node, id);
+
+    auto &record = _records.emplace_back();
+    record.kind = 'N';
+    record.node = parent;
+    record.prev = prev;
+    record.type = type;
+    if (type == 'e' || type == 'p') {
+        record.name = node.code();
+    }
+
+    for (auto const &attribute : node.attributeList()) {
+        _setValue(id, 'A', attribute.key, attribute.value);
+    }
+    if (auto const content = node.content()) {
+        _setValue(id, 'C', 0, Util::share_unsafe(content));
+    }
+    unsigned child_prev = 0;
+    for (auto child = node.firstChild(); child; child = child->next()) {
+        if (auto const child_id = _addSubtree(id, child_prev, *child)) {
+            child_prev = child_id;
+        }
+    }
+    return id;
+}
+
+void Journal::_forgetSubtree(Node const &node)
+{
+    _ids.erase(&node);
+    for (auto child = node.firstChild(); child; child = child->next()) {
+        _forgetSubtree(*child);
+    }
+}
+
+/// The number of @a node, which is 0 for none as for the document.
+unsigned Journal::_idOf(Node const *node) const
+{
+    if (!node) {
+        return 0;
+    }
+    auto const it = _ids.find(node);
+    return it != _ids.end() ? it->second : 0;
+}
+
+void Journal::_setValue(Node const &node, char kind, GQuark name, Util::ptr_shared value)
+{
+    if (auto const it = _ids.find(&node); it != _ids.end()) {
+        _setValue(it->second, kind, name, value);
+    }
+}
+
+void Journal::_setValue(unsigned id, char kind, GQuark name, Util::ptr_shared value)
+{
+    // A value set again replaces the one before, so a drag adds a single record per attribute.
+    auto const [it, inserted] = _latest.emplace(std::make_pair(id, name), _records.size());
+    auto &record = inserted ? _records.emplace_back() : _records[it->second];
+    record.kind = value ? kind : kind == 'A' ? 'U' : 'D';
+    record.node = id;
+    record.name = name;
+    record.value = value;
+}
+
+void Journal::notifyChildAdded(Node &node, Node &child, Node *prev)
+{
+    if (!_ids.contains(&node)) {
+        return;
+    }
+    _addSubtree(_idOf(&node), _idOf(prev), child);
+}
+
+void Journal::notifyChildRemoved(Node &/*node*/, Node &child, Node * /*prev*/)
+{
+    auto const id = _idOf(&child);
+    if (!id) {
+        return;
+    }
+    auto &record = _records.emplace_back();
+    record.kind = 'R';
+    record.node = id;
+    _forgetSubtree(child);
+}
+
+void Journal::notifyChildOrderChanged(Node &/*node*/, Node &child, Node * /*old_prev*/, Node *new_prev)
+{
+    auto const id = _idOf(&child);
+    if (!id) {
+        return;
+    }
+    auto &record = _records.emplace_back();
+    record.kind = 'M';
+    record.node = id;
+    record.prev = _idOf(new_prev);
+}
+
+void Journal::notifyContentChanged(Node &node, Util::ptr_shared /*old_content*/, Util::ptr_shared new_content)
+{
+    _setValue(node, 'C', 0, new_content);
+}
+
+void Journal::notifyAttributeChanged(Node &node, GQuark name, Util::ptr_shared /*old_value*/,
+                                     Util::ptr_shared new_value)
+{
+    _setValue(node, 'A', name, new_value);
+}
+
+void Journal::notifyElementNameChanged(Node &node, GQuark /*old_name*/, GQuark new_name)
+{
+    auto const id = _idOf(&node);
+    if (!id) {
+        return;
+    }
+    auto &record = _records.emplace_back();
+    record.kind = 'E';
+    record.node = id;
+    record.name = new_name;
+}
+
+bool Journal::replay(Document &doc, std::string_view journal)
+{
+    if (journal.substr(0, HEADER.size()) != HEADER) {
+        return false;
+    }
+
+    NodeList nodes = {&doc};
+    Parser parser(journal.substr(HEADER.size()));
+    while (!parser.atEnd()) {
+        auto const kind = parser.letter();
+        auto const length = parser.number();
+        if (*kind != 'K' || !length || !parser.endOfLine()) {
+            return false;
+        }
+        auto const chunk = parser.bytes(*length);
+        if (!chunk) {
+            // Cut short while it was written.
+            break;
+        }
+        if (!replay_chunk(doc, nodes, *chunk)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Document *Journal::read(std::string_view journal)
+{
+    auto const doc = new SimpleDocument();
+    if (!replay(*doc, journal)) {
+        GC::release(doc);
+        return nullptr;
+    }
+    return doc;
+}
+
+} // namespace XML
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Journal of the changes made to an XML document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_XML_JOURNAL_H
+#define SEEN_INKSCAPE_XML_JOURNAL_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "inkgc/gc-alloc.h"
+#include "xml/node-observer.h"
+#include "xml/node.h"
+
+namespace Inkscape {
+namespace XML {
+
+class Document;
+
+/**
+ * Records every change made to a document, so that it can be written out as a small delta
+ * rather than as the whole document again.
+ *
+ * A journal is a header line followed by chunks, each one the length of its records and the
+ * records themselves. The first chunk, from snapshot(), creates the whole tree; the following
+ * ones, from takeChanges(), hold the changes made since the chunk before. Nodes are numbered in
+ * the order the journal adds them, so that records do not depend on the positions of nodes,
+ * which would be slow to find in long lists of children. Replaying the chunks in order, with
+ * replay(), rebuilds the tree exactly as it was, down to empty and blank text nodes that an SVG
+ * file would not keep.
+ *
+ * The records of a chunk only share the names and values of the document, and are turned into
+ * text by Chunk::text(), which may be called on any thread.
+ *
+ * A chunk cut short, as when the program stops while it is being written, is ignored along
+ * with anything after it.
+ */
+class Journal : public NodeObserver
+{
+public:
+    class Chunk;
+
+    /// Starts recording the changes made to @a doc, which must outlive the journal.
+    explicit Journal(Document &doc);
+    ~Journal() override;
+
+    Journal(Journal const &) = delete;
+    Journal &operator=(Journal const &) = delete;
+
+    /// The start of a journal: its header, and a chunk creating the whole document as it is now.
+    /// The changes recorded so far are dropped, as the snapshot already holds them. Changes are
+    /// only recorded once a snapshot was taken.
+    Chunk snapshot();
+
+    /// A chunk with the changes recorded since the last snapshot or call, which may be empty.
+    Chunk takeChanges();
+
+    /// Whether any change was recorded since the last snapshot or call to takeChanges().
+    bool empty() const { return _records.empty(); }
+
+    /**
+     * Applies the chunks of @a journal to @a doc, which must be empty at first.
+     * @return false if the journal is not one, or if its records do not fit the tree.
+     */
+    static bool replay(Document &doc, std::string_view journal);
+
+    /// The document written to @a journal, or nullptr; see replay().
+    static Document *read(std::string_view journal);
+
+    void notifyChildAdded(Node &node, Node &child, Node *prev) override;
+    void notifyChildRemoved(Node &node, Node &child, Node *prev) override;
+    void notifyChildOrderChanged(Node &node, Node &child, Node *old_prev, Node *new_prev) override;
+    void notifyContentChanged(Node &node, Util::ptr_shared old_content, Util::ptr_shared new_content) override;
+    void notifyAttributeChanged(Node &node, GQuark name, Util::ptr_shared old_value, Util::ptr_shared new_value) override;
+    void notifyElementNameChanged(Node &node, GQuark old_name, GQuark new_name) override;
+
+private:
+    struct Record
+    {
+        char kind;            ///< The letter starting the record, see journal.cpp.
+        unsigned node = 0;    ///< The node changed, or the parent of a node added.
+        unsigned prev = 0;    ///< The node a node is added or moved after, or 0 for the start.
+        char type = 0;        ///< The type of a node added, see journal.cpp.
+        GQuark name = 0;      ///< The name of an attribute, element or instruction.
+        Util::ptr_shared value;
+    };
+
+    /// Allocated so that the collector sees the values the records share with the document.
+    using Records = std::vector<Record, GC::Alloc<Record, GC::SCANNED, GC::MANUAL>>;
+
+    struct KeyHash
+    {
+        std::size_t operator()(std::pair<unsigned, GQuark> const &key) const
+        {
+            return std::hash<unsigned>{}(key.first) ^ (std::hash<GQuark>{}(key.second) * 31);
+        }
+    };
+
+    unsigned _addSubtree(unsigned parent, unsigned prev, Node const &node);
+    void _forgetSubtree(Node const &node);
+    unsigned _idOf(Node const *node) const;
+    void _setValue(Node const &node, char kind, GQuark name, Util::ptr_shared value);
+    void _setValue(unsigned id, char kind, GQuark name, Util::ptr_shared value);
+    Chunk _takeChunk(bool header);
+
+    Document &_doc;
+    Records _records;
+    /// The number of each node of the document, or none before the first snapshot.
+    std::unordered_map<Node const *, unsigned> _ids;
+    unsigned _next_id = 1;
+    /// The attribute or content record of each node, kept up to date by later changes;
+    /// GQuark 0 stands for the content.
+    std::unordered_map<std::pair<unsigned, GQuark>, std::size_t, KeyHash> _latest;
+};
+
+/// The records of a chunk of a journal.
+class Journal::Chunk
+{
+public:
+    Chunk() = default;
+
+    bool empty() const { return _records.empty(); }
+    std::size_t size() const { return _records.size(); } ///< The number of records.
+
+    /// The chunk as it is written to a journal, preceded by the header of the journal if it is a
+    /// snapshot. Other chunks without records are written as an empty string.
+    std::string text() const;
+
+private:
+    friend class Journal;
+
+    Records _records;
+    bool _header = false;
+};
+
+} // namespace XML
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_XML_JOURNAL_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -16,22 +16,24 @@
 #include <vector>
 
 #include <2geom/point.h>
+#include <boost/container/small_vector.hpp>
 
 #include "gc-anchored.h"
 #include "inkgc/gc-alloc.h"
 #include "node-iterators.h"
 #include "util/const_char_ptr.h"
+#include "xml/attribute-record.h"
 
 class SVGLength;
 
 namespace Inkscape {
 namespace XML {
 
-class AttributeRecord;
 struct Document;
 class NodeObserver;
 
-using AttributeVector = std::vector<AttributeRecord, Inkscape::GC::Alloc<AttributeRecord>>;
+/// The attributes of a node. Most elements have few enough to be stored inline.
+using AttributeVector = boost::container::small_vector<AttributeRecord, 4, Inkscape::GC::Alloc<AttributeRecord>>;
 
 /**
  * @brief Enumeration containing all supported node types.
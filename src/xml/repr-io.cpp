@@ -11,20 +11,34 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <libxml/parser.h>
 #include <libxml/xinclude.h>
+#include <libxml/xmlreader.h>
 
 #include "xml/repr.h"
+#include "xml/repr-reader.h"
 #include "xml/attribute-record.h"
 #include "xml/rebase-hrefs.h"
 #include "xml/simple-document.h"
 #include "xml/text-node.h"
 #include "xml/node.h"
 
+#include "display/dispatch-pool.h"
+
 #include "io/sys.h"
 #include "io/stream/stringstream.h"
 #include "io/stream/gzipstream.h"
@@ -48,6 +62,10 @@ using Inkscape::XML::AttributeVector;
 using Inkscape::XML::rebase_href_attrs;
 
 Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns);
+static Document *sp_repr_do_read_stream(xmlTextReaderPtr reader, const gchar *default_ns, bool &failed);
+static Document *sp_repr_read_tree(xmlDocPtr doc, const gchar *default_ns);
+static void sp_repr_fix_namespaces(Node *root, const gchar *default_ns);
+static void sp_repr_clean_read(Document *rdoc, bool unchecked);
 static Node *sp_repr_svg_read_node (Document *xml_doc, xmlNodePtr node, const gchar *default_ns, std::map<std::string, std::string> &prefix_map);
 static gint sp_repr_qualified_name (gchar *p, gint len, xmlNsPtr ns, const xmlChar *name, const gchar *default_ns, std::map<std::string, std::string> &prefix_map);
 static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
@@ -56,14 +74,6 @@ static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
                                               gchar const *old_href_abs_base,
                                               gchar const *new_href_abs_base);
 
-static void sp_repr_write_stream_element(Node *repr, Writer &out,
-                                         gint indent_level, bool add_whitespace,
-                                         Glib::QueryQuark elide_prefix,
-                                         const AttributeVector & attributes,
-                                         int inlineattrs, int indent,
-                                         gchar const *old_href_abs_base,
-                                         gchar const *new_href_abs_base);
-
 
 class XmlSource
 {
@@ -91,8 +101,11 @@ public:
     }
 
     int setFile( char const * filename );
+    /// How much of the file was read, from 0 to 1; of the compressed file if it is gzipped.
+    double fraction() const;
 
-    xmlDocPtr readXml();
+    xmlDocPtr readXml(int options);
+    xmlTextReaderPtr openReader(int options);
 
     static int readCb( void * context, char * buffer, int len );
     static int closeCb( void * context );
@@ -108,6 +121,7 @@ private:
     int firstFewLen;
     Inkscape::IO::FileInputStream* instr;
     Inkscape::IO::GzipInputStream* gzin;
+    double size = 0;
 };
 
 int XmlSource::setFile(char const *filename)
@@ -165,12 +179,26 @@ int XmlSource::setFile(char const *filename)
 
             firstFewLen = some;
             retVal = 0; // no error
+
+            std::error_code error;
+            size = std::filesystem::file_size(std::filesystem::u8path(filename), error);
+            if (error) {
+                size = 0;
+            }
         }
     }
     return retVal;
 }
 
-xmlDocPtr XmlSource::readXml()
+double XmlSource::fraction() const
+{
+    if (!fp) {
+        return 1.0;
+    }
+    return size > 0 ? std::min(ftell(fp) / size, 1.0) : 0.0;
+}
+
+static int file_parse_options()
 {
     int parse_options = XML_PARSE_HUGE | XML_PARSE_RECOVER;
 
@@ -178,7 +206,20 @@ xmlDocPtr XmlSource::readXml()
     bool allowNetAccess = prefs->getBool("/options/externalresources/xml/allow_net_access", false);
     if (!allowNetAccess) parse_options |= XML_PARSE_NONET;
 
-    return xmlReadIO(readCb, closeCb, this, filename, getEncoding(), parse_options);
+    return parse_options;
+}
+
+xmlDocPtr XmlSource::readXml(int options)
+{
+    return xmlReadIO(readCb, closeCb, this, filename, getEncoding(), options);
+}
+
+/**
+ * Like readXml(), but for reading the document node by node.
+ */
+xmlTextReaderPtr XmlSource::openReader(int options)
+{
+    return xmlReaderForIO(readCb, closeCb, this, filename, getEncoding(), options);
 }
 
 int XmlSource::readCb( void * context, char * buffer, int len )
@@ -260,6 +301,30 @@ int XmlSource::close()
     return 0;
 }
 
+/**
+ * Reads a whole file into a libxml2 tree before turning it into a Document, for documents that
+ * need XInclude, and files on which the streaming reader failed, as the recovery mode of the
+ * full parser may salvage more of them. The document is not cleaned yet, see sp_repr_clean_read().
+ */
+static Document *sp_repr_read_file_dom(gchar const *filename, gchar const *default_ns, int options, bool xinclude)
+{
+    XmlSource src;
+    if (src.setFile(filename) != 0) {
+        return nullptr;
+    }
+
+    xmlDocPtr doc = src.readXml(options);
+    if (xinclude && doc && doc->properties && xmlXIncludeProcessFlags(doc, XML_PARSE_NOXINCNODE) < 0) {
+        g_warning("XInclude processing failed for %s", filename);
+    }
+    Document *rdoc = sp_repr_read_tree(doc, default_ns);
+
+    if (doc) {
+        xmlFreeDoc(doc);
+    }
+    return rdoc;
+}
+
 /**
  * Reads XML from a file, and returns the Document.
  * The default namespace can also be specified, if desired.
@@ -273,7 +338,6 @@ int XmlSource::close()
  */
 Document *sp_repr_read_file (const gchar * filename, const gchar *default_ns, bool xinclude)
 {
-    xmlDocPtr doc = nullptr;
     Document * rdoc = nullptr;
 
     xmlSubstituteEntitiesDefault(1);
@@ -297,18 +361,12 @@ Document *sp_repr_read_file (const gchar * filename, const gchar *default_ns, bo
 
     Inkscape::IO::dump_fopen_call(filename, "N");
 
-    XmlSource src;
-
-    if (src.setFile(filename) == 0) {
-        doc = src.readXml();
-        if (xinclude && doc && doc->properties && xmlXIncludeProcessFlags(doc, XML_PARSE_NOXINCNODE) < 0) {
-            g_warning("XInclude processing failed for %s", filename);
-        }
-        rdoc = sp_repr_do_read(doc, default_ns);
-    }
-
-    if (doc) {
-        xmlFreeDoc(doc);
+    // Files are streamed into the tree, unless XInclude needs the whole document at once.
+    if (xinclude) {
+        rdoc = sp_repr_read_file_dom(filename, default_ns, file_parse_options(), true);
+        sp_repr_clean_read(rdoc, false);
+    } else {
+        rdoc = Inkscape::XML::FileReader(filename, default_ns).finish();
     }
 
     if (localFilename) {
@@ -335,6 +393,14 @@ Document *sp_repr_read_mem (const gchar * buffer, gint length, const gchar *defa
                                        // proper solution would be to check the preference "/options/externalresources/xml/allow_net_access"
                                        // as done in XmlSource::readXml which gets called by the analogous sp_repr_read_file()
                                        // but sp_repr_read_mem() seems to be called in locations where Inkscape::Preferences::get() fails badly
+    bool failed = false;
+    rdoc = sp_repr_do_read_stream(xmlReaderForMemory(buffer, length, nullptr, nullptr, parser_options),
+                                  default_ns, failed);
+    if (!failed) {
+        sp_repr_clean_read(rdoc, false);
+        return rdoc;
+    }
+
     doc = xmlReadMemory (const_cast<gchar *>(buffer), length, nullptr, nullptr, parser_options);
 
     rdoc = sp_repr_do_read (doc, default_ns);
@@ -369,6 +435,8 @@ typedef std::map<Glib::QueryQuark, Glib::QueryQuark, Inkscape::compare_quark_ids
 
 Glib::QueryQuark qname_prefix(Glib::QueryQuark qname) {
     static PrefixMap prefix_map;
+    static std::mutex prefix_map_mutex; // Documents are also read and written off the main thread.
+    auto lock = std::scoped_lock(prefix_map_mutex);
     PrefixMap::iterator iter = prefix_map.find(qname);
     if ( iter != prefix_map.end() ) {
         return (*iter).second;
@@ -434,6 +502,16 @@ void repair_namespace(Node *repr, const gchar *prefix) {
  * Reads in a XML file to create a Document
  */
 Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns)
+{
+    auto rdoc = sp_repr_read_tree(doc, default_ns);
+    sp_repr_clean_read(rdoc, false);
+    return rdoc;
+}
+
+/**
+ * Turns a libxml2 tree into a Document, like sp_repr_do_read(), but without cleaning it.
+ */
+static Document *sp_repr_read_tree(xmlDocPtr doc, const gchar *default_ns)
 {
     if (doc == nullptr) {
         return nullptr;
@@ -467,37 +545,397 @@ Document *sp_repr_do_read (xmlDocPtr doc, const gchar *default_ns)
         }
     }
 
-    if (root != nullptr) {
-        /* promote elements of some XML documents that don't use namespaces
-         * into their default namespace */
-        if (!strcmp(root->name(), "ns:svg") || !strcmp(root->name(), "svg0:svg")) {
-            g_warning("Detected broken namespace \"%s\" in the SVG file, attempting to work around it", root->name());
-            repair_namespace(root, "svg");
-        } else if ( default_ns && !strchr(root->name(), ':') ) {
-            if ( !strcmp(default_ns, SP_SVG_NS_URI) ) {
-                promote_to_namespace(root, "svg");
+    sp_repr_fix_namespaces(root, default_ns);
+
+    return rdoc;
+}
+
+/**
+ * Fix up the namespaces of a freshly read document.
+ */
+static void sp_repr_fix_namespaces(Node *root, const gchar *default_ns)
+{
+    if (root == nullptr) {
+        return;
+    }
+
+    /* promote elements of some XML documents that don't use namespaces
+     * into their default namespace */
+    if (!strcmp(root->name(), "ns:svg") || !strcmp(root->name(), "svg0:svg")) {
+        g_warning("Detected broken namespace \"%s\" in the SVG file, attempting to work around it", root->name());
+        repair_namespace(root, "svg");
+    } else if ( default_ns && !strchr(root->name(), ':') ) {
+        if ( !strcmp(default_ns, SP_SVG_NS_URI) ) {
+            promote_to_namespace(root, "svg");
+        }
+        if ( !strcmp(default_ns, INKSCAPE_EXTENSION_URI) ) {
+            promote_to_namespace(root, INKSCAPE_EXTENSION_NS_NC);
+        }
+    }
+}
+
+/**
+ * Clean unnecessary attributes and style properties from a freshly read SVG document, if the
+ * preferences ask for it. Must run on the main thread, as it reads the preferences.
+ *
+ * @param unchecked Whether the attributes were set under SimpleNode::UncheckedAttributes, in
+ *                  which case the checks of /options/svgoutput/check_on_editing are done here.
+ */
+static void sp_repr_clean_read(Document *rdoc, bool unchecked)
+{
+    auto const root = rdoc ? rdoc->root() : nullptr;
+    if (!root) {
+        return;
+    }
+
+    // Note: internal Inkscape svg files will also be cleaned (filters.svg, icons.svg). How can one
+    // tell if a file is internal?
+    if ( !strcmp(root->name(), "svg:svg" ) ) {
+        Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+        bool clean = prefs->getBool("/options/svgoutput/check_on_reading") ||
+                     (unchecked && prefs->getBool("/options/svgoutput/check_on_editing"));
+        if( clean ) {
+            sp_attribute_clean_tree( root );
+        }
+    }
+}
+
+namespace {
+
+/**
+ * Qualified names ("prefix:name") of the elements and attributes met while streaming a document.
+ * Names are interned once per distinct namespace and local name, rather than being formatted
+ * again for every node.
+ */
+class QualifiedNames
+{
+public:
+    gchar const *get(xmlDocPtr doc, xmlNsPtr ns, xmlChar const *name);
+
+private:
+    // Local names are keyed by address, which is only stable for names owned by the parser's
+    // dictionary; all others are looked up by value.
+    struct PairHash
+    {
+        size_t operator()(std::pair<gchar const *, xmlChar const *> const &p) const
+        {
+            return std::hash<void const *>()(p.first) * 31 + std::hash<void const *>()(p.second);
+        }
+    };
+
+    gchar const *_prefix(xmlNsPtr ns);
+
+    std::unordered_map<std::string, gchar const *> _prefixes;
+    std::unordered_map<std::pair<gchar const *, xmlChar const *>, gchar const *, PairHash> _names;
+};
+
+gchar const *QualifiedNames::_prefix(xmlNsPtr ns)
+{
+    if (!ns || !ns->href) {
+        return nullptr;
+    }
+    auto const [it, inserted] = _prefixes.try_emplace(reinterpret_cast<char const *>(ns->href));
+    if (inserted) {
+        it->second = sp_xml_ns_uri_prefix(reinterpret_cast<gchar const *>(ns->href),
+                                          reinterpret_cast<gchar const *>(ns->prefix));
+    }
+    return it->second;
+}
+
+gchar const *QualifiedNames::get(xmlDocPtr doc, xmlNsPtr ns, xmlChar const *name)
+{
+    auto const prefix = _prefix(ns);
+
+    auto qualify = [&] {
+        // Truncated like sp_repr_qualified_name() does.
+        gchar c[256];
+        if (prefix) {
+            g_snprintf(c, sizeof(c), "%s:%s", prefix, name);
+        } else {
+            g_snprintf(c, sizeof(c), "%s", name);
+        }
+        return g_quark_to_string(g_quark_from_string(c));
+    };
+
+    if (!doc || !doc->dict || xmlDictOwns(doc->dict, name) != 1) {
+        return qualify();
+    }
+
+    auto const [it, inserted] = _names.try_emplace(std::make_pair(prefix, name));
+    if (inserted) {
+        it->second = qualify();
+    }
+    return it->second;
+}
+
+/**
+ * Reads a document from a libxml2 text reader node by node, so that the libxml2 tree never holds
+ * more than the ancestors of the current node. The result is the same as from sp_repr_do_read().
+ */
+class StreamReader
+{
+public:
+    StreamReader(xmlTextReaderPtr reader, gchar const *default_ns);
+    ~StreamReader();
+
+    StreamReader(StreamReader const &) = delete;
+    StreamReader &operator=(StreamReader const &) = delete;
+
+    /// Reads the next node; returns false at the end of the document, or on an error.
+    bool step();
+
+    /**
+     * The document read once step() returned false.
+     *
+     * @param failed Set if the reader stopped on an error, in which case nothing is returned and
+     *               the caller should fall back to sp_repr_do_read(), which may recover more of
+     *               the file.
+     */
+    Document *finish(bool &failed);
+
+private:
+    xmlTextReaderPtr _reader;
+    gchar const *_default_ns;
+    std::map<std::string, std::string> _prefix_map; // unused, for sp_repr_svg_read_node()
+    QualifiedNames _names;
+
+    Document *_rdoc;
+    std::vector<Node *> _open; // elements whose end has not been read yet
+    Node *_root = nullptr;
+    bool _has_element = false;
+    bool _done = false;
+    int _status = 1;
+};
+
+StreamReader::StreamReader(xmlTextReaderPtr reader, gchar const *default_ns)
+    : _reader(reader)
+    , _default_ns(default_ns)
+    , _rdoc(new Inkscape::XML::SimpleDocument())
+{
+    if (!_reader) {
+        _status = -1;
+        _done = true;
+    }
+}
+
+StreamReader::~StreamReader()
+{
+    if (_reader) {
+        xmlFreeTextReader(_reader);
+    }
+    if (_rdoc) {
+        Inkscape::GC::release(_rdoc);
+    }
+}
+
+bool StreamReader::step()
+{
+    if (_done) {
+        return false;
+    }
+    _status = xmlTextReaderRead(_reader);
+    if (_status != 1) {
+        _done = true;
+        return false;
+    }
+
+    int const type = xmlTextReaderNodeType(_reader);
+    xmlNodePtr node = xmlTextReaderCurrentNode(_reader);
+
+    if (type == XML_READER_TYPE_END_ELEMENT) {
+        if (!_open.empty()) {
+            _open.pop_back();
+        }
+        return true;
+    }
+
+    if (_open.empty()) {
+        // Top level, see sp_repr_do_read().
+        if (type == XML_READER_TYPE_ELEMENT) {
+            if (_has_element) {
+                // A second root, as accepted in recovery mode: keep it, but no root.
+                if (auto expanded = xmlTextReaderExpand(_reader)) {
+                    Node *repr = sp_repr_svg_read_node(_rdoc, expanded, _default_ns, _prefix_map);
+                    _rdoc->appendChild(repr);
+                    Inkscape::GC::release(repr);
+                }
+                _root = nullptr;
+                _done = true;
+                return false;
             }
-            if ( !strcmp(default_ns, INKSCAPE_EXTENSION_URI) ) {
-                promote_to_namespace(root, INKSCAPE_EXTENSION_NS_NC);
+            _has_element = true;
+        } else if (type != XML_READER_TYPE_COMMENT && type != XML_READER_TYPE_PROCESSING_INSTRUCTION) {
+            return true;
+        }
+    }
+
+    Node *repr = nullptr;
+    if (type == XML_READER_TYPE_ELEMENT) {
+        repr = _rdoc->createElement(_names.get(node->doc, node->ns, node->name));
+        for (auto prop = node->properties; prop; prop = prop->next) {
+            if (prop->children) {
+                repr->setAttribute(_names.get(node->doc, prop->ns, prop->name),
+                                   reinterpret_cast<gchar *>(prop->children->content));
             }
         }
+        if (node->content) {
+            repr->setContent(reinterpret_cast<gchar *>(node->content));
+        }
+    } else {
+        // Text, comments and the like are small and read as before.
+        repr = sp_repr_svg_read_node(_rdoc, node, _default_ns, _prefix_map);
+    }
+
+    if (repr) {
+        if (_open.empty()) {
+            _rdoc->appendChild(repr);
+        } else {
+            _open.back()->appendChild(repr);
+        }
+        Inkscape::GC::release(repr);
+    }
+
+    if (type == XML_READER_TYPE_ELEMENT) {
+        if (_open.empty()) {
+            _root = repr;
+        }
+        if (!xmlTextReaderIsEmptyElement(_reader)) {
+            _open.push_back(repr);
+        }
+    }
+    return true;
+}
+
+Document *StreamReader::finish(bool &failed)
+{
+    if (_reader) {
+        xmlFreeTextReader(_reader);
+        _reader = nullptr;
+    }
+    auto const rdoc = std::exchange(_rdoc, nullptr);
+
+    failed = _status < 0;
+    if (failed || !_has_element) {
+        // Like sp_repr_do_read(), return nothing for a document without elements.
+        Inkscape::GC::release(rdoc);
+        return nullptr;
+    }
+
+    sp_repr_fix_namespaces(_root, _default_ns);
+
+    return rdoc;
+}
+
+} // namespace
+
+/**
+ * Reads a whole document from @a reader, see StreamReader. The document is not cleaned yet, see
+ * sp_repr_clean_read().
+ *
+ * @param failed Set if the reader stopped on an error, in which case nothing is returned and the
+ *               caller should fall back to sp_repr_do_read(), which may recover more of the file.
+ */
+static Document *sp_repr_do_read_stream(xmlTextReaderPtr reader, const gchar *default_ns, bool &failed)
+{
+    StreamReader stream(reader, default_ns);
+    while (stream.step()) {
+    }
+    return stream.finish(failed);
+}
 
+namespace Inkscape::XML {
 
-        // Clean unnecessary attributes and style properties from SVG documents. (Controlled by
-        // preferences.)  Note: internal Inkscape svg files will also be cleaned (filters.svg,
-        // icons.svg). How can one tell if a file is internal?
-        if ( !strcmp(root->name(), "svg:svg" ) ) {
-            Inkscape::Preferences *prefs = Inkscape::Preferences::get();
-            bool clean = prefs->getBool("/options/svgoutput/check_on_reading");
-            if( clean ) {
-                sp_attribute_clean_tree( root );
+struct FileReader::Data
+{
+    std::string filename;
+    std::optional<std::string> default_ns;
+    int options;
+    XmlSource source;
+    bool opened = false;
+    std::optional<StreamReader> stream;
+    bool complete = false;
+    Document *rdoc = nullptr;
+
+    ~Data()
+    {
+        if (rdoc) {
+            Inkscape::GC::release(rdoc);
+        }
+    }
+
+    gchar const *ns() const { return default_ns ? default_ns->c_str() : nullptr; }
+};
+
+FileReader::FileReader(char const *filename, char const *default_ns)
+    : _data(std::make_unique<Data>())
+{
+    xmlSubstituteEntitiesDefault(1);
+
+    _data->filename = filename;
+    if (default_ns) {
+        _data->default_ns = default_ns;
+    }
+    _data->options = file_parse_options();
+    _data->opened = _data->source.setFile(_data->filename.c_str()) == 0;
+    _data->stream.emplace(_data->opened ? _data->source.openReader(_data->options) : nullptr, _data->ns());
+}
+
+FileReader::~FileReader() = default;
+
+bool FileReader::read(std::chrono::steady_clock::duration budget)
+{
+    // Checking the clock costs more than reading a node.
+    constexpr int nodes_between_checks = 256;
+
+    if (_data->complete) {
+        return false;
+    }
+
+    SimpleNode::UncheckedAttributes unchecked;
+    auto const until = std::chrono::steady_clock::now() + budget;
+    do {
+        for (int i = 0; i < nodes_between_checks; i++) {
+            if (!_data->stream->step()) {
+                return false;
             }
         }
+    } while (std::chrono::steady_clock::now() < until);
+    return true;
+}
+
+double FileReader::progress() const
+{
+    return _data->opened ? _data->source.fraction() : 1.0;
+}
+
+void FileReader::complete()
+{
+    while (read({})) {
+    }
+    if (_data->complete) {
+        return;
     }
+    _data->complete = true;
 
+    bool failed = false;
+    _data->rdoc = _data->stream->finish(failed);
+    if (failed && _data->opened) {
+        SimpleNode::UncheckedAttributes unchecked;
+        _data->rdoc = sp_repr_read_file_dom(_data->filename.c_str(), _data->ns(), _data->options, false);
+    }
+}
+
+Document *FileReader::finish()
+{
+    complete();
+
+    auto const rdoc = std::exchange(_data->rdoc, nullptr);
+    sp_repr_clean_read(rdoc, true);
     return rdoc;
 }
 
+} // namespace Inkscape::XML
+
 gint sp_repr_qualified_name (gchar *p, gint len, xmlNsPtr ns, const xmlChar *name, const gchar */*default_ns*/, std::map<std::string, std::string> &prefix_map)
 {
     const xmlChar *prefix;
@@ -727,64 +1165,436 @@ bool sp_repr_save_file(Document *doc, gchar const *const filename, gchar const *
 }
 
 
-/* (No doubt this function already exists elsewhere.) */
-static void repr_quote_write (Writer &out, const gchar * val, bool attr)
+namespace {
+
+/// Attributes of the elements whose links are rebased, as they are to be written.
+using RebasedAttributes = std::unordered_map<Node const *, std::vector<std::pair<GQuark, std::string>>>;
+
+/// What printf() writes for a string, including a null one.
+char const *printable(char const *string)
 {
-    if (val) {
-        for (; *val != '\0'; val++) {
-            switch (*val) {
-                case '"': out.writeString( "&quot;" ); break;
-                case '&': out.writeString( "&amp;" ); break;
-                case '<': out.writeString( "&lt;" ); break;
-                case '>': out.writeString( "&gt;" ); break;
-                case '\n': out.writeString( attr ? "&#10;" : "\n" ); break;
-                default: out.writeChar( *val ); break;
-            }
+    return string ? string : "(null)";
+}
+
+void append_quoted(std::string &out, char const *val, bool attr)
+{
+    if (!val) {
+        return;
+    }
+
+    // Copy the runs of characters that need no escaping at once.
+    char const *run = val;
+    for (; *val != '\0'; val++) {
+        char const *entity;
+        switch (*val) {
+            case '"': entity = "&quot;"; break;
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '\n':
+                if (!attr) {
+                    continue;
+                }
+                entity = "&#10;";
+                break;
+            default:
+                continue;
         }
+        out.append(run, val - run);
+        out += entity;
+        run = val + 1;
+    }
+    out.append(run, val - run);
+}
+
+/**
+ * Formats nodes into strings, the way they are written to SVG files.
+ *
+ * Once prepareRebase() has been called, formatting only reads the tree and allocates no memory
+ * from the garbage collector, so that separate subtrees can be formatted on separate threads.
+ */
+class NodeFormatter
+{
+public:
+    NodeFormatter(Glib::QueryQuark elide_prefix, int inlineattrs, int indent,
+                  gchar const *old_href_base, gchar const *new_href_base);
+
+    /// Rebase the links of the elements below @a root now, rather than while formatting them.
+    void prepareRebase(Node *root);
+
+    void formatNode(std::string &out, Node *repr, int indent_level, bool add_whitespace) const;
+
+    /// An element whose start tag has been formatted.
+    struct OpenElement
+    {
+        gchar const *name;
+        int indent_level;
+        bool add_whitespace_parent;
+        bool add_whitespace; ///< Around the children.
+        bool loose;          ///< Whether the children are on lines of their own.
+    };
+
+    /**
+     * Format the start tag of @a repr.  The attributes are those of @a repr unless given, in which
+     * case their links are rebased right away.
+     */
+    OpenElement openElement(std::string &out, Node *repr, int indent_level, bool add_whitespace,
+                            AttributeVector const *attributes = nullptr) const;
+    void closeElement(std::string &out, Node *repr, OpenElement const &element) const;
+
+    /// The indentation level of the children of @a element.
+    static int childIndent(OpenElement const &element) { return element.loose ? element.indent_level + 1 : 0; }
+
+private:
+    void _indentation(std::string &out, int indent_level) const;
+    void _formatAttribute(std::string &out, GQuark key, gchar const *value, int indent_level) const;
+    gchar const *_elementName(GQuark code) const;
+
+    std::optional<std::string> _elide_prefix;
+    int _inlineattrs;
+    int _indent;
+    gchar const *_old_href_base;
+    gchar const *_new_href_base;
+    GQuark _xml_space;
+
+    bool _rebase_prepared = false;
+    RebasedAttributes _rebased;
+};
+
+NodeFormatter::NodeFormatter(Glib::QueryQuark elide_prefix, int inlineattrs, int indent,
+                             gchar const *old_href_base, gchar const *new_href_base)
+    : _inlineattrs(inlineattrs)
+    , _indent(indent)
+    , _old_href_base(old_href_base)
+    , _new_href_base(new_href_base)
+    , _xml_space(g_quark_from_static_string("xml:space"))
+{
+    if (elide_prefix.id()) {
+        _elide_prefix = g_quark_to_string(elide_prefix);
     }
 }
 
-static void repr_write_comment( Writer &out, const gchar * val, bool addWhitespace, gint indentLevel, int indent )
+void NodeFormatter::prepareRebase(Node *root)
 {
-    if ( indentLevel > 16 ) {
-        indentLevel = 16;
+    _rebase_prepared = true;
+
+    // As in rebase_href_attrs(), identical bases leave every link as it is.
+    if (_old_href_base == _new_href_base) {
+        return;
     }
-    if (addWhitespace && indent) {
-        for (gint i = 0; i < indentLevel; i++) {
-            for (gint j = 0; j < indent; j++) {
-                out.writeChar(' ');
+
+    static GQuark const href_key = g_quark_from_static_string("href");
+    static GQuark const xlink_href_key = g_quark_from_static_string("xlink:href");
+
+    std::vector<Node *> stack{root};
+    while (!stack.empty()) {
+        auto const repr = stack.back();
+        stack.pop_back();
+        if (repr->type() != Inkscape::XML::NodeType::ELEMENT_NODE) {
+            continue;
+        }
+
+        auto const &attributes = repr->attributeList();
+        for (auto const &attr : attributes) {
+            if (attr.key == href_key || attr.key == xlink_href_key) {
+                auto &rebased = _rebased[repr];
+                for (auto const &iter : rebase_href_attrs(_old_href_base, _new_href_base, attributes)) {
+                    rebased.emplace_back(iter.key, iter.value ? iter.value.pointer() : "");
+                }
+                break;
             }
         }
+
+        for (auto child = repr->firstChild(); child; child = child->next()) {
+            stack.push_back(child);
+        }
     }
+}
 
-    out.printf("<!--%s-->", val);
+void NodeFormatter::_indentation(std::string &out, int indent_level) const
+{
+    if (indent_level > 0 && _indent > 0) {
+        out.append(static_cast<std::size_t>(indent_level) * _indent, ' ');
+    }
+}
 
-    if (addWhitespace) {
-        out.writeChar('\n');
+void NodeFormatter::_formatAttribute(std::string &out, GQuark key, gchar const *value, int indent_level) const
+{
+    if (!_inlineattrs) {
+        out += '\n';
+        _indentation(out, indent_level + 1);
     }
+    out += ' ';
+    out += g_quark_to_string(key);
+    out += "=\"";
+    append_quoted(out, value, true);
+    out += '"';
 }
 
-namespace {
+gchar const *NodeFormatter::_elementName(GQuark code) const
+{
+    gchar const *name = g_quark_to_string(code);
+    if (_elide_prefix) {
+        if (auto const prefix_end = std::strchr(name, ':');
+            prefix_end && std::string_view(name, prefix_end - name) == *_elide_prefix) {
+            return prefix_end + 1;
+        }
+    }
+    return name;
+}
 
-typedef std::map<Glib::QueryQuark, gchar const *, Inkscape::compare_quark_ids> LocalNameMap;
-typedef std::map<Glib::QueryQuark, Inkscape::Util::ptr_shared, Inkscape::compare_quark_ids> NSMap;
+void NodeFormatter::formatNode(std::string &out, Node *repr, int indent_level, bool add_whitespace) const
+{
+    switch (repr->type()) {
+        case Inkscape::XML::NodeType::TEXT_NODE: {
+            auto textnode = dynamic_cast<const Inkscape::XML::TextNode *>(repr);
+            assert(textnode);
+            if (textnode->is_CData()) {
+                // Preserve CDATA sections, not converting '&' to &amp;, etc.
+                out += "<![CDATA[";
+                out += printable(repr->content());
+                out += "]]>";
+            } else {
+                append_quoted(out, repr->content(), false);
+            }
+            break;
+        }
+        case Inkscape::XML::NodeType::COMMENT_NODE: {
+            if (add_whitespace) {
+                _indentation(out, std::min(indent_level, 16));
+            }
+            out += "<!--";
+            out += printable(repr->content());
+            out += "-->";
+            if (add_whitespace) {
+                out += '\n';
+            }
+            break;
+        }
+        case Inkscape::XML::NodeType::PI_NODE: {
+            out += "<?";
+            out += printable(repr->name());
+            out += ' ';
+            out += printable(repr->content());
+            out += "?>";
+            break;
+        }
+        case Inkscape::XML::NodeType::ELEMENT_NODE: {
+            auto const element = openElement(out, repr, indent_level, add_whitespace);
+            for (auto child = repr->firstChild(); child; child = child->next()) {
+                formatNode(out, child, childIndent(element), element.add_whitespace);
+            }
+            closeElement(out, repr, element);
+            break;
+        }
+        case Inkscape::XML::NodeType::DOCUMENT_NODE: {
+            g_assert_not_reached();
+            break;
+        }
+        default: {
+            g_assert_not_reached();
+        }
+    }
+}
 
-gchar const *qname_local_name(Glib::QueryQuark qname) {
-    static LocalNameMap local_name_map;
-    LocalNameMap::iterator iter = local_name_map.find(qname);
-    if ( iter != local_name_map.end() ) {
-        return (*iter).second;
+NodeFormatter::OpenElement NodeFormatter::openElement(std::string &out, Node *repr, int indent_level,
+                                                      bool add_whitespace,
+                                                      AttributeVector const *attributes) const
+{
+    if ( indent_level > 16 ) {
+        indent_level = 16;
+    }
+
+    OpenElement element{_elementName(repr->code()), indent_level, add_whitespace, add_whitespace, true};
+
+    if (add_whitespace) {
+        _indentation(out, indent_level);
+    }
+    out += '<';
+    out += element.name;
+
+    // If this is a <text> element, suppress formatting whitespace
+    // for its content and children:
+    if (strcmp(repr->name(), "svg:text")     == 0 ||
+        strcmp(repr->name(), "svg:flowRoot") == 0) {
+        element.add_whitespace = false;
     } else {
-        gchar const *name_string=g_quark_to_string(qname);
-        gchar const *prefix_end=strchr(name_string, ':');
-        if (prefix_end) {
-            return prefix_end + 1;
-        } else {
-            return name_string;
+        // Suppress formatting whitespace for xml:space="preserve"
+        gchar const *xml_space_attr = nullptr;
+        for (auto const &attr : repr->attributeList()) {
+            if (attr.key == _xml_space) {
+                xml_space_attr = attr.value.pointer();
+                break;
+            }
+        }
+        if (g_strcmp0(xml_space_attr, "preserve") == 0) {
+            element.add_whitespace = false;
+        } else if (g_strcmp0(xml_space_attr, "default") == 0) {
+            element.add_whitespace = true;
+        }
+    }
+
+    if (attributes || !_rebase_prepared) {
+        auto const rbd = rebase_href_attrs(_old_href_base, _new_href_base,
+                                           attributes ? *attributes : repr->attributeList());
+        for (auto const &attr : rbd) {
+            _formatAttribute(out, attr.key, attr.value.pointer(), indent_level);
+        }
+    } else if (auto const rebased = _rebased.find(repr); rebased != _rebased.end()) {
+        for (auto const &[key, value] : rebased->second) {
+            _formatAttribute(out, key, value.c_str(), indent_level);
+        }
+    } else {
+        for (auto const &attr : repr->attributeList()) {
+            _formatAttribute(out, attr.key, attr.value.pointer(), indent_level);
+        }
+    }
+
+    for (auto child = repr->firstChild(); child; child = child->next()) {
+        if (child->type() == Inkscape::XML::NodeType::TEXT_NODE) {
+            element.loose = false;
+            break;
+        }
+    }
+
+    if (repr->firstChild()) {
+        out += '>';
+        if (element.loose && element.add_whitespace) {
+            out += '\n';
+        }
+    }
+
+    return element;
+}
+
+void NodeFormatter::closeElement(std::string &out, Node *repr, OpenElement const &element) const
+{
+    if (repr->firstChild()) {
+        if (element.loose && element.add_whitespace) {
+            _indentation(out, element.indent_level);
+        }
+        out += "</";
+        out += element.name;
+        out += '>';
+    } else {
+        out += " />";
+    }
+
+    if (element.add_whitespace_parent) {
+        out += '\n';
+    }
+}
+
+/// Subtrees of at least this many nodes are split between several tasks.
+constexpr std::size_t SPLIT_NODES = 4096;
+/// Runs of siblings are gathered into tasks of about this many nodes.
+constexpr std::size_t TASK_NODES = 1024;
+/// The number of pieces formatted before they are written out, which bounds the memory used.
+constexpr std::size_t BATCH_PIECES = 64;
+
+/// The number of nodes in the subtree of @a repr, counted up to @a limit.
+std::size_t count_nodes(Node *repr, std::size_t limit)
+{
+    std::size_t count = 1;
+    for (auto child = repr->firstChild(); child && count < limit; child = child->next()) {
+        count += count_nodes(child, limit - count);
+    }
+    return count;
+}
+
+/// A part of the output: text formatted in advance, or a run of siblings to format.
+struct Piece
+{
+    std::string text;
+    Node *first = nullptr; ///< The first of the siblings, or null for text.
+    std::size_t count = 0;
+    int indent_level = 0;
+    bool add_whitespace = false;
+};
+
+/**
+ * Cut the output for @a repr into pieces, descending into the subtrees that are too large to be
+ * formatted by a single task.
+ */
+void plan_element(std::vector<Piece> &pieces, NodeFormatter const &formatter, Node *repr,
+                  int indent_level, bool add_whitespace, AttributeVector const *attributes)
+{
+    auto const text = [&] () -> std::string & {
+        if (pieces.empty() || pieces.back().first) {
+            pieces.emplace_back();
+        }
+        return pieces.back().text;
+    };
+
+    auto const element = formatter.openElement(text(), repr, indent_level, add_whitespace, attributes);
+    auto const child_indent = NodeFormatter::childIndent(element);
+
+    std::size_t task_nodes = TASK_NODES;
+    for (auto child = repr->firstChild(); child; child = child->next()) {
+        auto const nodes = count_nodes(child, SPLIT_NODES);
+        if (nodes >= SPLIT_NODES) {
+            plan_element(pieces, formatter, child, child_indent, element.add_whitespace, nullptr);
+            task_nodes = TASK_NODES;
+            continue;
+        }
+
+        if (task_nodes >= TASK_NODES) {
+            auto &piece = pieces.emplace_back();
+            piece.first = child;
+            piece.indent_level = child_indent;
+            piece.add_whitespace = element.add_whitespace;
+            task_nodes = 0;
+        }
+        pieces.back().count++;
+        task_nodes += nodes;
+    }
+
+    formatter.closeElement(text(), repr, element);
+}
+
+/**
+ * Write @a repr and its descendants.  Large documents are formatted a batch of subtrees at a time,
+ * in parallel, and each batch is written in document order as one block.
+ */
+void write_element(Writer &out, NodeFormatter const &formatter, Node *repr, bool add_whitespace,
+                   AttributeVector const &attributes)
+{
+    std::vector<Piece> pieces;
+    plan_element(pieces, formatter, repr, 0, add_whitespace, &attributes);
+
+    std::vector<Piece *> tasks;
+    for (std::size_t begin = 0; begin < pieces.size(); begin += BATCH_PIECES) {
+        auto const end = std::min(begin + BATCH_PIECES, pieces.size());
+
+        tasks.clear();
+        for (auto i = begin; i < end; i++) {
+            if (pieces[i].first) {
+                tasks.push_back(&pieces[i]);
+            }
+        }
+
+        int const count = tasks.size();
+        Inkscape::get_global_dispatch_pool().dispatch_threshold(count, count > 1, [&] (int i) {
+            auto &piece = *tasks[i];
+            auto child = piece.first;
+            for (std::size_t n = 0; n < piece.count; n++, child = child->next()) {
+                formatter.formatNode(piece.text, child, piece.indent_level, piece.add_whitespace);
+            }
+        });
+
+        for (auto i = begin; i < end; i++) {
+            out.write(pieces[i].text.data(), pieces[i].text.size());
+            std::string().swap(pieces[i].text);
         }
     }
 }
 
+} // namespace
+
+namespace {
+
+typedef std::map<Glib::QueryQuark, Inkscape::Util::ptr_shared, Inkscape::compare_quark_ids> NSMap;
+
 void add_ns_map_entry(NSMap &ns_map, Glib::QueryQuark prefix) {
     using Inkscape::Util::ptr_shared;
     using Inkscape::Util::share_unsafe;
@@ -883,8 +1693,9 @@ static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
         }
     }
 
-    return sp_repr_write_stream_element(repr, out, 0, add_whitespace, elide_prefix, attributes,
-                                        inlineattrs, indent, old_href_base, new_href_base);
+    NodeFormatter formatter(elide_prefix, inlineattrs, indent, old_href_base, new_href_base);
+    formatter.prepareRebase(repr);
+    write_element(out, formatter, repr, add_whitespace, attributes);
 }
 
 void sp_repr_write_stream( Node *repr, Writer &out, gint indent_level,
@@ -893,146 +1704,12 @@ void sp_repr_write_stream( Node *repr, Writer &out, gint indent_level,
                            gchar const *const old_href_base,
                            gchar const *const new_href_base)
 {
-    switch (repr->type()) {
-        case Inkscape::XML::NodeType::TEXT_NODE: {
-            auto textnode = dynamic_cast<const Inkscape::XML::TextNode *>(repr);
-            assert(textnode);
-            if (textnode->is_CData()) {
-                // Preserve CDATA sections, not converting '&' to &amp;, etc.
-                out.printf( "<![CDATA[%s]]>", repr->content() );
-            } else {
-                repr_quote_write( out, repr->content(), false );
-            }
-            break;
-        }
-        case Inkscape::XML::NodeType::COMMENT_NODE: {
-            repr_write_comment( out, repr->content(), add_whitespace, indent_level, indent );
-            break;
-        }
-        case Inkscape::XML::NodeType::PI_NODE: {
-            out.printf( "<?%s %s?>", repr->name(), repr->content() );
-            break;
-        }
-        case Inkscape::XML::NodeType::ELEMENT_NODE: {
-            sp_repr_write_stream_element( repr, out, indent_level,
-                                          add_whitespace, elide_prefix,
-                                          repr->attributeList(),
-                                          inlineattrs, indent,
-                                          old_href_base, new_href_base);
-            break;
-        }
-        case Inkscape::XML::NodeType::DOCUMENT_NODE: {
-            g_assert_not_reached();
-            break;
-        }
-        default: {
-            g_assert_not_reached();
-        }
-    }
-}
-
-
-void sp_repr_write_stream_element( Node * repr, Writer & out,
-                                   gint indent_level, bool add_whitespace,
-                                   Glib::QueryQuark elide_prefix,
-                                   const AttributeVector & attributes, 
-                                   int inlineattrs, int indent,
-                                   gchar const *old_href_base,
-                                   gchar const *new_href_base )
-{
-    Node *child = nullptr;
-    bool loose = false;
-    bool const add_whitespace_parent = add_whitespace;
-
     g_return_if_fail (repr != nullptr);
 
-    if ( indent_level > 16 ) {
-        indent_level = 16;
-    }
-
-    if (add_whitespace && indent) {
-        for (gint i = 0; i < indent_level; i++) {
-            for (gint j = 0; j < indent; j++) {
-                out.writeChar(' ');
-            }
-        }
-    }
-
-    GQuark code = repr->code();
-    gchar const *element_name;
-    if ( elide_prefix == qname_prefix(code) ) {
-        element_name = qname_local_name(code);
-    } else {
-        element_name = g_quark_to_string(code);
-    }
-    out.printf( "<%s", element_name );
-
-    // If this is a <text> element, suppress formatting whitespace
-    // for its content and children:
-    if (strcmp(repr->name(), "svg:text")     == 0 ||
-        strcmp(repr->name(), "svg:flowRoot") == 0) {
-        add_whitespace = false;
-    } else {
-        // Suppress formatting whitespace for xml:space="preserve"
-        gchar const *xml_space_attr = repr->attribute("xml:space");
-        if (g_strcmp0(xml_space_attr, "preserve") == 0) {
-            add_whitespace = false;
-        } else if (g_strcmp0(xml_space_attr, "default") == 0) {
-            add_whitespace = true;
-        }
-    }
-
-    const auto rbd = rebase_href_attrs(old_href_base, new_href_base, attributes);
-    for (const auto &iter : rbd) {
-        if (!inlineattrs) {
-            out.writeChar('\n');
-            if (indent) {
-                for ( gint i = 0 ; i < indent_level + 1 ; i++ ) {
-                    for ( gint j = 0 ; j < indent ; j++ ) {
-                        out.writeChar(' ');
-                    }
-                }
-            }
-        }
-        out.printf(" %s=\"", g_quark_to_string(iter.key));
-        repr_quote_write(out, iter.value, true);
-        out.writeChar('"');
-    }
-
-    loose = TRUE;
-    for (child = repr->firstChild() ; child != nullptr; child = child->next()) {
-        if (child->type() == Inkscape::XML::NodeType::TEXT_NODE) {
-            loose = FALSE;
-            break;
-        }
-    }
-
-    if (repr->firstChild()) {
-        out.writeChar('>');
-        if (loose && add_whitespace) {
-            out.writeChar('\n');
-        }
-        for (child = repr->firstChild(); child != nullptr; child = child->next()) {
-            sp_repr_write_stream(child, out, ( loose ? indent_level + 1 : 0 ),
-                                 add_whitespace, elide_prefix, inlineattrs, indent,
-                                 old_href_base, new_href_base);
-        }
-
-        if (loose && add_whitespace && indent) {
-            for (gint i = 0; i < indent_level; i++) {
-                for ( gint j = 0 ; j < indent ; j++ ) {
-                    out.writeChar(' ');
-                }
-            }
-        }
-        out.printf( "</%s>", element_name );
-    } else {
-        out.writeString( " />" );
-    }
-
-    if (add_whitespace_parent) {
-        out.writeChar('\n');
-    }
+    std::string text;
+    NodeFormatter(elide_prefix, inlineattrs, indent, old_href_base, new_href_base)
+        .formatNode(text, repr, indent_level, add_whitespace);
+    out.write(text.data(), text.size());
 }
 
 
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Reading an XML file into a document a slice at a time, or on another thread.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_XML_REPR_READER_H
+#define SEEN_INKSCAPE_XML_REPR_READER_H
+
+#include <chrono>
+#include <memory>
+
+namespace Inkscape {
+namespace XML {
+
+class Document;
+
+/**
+ * Streams a file into a Document like sp_repr_read_file() does, but a slice at a time, so that
+ * reading a large file can be interleaved with other work, or moved to another thread.
+ *
+ * The reader is created, finished and destroyed on the main thread, whose preferences it reads.
+ * read(), progress() and complete() may be called from one other thread instead, as long as that
+ * thread is registered with the garbage collector (see GC::ThreadRegistration), which the nodes
+ * are allocated from. The attribute checks that depend on the preferences are then left to
+ * finish().
+ */
+class FileReader
+{
+public:
+    FileReader(char const *filename, char const *default_ns);
+    ~FileReader();
+
+    FileReader(FileReader const &) = delete;
+    FileReader &operator=(FileReader const &) = delete;
+
+    /// Reads nodes for about @a budget, and at least a few; returns whether there are more.
+    bool read(std::chrono::steady_clock::duration budget);
+
+    /// How much of the file was read so far, from 0 to 1.
+    double progress() const;
+
+    /**
+     * Reads the rest of the file. If the stream broke off, the file is read again with the
+     * recovery mode of the full parser, like sp_repr_read_file() does.
+     */
+    void complete();
+
+    /**
+     * Reads the rest of the file, cleans the document as the preferences ask, and returns it, or
+     * nullptr if the file could not be read.
+     */
+    Document *finish();
+
+private:
+    struct Data;
+    std::unique_ptr<Data> _data;
+};
+
+} // namespace XML
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_XML_REPR_READER_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -17,6 +17,7 @@
  */
 
 #include <cstring>
+#include <mutex>
 
 #include <glib.h>
 #include <glibmm.h>
@@ -65,6 +66,9 @@ static char *sp_xml_ns_auto_prefix(char const *uri);
 
 static SPXMLNs *namespaces=nullptr;
 
+/// Guards namespaces, as documents are also read on other threads than the main thread.
+static std::recursive_mutex namespaces_mutex;
+
 /*
  * There are the prefixes to use for the XML namespaces defined
  * in repr.h
@@ -163,6 +167,7 @@ gchar const *sp_xml_ns_uri_prefix(gchar const *uri, gchar const *suggested)
 
     if (!uri) return nullptr;
 
+    auto lock = std::scoped_lock(namespaces_mutex);
     if (!namespaces) {
         sp_xml_ns_register_defaults();
     }
@@ -224,6 +229,7 @@ gchar const *sp_xml_ns_prefix_uri(gchar const *prefix)
 
     if (!prefix) return nullptr;
 
+    auto lock = std::scoped_lock(namespaces_mutex);
     if (!namespaces) {
         sp_xml_ns_register_defaults();
     }
@@ -17,6 +17,7 @@
 #include "xml/simple-node.h"
 #include "xml/node-observer.h"
 #include "xml/log-builder.h"
+#include "xml/string-table.h"
 
 namespace Inkscape {
 
@@ -74,10 +75,12 @@ protected:
         return new SimpleDocument(*this);
     }
     NodeObserver *logger() override { return this; }
+    Util::ptr_shared shareValue(char const *value) override { return _values.share(value); }
 
 private:
     bool _in_transaction;
     LogBuilder _log_builder;
+    StringTable _values;
 };
 
 }
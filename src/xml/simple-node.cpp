@@ -19,7 +19,9 @@
 // clang-format on
 
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <iterator>
 #include <string>
 
 #include <glib.h>
@@ -170,6 +172,50 @@ using Util::ptr_shared;
 using Util::share_string;
 using Util::share_unsafe;
 
+namespace {
+
+/// Attributes read often enough, while building and rendering objects, to be found without a
+/// search; the order of SimpleNode::_hot_positions.
+constexpr char const *hot_attribute_names[] = {"id", "style", "d", "transform"};
+constexpr unsigned HOT_ATTRIBUTE_COUNT = std::size(hot_attribute_names);
+
+unsigned hot_attribute(char const *name)
+{
+    for (unsigned i = 0; i < HOT_ATTRIBUTE_COUNT; ++i) {
+        if (std::strcmp(name, hot_attribute_names[i]) == 0) {
+            return i;
+        }
+    }
+    return HOT_ATTRIBUTE_COUNT;
+}
+
+unsigned hot_attribute(GQuark key)
+{
+    static auto const quarks = [] {
+        std::array<GQuark, HOT_ATTRIBUTE_COUNT> quarks;
+        for (unsigned i = 0; i < HOT_ATTRIBUTE_COUNT; ++i) {
+            quarks[i] = g_quark_from_static_string(hot_attribute_names[i]);
+        }
+        return quarks;
+    }();
+    return std::find(quarks.begin(), quarks.end(), key) - quarks.begin();
+}
+
+/// Number of SimpleNode::UncheckedAttributes alive on this thread.
+thread_local int unchecked_attributes = 0;
+
+} // namespace
+
+SimpleNode::UncheckedAttributes::UncheckedAttributes()
+{
+    unchecked_attributes++;
+}
+
+SimpleNode::UncheckedAttributes::~UncheckedAttributes()
+{
+    unchecked_attributes--;
+}
+
 SimpleNode::SimpleNode(int code, Document *document)
     : _name(code)
 {
@@ -213,6 +259,7 @@ SimpleNode::SimpleNode(SimpleNode const &node, Document *document)
     }
 
     _attributes = node._attributes;
+    _hot_positions = node._hot_positions;
 
     _observers.add(_subtree_observers);
 }
@@ -228,7 +275,17 @@ gchar const *SimpleNode::content() const {
 gchar const *SimpleNode::attribute(gchar const *name) const {
     g_return_val_if_fail(name != nullptr, NULL);
 
-    GQuark const key = g_quark_from_string(name);
+    if (auto const hot = hot_attribute(name); hot < HOT_ATTRIBUTE_COUNT) {
+        if (auto const position = _hot_positions[hot]; position != HOT_POSITION_UNKNOWN) {
+            return position ? _attributes[position - 1].value.pointer() : nullptr;
+        }
+    }
+
+    // No attribute can have a name that is not a quark yet.
+    GQuark const key = g_quark_try_string(name);
+    if (!key) {
+        return nullptr;
+    }
 
     for (const auto & iter : _attributes)
     {
@@ -240,6 +297,20 @@ gchar const *SimpleNode::attribute(gchar const *name) const {
     return nullptr;
 }
 
+void SimpleNode::_indexHotAttributes() {
+    if (_attributes.size() >= HOT_POSITION_UNKNOWN) {
+        _hot_positions.fill(HOT_POSITION_UNKNOWN);
+        return;
+    }
+
+    _hot_positions.fill(0);
+    for (std::size_t i = 0; i < _attributes.size(); ++i) {
+        if (auto const hot = hot_attribute(_attributes[i].key); hot < HOT_ATTRIBUTE_COUNT) {
+            _hot_positions[hot] = i + 1;
+        }
+    }
+}
+
 unsigned SimpleNode::position() const {
     g_return_val_if_fail(_parent != nullptr, 0);
     return _parent->_childPosition(*this);
@@ -325,7 +396,7 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
 
     // Only check elements in SVG name space and don't block setting attribute to NULL.
     // .raw() is only for performance reasons because Glib::ustring.== is slow
-    if (value != nullptr && element.raw().starts_with("svg:")) {
+    if (value != nullptr && !unchecked_attributes && element.raw().starts_with("svg:")) {
 
         Inkscape::Preferences *prefs = Inkscape::Preferences::get();
         if( prefs->getBool("/options/svgoutput/check_on_editing") ) {
@@ -374,10 +445,11 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
 
     ptr_shared new_value=ptr_shared();
     if (cleaned_value) { // set value of attribute
-        new_value = share_string(cleaned_value);
+        new_value = _document->shareValue(cleaned_value);
         tracker.set<DebugSetAttribute>(*this, key, new_value);
         if (!ref) {
 	    _attributes.emplace_back(key, new_value);
+            _indexHotAttributes();
         } else {
             ref->value = new_value;
         }
@@ -385,6 +457,7 @@ SimpleNode::setAttributeImpl(gchar const *name, gchar const *value)
         tracker.set<DebugClearAttribute>(*this, key);
         if (ref) {
 	    _attributes.erase(std::find(_attributes.begin(),_attributes.end(),(*ref)));
+            _indexHotAttributes();
         }
     }
 
@@ -15,7 +15,9 @@
 #ifndef SEEN_INKSCAPE_XML_SIMPLE_NODE_H
 #define SEEN_INKSCAPE_XML_SIMPLE_NODE_H
 
+#include <array>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
@@ -113,6 +115,21 @@ public:
 
     void recursivePrintTree(unsigned level = 0) override;
 
+    /**
+     * While one exists on a thread, attributes set on that thread are not checked as the
+     * /options/svgoutput/check_on_editing preference asks, since preferences can only be read on
+     * the main thread. Used while reading documents, which are checked once read instead.
+     */
+    class UncheckedAttributes
+    {
+    public:
+        UncheckedAttributes();
+        ~UncheckedAttributes();
+
+        UncheckedAttributes(UncheckedAttributes const &) = delete;
+        UncheckedAttributes &operator=(UncheckedAttributes const &) = delete;
+    };
+
 protected:
     SimpleNode(int code, Document *document);
     SimpleNode(SimpleNode const &repr, Document *document);
@@ -125,6 +142,7 @@ private:
 
     void _setParent(SimpleNode *parent);
     unsigned _childPosition(SimpleNode const &child) const;
+    void _indexHotAttributes();
 
     SimpleNode *_parent;
     SimpleNode *_next;
@@ -135,6 +153,10 @@ private:
     int _name;
 
     AttributeVector _attributes;
+    /// Position plus one in _attributes of id, style, d and transform, 0 if not set, or
+    /// HOT_POSITION_UNKNOWN if there are too many attributes to tell.
+    std::array<std::uint8_t, 4> _hot_positions{};
+    static constexpr std::uint8_t HOT_POSITION_UNKNOWN = 0xff;
 
     Inkscape::Util::ptr_shared _content;
 
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Attribute values shared among the nodes of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "xml/string-table.h"
+
+namespace Inkscape {
+namespace XML {
+
+Util::ptr_shared StringTable::share(char const *string)
+{
+    auto const length = std::strlen(string);
+    if (length > MAX_LENGTH) {
+        return Util::share_string(string, length);
+    }
+
+    if (auto const it = _strings.find(string); it != _strings.end()) {
+        return Util::share_unsafe(*it);
+    }
+
+    if (_strings.size() >= MAX_SIZE) {
+        _strings.clear();
+    }
+    auto const shared = Util::share_string(string, length);
+    _strings.insert(shared.pointer());
+    return shared;
+}
+
+} // namespace XML
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Attribute values shared among the nodes of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_XML_STRING_TABLE_H
+#define SEEN_INKSCAPE_XML_STRING_TABLE_H
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <unordered_set>
+
+#include "inkgc/gc-alloc.h"
+#include "util/share.h"
+
+namespace Inkscape {
+namespace XML {
+
+/**
+ * Interned copies of short strings.
+ *
+ * Drawings repeat the same short values on many elements, such as fill="none" or one style
+ * attribute copied to every shape; the table keeps a single copy of each.
+ *
+ * The table is allocated from memory scanned by the garbage collector, so it must be a member
+ * of a garbage-collected object, like SimpleDocument. It is emptied once it holds MAX_SIZE
+ * strings, so that a long session does not keep every value it ever saw; the strings still in
+ * use are kept alive by their nodes.
+ */
+class StringTable
+{
+public:
+    /// Longer strings are copied rather than looked up.
+    static constexpr std::size_t MAX_LENGTH = 255;
+    static constexpr std::size_t MAX_SIZE = 1 << 16;
+
+    /// A copy of @a string, shared with the equal strings given before if it is short.
+    Util::ptr_shared share(char const *string);
+
+    std::size_t size() const { return _strings.size(); }
+
+private:
+    struct Hash
+    {
+        std::size_t operator()(char const *s) const { return std::hash<std::string_view>{}(s); }
+    };
+    struct Equal
+    {
+        bool operator()(char const *a, char const *b) const { return std::strcmp(a, b) == 0; }
+    };
+
+    std::unordered_set<char const *, Hash, Equal, GC::Alloc<char const *>> _strings;
+};
+
+} // namespace XML
+} // namespace Inkscape
+
+#endif // SEEN_INKSCAPE_XML_STRING_TABLE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the strategies deciding which parts of the canvas to redraw.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <gtest/gtest.h>
+
+#include "ui/util.h"
+#include "ui/widget/canvas/updaters.h"
+
+using namespace Inkscape::UI::Widget;
+
+namespace {
+
+bool covers(Cairo::RefPtr<Cairo::Region> const &region, Geom::IntRect const &rect)
+{
+    auto const r = geom_to_cairo(rect);
+    return cairo_region_contains_rectangle(region->cobj(), &r) == CAIRO_REGION_OVERLAP_IN;
+}
+
+bool misses(Cairo::RefPtr<Cairo::Region> const &region, Geom::IntRect const &rect)
+{
+    auto const r = geom_to_cairo(rect);
+    return cairo_region_contains_rectangle(region->cobj(), &r) == CAIRO_REGION_OVERLAP_OUT;
+}
+
+class PreviewUpdaterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        updater = Updater::create(Updater::Strategy::Preview);
+        updater->reset();
+    }
+
+    std::unique_ptr<Updater> updater;
+    Geom::IntRect const left = Geom::IntRect::from_xywh(0, 0, 100, 100);
+    Geom::IntRect const right = Geom::IntRect::from_xywh(100, 0, 100, 100);
+};
+
+} // namespace
+
+TEST_F(PreviewUpdaterTest, PreviewThenRefine)
+{
+    EXPECT_TRUE(updater->preview_pass());
+    EXPECT_TRUE(misses(updater->get_next_clean_region(), left));
+
+    // A preview counts as drawn, but not as clean.
+    updater->mark_coarse(left);
+    EXPECT_TRUE(covers(updater->get_drawn_region(), left));
+    EXPECT_TRUE(misses(updater->clean_region, left));
+
+    // Finishing the preview starts refining it at full quality.
+    EXPECT_TRUE(updater->report_finished());
+    EXPECT_FALSE(updater->preview_pass());
+    EXPECT_TRUE(misses(updater->get_next_clean_region(), left));
+
+    updater->mark_clean(left);
+    EXPECT_TRUE(covers(updater->clean_region, left));
+    EXPECT_TRUE(covers(updater->get_drawn_region(), left));
+
+    // Finishing refining finishes the redraw, and the next damage is previewed again.
+    EXPECT_FALSE(updater->report_finished());
+    EXPECT_TRUE(updater->preview_pass());
+}
+
+TEST_F(PreviewUpdaterTest, NothingToRefine)
+{
+    updater->mark_clean(left);
+    EXPECT_FALSE(updater->report_finished());
+    EXPECT_TRUE(updater->preview_pass());
+}
+
+TEST_F(PreviewUpdaterTest, DrawnRegionIncludesPreviews)
+{
+    updater->mark_clean(left);
+    updater->mark_coarse(right);
+
+    EXPECT_TRUE(covers(updater->get_drawn_region(), left));
+    EXPECT_TRUE(covers(updater->get_drawn_region(), right));
+    EXPECT_TRUE(covers(updater->clean_region, left));
+    EXPECT_TRUE(misses(updater->clean_region, right));
+
+    // Previewing leaves out what is already drawn; refining only what is clean.
+    EXPECT_TRUE(covers(updater->get_next_clean_region(), right));
+    EXPECT_TRUE(updater->report_finished());
+    EXPECT_TRUE(misses(updater->get_next_clean_region(), right));
+    EXPECT_TRUE(covers(updater->get_next_clean_region(), left));
+}
+
+TEST_F(PreviewUpdaterTest, DamageDuringRefinementIsPreviewedFirst)
+{
+    updater->mark_coarse(left);
+    updater->mark_coarse(right);
+    ASSERT_TRUE(updater->report_finished());
+    ASSERT_FALSE(updater->preview_pass());
+
+    // Part of the preview is refined, then new damage arrives in the rest.
+    updater->mark_clean(left);
+    updater->mark_dirty(right);
+    EXPECT_TRUE(updater->preview_pass());
+    EXPECT_TRUE(misses(updater->get_drawn_region(), right));
+    EXPECT_TRUE(covers(updater->get_drawn_region(), left));
+
+    // The damage is previewed, then refined.
+    EXPECT_TRUE(misses(updater->get_next_clean_region(), right));
+    updater->mark_coarse(right);
+    EXPECT_TRUE(updater->report_finished());
+    EXPECT_FALSE(updater->preview_pass());
+    EXPECT_TRUE(misses(updater->get_next_clean_region(), right));
+    updater->mark_clean(right);
+    EXPECT_FALSE(updater->report_finished());
+    EXPECT_TRUE(covers(updater->clean_region, left));
+    EXPECT_TRUE(covers(updater->clean_region, right));
+}
+
+TEST_F(PreviewUpdaterTest, DamagedRegionResetsRefining)
+{
+    updater->mark_coarse(left);
+    ASSERT_TRUE(updater->report_finished());
+
+    // Empty damage changes nothing.
+    updater->mark_dirty(Cairo::Region::create());
+    EXPECT_FALSE(updater->preview_pass());
+
+    updater->mark_dirty(Cairo::Region::create(geom_to_cairo(left)));
+    EXPECT_TRUE(updater->preview_pass());
+    EXPECT_TRUE(misses(updater->get_drawn_region(), left));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
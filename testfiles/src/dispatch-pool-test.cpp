@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the shared render thread pool.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "display/dispatch-pool.h"
+
+using Inkscape::DispatchPool;
+
+TEST(DispatchPoolTest, DispatchVisitsEveryIndexOnce)
+{
+    DispatchPool pool(4);
+    std::vector<std::atomic<int>> visits(10007);
+    pool.dispatch(visits.size(), [&] (int i) { visits[i]++; });
+    for (auto &v : visits) {
+        ASSERT_EQ(v, 1);
+    }
+}
+
+TEST(DispatchPoolTest, NestedDispatchCompletes)
+{
+    DispatchPool pool(3);
+    std::atomic<int> count = 0;
+    pool.dispatch(16, [&] (int) {
+        pool.dispatch(16, [&] (int) {
+            pool.dispatch(16, [&] (int) { count++; });
+        });
+    });
+    EXPECT_EQ(count, 16 * 16 * 16);
+}
+
+TEST(DispatchPoolTest, DispatchFromPostedTasks)
+{
+    // A posted task occupies a worker, as a canvas tile does; loops issued from it must still finish.
+    DispatchPool pool(2);
+    std::vector<std::future<int>> results;
+    for (int t = 0; t < 4; t++) {
+        auto promise = std::make_shared<std::promise<int>>();
+        results.push_back(promise->get_future());
+        pool.post([&pool, promise] {
+            std::atomic<int> sum = 0;
+            pool.dispatch(1000, [&] (int i) { sum += i; });
+            promise->set_value(sum);
+        });
+    }
+    for (auto &result : results) {
+        EXPECT_EQ(result.get(), 999 * 1000 / 2);
+    }
+}
+
+TEST(DispatchPoolTest, ExceptionReachesCaller)
+{
+    DispatchPool pool(4);
+    std::atomic<int> count = 0;
+    EXPECT_THROW(pool.dispatch(100, [&] (int i) {
+        count++;
+        if (i == 50) {
+            throw std::runtime_error("failed");
+        }
+    }), std::runtime_error);
+    EXPECT_LE(count, 100);
+
+    // The pool is still usable afterwards.
+    count = 0;
+    pool.dispatch(100, [&] (int) { count++; });
+    EXPECT_EQ(count, 100);
+}
+
+TEST(DispatchPoolTest, Resize)
+{
+    DispatchPool pool(1);
+    pool.set_num_threads(8);
+    EXPECT_EQ(pool.num_threads(), 8);
+    pool.set_num_threads(2);
+    EXPECT_EQ(pool.num_threads(), 2);
+
+    std::atomic<int> count = 0;
+    pool.dispatch(1000, [&] (int) { count++; });
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(DispatchPoolTest, ResizeDoesNotWaitForRunningTasks)
+{
+    DispatchPool pool(2);
+    std::promise<void> release;
+    auto const released = release.get_future().share();
+    std::atomic<int> started = 0;
+    std::atomic<int> finished = 0;
+    for (int t = 0; t < 2; t++) {
+        pool.post([&, released] {
+            started++;
+            released.wait();
+            finished++;
+        });
+    }
+    while (started < 2) {
+        std::this_thread::yield();
+    }
+
+    // Both workers are busy; shrinking and growing again must return at once.
+    auto resized = std::async(std::launch::async, [&] {
+        pool.set_num_threads(1);
+        pool.set_num_threads(3);
+    });
+    ASSERT_EQ(resized.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+    EXPECT_EQ(pool.num_threads(), 3);
+    EXPECT_EQ(finished, 0);
+
+    // New work runs on the new workers meanwhile.
+    std::promise<void> done;
+    pool.post([&] { done.set_value(); });
+    EXPECT_EQ(done.get_future().wait_for(std::chrono::seconds(10)), std::future_status::ready);
+
+    release.set_value();
+    std::atomic<int> count = 0;
+    pool.dispatch(1000, [&] (int) { count++; });
+    EXPECT_EQ(count, 1000);
+    while (finished < 2) {
+        std::this_thread::yield();
+    }
+}
+
+TEST(DispatchPoolTest, LoopsStayOnTheWorkersPool)
+{
+    EXPECT_EQ(&Inkscape::get_dispatch_pool(), &Inkscape::get_global_dispatch_pool());
+
+    DispatchPool pool(2);
+    std::promise<DispatchPool *> current;
+    pool.post([&] { current.set_value(&Inkscape::get_dispatch_pool()); });
+    EXPECT_EQ(current.get_future().get(), &pool);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the memory used by the undo history.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "document-undo.h"
+#include "event-log.h"
+#include "inkscape.h"
+#include "preferences.h"
+#include "gc-anchored.h"
+#include "xml/document.h"
+#include "xml/event.h"
+#include "xml/event-fns.h"
+#include "xml/repr.h"
+
+using namespace Inkscape;
+using namespace std::literals;
+
+namespace {
+
+int log_length(XML::Event const *log)
+{
+    int length = 0;
+    for (; log; log = log->next) {
+        ++length;
+    }
+    return length;
+}
+
+/// The number of events the Undo History dialog lists before the current one, included.
+int listed_events(SPDocument &doc)
+{
+    auto const &rows = doc.get_event_log()->getEventListStore()->children();
+    int count = 0;
+    for (auto row = ++rows.begin(); row != rows.end(); ++row) {
+        count += 1 + row->children().size();
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(DocumentUndoTest, CompactsRepeatedChanges)
+{
+    auto doc = std::unique_ptr<XML::Document>(sp_repr_document_new("svg"));
+    auto rect = doc->createElement("svg:rect");
+    doc->root()->appendChild(rect);
+    rect->setAttribute("x", "0");
+    rect->setAttribute("y", "0");
+
+    // Like a drag: the same attributes, in turn, many times over.
+    sp_repr_begin_transaction(doc.get());
+    for (int i = 1; i <= 100; ++i) {
+        rect->setAttribute("x", std::to_string(i));
+        rect->setAttribute("y", std::to_string(-i));
+    }
+    rect->setAttribute("width", "5");
+    rect->setAttribute("width", nullptr);
+    auto log = sp_repr_commit_undoable(doc.get());
+    EXPECT_EQ(log_length(log), 201);
+
+    log = sp_repr_compact_log(log);
+    EXPECT_EQ(log_length(log), 2);
+    EXPECT_GT(sp_repr_log_size(log), 0u);
+
+    sp_repr_undo_log(log);
+    EXPECT_STREQ(rect->attribute("x"), "0");
+    EXPECT_STREQ(rect->attribute("y"), "0");
+    sp_repr_replay_log(log);
+    EXPECT_STREQ(rect->attribute("x"), "100");
+    EXPECT_STREQ(rect->attribute("y"), "-100");
+    EXPECT_FALSE(rect->attribute("width"));
+
+    sp_repr_free_log(log);
+    Inkscape::GC::release(rect);
+}
+
+TEST(DocumentUndoTest, KeepsWithinBudget)
+{
+    Application::create(false);
+    auto prefs = Preferences::get();
+    prefs->setInt("/options/undo/budget", 1);
+
+    auto doc = SPDocument::createNewDocFromMem(R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+<path id='p' d='M 0,0' />
+</svg>)A"sv, false);
+    ASSERT_TRUE(doc);
+    auto path = doc->getObjectById("p")->getRepr();
+
+    // Each step holds a 100 kB path, so that only ten fit into 1 MiB.
+    auto const path_data = [] (int step) { return "M " + std::to_string(step) + ",0" + std::string(100000, 'h'); };
+    constexpr int steps = 30;
+    DocumentUndo::setUndoSensitive(doc.get(), true);
+    for (int step = 1; step <= steps; ++step) {
+        path->setAttribute("d", path_data(step));
+        DocumentUndo::done(doc.get(), "Edit", step % 3 ? "icon-a" : "icon-b");
+    }
+
+    auto const kept = doc->undoStepCount();
+    EXPECT_LT(kept, static_cast<std::size_t>(steps));
+    EXPECT_GE(kept, 5u);
+    EXPECT_LE(doc->undoMemoryUsage(), std::size_t{1} << 20);
+    EXPECT_EQ(listed_events(*doc), static_cast<int>(kept));
+
+    // The steps kept can all be undone, back to the state after the last step dropped, and redone.
+    auto const usage = doc->undoMemoryUsage();
+    while (DocumentUndo::undo(doc.get())) {
+    }
+    EXPECT_EQ(doc->undoStepCount(), 0u);
+    EXPECT_EQ(path->attribute("d"), path_data(steps - kept));
+    while (DocumentUndo::redo(doc.get())) {
+    }
+    EXPECT_EQ(path->attribute("d"), path_data(steps));
+    EXPECT_EQ(doc->undoMemoryUsage(), usage);
+
+    prefs->setInt("/options/undo/budget", 256);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
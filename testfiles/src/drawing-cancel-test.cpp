@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for abandoning the rendering of a drawing.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <gtest/gtest.h>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "object/sp-root.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+#include "display/tile-disk-cache.h"
+
+using namespace Inkscape;
+
+namespace fs = std::filesystem;
+using namespace std::literals;
+
+namespace {
+
+/// A blurred rectangle large enough to be worth caching, and a plain one.
+constexpr auto svg = R"A(<svg xmlns="http://www.w3.org/2000/svg" width="400" height="400">
+  <defs>
+    <filter id="blur" x="-0.1" y="-0.1" width="1.2" height="1.2">
+      <feGaussianBlur stdDeviation="4"/>
+    </filter>
+  </defs>
+  <rect x="20" y="20" width="360" height="360" style="fill:#ff0000;filter:url(#blur)"/>
+  <rect x="100" y="100" width="200" height="200" style="fill:#0000ff"/>
+</svg>)A"sv;
+
+class DrawingCancelTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!Application::exists()) {
+            Application::create(false);
+        }
+        doc = SPDocument::createNewDocFromMem(svg, false);
+        ASSERT_TRUE(doc);
+        doc->ensureUpToDate();
+
+        root = doc->getRoot();
+        dkey = SPItem::display_key_new(1);
+        drawing.setCacheBudget(64 << 20);
+        drawing.setCacheLimit(area);
+        drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing.update();
+    }
+
+    void TearDown() override { root->invoke_hide(dkey); }
+
+    void draw(std::atomic<bool> const *cancel)
+    {
+        auto cs = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, area.width(), area.height());
+        auto ds = DrawingSurface(cs->cobj(), area.min());
+        auto dc = DrawingContext(ds);
+        drawing.render(dc, area, 0, cancel);
+    }
+
+    Geom::IntRect const area = Geom::IntRect::from_xywh(0, 0, 400, 400);
+    std::unique_ptr<SPDocument> doc;
+    Drawing drawing;
+    SPRoot *root = nullptr;
+    unsigned dkey = 0;
+};
+
+} // namespace
+
+TEST_F(DrawingCancelTest, CancelledRenderCachesNothing)
+{
+    auto const cancel = std::atomic<bool>(true);
+    draw(&cancel);
+
+    EXPECT_EQ(drawing.cachedItemCount(), 0u);
+    EXPECT_EQ(drawing.filterResultSize(), 0u);
+
+    // The same rendering, left to finish, fills both caches.
+    auto const go_on = std::atomic<bool>(false);
+    draw(&go_on);
+
+    EXPECT_GT(drawing.cachedItemCount(), 0u);
+    EXPECT_GT(drawing.filterResultSize(), 0u);
+}
+
+TEST_F(DrawingCancelTest, CancelledTileIsNotStoredOnDisk)
+{
+    auto const dir = fs::temp_directory_path() / "inkscape-drawing-cancel-test";
+    fs::remove_all(dir);
+    auto const cache = std::make_shared<TileDiskCache>(dir.string(), 64 << 20);
+    auto const tile = Geom::IntRect::from_xywh(0, 0, TileDiskCache::TILE_SIZE, TileDiskCache::TILE_SIZE);
+
+    auto const cancel = std::atomic<bool>(true);
+    cairo_surface_destroy(cache->render("tile", drawing, tile, 1, &cancel));
+    cache->flush();
+    EXPECT_EQ(cache->lookup("tile"), nullptr);
+    EXPECT_EQ(drawing.cachedItemCount(), 0u);
+    EXPECT_EQ(drawing.filterResultSize(), 0u);
+
+    cairo_surface_destroy(cache->render("tile", drawing, tile, 1));
+    cache->flush();
+    auto const stored = cache->lookup("tile");
+    EXPECT_NE(stored, nullptr);
+    cairo_surface_destroy(stored);
+
+    fs::remove_all(dir);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for picking the children of large groups through their spatial index.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <2geom/point.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "object/sp-item-group.h"
+#include "object/sp-root.h"
+#include "display/drawing.h"
+#include "display/drawing-item.h"
+
+using namespace Inkscape;
+
+namespace {
+
+constexpr int rows = 10;
+constexpr int columns = 10;
+
+/// A layer of overlapping squares, enough of them for the layer to pick through its index.
+std::string layer()
+{
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg' "
+                      "xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape' width='200' height='200'>"
+                      "<g id='layer' inkscape:groupmode='layer'>";
+    for (int i = 0; i < rows * columns; i++) {
+        svg += "<rect id='r" + std::to_string(i) + "' x='" + std::to_string(i % columns * 10) + "' y='" +
+               std::to_string(i / columns * 10) + "' width='15' height='15'/>";
+    }
+    return svg + "</g></svg>";
+}
+
+class DrawingGroupPickTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        if (!Application::exists()) {
+            Application::create(false);
+        }
+        auto const svg = layer();
+        doc = SPDocument::createNewDocFromMem(svg, false);
+        ASSERT_TRUE(doc);
+        doc->ensureUpToDate();
+
+        root = doc->getRoot();
+        group = cast<SPGroup>(doc->getObjectById("layer"));
+        ASSERT_TRUE(group);
+        dkey = SPItem::display_key_new(1);
+        drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing.update();
+    }
+
+    void TearDown() override { root->invoke_hide(dkey); }
+
+    void update()
+    {
+        doc->ensureUpToDate();
+        drawing.update();
+    }
+
+    DrawingItem *drawingItem(char const *id) { return cast<SPItem>(doc->getObjectById(id))->get_arenaitem(dkey); }
+
+    /// Pick through the layer, which uses its index.
+    DrawingItem *pick(Geom::Point const &p) { return group->get_arenaitem(dkey)->pick(p, 0, 0); }
+
+    /// Pick the children one by one in their order, as a group without an index does.
+    DrawingItem *pickLinearly(Geom::Point const &p)
+    {
+        for (auto &child : group->children) {
+            if (auto item = cast<SPItem>(&child)) {
+                if (auto picked = item->get_arenaitem(dkey)->pick(p, 0, 0)) {
+                    return picked;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void expectSameAsLinear()
+    {
+        for (double y = 0.5; y < 130; y += 2.25) {
+            for (double x = 0.5; x < 130; x += 2.25) {
+                EXPECT_EQ(pick({x, y}), pickLinearly({x, y})) << "at " << x << ", " << y;
+            }
+        }
+    }
+
+    std::unique_ptr<SPDocument> doc;
+    Drawing drawing;
+    SPRoot *root = nullptr;
+    SPGroup *group = nullptr;
+    unsigned dkey = 0;
+};
+
+} // namespace
+
+TEST_F(DrawingGroupPickTest, MatchesLinearPick)
+{
+    ASSERT_GE(group->children.size(), 64u);
+    expectSameAsLinear();
+
+    EXPECT_EQ(pick({1, 1}), drawingItem("r0"));
+    EXPECT_EQ(pick({150, 150}), nullptr);
+}
+
+TEST_F(DrawingGroupPickTest, FirstOverlappingChildWins)
+{
+    // Where r0 and r1 overlap, the child picked first is the one earlier in the pick order.
+    EXPECT_EQ(pick({12, 5}), drawingItem("r0"));
+    EXPECT_EQ(pick({12, 12}), drawingItem("r0"));
+    EXPECT_EQ(pick({17, 5}), drawingItem("r1"));
+}
+
+TEST_F(DrawingGroupPickTest, ReorderingChangesPick)
+{
+    ASSERT_EQ(pick({12, 5}), drawingItem("r0"));
+
+    // Moving r0 to the end of the layer calls setZOrder() on its drawing item.
+    auto const repr = doc->getObjectById("r0")->getRepr();
+    repr->parent()->changeOrder(repr, repr->parent()->lastChild());
+    update();
+
+    EXPECT_EQ(pick({12, 5}), drawingItem("r1"));
+    EXPECT_EQ(pick({1, 1}), drawingItem("r0"));
+    expectSameAsLinear();
+}
+
+TEST_F(DrawingGroupPickTest, MovingChildChangesPick)
+{
+    ASSERT_EQ(pick({1, 1}), drawingItem("r0"));
+
+    // Moving r0 changes its bounding box, which drops the index of the layer.
+    auto const repr = doc->getObjectById("r0")->getRepr();
+    repr->setAttribute("x", "150");
+    repr->setAttribute("y", "150");
+    update();
+
+    EXPECT_EQ(pick({1, 1}), nullptr);
+    EXPECT_EQ(pick({155, 155}), drawingItem("r0"));
+    expectSameAsLinear();
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for drawing long and dense paths.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include <cairomm/surface.h>
+#include <2geom/int-rect.h>
+#include <2geom/int-point.h>
+#include <2geom/path-sink.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "helper/geom.h"
+#include "object/sp-root.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+
+using namespace Inkscape;
+
+namespace {
+
+std::string point(double x, double y)
+{
+    return std::to_string(x) + "," + std::to_string(y) + " ";
+}
+
+/// A closed star with many points around the centre of the drawing, enclosing its middle.
+std::string star()
+{
+    std::string d = "M " + point(185, 100) + "L ";
+    for (int i = 1; i < 1200; i++) {
+        auto const angle = 2 * M_PI * i / 1200;
+        auto const radius = i % 2 ? 55.0 : 85.0;
+        d += point(100 + radius * std::cos(angle), 100 + radius * std::sin(angle));
+    }
+    return d + "Z";
+}
+
+/// An open zigzag across the drawing.
+std::string wave()
+{
+    std::string d = "M " + point(5, 100) + "L ";
+    for (int i = 1; i <= 800; i++) {
+        auto const x = 5 + 190.0 * i / 800;
+        d += point(x, 100 + 40 * std::sin(x / 7) + (i % 2 ? 3 : -3));
+    }
+    return d;
+}
+
+/// A closed circle made of many cubic arcs.
+std::string circle()
+{
+    constexpr int arcs = 400;
+    auto const at = [] (double angle, double radius) {
+        return point(60 + radius * std::cos(angle), 60 + radius * std::sin(angle));
+    };
+    auto const step = 2 * M_PI / arcs;
+    auto const handle = 4.0 / 3 * std::tan(step / 4) * 30;
+    auto const radius = std::hypot(30.0, handle);
+    auto const skew = std::atan2(handle, 30.0);
+
+    std::string d = "M " + at(0, 30);
+    for (int i = 0; i < arcs; i++) {
+        d += "C " + at(i * step + skew, radius) + at((i + 1) * step - skew, radius) + at((i + 1) * step, 30);
+    }
+    return d + "Z";
+}
+
+class Display
+{
+public:
+    Display(SPDocument &doc)
+        : root(doc.getRoot())
+    {
+        dkey = SPItem::display_key_new(1);
+        drawing.setRoot(root->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing.update();
+    }
+
+    ~Display() { root->invoke_hide(dkey); }
+
+    auto draw(Geom::IntRect const &rect)
+    {
+        auto cs = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, rect.width(), rect.height());
+        auto ds = DrawingSurface(cs->cobj(), rect.min());
+        auto dc = DrawingContext(ds);
+        drawing.render(dc, rect);
+        return cs;
+    }
+
+private:
+    Drawing drawing;
+    SPRoot *root;
+    unsigned dkey;
+};
+
+} // namespace
+
+TEST(DrawingShapeTest, DrawsLongPathsInTiles)
+{
+    Application::create(false);
+
+    auto const svg = "<svg xmlns='http://www.w3.org/2000/svg' width='200' height='200'>"
+        "<path d='" + star() + "' style='fill:#ff0000;stroke:#0000ff;stroke-width:5;stroke-linejoin:miter' />"
+        "<path d='" + wave() + "' style='fill:none;stroke:#00ff00;stroke-width:2.5;stroke-dasharray:6,3;stroke-linecap:round' />"
+        "<path d='" + circle() + "' style='fill:#ffff00;fill-rule:evenodd;stroke:#000000;stroke-width:2;stroke-dasharray:4,2' />"
+        "</svg>";
+    auto doc = SPDocument::createNewDocFromMem(svg, false);
+    ASSERT_TRUE(doc);
+    doc->ensureUpToDate();
+
+    auto const area = Geom::IntRect::from_xywh(0, 0, 200, 200);
+    auto display = Display(*doc);
+    auto const reference = display.draw(area);
+
+    int maxdiff = 0;
+    auto compare = [&] (Cairo::RefPtr<Cairo::ImageSurface> const &part, Geom::IntPoint const &off) {
+        for (int y = 0; y < part->get_height(); y++) {
+            auto p = reference->get_data() + (off.y() + y) * reference->get_stride() + off.x() * 4;
+            auto q = part->get_data() + y * part->get_stride();
+            for (int x = 0; x < part->get_width() * 4; x++) {
+                maxdiff = std::max(maxdiff, std::abs((int)p[x] - (int)q[x]));
+            }
+        }
+    };
+
+    // Tiles within the fill of the star, on its edges, and away from every path.
+    for (int y = 0; y < 200; y += 16) {
+        for (int x = 0; x < 200; x += 16) {
+            auto const tile = Geom::IntRect::from_xywh(x, y, 16, 16) & area;
+            compare(display.draw(*tile), tile->min());
+        }
+    }
+
+    EXPECT_LE(maxdiff, 10);
+}
+
+TEST(DrawingShapeTest, SimplifiesWithinTolerance)
+{
+    // A dense wiggly line, a few curves, and a closed polygon.
+    Geom::PathVector pv;
+    Geom::PathBuilder builder(pv);
+    builder.moveTo(Geom::Point(0, 0));
+    for (int i = 1; i <= 2000; i++) {
+        builder.lineTo(Geom::Point(i * 0.01, 0.005 * std::sin(i)));
+    }
+    builder.curveTo(Geom::Point(25, 10), Geom::Point(30, -10), Geom::Point(35, 0));
+    builder.quadTo(Geom::Point(40, 0.01), Geom::Point(45, 0));
+    builder.moveTo(Geom::Point(0, 10));
+    for (int i = 1; i < 1000; i++) {
+        auto const angle = 2 * M_PI * i / 1000;
+        builder.lineTo(Geom::Point(5 * std::sin(angle), 10 + 5 * std::cos(angle)));
+    }
+    builder.closePath();
+    builder.flush();
+
+    constexpr double tolerance = 0.05;
+    auto const simplified = pathv_simplify_within(pv, tolerance);
+    ASSERT_EQ(simplified.size(), pv.size());
+    EXPECT_LT(simplified.curveCount() * 10, pv.curveCount());
+    EXPECT_TRUE(simplified[1].closed());
+
+    auto const distance = [] (Geom::PathVector const &to, Geom::Point const &p) {
+        auto const t = to.nearestTime(p);
+        return t ? Geom::distance(p, to.pointAt(*t)) : Geom::infinity();
+    };
+    for (auto [from, to] : {std::pair{&pv, &simplified}, std::pair{&simplified, &pv}}) {
+        for (auto const &path : *from) {
+            for (auto const &c : path) {
+                for (double t = 0; t <= 1; t += 0.25) {
+                    EXPECT_LE(distance(*to, c.pointAt(t)), tolerance * 1.001);
+                }
+            }
+        }
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the cache of filter results kept across redraws.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <cstdint>
+#include <gtest/gtest.h>
+
+#include "display/filter-result-cache.h"
+
+using Inkscape::DrawingItem;
+using Inkscape::FilterResultCache;
+
+namespace {
+
+FilterResultCache::Key make_key(int item, double scale = 1.0)
+{
+    return {
+        .item = reinterpret_cast<DrawingItem const *>(static_cast<uintptr_t>(item) * 16),
+        .filter = nullptr,
+        .transform = Geom::Scale(scale),
+        .device_scale = 1,
+        .filter_quality = 0,
+        .blur_quality = 0,
+        .flags = 0
+    };
+}
+
+/// Insert a solid 100x100 result and return its size in bytes.
+size_t insert(FilterResultCache &cache, FilterResultCache::Key const &key, Geom::IntPoint const &origin = {0, 0})
+{
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cache.insert(key, Geom::IntRect::from_xywh(origin, {100, 100}), surface);
+    size_t bytes = cairo_image_surface_get_stride(surface) * 100;
+    cairo_surface_destroy(surface);
+    return bytes;
+}
+
+bool contains(FilterResultCache &cache, FilterResultCache::Key const &key,
+              Geom::IntRect const &area = Geom::IntRect::from_xywh(10, 10, 50, 50))
+{
+    Geom::IntRect result_area;
+    auto result = cache.lookup(key, area, result_area);
+    if (!result) {
+        return false;
+    }
+    cairo_surface_destroy(result);
+    return true;
+}
+
+} // namespace
+
+TEST(FilterResultCacheTest, LookupNeedsMatchingKeyAndArea)
+{
+    FilterResultCache cache;
+    cache.set_budget(1 << 20);
+    insert(cache, make_key(1));
+
+    EXPECT_TRUE(contains(cache, make_key(1)));
+    EXPECT_FALSE(contains(cache, make_key(1, 2.0)));
+    EXPECT_FALSE(contains(cache, make_key(2)));
+    EXPECT_FALSE(contains(cache, make_key(1), Geom::IntRect::from_xywh(50, 50, 100, 100)));
+
+    Geom::IntRect result_area;
+    auto result = cache.lookup(make_key(1), Geom::IntRect::from_xywh(0, 0, 10, 10), result_area);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result_area, Geom::IntRect::from_xywh(0, 0, 100, 100));
+    cairo_surface_destroy(result);
+}
+
+TEST(FilterResultCacheTest, EvictsLeastRecentlyUsed)
+{
+    FilterResultCache cache;
+    size_t bytes = insert(cache, make_key(0));
+    EXPECT_EQ(cache.size(), 0); // no budget
+
+    cache.set_budget(2 * bytes);
+    insert(cache, make_key(1));
+    insert(cache, make_key(2));
+    EXPECT_TRUE(contains(cache, make_key(1))); // now more recently used than 2
+    insert(cache, make_key(3));
+
+    EXPECT_TRUE(contains(cache, make_key(1)));
+    EXPECT_FALSE(contains(cache, make_key(2)));
+    EXPECT_TRUE(contains(cache, make_key(3)));
+    EXPECT_EQ(cache.size(), 2 * bytes);
+
+    cache.set_budget(bytes);
+    EXPECT_EQ(cache.size(), bytes);
+    EXPECT_TRUE(contains(cache, make_key(3))); // looked up last
+    EXPECT_FALSE(contains(cache, make_key(1)));
+}
+
+TEST(FilterResultCacheTest, KeepsSeveralTilesPerKey)
+{
+    FilterResultCache cache;
+    cache.set_budget(1 << 20);
+    size_t bytes = insert(cache, make_key(1));
+    insert(cache, make_key(1), {100, 0});
+    insert(cache, make_key(1), {0, 100});
+
+    EXPECT_TRUE(contains(cache, make_key(1), Geom::IntRect::from_xywh(10, 10, 50, 50)));
+    EXPECT_TRUE(contains(cache, make_key(1), Geom::IntRect::from_xywh(110, 10, 50, 50)));
+    EXPECT_TRUE(contains(cache, make_key(1), Geom::IntRect::from_xywh(10, 110, 50, 50)));
+    EXPECT_FALSE(contains(cache, make_key(1), Geom::IntRect::from_xywh(50, 10, 100, 50))); // straddles two tiles
+    EXPECT_EQ(cache.size(), 3 * bytes);
+
+    Geom::IntRect result_area;
+    auto result = cache.lookup(make_key(1), Geom::IntRect::from_xywh(120, 20, 10, 10), result_area);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result_area, Geom::IntRect::from_xywh(100, 0, 100, 100));
+    cairo_surface_destroy(result);
+}
+
+TEST(FilterResultCacheTest, LargerResultReplacesTilesWithin)
+{
+    FilterResultCache cache;
+    cache.set_budget(1 << 20);
+    insert(cache, make_key(1), {0, 0});
+    size_t tile_bytes = insert(cache, make_key(1), {200, 0});
+
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 150, 150);
+    cache.insert(make_key(1), Geom::IntRect::from_xywh(-10, -10, 150, 150), surface);
+    size_t bytes = cairo_image_surface_get_stride(surface) * 150;
+    cairo_surface_destroy(surface);
+
+    EXPECT_EQ(cache.size(), bytes + tile_bytes);
+
+    Geom::IntRect result_area;
+    auto result = cache.lookup(make_key(1), Geom::IntRect::from_xywh(10, 10, 50, 50), result_area);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result_area, Geom::IntRect::from_xywh(-10, -10, 150, 150));
+    cairo_surface_destroy(result);
+    EXPECT_TRUE(contains(cache, make_key(1), Geom::IntRect::from_xywh(210, 10, 50, 50)));
+}
+
+TEST(FilterResultCacheTest, RemoveDropsAllResultsOfItem)
+{
+    FilterResultCache cache;
+    cache.set_budget(1 << 20);
+    insert(cache, make_key(1));
+    insert(cache, make_key(1, 2.0));
+    insert(cache, make_key(2));
+
+    cache.remove(make_key(1).item);
+    EXPECT_FALSE(contains(cache, make_key(1)));
+    EXPECT_FALSE(contains(cache, make_key(1, 2.0)));
+    EXPECT_TRUE(contains(cache, make_key(2)));
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the downscaled copies of images used when zoomed out.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <cstdint>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "display/image-pyramid-cache.h"
+
+using Inkscape::DrawingImage;
+using Inkscape::ImagePyramidCache;
+using Inkscape::downsample_half;
+
+namespace {
+
+DrawingImage const *make_image(int id)
+{
+    return reinterpret_cast<DrawingImage const *>(static_cast<uintptr_t>(id) * 16);
+}
+
+/// Create an ARGB32 surface from rows of premultiplied pixels.
+cairo_surface_t *make_surface(std::vector<std::vector<uint32_t>> const &rows)
+{
+    int const h = rows.size();
+    int const w = rows[0].size();
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+    int const stride = cairo_image_surface_get_stride(surface);
+    auto const data = cairo_image_surface_get_data(surface);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            reinterpret_cast<uint32_t *>(data + y * stride)[x] = rows[y][x];
+        }
+    }
+    cairo_surface_mark_dirty(surface);
+    return surface;
+}
+
+uint32_t pixel(cairo_surface_t *surface, int x, int y)
+{
+    cairo_surface_flush(surface);
+    auto const data = cairo_image_surface_get_data(surface);
+    return reinterpret_cast<uint32_t const *>(data + y * cairo_image_surface_get_stride(surface))[x];
+}
+
+/// Insert a 100x100 level and return its size in bytes.
+size_t insert(ImagePyramidCache &cache, int image, int level)
+{
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cache.insert(make_image(image), level, surface);
+    size_t bytes = cairo_image_surface_get_stride(surface) * 100;
+    cairo_surface_destroy(surface);
+    return bytes;
+}
+
+bool contains(ImagePyramidCache &cache, int image, int level)
+{
+    auto surface = cache.lookup(make_image(image), level);
+    if (!surface) {
+        return false;
+    }
+    cairo_surface_destroy(surface);
+    return true;
+}
+
+} // namespace
+
+TEST(DownsampleHalfTest, AveragesEachChannelOfTwoByTwoBlocks)
+{
+    auto src = make_surface({
+        { 0xff000000, 0xffff0000, 0x00000000, 0x80808080 },
+        { 0xff00ff00, 0xff0000ff, 0x80808080, 0x80808080 },
+    });
+    auto dst = downsample_half(src);
+
+    ASSERT_EQ(cairo_image_surface_get_width(dst), 2);
+    ASSERT_EQ(cairo_image_surface_get_height(dst), 1);
+    EXPECT_EQ(pixel(dst, 0, 0), 0xff404040);
+    EXPECT_EQ(pixel(dst, 1, 0), 0x60606060);
+
+    cairo_surface_destroy(dst);
+    cairo_surface_destroy(src);
+}
+
+TEST(DownsampleHalfTest, RepeatsLastRowAndColumnOfOddSizes)
+{
+    auto src = make_surface({
+        { 0x10101010, 0x20202020, 0x30303030 },
+        { 0x50505050, 0x60606060, 0x70707070 },
+        { 0x90909090, 0xa0a0a0a0, 0xb0b0b0b0 },
+    });
+    auto dst = downsample_half(src);
+
+    ASSERT_EQ(cairo_image_surface_get_width(dst), 2);
+    ASSERT_EQ(cairo_image_surface_get_height(dst), 2);
+    EXPECT_EQ(pixel(dst, 0, 0), 0x38383838);
+    EXPECT_EQ(pixel(dst, 1, 0), 0x50505050);
+    EXPECT_EQ(pixel(dst, 0, 1), 0x98989898);
+    EXPECT_EQ(pixel(dst, 1, 1), 0xb0b0b0b0);
+
+    cairo_surface_destroy(dst);
+    cairo_surface_destroy(src);
+}
+
+TEST(DownsampleHalfTest, SinglePixelStaysTheSame)
+{
+    auto src = make_surface({{ 0x80402010 }});
+    auto dst = downsample_half(src);
+
+    ASSERT_EQ(cairo_image_surface_get_width(dst), 1);
+    ASSERT_EQ(cairo_image_surface_get_height(dst), 1);
+    EXPECT_EQ(pixel(dst, 0, 0), 0x80402010);
+
+    cairo_surface_destroy(dst);
+    cairo_surface_destroy(src);
+}
+
+TEST(ImagePyramidCacheTest, LookupNeedsMatchingImageAndLevel)
+{
+    ImagePyramidCache cache;
+    cache.set_budget(1 << 20);
+    insert(cache, 1, 2);
+
+    EXPECT_TRUE(contains(cache, 1, 2));
+    EXPECT_FALSE(contains(cache, 1, 1));
+    EXPECT_FALSE(contains(cache, 2, 2));
+}
+
+TEST(ImagePyramidCacheTest, EvictsLeastRecentlyUsedLevel)
+{
+    ImagePyramidCache cache;
+    auto const bytes = insert(cache, 0, 1);
+    cache.clear();
+    cache.set_budget(2 * bytes);
+
+    insert(cache, 1, 1);
+    insert(cache, 2, 1);
+    EXPECT_TRUE(contains(cache, 1, 1));
+    insert(cache, 3, 1);
+
+    EXPECT_TRUE(contains(cache, 1, 1));
+    EXPECT_FALSE(contains(cache, 2, 1));
+    EXPECT_TRUE(contains(cache, 3, 1));
+    EXPECT_EQ(cache.size(), 2 * bytes);
+}
+
+TEST(ImagePyramidCacheTest, RejectsLevelLargerThanBudget)
+{
+    ImagePyramidCache cache;
+    cache.set_budget(100);
+
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    EXPECT_FALSE(cache.insert(make_image(1), 1, surface));
+    cairo_surface_destroy(surface);
+
+    EXPECT_FALSE(contains(cache, 1, 1));
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(ImagePyramidCacheTest, RemoveDropsAllLevelsOfImage)
+{
+    ImagePyramidCache cache;
+    cache.set_budget(1 << 20);
+    insert(cache, 1, 1);
+    auto const bytes = insert(cache, 1, 2);
+    insert(cache, 2, 1);
+
+    cache.remove(make_image(1));
+
+    EXPECT_FALSE(contains(cache, 1, 1));
+    EXPECT_FALSE(contains(cache, 1, 2));
+    EXPECT_TRUE(contains(cache, 2, 1));
+    EXPECT_EQ(cache.size(), bytes);
+}
+
+TEST(ImagePyramidCacheTest, ShrinkingBudgetEvicts)
+{
+    ImagePyramidCache cache;
+    cache.set_budget(1 << 20);
+    auto const bytes = insert(cache, 1, 1);
+    insert(cache, 2, 1);
+
+    cache.set_budget(bytes);
+
+    EXPECT_FALSE(contains(cache, 1, 1));
+    EXPECT_TRUE(contains(cache, 2, 1));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
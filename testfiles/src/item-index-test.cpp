@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for finding the items of a document by area through its spatial index.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "object/item-index.h"
+#include "object/sp-item.h"
+
+using namespace Inkscape;
+using namespace std::literals;
+
+class ItemIndexTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // setup hidden dependency
+        Application::create(false);
+
+        constexpr auto svg = R"A(
+<svg width='100' height='100' xmlns:inkscape='http://www.inkscape.org/namespaces/inkscape'>
+  <g id='layer1' inkscape:groupmode='layer'>
+    <rect id='rect1' x='0' y='0' width='10' height='10' />
+    <g id='group1'>
+      <rect id='rect2' x='20' y='0' width='10' height='10' />
+      <rect id='rect3' x='40' y='0' width='10' height='10' />
+    </g>
+    <rect id='rect4' x='60' y='0' width='10' height='10' style='display:none' />
+  </g>
+  <rect id='rect5' x='80' y='80' width='10' height='10' />
+</svg>)A"sv;
+
+        doc = SPDocument::createNewDocFromMem(svg, true);
+        doc->ensureUpToDate();
+    }
+
+    std::vector<std::string> ids(std::vector<SPItem *> const &items)
+    {
+        std::vector<std::string> result;
+        for (auto item : items) {
+            result.emplace_back(item->getId());
+        }
+        return result;
+    }
+
+    std::unique_ptr<SPDocument> doc;
+};
+
+TEST_F(ItemIndexTest, ItemsInBox)
+{
+    auto const all = Geom::Rect(-1, -1, 101, 101);
+    EXPECT_EQ(ids(doc->getItemsInBox(0, all)), (std::vector<std::string>{"rect1", "group1", "rect5"}));
+    EXPECT_EQ(ids(doc->getItemsInBox(0, all, true)),
+              (std::vector<std::string>{"rect1", "group1", "rect4", "rect5"}));
+    EXPECT_EQ(ids(doc->getItemsInBox(0, all, false, false, true, true)),
+              (std::vector<std::string>{"rect1", "rect2", "rect3", "group1", "rect5"}));
+    EXPECT_EQ(ids(doc->getItemsInBox(0, all, false, false, false, true)),
+              (std::vector<std::string>{"rect1", "rect2", "rect3", "rect5"}));
+
+    EXPECT_EQ(ids(doc->getItemsInBox(0, Geom::Rect(-1, -1, 35, 11))), (std::vector<std::string>{"rect1"}));
+    EXPECT_EQ(ids(doc->getItemsPartiallyInBox(0, Geom::Rect(-1, -1, 35, 11))),
+              (std::vector<std::string>{"rect1", "group1"}));
+}
+
+TEST_F(ItemIndexTest, FollowsChanges)
+{
+    auto const box = Geom::Rect(75, 75, 95, 95);
+    EXPECT_EQ(ids(doc->getItemsInBox(0, box)), (std::vector<std::string>{"rect5"}));
+
+    doc->getObjectById("rect1")->setAttribute("transform", "translate(80,80)");
+    doc->ensureUpToDate();
+    EXPECT_EQ(ids(doc->getItemsInBox(0, box)), (std::vector<std::string>{"rect1", "rect5"}));
+
+    // Moving a group moves the items inside it.
+    doc->getObjectById("group1")->setAttribute("transform", "translate(40,80)");
+    doc->ensureUpToDate();
+    EXPECT_EQ(ids(doc->getItemsPartiallyInBox(0, box, false, false, false, true)),
+              (std::vector<std::string>{"rect1", "rect3", "rect5"}));
+
+    doc->getObjectById("rect5")->deleteObject();
+    doc->ensureUpToDate();
+    EXPECT_EQ(ids(doc->getItemsInBox(0, box)), (std::vector<std::string>{"rect1"}));
+    EXPECT_EQ(doc->getItemIndex().size(), 7u); // including the root
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
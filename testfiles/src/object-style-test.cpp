@@ -195,3 +195,78 @@ TEST_F(ObjectTest, StyleFontSizes) {
     // 50% is 118.59 == ((300^2 + 150^2) / 2)^0.5 * 0.5
     EXPECT_FLOAT_EQ(eight->style->stroke_width.computed, 118.58541);
 }
+
+class ObjectStyleShareTest : public DocPerCaseTest {
+public:
+    ObjectStyleShareTest() {
+        constexpr auto docString = R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+<defs><linearGradient id='grad'><stop offset='0' stop-color='red'/></linearGradient></defs>
+<g id='group' style='stroke-width:2px;'>
+  <rect id='one' style='fill:red;' width='1' height='1'/>
+  <rect id='two' style='fill:red;' width='2' height='2'/>
+  <path id='three' style='fill:red;' d='M 0,0 L 3,3'/>
+  <rect id='four' style='fill:blue;' width='1' height='1'/>
+  <rect id='five' style='fill:url(#grad);' width='1' height='1'/>
+  <rect id='six' style='fill:url(#grad);' width='1' height='1'/>
+</g>
+<g id='other' style='stroke-width:2px;'>
+  <rect id='seven' style='fill:red;' width='1' height='1'/>
+</g>
+</svg>)A"sv;
+        doc = SPDocument::createNewDocFromMem(docString, false);
+        doc->ensureUpToDate();
+    }
+
+    SPObject *get(char const *id) { return doc->getObjectById(id); }
+
+    std::unique_ptr<SPDocument> doc;
+};
+
+TEST_F(ObjectStyleShareTest, SameDeclaredStyleIsShared) {
+    EXPECT_TRUE(get("one")->style->isShared());
+    EXPECT_EQ(get("one")->style, get("two")->style);
+    // The 'd' of a path does not keep it from sharing.
+    EXPECT_EQ(get("one")->style, get("three")->style);
+    EXPECT_NE(get("one")->style, get("four")->style);
+    EXPECT_EQ(get("one")->style->stroke_width.computed, 2);
+
+    // Groups keep their own styles, so shapes share only under the same parent.
+    EXPECT_FALSE(get("group")->style->isShared());
+    EXPECT_NE(get("one")->style, get("seven")->style);
+}
+
+TEST_F(ObjectStyleShareTest, PaintServersAreNotShared) {
+    EXPECT_FALSE(get("five")->style->isShared());
+    EXPECT_NE(get("five")->style, get("six")->style);
+    EXPECT_TRUE(get("five")->style->getFillPaintServer());
+}
+
+TEST_F(ObjectStyleShareTest, SettingStyleUnshares) {
+    get("one")->setAttribute("style", "fill:blue;");
+    doc->ensureUpToDate();
+
+    EXPECT_EQ(get("one")->style, get("four")->style);
+    EXPECT_EQ(get("two")->style, get("three")->style);
+    EXPECT_EQ(get("two")->style->fill.get_value(), Glib::ustring("red"));
+}
+
+TEST_F(ObjectStyleShareTest, WritableStyleIsOwn) {
+    auto const style = get("one")->writableStyle();
+    EXPECT_FALSE(style->isShared());
+    EXPECT_EQ(style, get("one")->style);
+    EXPECT_NE(style, get("two")->style);
+
+    style->opacity.set_double(0.5);
+    EXPECT_EQ(get("two")->style->opacity.value, SP_SCALE24_MAX);
+}
+
+TEST_F(ObjectStyleShareTest, ParentChangeCascadesOnce) {
+    get("group")->setAttribute("style", "stroke-width:3px;");
+    doc->ensureUpToDate();
+
+    EXPECT_TRUE(get("one")->style->isShared());
+    EXPECT_EQ(get("one")->style, get("two")->style);
+    EXPECT_EQ(get("one")->style->stroke_width.computed, 3);
+    EXPECT_EQ(get("seven")->style->stroke_width.computed, 2);
+}
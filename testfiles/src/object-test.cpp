@@ -201,3 +201,32 @@ TEST_F(ObjectTest, Objects) {
     // Test hrefcount
     EXPECT_TRUE(path->isReferenced());
 }
+
+TEST_F(ObjectTest, ObjectsByClassAndElement) {
+    ASSERT_TRUE(doc);
+
+    // The path, then its clone in the use element
+    auto paths = doc->getObjectsByElement("path");
+    ASSERT_EQ(paths.size(), 2u);
+    EXPECT_EQ(paths[0], doc->getObjectById("P"));
+    EXPECT_TRUE(paths[1]->cloned);
+    EXPECT_TRUE(doc->getObjectsByElement("path", true).empty());
+
+    auto group = doc->getObjectById("G");
+    auto circle = doc->getObjectById("C");
+    auto ellipse = doc->getObjectById("E");
+    EXPECT_TRUE(doc->getObjectsByClass("shape").empty());
+
+    ellipse->setAttribute("class", "shape round");
+    circle->setAttribute("class", " round\tshape ");
+    group->setAttribute("class", "shape");
+    EXPECT_EQ(doc->getObjectsByClass("shape"), (std::vector<SPObject *>{group, circle, ellipse}));
+    EXPECT_EQ(doc->getObjectsByClass("round"), (std::vector<SPObject *>{circle, ellipse}));
+
+    circle->setAttribute("class", "round");
+    EXPECT_EQ(doc->getObjectsByClass("shape"), (std::vector<SPObject *>{group, ellipse}));
+
+    ellipse->deleteObject();
+    EXPECT_EQ(doc->getObjectsByClass("round"), std::vector<SPObject *>{circle});
+    EXPECT_TRUE(doc->getObjectsByElement("ellipse").empty());
+}
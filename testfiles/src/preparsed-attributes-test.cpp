@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for parsing attributes ahead of building the objects of a document.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "display/curve.h"
+#include "object/preparsed-attributes.h"
+#include "object/sp-path.h"
+#include "svg/svg.h"
+#include "xml/repr.h"
+
+using namespace Inkscape;
+
+TEST(PreparsedAttributesTest, TakesMatchingValues)
+{
+    auto rdoc = std::shared_ptr<XML::Document>(sp_repr_read_buf(R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+  <g transform='translate(1,2)'>
+    <path id='p' d='M 0,0 L 10,0 L 10,10 Z' transform='scale(2)' />
+    <rect id='r' d='M 0,0 L 1,1' />
+  </g>
+</svg>)A", SP_SVG_NS_URI));
+    ASSERT_TRUE(rdoc);
+
+    auto preparsed = PreparsedAttributes(*rdoc->root());
+    EXPECT_EQ(preparsed.size(), 2u);
+
+    auto g = rdoc->root()->firstChild();
+    auto path = g->firstChild();
+    auto rect = path->next();
+
+    // Only a path's "d" is path data.
+    EXPECT_FALSE(preparsed.takePath(rect, rect->attribute("d")));
+
+    // A value changed since parsing is not taken; an equal one is, wherever it is stored.
+    EXPECT_FALSE(preparsed.takePath(path, "M 0,0 L 5,5"));
+    std::string copy = path->attribute("d");
+    auto pathv = preparsed.takePath(path, copy.c_str());
+    ASSERT_TRUE(pathv);
+    EXPECT_EQ(*pathv, sp_svg_read_pathv(path->attribute("d")));
+    // Results are handed out once.
+    EXPECT_FALSE(preparsed.takePath(path, path->attribute("d")));
+
+    auto affine = preparsed.takeTransform(g, g->attribute("transform"));
+    ASSERT_TRUE(affine);
+    EXPECT_EQ(*affine, Geom::Affine(Geom::Translate(1, 2)));
+    EXPECT_EQ(preparsed.takeTransform(path, path->attribute("transform")), Geom::Affine(Geom::Scale(2)));
+}
+
+TEST(PreparsedAttributesTest, LoadsLargeDocument)
+{
+    // setup hidden dependency
+    Application::create(false);
+
+    // Enough paths to be parsed in parallel.
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'>";
+    for (int i = 0; i < 500; ++i) {
+        auto n = std::to_string(i);
+        svg += "<path id='p" + n + "' d='M " + n + ",0 h 10 v 10 z' transform='translate(" + n +
+               ")' style='fill:#ff0000;stroke-width:" + std::to_string(i % 7) + "' />";
+    }
+    svg += "</svg>";
+
+    auto doc = SPDocument::createNewDocFromMem(svg, false);
+    ASSERT_TRUE(doc);
+    EXPECT_FALSE(doc->getPreparsedAttributes());
+
+    for (int i = 0; i < 500; ++i) {
+        auto path = cast<SPPath>(doc->getObjectById("p" + std::to_string(i)));
+        ASSERT_TRUE(path);
+        ASSERT_TRUE(path->curve());
+        EXPECT_EQ(path->curve()->get_pathvector(), sp_svg_read_pathv(path->getAttribute("d")));
+        EXPECT_EQ(path->transform, Geom::Affine(Geom::Translate(i, 0)));
+        EXPECT_EQ(path->style->stroke_width.value, i % 7);
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
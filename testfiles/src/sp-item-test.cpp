@@ -80,3 +80,62 @@ TEST_F(SPItemTest, getClipPathVector)
     auto pathv4 = r_item->getClipPathVector(r_parent);
     ASSERT_EQ(sp_svg_write_path(*pathv4), "M 13.166016,13.166016 V 40.837891 H 40.837891 V 13.166016 Z");
 }
+
+TEST_F(SPItemTest, boundsCache)
+{
+    constexpr auto svg = R"""(<?xml version="1.0"?>
+<svg width="100" height="100">
+  <clipPath clipPathUnits="userSpaceOnUse" id="clipPath1">
+    <rect id="cliprect1" x="0" y="0" width="20" height="20" />
+  </clipPath>
+  <g id="group1" transform="translate(10,10)">
+    <rect id="rect1" x="0" y="0" width="50" height="50" style="fill: blue" />
+    <rect id="rect2" x="0" y="0" width="50" height="50" clip-path="url(#clipPath1)" />
+  </g>
+</svg>)"""sv;
+
+    auto doc = SPDocument::createNewDocFromMem(svg, true);
+    doc->ensureUpToDate();
+
+    auto group = cast<SPItem>(doc->getObjectById("group1"));
+    auto rect = cast<SPItem>(doc->getObjectById("rect1"));
+    auto clipped = cast<SPItem>(doc->getObjectById("rect2"));
+
+    SPItem::resetBoundsCacheStats();
+    EXPECT_EQ(rect->documentVisualBounds(), Geom::Rect(10, 10, 60, 60));
+    EXPECT_EQ(SPItem::boundsCacheStats().misses, 1ul);
+    EXPECT_EQ(rect->documentVisualBounds(), Geom::Rect(10, 10, 60, 60));
+    EXPECT_EQ(rect->geometricBounds(), Geom::Rect(0, 0, 50, 50));
+    EXPECT_EQ(rect->geometricBounds(), Geom::Rect(0, 0, 50, 50));
+    EXPECT_EQ(SPItem::boundsCacheStats().hits, 2ul);
+    EXPECT_EQ(SPItem::boundsCacheStats().misses, 2ul);
+
+    // Changing a child is seen by its ancestors.
+    EXPECT_EQ(group->documentGeometricBounds(), Geom::Rect(10, 10, 60, 60));
+    rect->setAttribute("width", "100");
+    doc->ensureUpToDate();
+    EXPECT_EQ(rect->documentVisualBounds(), Geom::Rect(10, 10, 110, 60));
+    EXPECT_EQ(group->documentGeometricBounds(), Geom::Rect(10, 10, 110, 60));
+
+    // Moving an ancestor moves the document bounds.
+    group->setAttribute("transform", "translate(20,20)");
+    doc->ensureUpToDate();
+    EXPECT_EQ(rect->documentGeometricBounds(), Geom::Rect(20, 20, 120, 70));
+    EXPECT_EQ(rect->geometricBounds(), Geom::Rect(0, 0, 100, 50));
+
+    // Editing a clip path changes the bounds of the clipped item.
+    EXPECT_EQ(clipped->visualBounds(), Geom::Rect(0, 0, 20, 20));
+    doc->getObjectById("cliprect1")->setAttribute("width", "30");
+    doc->ensureUpToDate();
+    EXPECT_EQ(clipped->visualBounds(), Geom::Rect(0, 0, 30, 20));
+
+    // Changes made before the next query are all seen, also after only an ancestor was queried.
+    rect->setAttribute("width", "60");
+    rect->setAttribute("height", "60");
+    doc->ensureUpToDate();
+    EXPECT_EQ(group->documentGeometricBounds(), Geom::Rect(20, 20, 80, 80));
+    rect->setAttribute("width", "70");
+    doc->ensureUpToDate();
+    EXPECT_EQ(group->documentGeometricBounds(), Geom::Rect(20, 20, 90, 80));
+    EXPECT_EQ(rect->geometricBounds(), Geom::Rect(0, 0, 70, 60));
+}
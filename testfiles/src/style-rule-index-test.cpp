@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the index of the rules of a document's style sheets.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "document.h"
+#include "inkscape.h"
+#include "style.h"
+#include "3rdparty/libcroco/src/cr-sel-eng.h"
+#include "object/sp-object.h"
+#include "object/sp-style-elem.h"
+#include "object/style-rule-index.h"
+#include "xml/croco-node-iface.h"
+#include "xml/node.h"
+
+using namespace Inkscape;
+using namespace std::literals;
+
+namespace {
+
+/// What libcroco's own engine makes of the cascade for @a node.
+std::vector<CRDeclaration *> cascade_declarations(SPDocument &doc, XML::Node &node)
+{
+    static CRSelEng *const sel_eng = cr_sel_eng_new(&XML::croco_node_iface);
+
+    CRPropList *props = nullptr;
+    cr_sel_eng_get_matched_properties_from_cascade(sel_eng, doc.getStyleCascade(), &node, &props);
+
+    std::vector<CRDeclaration *> result;
+    for (auto prop = props; prop; prop = cr_prop_list_get_next(prop)) {
+        CRDeclaration *decl = nullptr;
+        cr_prop_list_get_decl(prop, &decl);
+        result.push_back(decl);
+    }
+    cr_prop_list_destroy(props);
+    return result;
+}
+
+void expect_same_as_cascade(SPDocument &doc, XML::Node &node)
+{
+    if (node.type() == XML::NodeType::ELEMENT_NODE) {
+        EXPECT_EQ(doc.getStyleRules().matchedDeclarations(node), cascade_declarations(doc, node))
+            << "for " << node.name() << " " << (node.attribute("id") ? node.attribute("id") : "");
+    }
+    for (auto child = node.firstChild(); child; child = child->next()) {
+        expect_same_as_cascade(doc, *child);
+    }
+}
+
+} // namespace
+
+TEST(StyleRuleIndexTest, MatchesLikeCascade)
+{
+    Application::create(false);
+
+    auto doc = SPDocument::createNewDocFromMem(R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+<style>
+* { stroke-width: 1; }
+rect { fill: red; opacity: 0.5; }
+.a { fill: blue; }
+.a.b { fill: green !important; }
+#r1, .b { stroke: black; opacity: 1; }
+g rect { stroke-width: 2; }
+g > .a { stroke-width: 3; }
+#g1 .b rect { stroke-width: 4; }
+rect + rect { fill-opacity: 0.3; }
+[class~=c] { stroke-opacity: 0.2; }
+circle:first-child { fill: yellow; }
+rect.a, ellipse { fill: orange; }
+</style>
+<style>
+.a { fill: purple; }
+g#g1 > rect.b { opacity: 0.7 !important; }
+rect { opacity: 0.1; }
+</style>
+<g id='g1' class='b'>
+  <rect id='r1' class='a' />
+  <rect id='r2' class='a b c' />
+  <g class='a'>
+    <circle id='c1' class=' c ' />
+    <rect id='r3' class='b' />
+  </g>
+</g>
+<rect id='r4' class='a a' />
+<ellipse id='e1' />
+</svg>)A"sv, false);
+    ASSERT_TRUE(doc);
+    EXPECT_GT(doc->getStyleRules().size(), 0u);
+
+    expect_same_as_cascade(*doc, *doc->getReprRoot());
+
+    auto r1 = doc->getObjectById("r1");
+    ASSERT_TRUE(r1);
+    EXPECT_EQ(r1->style->stroke_width.value, 3);
+}
+
+TEST(StyleRuleIndexTest, RebuiltWhenStyleChanges)
+{
+    Application::create(false);
+
+    auto doc = SPDocument::createNewDocFromMem(R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+<style id='s'>.a { stroke-width: 2; }</style>
+<rect id='r' class='a' />
+</svg>)A"sv, false);
+    ASSERT_TRUE(doc);
+
+    auto rect = doc->getObjectById("r");
+    ASSERT_TRUE(rect);
+    EXPECT_EQ(rect->style->stroke_width.value, 2);
+    EXPECT_EQ(doc->getStyleRules().size(), 1u);
+
+    auto style = cast<SPStyleElem>(doc->getObjectById("s"));
+    ASSERT_TRUE(style);
+    style->getRepr()->firstChild()->setContent(".a { stroke-width: 5; } rect { fill: red; }");
+    EXPECT_EQ(doc->getStyleRules().size(), 2u);
+
+    rect->style->readFromObject(rect);
+    EXPECT_EQ(rect->style->stroke_width.value, 5);
+    expect_same_as_cascade(*doc, *doc->getReprRoot());
+}
+
+TEST(StyleRuleIndexTest, ObjectsBySelector)
+{
+    Application::create(false);
+
+    auto doc = SPDocument::createNewDocFromMem(R"A(
+<svg xmlns='http://www.w3.org/2000/svg'>
+<g id='g1' class='x'>
+  <rect id='r1' class='a' />
+  <rect id='r2' class='a b' />
+</g>
+<rect id='r3' class='b' />
+<circle id='c1' class='a' />
+</svg>)A"sv, false);
+    ASSERT_TRUE(doc);
+
+    auto ids = [&] (char const *selector) {
+        std::string result;
+        for (auto object : doc->getObjectsBySelector(selector)) {
+            result += object->getId();
+            result += ' ';
+        }
+        return result;
+    };
+    EXPECT_EQ(ids(".a"), "r1 r2 c1 ");
+    EXPECT_EQ(ids("rect.a"), "r1 r2 ");
+    EXPECT_EQ(ids(".x .b"), "r2 ");
+    EXPECT_EQ(ids("rect"), "r1 r2 r3 ");
+    EXPECT_EQ(ids("#r3, .x > .a.b"), "r3 r2 ");
+}
+
+TEST(StyleRuleIndexTest, LoadsLargeStyleSheet)
+{
+    Application::create(false);
+
+    // Many class rules, as in drawings exported from CAD software, each used by a few objects.
+    constexpr int rules = 2000;
+    constexpr int objects = 4000;
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'><style>";
+    for (int i = 0; i < rules; ++i) {
+        svg += ".c" + std::to_string(i) + " { stroke-width: " + std::to_string(i % 9) + "; }\n";
+    }
+    svg += "</style><g>";
+    for (int i = 0; i < objects; ++i) {
+        svg += "<rect id='r" + std::to_string(i) + "' class='c" + std::to_string(i % rules) + "' />";
+    }
+    svg += "</g></svg>";
+
+    auto doc = SPDocument::createNewDocFromMem(svg, false);
+    ASSERT_TRUE(doc);
+    auto const &index = doc->getStyleRules();
+    EXPECT_EQ(index.size(), static_cast<std::size_t>(rules));
+
+    // Each object picks up the one rule for its class, and nothing from the other rules.
+    for (int i = 0; i < objects; ++i) {
+        auto rect = doc->getObjectById("r" + std::to_string(i));
+        ASSERT_TRUE(rect);
+        EXPECT_EQ(index.matchedDeclarations(*rect->getRepr()).size(), 1u);
+        EXPECT_EQ(rect->style->stroke_width.value, (i % rules) % 9);
+    }
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -10,6 +10,7 @@
 #include "svg/svg-length.h"
 #include "svg/svg.h"
 
+#include <cstring>
 #include <glib.h>
 #include <gtest/gtest.h>
 #include <utility>
@@ -210,6 +211,17 @@ TEST(SvgLengthTest, testPlaces)
     testd_t const precTests[] = {
         {"760", 761.92918978947023, 2, -8},
         {"761.9", 761.92918978947023, 4, -8},
+        {"510", 514.851, 2, -8},
+        {"2.68", 2.675, 3, -8},
+        {"0.3", 0.1 + 0.2, 8, -8},
+        {"1000", 999.99999999, 8, -8},
+        {"-0.01234568", -0.0123456789, 8, -8},
+        {"0", -0.0004, 3, -3},
+        {"1.2345679e-5", 1.23456789e-5, 8, -8},
+        {"0", 1.23456789e-9, 8, -8},
+        {"1e-4", 9.99999999e-5, 8, -8},
+        {"1234567890123", 1234567890123.0, 16, -8},
+        {"1.2346e20", 1.23456789e20, 5, -8},
     };
 
     for (size_t i = 0; i < G_N_ELEMENTS(precTests); i++) {
@@ -221,6 +233,43 @@ TEST(SvgLengthTest, testPlaces)
     }
 }
 
+TEST(SvgLengthTest, testScanNumber)
+{
+    struct testd_t
+    {
+        char const *str;
+        int length; ///< of the number at the start of str, or -1 if there is none
+        double val;
+    };
+
+    testd_t const scanTests[] = {
+        {"1e-2", 4, 1e-2},
+        {".2e-1,", 5, .2e-1},
+        {"+0150E-2", 8, 1.5},
+        {"-.5.5", 3, -.5},
+        {"3.e", 2, 3.},
+        {"13e+-12", 2, 13},
+        {"0.30000000000000004", 19, 0.30000000000000004},
+        {"123456789012345678901234", 24, 123456789012345678901234.},
+        {"4.9e-324", 8, 4.9e-324},
+        {".e12", -1, 0},
+        {"+.", -1, 0},
+        {"e5", -1, 0},
+    };
+
+    for (auto const &test : scanTests) {
+        double val = 0;
+        char const *end = sp_svg_number_scan(test.str, test.str + std::strlen(test.str), &val);
+        if (test.length < 0) {
+            EXPECT_EQ(end, nullptr) << test.str;
+        } else {
+            ASSERT_NE(end, nullptr) << test.str;
+            EXPECT_EQ(end - test.str, test.length) << test.str;
+            EXPECT_EQ(val, test.val) << test.str;
+        }
+    }
+}
+
 // TODO: More tests
 
 // vim: filetype=cpp:expandtab:shiftwidth=4:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -9,9 +9,14 @@
  */
 #include <2geom/coord.h>
 #include <2geom/curves.h>
+#include <2geom/path-sink.h>
 #include <2geom/pathvector.h>
+#include <2geom/svg-path-parser.h>
+#include <algorithm>
+#include <cmath>
 #include <glib.h>
 #include <gtest/gtest.h>
+#include <random>
 #include <vector>
 
 #include "preferences.h"
@@ -489,6 +494,134 @@ TEST(PathVectorToBeziersTest, random)
     pathv_to_linear_and_cubic_beziers(pathv);
 }
 
+namespace {
+
+/// Random path data using every command, both coordinate modes and all sorts of separators.
+std::string random_path_data(std::mt19937 &rng, int segments)
+{
+    static char const commands[] = "MLHVCSQTAZmlhvcsqtaz";
+    static char const *separators[] = {" ", ",", " , ", "\n"};
+    std::uniform_real_distribution<double> coord(-500, 500);
+    auto number = [&] (std::string &str, bool nonnegative = false) {
+        double const v = nonnegative ? std::fabs(coord(rng)) : coord(rng);
+        switch (rng() % 4) {
+            case 0: str += std::to_string(static_cast<int>(v)); break;
+            case 1: str += sp_svg_number_write_de(v, 8, -8); break;
+            case 2: str += sp_svg_number_write_de(v / 1000, 4, -8); break;
+            default: str += sp_svg_number_write_de(v * 1e7, 3, -8); break;
+        }
+    };
+    auto separator = [&] (std::string &str) {
+        str += separators[rng() % G_N_ELEMENTS(separators)];
+    };
+
+    std::string str = "M";
+    number(str);
+    separator(str);
+    number(str);
+    for (int i = 0; i < segments; ++i) {
+        char const cmd = commands[rng() % (sizeof(commands) - 1)];
+        str += ' ';
+        str += cmd;
+        int args = 0;
+        switch (cmd) {
+            case 'M': case 'm': case 'L': case 'l': case 'T': case 't': args = 2; break;
+            case 'H': case 'h': case 'V': case 'v': args = 1; break;
+            case 'C': case 'c': args = 6; break;
+            case 'S': case 's': case 'Q': case 'q': args = 4; break;
+            case 'A': case 'a': args = 7; break;
+            default: break;
+        }
+        int const repeats = args ? 1 + rng() % 3 : 1;
+        for (int r = 0; r < repeats; ++r) {
+            for (int a = 0; a < args; ++a) {
+                str += ' ';
+                bool const arc = cmd == 'A' || cmd == 'a';
+                if (arc && (a == 3 || a == 4)) {
+                    str += rng() % 2 ? '1' : '0';
+                } else {
+                    number(str, arc && a < 2);
+                }
+                if (a + 1 < args) {
+                    separator(str);
+                }
+            }
+        }
+    }
+    return str;
+}
+
+Geom::PathVector read_pathv_2geom(char const *str)
+{
+    Geom::PathVector pathv;
+    Geom::PathBuilder builder(pathv);
+    Geom::SVGPathParser parser(builder);
+    parser.setZSnapThreshold(Geom::EPSILON);
+    parser.parse(str);
+    builder.flush();
+    return pathv;
+}
+
+} // namespace
+
+TEST_F(SvgPathGeomTest, testReadMatchesSVGPathParser)
+{
+    std::mt19937 rng(4);
+    for (int i = 0; i < 2000; ++i) {
+        auto const str = random_path_data(rng, 1 + i % 40);
+        Geom::PathVector pv;
+        ASSERT_TRUE(sp_svg_read_pathv(str.data(), str.data() + str.size(), pv)) << str;
+        ASSERT_TRUE(pv == read_pathv_2geom(str.c_str())) << str;
+    }
+}
+
+TEST_F(SvgPathGeomTest, testReadSpan)
+{
+    // The span need not be null-terminated
+    std::string const str = "M 1,2 4,2 4,8 1,8 z M 5,5";
+    Geom::PathVector pv;
+    ASSERT_TRUE(sp_svg_read_pathv(str.data(), str.data() + str.find(" M 5"), pv));
+    ASSERT_TRUE(bpathEqual(pv, rectanglepvclosed));
+
+    // Malformed data gives what was read up to the error
+    pv.clear();
+    ASSERT_FALSE(sp_svg_read_pathv(str.data(), str.data() + str.find("4,8") + 2, pv));
+    ASSERT_EQ(pv.size(), 1u);
+    ASSERT_EQ(pv[0].size(), 1u);
+}
+
+TEST_F(SvgPathGeomTest, testWriteReadsBack)
+{
+    std::mt19937 rng(5);
+    for (int i = 0; i < 2000; ++i) {
+        auto const pv = sp_svg_read_pathv(random_path_data(rng, 1 + i % 40).c_str());
+        auto const str = sp_svg_write_path(pv);
+        Geom::PathVector back;
+        ASSERT_TRUE(sp_svg_read_pathv(str.data(), str.data() + str.size(), back)) << str;
+
+        // Coordinates are written with 8 significant digits.
+        double scale = 1.0;
+        for (auto const &path : pv) {
+            for (auto const &curve : path) {
+                for (auto const &p : {curve.initialPoint(), curve.finalPoint()}) {
+                    scale = std::max({scale, std::fabs(p[Geom::X]), std::fabs(p[Geom::Y])});
+                }
+            }
+        }
+        double const eps = scale * 1e-6;
+
+        ASSERT_EQ(back.size(), pv.size()) << str;
+        for (std::size_t j = 0; j < pv.size(); ++j) {
+            ASSERT_EQ(back[j].closed(), pv[j].closed()) << str;
+            ASSERT_EQ(back[j].size(), pv[j].size()) << str;
+            for (std::size_t k = 0; k < pv[j].size(); ++k) {
+                ASSERT_TRUE(Geom::are_near(back[j][k].initialPoint(), pv[j][k].initialPoint(), eps)) << str;
+                ASSERT_TRUE(Geom::are_near(back[j][k].finalPoint(), pv[j][k].finalPoint(), eps)) << str;
+            }
+        }
+    }
+}
+
 /*
  * Please do not change my prefs or put them back after :(
  * also, fails.
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Tests for the cache of rendered tiles kept on disk.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2026 Authors
+ *
+ * Released under GNU GPL version 2 or later, read the file 'COPYING' for more information
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "display/tile-disk-cache.h"
+
+using Inkscape::TileDiskCache;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int SIDE = 32;
+constexpr std::size_t TILE_BYTES = 12 + SIDE * SIDE * 4;
+
+class TileDiskCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto const test = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        dir = fs::temp_directory_path() / (std::string("inkscape-tile-disk-cache-test-") + test);
+        fs::remove_all(dir);
+    }
+
+    void TearDown() override { fs::remove_all(dir); }
+
+    std::shared_ptr<TileDiskCache> make_cache(std::size_t budget)
+    {
+        return std::make_shared<TileDiskCache>(dir.string(), budget);
+    }
+
+    fs::path dir;
+};
+
+/// Insert a tile filled with @a pixel.
+void insert(TileDiskCache &cache, std::string const &key, std::uint32_t pixel)
+{
+    auto surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, SIDE, SIDE);
+    auto const data = cairo_image_surface_get_data(surface);
+    for (int y = 0; y < SIDE; y++) {
+        auto row = reinterpret_cast<std::uint32_t *>(data + y * cairo_image_surface_get_stride(surface));
+        std::fill(row, row + SIDE, pixel);
+    }
+    cairo_surface_mark_dirty(surface);
+    cache.insert(key, surface);
+    cairo_surface_destroy(surface);
+}
+
+/// The pixel the tile for @a key is filled with, or 0 if it is not found.
+std::uint32_t lookup(TileDiskCache &cache, std::string const &key)
+{
+    auto surface = cache.lookup(key);
+    if (!surface) {
+        return 0;
+    }
+    EXPECT_EQ(cairo_image_surface_get_width(surface), SIDE);
+    EXPECT_EQ(cairo_image_surface_get_height(surface), SIDE);
+    auto const data = cairo_image_surface_get_data(surface);
+    auto const pixel = reinterpret_cast<std::uint32_t *>(data + (SIDE - 1) * cairo_image_surface_get_stride(surface))[SIDE - 1];
+    cairo_surface_destroy(surface);
+    return pixel;
+}
+
+} // namespace
+
+TEST_F(TileDiskCacheTest, KeepsTilesAcrossInstances)
+{
+    auto cache = make_cache(TILE_BYTES * 10);
+    EXPECT_EQ(lookup(*cache, "a"), 0u);
+    insert(*cache, "a", 0xff102030);
+    insert(*cache, "b", 0x80402010);
+    cache->flush();
+    EXPECT_EQ(cache->size(), TILE_BYTES * 2);
+    EXPECT_EQ(lookup(*cache, "a"), 0xff102030);
+    EXPECT_EQ(lookup(*cache, "b"), 0x80402010);
+
+    // Writing again to the same key replaces the tile.
+    insert(*cache, "a", 0xff000000);
+    cache->flush();
+    EXPECT_EQ(cache->size(), TILE_BYTES * 2);
+    cache.reset();
+
+    auto later = make_cache(TILE_BYTES * 10);
+    EXPECT_EQ(lookup(*later, "a"), 0xff000000);
+    EXPECT_EQ(lookup(*later, "b"), 0x80402010);
+    insert(*later, "c", 0xffffffff);
+    later->flush();
+    EXPECT_EQ(later->size(), TILE_BYTES * 3);
+}
+
+TEST_F(TileDiskCacheTest, EvictsLeastRecentlyUsed)
+{
+    auto cache = make_cache(TILE_BYTES * 2);
+    insert(*cache, "a", 0xff0000ff);
+    insert(*cache, "b", 0xff00ff00);
+    cache->flush();
+
+    // Using "a" makes "b" the least recently used.
+    EXPECT_EQ(lookup(*cache, "a"), 0xff0000ff);
+    insert(*cache, "c", 0xffff0000);
+    cache->flush();
+
+    EXPECT_LE(cache->size(), TILE_BYTES * 2);
+    EXPECT_EQ(lookup(*cache, "b"), 0u);
+    EXPECT_EQ(lookup(*cache, "a"), 0xff0000ff);
+    EXPECT_EQ(lookup(*cache, "c"), 0xffff0000);
+
+    cache->set_budget(TILE_BYTES);
+    EXPECT_EQ(cache->size(), TILE_BYTES);
+    EXPECT_EQ(lookup(*cache, "a"), 0u);
+    EXPECT_EQ(lookup(*cache, "c"), 0xffff0000);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -12,11 +12,22 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
+#include <glib.h>
+#include "gc-anchored.h"
+#include "inkgc/gc-core.h"
+#include "xml/journal.h"
 #include "xml/repr.h"
+#include "xml/repr-reader.h"
+#include "xml/string-table.h"
 
 TEST(XmlTest, nodeiter)
 {
@@ -98,6 +109,349 @@ NODE
 )""");
 }
 
+TEST(XmlReadTest, structure)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(R"""(<?xml version="1.0"?>
+<!-- before -->
+<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink">
+  <g id="a" xml:space="preserve"> <use xlink:href="#b"/></g>
+  <text id="b">x<![CDATA[<y>]]></text><empty></empty>
+  <?target data?>
+</svg>)""", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+
+    auto first = testdoc->firstChild();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->type(), Inkscape::XML::NodeType::COMMENT_NODE);
+    EXPECT_STREQ(first->content(), " before ");
+
+    auto root = testdoc->root();
+    ASSERT_TRUE(root);
+    EXPECT_STREQ(root->name(), "svg:svg");
+    EXPECT_EQ(root->childCount(), 4u);
+
+    // Whitespace is only kept where asked for.
+    auto g = root->firstChild();
+    EXPECT_STREQ(g->name(), "svg:g");
+    EXPECT_STREQ(g->attribute("xml:space"), "preserve");
+    ASSERT_EQ(g->childCount(), 2u);
+    EXPECT_STREQ(g->firstChild()->content(), " ");
+    EXPECT_STREQ(g->lastChild()->name(), "svg:use");
+    EXPECT_STREQ(g->lastChild()->attribute("xlink:href"), "#b");
+
+    auto text = g->next();
+    EXPECT_STREQ(text->name(), "svg:text");
+    ASSERT_EQ(text->childCount(), 2u);
+    EXPECT_STREQ(text->firstChild()->content(), "x");
+    EXPECT_STREQ(text->lastChild()->content(), "<y>");
+
+    auto empty = text->next();
+    EXPECT_STREQ(empty->name(), "svg:empty");
+    EXPECT_EQ(empty->childCount(), 0u);
+
+    auto pi = empty->next();
+    EXPECT_EQ(pi->type(), Inkscape::XML::NodeType::PI_NODE);
+    EXPECT_STREQ(pi->name(), "target");
+}
+
+TEST(XmlAttributeTest, SharesShortValues)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(R"""(
+<svg>
+  <path id='a' fill='none' style='stroke:#000000;stroke-width:2' />
+  <path id='b' fill='none' style='stroke:#000000;stroke-width:2' />
+</svg>)""", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+
+    auto a = testdoc->root()->firstChild();
+    auto b = a->next();
+    EXPECT_EQ(a->attribute("fill"), b->attribute("fill"));
+    EXPECT_EQ(a->attribute("style"), b->attribute("style"));
+    EXPECT_NE(a->attribute("id"), b->attribute("id"));
+
+    // Long values are copied.
+    auto const long_value = std::string(Inkscape::XML::StringTable::MAX_LENGTH + 1, 'x');
+    a->setAttribute("d", long_value);
+    b->setAttribute("d", long_value);
+    EXPECT_STREQ(a->attribute("d"), b->attribute("d"));
+    EXPECT_NE(a->attribute("d"), b->attribute("d"));
+}
+
+TEST(XmlAttributeTest, FindsHotAttributes)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf("<svg><path/></svg>", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+
+    auto path = testdoc->root()->firstChild();
+    path->setAttribute("fill", "red");
+    path->setAttribute("d", "M 0,0 h 1");
+    path->setAttribute("id", "p");
+    path->setAttribute("transform", "scale(2)");
+    path->setAttribute("style", "opacity:1");
+    EXPECT_STREQ(path->attribute("d"), "M 0,0 h 1");
+    EXPECT_STREQ(path->attribute("id"), "p");
+
+    // Positions move when an attribute before them is removed.
+    path->removeAttribute("fill");
+    path->removeAttribute("d");
+    EXPECT_EQ(path->attribute("d"), nullptr);
+    EXPECT_STREQ(path->attribute("id"), "p");
+    EXPECT_STREQ(path->attribute("transform"), "scale(2)");
+    EXPECT_STREQ(path->attribute("style"), "opacity:1");
+    EXPECT_EQ(path->attribute("never-used-as-an-attribute-name"), nullptr);
+
+    // Too many attributes to keep positions for.
+    for (int i = 0; i < 300; ++i) {
+        path->setAttribute("attr" + std::to_string(i), std::to_string(i));
+    }
+    path->setAttribute("d", "M 1,1");
+    EXPECT_STREQ(path->attribute("d"), "M 1,1");
+    EXPECT_STREQ(path->attribute("id"), "p");
+    EXPECT_STREQ(path->attribute("attr299"), "299");
+
+    auto copy = path->duplicate(testdoc.get());
+    EXPECT_STREQ(copy->attribute("d"), "M 1,1");
+    Inkscape::GC::release(copy);
+}
+
+TEST(XmlAttributeTest, MemoryPerNode)
+{
+    // Typical of drawings: a unique id and path, and presentation values repeated on every shape.
+    constexpr int count = 20000;
+    auto const style = std::string("fill:none;stroke:#000000;stroke-width:0.26458332px;stroke-linecap:butt");
+    auto const make_svg = [&] (bool unique_style) {
+        std::string svg = "<svg>";
+        for (int i = 0; i < count; ++i) {
+            auto n = std::to_string(i);
+            svg += "<path id='path" + n + "' d='M " + n + ",0 h 10 v 10 z' fill='none' "
+                   "style='" + style + (unique_style ? ";--n:" + n : "") + "' />";
+        }
+        return svg + "</svg>";
+    };
+
+    auto const in_use = [] {
+        Inkscape::GC::Core::gcollect();
+        return Inkscape::GC::Core::get_heap_size() - Inkscape::GC::Core::get_free_bytes();
+    };
+
+    auto const bytes_per_node = [&] (std::string const &svg) {
+        auto const before = in_use();
+        auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(svg, SP_SVG_NS_URI));
+        EXPECT_TRUE(testdoc);
+        EXPECT_EQ(testdoc->root()->childCount(), static_cast<unsigned>(count));
+        auto const after = in_use();
+        return after > before ? double(after - before) / count : 0.0;
+    };
+
+    auto const shared = bytes_per_node(make_svg(false));
+    auto const unique = bytes_per_node(make_svg(true));
+    RecordProperty("bytes_per_node", std::to_string(shared));
+
+    // The repeated style is stored once per document rather than once per node...
+    EXPECT_LT(shared + style.size() / 2, unique);
+    // ...leaving little more than the node itself and its unique id and path data.
+    EXPECT_LT(shared, 1024.0);
+}
+
+TEST(XmlSaveTest, LargeDocument)
+{
+    // Enough nodes for the writer to format parts of the document in parallel, with one group
+    // large enough to be split itself.
+    constexpr int groups = 400;
+    std::string svg = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+                      "<svg:svg\n   xmlns:svg=\"http://www.w3.org/2000/svg\">\n";
+    for (int g = 0; g < groups; ++g) {
+        auto const n = std::to_string(g);
+        svg += "  <svg:g\n     id=\"g" + n + "\">\n";
+        for (int r = 0, rects = g == 0 ? 6000 : 20; r < rects; ++r) {
+            svg += "    <svg:rect\n       id=\"r" + n + "-" + std::to_string(r) + "\"\n       width=\"" +
+                   std::to_string(r) + "\" />\n";
+        }
+        svg += "    <svg:text\n       id=\"t" + n + "\"><svg:tspan>a &amp; b</svg:tspan></svg:text>\n";
+        svg += "    <!-- c" + n + " -->\n";
+        svg += "  </svg:g>\n";
+    }
+    svg += "</svg:svg>\n";
+
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(svg, SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+
+    // Written exactly as it was read, in document order.
+    ASSERT_EQ(sp_repr_save_buf(testdoc.get()).raw(), svg);
+
+    // Changes within the split group and after it land in the right place.
+    auto const big_group = testdoc->root()->firstChild();
+    big_group->nthChild(2999)->setAttribute("width", "x");
+    big_group->nthChild(3000)->setAttribute("width", "y");
+    testdoc->root()->lastChild()->firstChild()->setAttribute("width", "z");
+
+    auto expected = svg;
+    for (auto [id, value] : {std::pair{"r0-2999", "x"}, std::pair{"r0-3000", "y"}, std::pair{"r399-0", "z"}}) {
+        auto const pos = expected.find("width=\"", expected.find(std::string("id=\"") + id + "\""));
+        ASSERT_NE(pos, std::string::npos);
+        auto const start = pos + 7;
+        expected.replace(start, expected.find('"', start) - start, value);
+    }
+    EXPECT_EQ(sp_repr_save_buf(testdoc.get()).raw(), expected);
+}
+
+TEST(XmlJournalTest, ReplaysChanges)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf(R"""(
+<svg>
+  <g id='a'><rect id='r1'/><rect id='r2'/><rect id='r3'/></g>
+  <!-- comment -->
+  <text id='t'><![CDATA[x < y]]></text>
+</svg>)""", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+    auto const root = testdoc->root();
+    auto const group = root->firstChild();
+
+    Inkscape::XML::Journal journal(*testdoc);
+    auto written = journal.snapshot().text();
+    auto const snapshot_size = written.size();
+
+    // Like a drag: only the last value of each attribute is kept.
+    for (int i = 0; i < 1000; ++i) {
+        group->firstChild()->setAttribute("x", std::to_string(i));
+        group->firstChild()->setAttribute("y", std::to_string(-i));
+    }
+    auto changes = journal.takeChanges();
+    EXPECT_EQ(changes.size(), 2u);
+    written += changes.text();
+    EXPECT_TRUE(journal.empty());
+    EXPECT_EQ(journal.takeChanges().text(), "");
+
+    // Nodes added with their subtrees, moved both ways, removed, renamed and changed.
+    auto const added = testdoc->createElement("svg:g");
+    added->setAttribute("id", "b");
+    auto const text = testdoc->createTextNode("");
+    added->appendChild(text);
+    root->addChildAtPos(added, 1);
+    Inkscape::GC::release(added);
+    Inkscape::GC::release(text);
+    text->setContent("multi\nline ");
+    group->changeOrder(group->firstChild(), group->lastChild());
+    group->changeOrder(group->lastChild(), nullptr);
+    group->changeOrder(group->nthChild(2), group->firstChild());
+    group->removeChild(group->nthChild(1));
+    group->firstChild()->setCodeUnsafe(g_quark_from_string("svg:circle"));
+    group->firstChild()->setAttribute("y", nullptr);
+    root->lastChild()->firstChild()->setContent("y > x");
+    root->setAttribute("width", "10");
+    written += journal.takeChanges().text();
+
+    auto replayed = std::shared_ptr<Inkscape::XML::Document>(Inkscape::XML::Journal::read(written));
+    ASSERT_TRUE(replayed);
+    EXPECT_EQ(sp_repr_save_buf(replayed.get()), sp_repr_save_buf(testdoc.get()));
+    EXPECT_EQ(replayed->root()->nthChild(1)->childCount(), 1u);
+
+    // A chunk cut short is left out.
+    replayed = std::shared_ptr<Inkscape::XML::Document>(Inkscape::XML::Journal::read(written.substr(0, snapshot_size + 10)));
+    ASSERT_TRUE(replayed);
+    EXPECT_EQ(replayed->root()->firstChild()->firstChild()->attribute("x"), nullptr);
+
+    EXPECT_FALSE(Inkscape::XML::Journal::read("<svg/>"));
+}
+
+TEST(XmlJournalTest, RecordsEachChangeOnce)
+{
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_buf("<svg><g/></svg>", SP_SVG_NS_URI));
+    ASSERT_TRUE(testdoc);
+    auto const group = testdoc->root()->firstChild();
+    for (int i = 0; i < 2000; ++i) {
+        auto const rect = testdoc->createElement("svg:rect");
+        rect->setAttribute("id", "r" + std::to_string(i));
+        group->appendChild(rect);
+        Inkscape::GC::release(rect);
+    }
+
+    Inkscape::XML::Journal journal(*testdoc);
+    auto written = journal.snapshot().text();
+
+    // Deleting many children of a large group, and adding some among those that are left.
+    for (int i = 0; i < 1000; ++i) {
+        group->removeChild(group->nthChild(i));
+    }
+    for (int i = 0; i < 10; ++i) {
+        auto const circle = testdoc->createElement("svg:circle");
+        group->addChildAtPos(circle, i * 50);
+        Inkscape::GC::release(circle);
+        group->changeOrder(group->nthChild(i * 7 + 3), group->nthChild(i * 30 + 20));
+    }
+    auto const changes = journal.takeChanges();
+    EXPECT_EQ(changes.size(), 1000u + 10u + 10u);
+    written += changes.text();
+
+    auto replayed = std::shared_ptr<Inkscape::XML::Document>(Inkscape::XML::Journal::read(written));
+    ASSERT_TRUE(replayed);
+    EXPECT_EQ(sp_repr_save_buf(replayed.get()), sp_repr_save_buf(testdoc.get()));
+}
+
+TEST(XmlReadTest, ReadsFileInSlices)
+{
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'>";
+    for (int i = 0; i < 20000; ++i) {
+        svg += "<rect id='r" + std::to_string(i) + "' width='" + std::to_string(i) + "'/>";
+    }
+    svg += "</svg>";
+
+    auto const filename = std::string(g_get_tmp_dir()) + "/xml-test-" + std::to_string(g_random_int()) + ".svg";
+    ASSERT_TRUE(g_file_set_contents(filename.c_str(), svg.data(), svg.size(), nullptr));
+
+    Inkscape::XML::FileReader reader(filename.c_str(), SP_SVG_NS_URI);
+    std::vector<double> progress;
+    while (reader.read({})) {
+        progress.push_back(reader.progress());
+    }
+    EXPECT_GT(progress.size(), 1u);
+    EXPECT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(reader.finish());
+    ASSERT_TRUE(testdoc);
+    EXPECT_STREQ(testdoc->root()->name(), "svg:svg");
+    EXPECT_EQ(testdoc->root()->childCount(), 20000u);
+
+    auto whole = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_file(filename.c_str(), SP_SVG_NS_URI));
+    ASSERT_TRUE(whole);
+    EXPECT_EQ(sp_repr_save_buf(testdoc.get()), sp_repr_save_buf(whole.get()));
+
+    std::remove(filename.c_str());
+}
+
+TEST(XmlReadTest, ReadsFileOnAnotherThread)
+{
+    std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'>";
+    for (int i = 0; i < 20000; ++i) {
+        svg += "<g id='g" + std::to_string(i) + "'><rect width='" + std::to_string(i) + "'/>text</g>";
+    }
+    svg += "</svg>";
+
+    auto const filename = std::string(g_get_tmp_dir()) + "/xml-test-" + std::to_string(g_random_int()) + ".svg";
+    ASSERT_TRUE(g_file_set_contents(filename.c_str(), svg.data(), svg.size(), nullptr));
+
+    Inkscape::XML::FileReader reader(filename.c_str(), SP_SVG_NS_URI);
+    std::thread([&] {
+        Inkscape::GC::ThreadRegistration registration;
+        while (reader.read(std::chrono::milliseconds(1))) {
+            // Collections meanwhile must not lose the nodes read so far.
+            Inkscape::GC::Core::gcollect();
+        }
+        reader.complete();
+    }).join();
+    Inkscape::GC::Core::gcollect();
+
+    auto testdoc = std::shared_ptr<Inkscape::XML::Document>(reader.finish());
+    ASSERT_TRUE(testdoc);
+    EXPECT_EQ(testdoc->root()->childCount(), 20000u);
+
+    auto whole = std::shared_ptr<Inkscape::XML::Document>(sp_repr_read_file(filename.c_str(), SP_SVG_NS_URI));
+    ASSERT_TRUE(whole);
+    EXPECT_EQ(sp_repr_save_buf(testdoc.get()), sp_repr_save_buf(whole.get()));
+
+    std::remove(filename.c_str());
+}
+
 /*
   Local Variables:
   mode:c++